@@ -46,6 +46,15 @@ typedef Eigen::Matrix<acfd::a_real, NDIM, NDIM, Eigen::RowMajor> MatrixDim;
 /// Vector type to be used for dense linear algebra
 typedef Eigen::Matrix<acfd::a_real, Eigen::Dynamic, 1> Vector;
 
+/// Writable view of a Matrix stored elsewhere, eg, one element's block of a [DOF vector](@ref acfd::DOFVector)
+typedef Eigen::Map<Matrix> MatrixMap;
+
+/// Read-only view of a Matrix stored elsewhere
+typedef Eigen::Map<const Matrix> ConstMatrixMap;
+
+/// Read-only argument type that binds to a Matrix or a map of one without copying
+typedef Eigen::Ref<const Matrix> ConstMatrixRef;
+
 #endif
 
 
@@ -0,0 +1,87 @@
+/** @file adofvector.cpp
+ * @brief Implementation of contiguous DOF storage
+ */
+
+#include "adofvector.hpp"
+
+namespace acfd {
+
+DOFVector::DOFVector() : nv(0), offsets(1,0)
+{ }
+
+DOFVector::DOFVector(const short nvars, const std::vector<int>& ndofs)
+{
+	setup(nvars, ndofs);
+}
+
+void DOFVector::setup(const short nvars, const std::vector<int>& ndofs)
+{
+	nv = nvars;
+	offsets.resize(ndofs.size()+1);
+	offsets[0] = 0;
+	for(size_t iel = 0; iel < ndofs.size(); iel++)
+		offsets[iel+1] = offsets[iel] + nv*ndofs[iel];
+	vals.assign(offsets.back(), 0.0);
+}
+
+void DOFVector::setZero()
+{
+	setConstant(0.0);
+}
+
+void DOFVector::setConstant(const a_real value)
+{
+	const a_int n = size();
+	a_real *const __restrict__ v = vals.data();
+#pragma omp parallel for default(shared)
+	for(a_int i = 0; i < n; i++)
+		v[i] = value;
+}
+
+void DOFVector::axpy(const a_real a, const DOFVector& x)
+{
+	const a_int n = size();
+	a_real *const __restrict__ v = vals.data();
+	const a_real *const __restrict__ xv = x.vals.data();
+#pragma omp parallel for default(shared)
+	for(a_int i = 0; i < n; i++)
+		v[i] += a*xv[i];
+}
+
+void DOFVector::axpby(const a_real a, const a_real b, const DOFVector& x)
+{
+	const a_int n = size();
+	a_real *const __restrict__ v = vals.data();
+	const a_real *const __restrict__ xv = x.vals.data();
+#pragma omp parallel for default(shared)
+	for(a_int i = 0; i < n; i++)
+		v[i] = a*v[i] + b*xv[i];
+}
+
+void DOFVector::scale(const a_real a)
+{
+	const a_int n = size();
+	a_real *const __restrict__ v = vals.data();
+#pragma omp parallel for default(shared)
+	for(a_int i = 0; i < n; i++)
+		v[i] *= a;
+}
+
+a_real DOFVector::dot(const DOFVector& x) const
+{
+	const a_int n = size();
+	const a_real *const __restrict__ v = vals.data();
+	const a_real *const __restrict__ xv = x.vals.data();
+	a_real sum = 0;
+#pragma omp parallel for default(shared) reduction(+:sum)
+	for(a_int i = 0; i < n; i++)
+		sum += v[i]*xv[i];
+	return sum;
+}
+
+a_real DOFVector::norm() const
+{
+	return std::sqrt(dot(*this));
+}
+
+}
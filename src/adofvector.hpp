@@ -0,0 +1,94 @@
+/** @file adofvector.hpp
+ * @brief Contiguous storage of the degrees of freedom of all elements
+ */
+
+#ifndef __ADOFVECTOR_H
+#define __ADOFVECTOR_H
+
+#ifndef __ACONSTANTS_H
+#include "aconstants.hpp"
+#endif
+
+#include <Eigen/StdVector>
+
+namespace acfd {
+
+/// Holds the DOFs of all physical variables of all elements in one aligned, contiguous array
+/** The DOFs of element iel occupy entries [offset](@ref offset)(iel) to offset(iel+1)-1, stored as a row-major
+ * nvars x ndofs(iel) block - the same layout as the per-element Matrix used by the elements. operator[] returns
+ * an Eigen map of this block, so per-element access does not copy or allocate anything.
+ * Whole-vector operations act on the underlying array directly.
+ */
+class DOFVector
+{
+	short nv;										///< Number of physical variables
+	std::vector<a_int> offsets;						///< Start of each element's block; has nelem+1 entries
+	std::vector<a_real, Eigen::aligned_allocator<a_real>> vals;	///< All DOFs
+
+public:
+	DOFVector();
+
+	/// Allocates storage for nvars variables with ndofs[iel] DOFs per variable in element iel
+	DOFVector(const short nvars, const std::vector<int>& ndofs);
+
+	/// Allocates storage as in the [constructor](@ref DOFVector(const short, const std::vector<int>&))
+	/** The DOFs are set to zero.
+	 */
+	void setup(const short nvars, const std::vector<int>& ndofs);
+
+	a_int nelem() const { return static_cast<a_int>(offsets.size())-1; }
+
+	short nvars() const { return nv; }
+
+	/// Total number of entries, for all variables of all elements
+	a_int size() const { return static_cast<a_int>(vals.size()); }
+
+	/// Number of DOFs per physical variable in an element
+	int ndofs(const a_int iel) const { return (offsets[iel+1]-offsets[iel])/nv; }
+
+	/// Position of the first entry of an element's block in the [array](@ref data)
+	a_int offset(const a_int iel) const { return offsets[iel]; }
+
+	/// Read-write view of the DOFs of element iel as an nvars x ndofs matrix
+	MatrixMap operator[](const a_int iel) {
+		return MatrixMap(&vals[offsets[iel]], nv, (offsets[iel+1]-offsets[iel])/nv);
+	}
+
+	/// Read-only view of the DOFs of element iel as an nvars x ndofs matrix
+	ConstMatrixMap operator[](const a_int iel) const {
+		return ConstMatrixMap(&vals[offsets[iel]], nv, (offsets[iel+1]-offsets[iel])/nv);
+	}
+
+	/// Raw access to the array of all DOFs, eg, for writing or reading checkpoints in one go
+	a_real* data() { return vals.data(); }
+	const a_real* data() const { return vals.data(); }
+
+	/// Checks whether another DOF vector has the same number of variables and DOFs per element
+	bool sameLayout(const DOFVector& x) const {
+		return nv == x.nv && offsets == x.offsets;
+	}
+
+	/// Sets all entries to zero
+	void setZero();
+
+	/// Sets all entries to a value
+	void setConstant(const a_real value);
+
+	/// this <- this + a x; x must be a different vector
+	void axpy(const a_real a, const DOFVector& x);
+
+	/// this <- a this + b x; x must be a different vector
+	void axpby(const a_real a, const a_real b, const DOFVector& x);
+
+	/// this <- a this
+	void scale(const a_real a);
+
+	/// Euclidean inner product of all entries
+	a_real dot(const DOFVector& x) const;
+
+	/// Euclidean norm of all entries
+	a_real norm() const;
+};
+
+}
+#endif
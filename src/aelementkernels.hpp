@@ -0,0 +1,207 @@
+/** @file aelementkernels.hpp
+ * @brief Element kernels specialised at compile time for the polynomial degree, shape and number of variables
+ *
+ * The kernels evaluate functions and their gradients at the domain quadrature points of an element,
+ * and integrate against the gradients of the test functions. With the sizes known at compile time,
+ * Eigen uses fixed-size types whose products are fully unrolled and vectorised.
+ * [getElementKernels](@ref getElementKernels) selects the instantiation at run time.
+ */
+
+#ifndef __AELEMENTKERNELS_H
+#define __AELEMENTKERNELS_H
+
+#ifndef __AELEMENTS_H
+#include "aelements.hpp"
+#endif
+
+namespace acfd {
+
+/// Row-major fixed-size matrix, except for column vectors which Eigen requires to be column-major
+template <int rows, int cols>
+using FixedMatrix = Eigen::Matrix<a_real, rows, cols, (cols == 1 && rows != 1) ? Eigen::ColMajor : Eigen::RowMajor>;
+
+/// Kernels for basis sets with ndofs basis functions evaluated at ngauss points, for nvars variables
+/** The argument conventions are those of [evaluateFunctions](@ref evaluateFunctions),
+ * [evaluateGradients](@ref evaluateGradients(const BasisSet&, const ConstMatrixRef&, Matrix&, Matrix&)) and
+ * [integrateGradients](@ref integrateGradients).
+ */
+template <int ndofs, int ngauss, int nvars>
+struct FixedElementKernels
+{
+	static const char* name() { return "specialised"; }
+
+	static void interpolate(const BasisSet& bs, const ConstMatrixRef& dofs, Matrix& values)
+	{
+		const FixedMatrix<nvars,ndofs> u = dofs;
+		values.resize(ngauss, nvars);
+		Eigen::Map<FixedMatrix<ngauss,nvars>> v(values.data());
+		v.noalias() = Eigen::Map<const FixedMatrix<ngauss,ndofs>>(bs.basis.data()) * u.transpose();
+	}
+
+	static void gradients(const BasisSet& bs, const ConstMatrixRef& dofs, Matrix& dx, Matrix& dy)
+	{
+		const FixedMatrix<nvars,ndofs> u = dofs;
+		dx.resize(ngauss, nvars);
+		dy.resize(ngauss, nvars);
+		for(int ig = 0; ig < ngauss; ig++)
+		{
+			const FixedMatrix<nvars,NDIM> g = u * Eigen::Map<const FixedMatrix<ndofs,NDIM>>(bs.basisGrad[ig].data());
+			for(int ivar = 0; ivar < nvars; ivar++) {
+				dx(ig,ivar) = g(ivar,0);
+				dy(ig,ivar) = g(ivar,1);
+			}
+		}
+	}
+
+	static void integrateGradients(const BasisSet& bs, const ConstMatrixRef& fx, const ConstMatrixRef& fy, Matrix& term)
+	{
+		FixedMatrix<nvars,ndofs> t = FixedMatrix<nvars,ndofs>::Zero();
+		FixedMatrix<nvars,NDIM> f;
+		for(int ig = 0; ig < ngauss; ig++)
+		{
+			for(int ivar = 0; ivar < nvars; ivar++) {
+				f(ivar,0) = fx(ig,ivar);
+				f(ivar,1) = fy(ig,ivar);
+			}
+			t.noalias() += f * Eigen::Map<const FixedMatrix<ndofs,NDIM>>(bs.basisGrad[ig].data()).transpose();
+		}
+		term += t;
+	}
+};
+
+/// Kernels for any basis set, using sum factorization if the basis set asks for it and dense products otherwise
+struct DynamicElementKernels
+{
+	static const char* name() { return "dynamic"; }
+
+	static void interpolate(const BasisSet& bs, const ConstMatrixRef& dofs, Matrix& values)
+	{
+		if(bs.tensor.sumfactorize)
+			tensorEvaluateFunctions(bs.tensor, dofs, values);
+		else {
+			values.resize(bs.basis.rows(), dofs.rows());
+			evaluateFunctions(dofs, bs.basis, values);
+		}
+	}
+
+	static void gradients(const BasisSet& bs, const ConstMatrixRef& dofs, Matrix& dx, Matrix& dy)
+	{
+		if(bs.tensor.sumfactorize)
+			tensorEvaluateGradients(bs.tensor, dofs, dx, dy);
+		else
+			evaluateGradients(bs, dofs, dx, dy);
+	}
+
+	static void integrateGradients(const BasisSet& bs, const ConstMatrixRef& fx, const ConstMatrixRef& fy, Matrix& term)
+	{
+		if(bs.tensor.sumfactorize)
+			tensorIntegrateGradients(bs.tensor, fx, fy, term);
+		else
+			acfd::integrateGradients(bs, fx, fy, term);
+	}
+};
+
+/// Kernels for [collocated](@ref BasisSet::collocated) tensor-product bases on quadrangles
+/** The DOFs are the values at the quadrature points, so interpolation is a copy, and gradients and their integrals
+ * need only the 1D derivative matrix along each direction.
+ */
+struct CollocatedElementKernels
+{
+	static const char* name() { return "collocated"; }
+
+	static void interpolate(const BasisSet& bs, const ConstMatrixRef& dofs, Matrix& values)
+	{
+		values = dofs.transpose();
+	}
+
+	static void gradients(const BasisSet& bs, const ConstMatrixRef& dofs, Matrix& dx, Matrix& dy)
+	{
+		collocatedEvaluateGradients(bs.tensor, dofs, dx, dy);
+	}
+
+	static void integrateGradients(const BasisSet& bs, const ConstMatrixRef& fx, const ConstMatrixRef& fy, Matrix& term)
+	{
+		collocatedIntegrateGradients(bs.tensor, fx, fy, term);
+	}
+};
+
+/// A set of element kernels for one kind of element
+struct ElementKernels
+{
+	/// Values at the quadrature points (npoints x nvars) from DOFs (nvars x ndofs)
+	void (*interpolate)(const BasisSet& bs, const ConstMatrixRef& dofs, Matrix& values);
+
+	/// Gradients at the quadrature points, in the coordinates of the basis set's gradients
+	void (*gradients)(const BasisSet& bs, const ConstMatrixRef& dofs, Matrix& dx, Matrix& dy);
+
+	/// Adds the integrals of fields (npoints x nvars, weights included) against the test function gradients to term
+	void (*integrateGradients)(const BasisSet& bs, const ConstMatrixRef& fx, const ConstMatrixRef& fy, Matrix& term);
+
+	/// True if the kernels are specialised for the size of the basis set
+	bool fixed;
+
+	const char* name;				///< Kind of kernels, for reporting
+};
+
+template <class Kernels>
+inline ElementKernels makeElementKernels(const bool fixed)
+{
+	ElementKernels k;
+	k.interpolate = &Kernels::interpolate;
+	k.gradients = &Kernels::gradients;
+	k.integrateGradients = &Kernels::integrateGradients;
+	k.fixed = fixed;
+	k.name = Kernels::name();
+	return k;
+}
+
+/// Returns the specialised kernels for the given numbers of DOFs and points if they are instantiated, or else the dynamic ones
+template <int nvars, int ndofs, int ngauss>
+inline ElementKernels selectFixedKernels(const int npoints)
+{
+	if(npoints == ngauss)
+		return makeElementKernels<FixedElementKernels<ndofs,ngauss,nvars>>(true);
+	else
+		return makeElementKernels<DynamicElementKernels>(false);
+}
+
+/// Selects element kernels for the elements of a shape, given the degree and type of basis and the domain quadrature
+/** Specialised kernels are instantiated for degrees 1 to 3 with the quadrature of strength 2p, which is what
+ * [SpatialBase](@ref SpatialBase) uses. Lagrange and orthonormal bases on quadrangles have (p+1)^2 DOFs; 
+ * bases on triangles and Taylor bases have (p+1)(p+2)/2 DOFs. In all other cases, the dynamic kernels are returned.
+ * Gauss-Lobatto bases on quadrangles with the Gauss-Lobatto quadrature of the same points get the collocated kernels.
+ * \param basistype 'l' for Lagrange, 'o' for orthonormal, 'g' for Gauss-Lobatto, 't' for Taylor
+ */
+template <int nvars>
+ElementKernels getElementKernels(const Shape shape, const int degree, const char basistype, const Quadrature2D *const quad)
+{
+	const int ng = quad->numGauss();
+	const bool tensorbasis = (shape == QUADRANGLE && basistype != 't');
+
+	if(shape == QUADRANGLE && basistype == 'g' && ng == (degree+1)*(degree+1) && degree+1 <= TENSOR_MAX_1D)
+		return makeElementKernels<CollocatedElementKernels>(false);
+
+	if(shape == TRIANGLE)
+		switch(degree) {
+			case 1: return selectFixedKernels<nvars,3,3>(ng);
+			case 2: return selectFixedKernels<nvars,6,6>(ng);
+			case 3: return selectFixedKernels<nvars,10,12>(ng);
+		}
+	else if(shape == QUADRANGLE && tensorbasis)
+		switch(degree) {
+			case 1: return selectFixedKernels<nvars,4,4>(ng);
+			case 2: return selectFixedKernels<nvars,9,9>(ng);
+			case 3: return selectFixedKernels<nvars,16,16>(ng);
+		}
+	else if(shape == QUADRANGLE)
+		switch(degree) {
+			case 1: return selectFixedKernels<nvars,3,4>(ng);
+			case 2: return selectFixedKernels<nvars,6,9>(ng);
+			case 3: return selectFixedKernels<nvars,10,16>(ng);
+		}
+
+	return makeElementKernels<DynamicElementKernels>(false);
+}
+
+}
+#endif
@@ -5,11 +5,132 @@
  */
 
 #include "aelements.hpp"
+#include <cstdlib>
 
 namespace acfd {
 
 using namespace amat;
 
+/// Computes 1D Lagrange basis functions on given nodes and their derivatives at some points
+/** The derivative of the kth basis function is computed with the product rule.
+ */
+static void getLagrangeBasis1D(const Vector& __restrict__ pts, const std::vector<a_real>& nodes, 
+		Matrix& __restrict__ vals, Matrix& __restrict__ ders)
+{
+	const int np = pts.size();
+	const int degree = static_cast<int>(nodes.size())-1;
+	vals.resize(np,degree+1);
+	ders.resize(np,degree+1);
+
+	for(int ip = 0; ip < np; ip++)
+		for(int k = 0; k <= degree; k++)
+		{
+			vals(ip,k) = 1.0;
+			ders(ip,k) = 0.0;
+			for(int m = 0; m <= degree; m++)
+			{
+				if(m == k) continue;
+				a_real term = 1.0/(nodes[k]-nodes[m]);
+				for(int l = 0; l <= degree; l++)
+					if(l != k && l != m)
+						term *= (pts(ip)-nodes[l])/(nodes[k]-nodes[l]);
+				ders(ip,k) += term;
+				vals(ip,k) *= (pts(ip)-nodes[m])/(nodes[k]-nodes[m]);
+			}
+		}
+}
+
+/** The nodes are at \f$ \xi_k = -1 + 2k/p \f$, k = 0,1,...,p.
+ */
+void getLagrangeBasis1D(const Vector& __restrict__ pts, const int degree, Matrix& __restrict__ vals, Matrix& __restrict__ ders)
+{
+	std::vector<a_real> nodes(degree+1);
+	for(int k = 0; k <= degree; k++)
+		nodes[k] = -1.0 + 2.0*k/degree;
+	getLagrangeBasis1D(pts, nodes, vals, ders);
+}
+
+void getLobattoBasis1D(const Vector& __restrict__ pts, const int degree, Matrix& __restrict__ vals, Matrix& __restrict__ ders)
+{
+	Vector gll, wts;
+	getGaussLobattoPoints(degree+1, gll, wts);
+	std::vector<a_real> nodes(gll.data(), gll.data()+degree+1);
+	getLagrangeBasis1D(pts, nodes, vals, ders);
+}
+
+/** Nodes are ordered as the 4 vertices, then the nodes inside each side going around the element
+ * from its first vertex to its second, and lastly the interior nodes row by row along \f$ \xi \f$.
+ * This is the usual ordering for P1 and P2 quadrangles.
+ */
+void getQuadrangleTensorIndices(const int degree, std::vector<int>& lex)
+{
+	const int n = degree;
+	lex.resize((n+1)*(n+1));
+	std::vector<int> ia, ib;
+
+	ia.push_back(0); ib.push_back(0);
+	ia.push_back(n); ib.push_back(0);
+	ia.push_back(n); ib.push_back(n);
+	ia.push_back(0); ib.push_back(n);
+	for(int k = 1; k < n; k++) { ia.push_back(k);   ib.push_back(0); }
+	for(int k = 1; k < n; k++) { ia.push_back(n);   ib.push_back(k); }
+	for(int k = 1; k < n; k++) { ia.push_back(n-k); ib.push_back(n); }
+	for(int k = 1; k < n; k++) { ia.push_back(0);   ib.push_back(n-k); }
+	for(int b = 1; b < n; b++)
+		for(int a = 1; a < n; a++) {
+			ia.push_back(a); ib.push_back(b);
+		}
+
+	for(size_t i = 0; i < lex.size(); i++)
+		lex[i] = ia[i]*(n+1) + ib[i];
+}
+
+/** Evaluates the tensor product of 1D Lagrange bases; used for quadrangles of degree higher than 2.
+ */
+static void getLagrangeTensorBasis(const Matrix& __restrict__ gp, const int degree, Matrix *const basisv, std::vector<Matrix> *const basisG)
+{
+	std::vector<int> lex;
+	getQuadrangleTensorIndices(degree, lex);
+	Matrix vx, dx, vy, dy;
+	getLagrangeBasis1D(gp.col(0), degree, vx, dx);
+	getLagrangeBasis1D(gp.col(1), degree, vy, dy);
+
+	for(int ip = 0; ip < gp.rows(); ip++)
+		for(size_t idof = 0; idof < lex.size(); idof++)
+		{
+			const int a = lex[idof]/(degree+1), b = lex[idof]%(degree+1);
+			if(basisv)
+				(*basisv)(ip,idof) = vx(ip,a)*vy(ip,b);
+			if(basisG) {
+				(*basisG)[ip](idof,0) = dx(ip,a)*vy(ip,b);
+				(*basisG)[ip](idof,1) = vx(ip,a)*dy(ip,b);
+			}
+		}
+}
+
+/** Evaluates the tensor product of 1D Lagrange bases on Gauss-Lobatto-Legendre nodes; 
+ * DOF a*(degree+1)+b is at the ath node in \f$ \xi \f$ and the bth node in \f$ \eta \f$.
+ */
+static void getLobattoTensorBasis(const Matrix& __restrict__ gp, const int degree, Matrix *const basisv, std::vector<Matrix> *const basisG)
+{
+	Matrix vx, dx, vy, dy;
+	getLobattoBasis1D(gp.col(0), degree, vx, dx);
+	getLobattoBasis1D(gp.col(1), degree, vy, dy);
+
+	for(int ip = 0; ip < gp.rows(); ip++)
+		for(int a = 0; a <= degree; a++)
+			for(int b = 0; b <= degree; b++)
+			{
+				const int idof = a*(degree+1)+b;
+				if(basisv)
+					(*basisv)(ip,idof) = vx(ip,a)*vy(ip,b);
+				if(basisG) {
+					(*basisG)[ip](idof,0) = dx(ip,a)*vy(ip,b);
+					(*basisG)[ip](idof,1) = vx(ip,a)*dy(ip,b);
+				}
+			}
+}
+
 /** Computes Lagrange basis function values at given points in the reference element.
  * \note NOTE: For efficiency, we would want to able to request computation of only certain basis functions.
  */
@@ -35,6 +156,20 @@ void getLagrangeBasis(const Matrix& __restrict__ gp, const Shape shape, const in
 				basisv(ip,5) = 4.0*(gp(ip,1) - gp(ip,1)*gp(ip,1) - gp(ip,0)*gp(ip,1));
 			}
 		}
+		if(degree == 3) {
+			for(int ip = 0; ip < gp.rows(); ip++)
+			{
+				const a_real l[3] = {1.0-gp(ip,0)-gp(ip,1), gp(ip,0), gp(ip,1)};
+				for(int i = 0; i < 3; i++)
+					basisv(ip,i) = 0.5*l[i]*(3*l[i]-1)*(3*l[i]-2);
+				for(int i = 0; i < 3; i++) {
+					const int j = (i+1)%3;
+					basisv(ip,3+2*i) = 4.5*l[i]*l[j]*(3*l[i]-1);
+					basisv(ip,4+2*i) = 4.5*l[i]*l[j]*(3*l[j]-1);
+				}
+				basisv(ip,9) = 27.0*l[0]*l[1]*l[2];
+			}
+		}
 	}
 	else {
 		if(degree == 1) {
@@ -60,6 +195,8 @@ void getLagrangeBasis(const Matrix& __restrict__ gp, const Shape shape, const in
 				basisv(ip,8) = (1-gp(ip,0)*gp(ip,0))        * (1-gp(ip,1)*gp(ip,1));
 			}
 		}
+		if(degree >= 3)
+			getLagrangeTensorBasis(gp, degree, &basisv, nullptr);
 	}
 }
 
@@ -88,6 +225,25 @@ void getLagrangeBasisGrads(const Matrix& __restrict__ gp, const Shape shape, con
 				basisG[ip](5,0) = -4.0*gp(ip,1);                 basisG[ip](5,1) = 4.0*(1.0-2*gp(ip,1)-gp(ip,0));
 			}
 		}
+		if(degree == 3) {
+			// gradients of the barycentric coordinates
+			const a_real dl[3][2] = {{-1.0,-1.0}, {1.0,0.0}, {0.0,1.0}};
+			for(int ip = 0; ip < gp.rows(); ip++)
+			{
+				const a_real l[3] = {1.0-gp(ip,0)-gp(ip,1), gp(ip,0), gp(ip,1)};
+				for(int idim = 0; idim < NDIM; idim++)
+				{
+					for(int i = 0; i < 3; i++)
+						basisG[ip](i,idim) = 0.5*(27*l[i]*l[i] - 18*l[i] + 2)*dl[i][idim];
+					for(int i = 0; i < 3; i++) {
+						const int j = (i+1)%3;
+						basisG[ip](3+2*i,idim) = 4.5*((6*l[i]*l[j] - l[j])*dl[i][idim] + (3*l[i]*l[i] - l[i])*dl[j][idim]);
+						basisG[ip](4+2*i,idim) = 4.5*((3*l[j]*l[j] - l[j])*dl[i][idim] + (6*l[i]*l[j] - l[i])*dl[j][idim]);
+					}
+					basisG[ip](9,idim) = 27.0*(l[1]*l[2]*dl[0][idim] + l[0]*l[2]*dl[1][idim] + l[0]*l[1]*dl[2][idim]);
+				}
+			}
+		}
 	}
 	else { // QUADRANGLE
 		if(degree == 1) {
@@ -113,9 +269,152 @@ void getLagrangeBasisGrads(const Matrix& __restrict__ gp, const Shape shape, con
 				basisG[ip](8,0) = -2*gp(ip,0)*(1-gp(ip,1)*gp(ip,1));          basisG[ip](8,1) = -2*gp(ip,1)*(1-gp(ip,0)*gp(ip,0));
 			}
 		}
+		if(degree >= 3)
+			getLagrangeTensorBasis(gp, degree, nullptr, &basisG);
 	}
 }
 
+/// Computes the Jacobi polynomials \f$ P_n^{(\alpha,\beta)}(x) \f$ for n = 0,1,...,degree by the three-term recurrence
+static void getJacobiPolynomials(const a_real x, const int degree, const a_real alpha, const a_real beta, a_real *const __restrict__ P)
+{
+	if(degree < 0) return;
+	P[0] = 1.0;
+	if(degree >= 1)
+		P[1] = 0.5*((alpha+beta+2)*x + alpha-beta);
+	for(int n = 2; n <= degree; n++)
+	{
+		const a_real c = 2*n+alpha+beta;
+		P[n] = ((c-1)*(c*(c-2)*x + alpha*alpha-beta*beta)*P[n-1] - 2*(n+alpha-1)*(n+beta-1)*c*P[n-2])
+			/ (2*n*(n+alpha+beta)*(c-2));
+	}
+}
+
+/** Uses \f$ \frac{d}{dx} P_n = \frac{n+1}{2} P_{n-1}^{(1,1)} \f$.
+ */
+void getLegendreBasis1D(const Vector& __restrict__ pts, const int degree, Matrix& __restrict__ vals, Matrix& __restrict__ ders)
+{
+	const int np = pts.size();
+	vals.resize(np,degree+1);
+	ders.resize(np,degree+1);
+	std::vector<a_real> P(degree+1), dP(degree+1);
+
+	for(int ip = 0; ip < np; ip++)
+	{
+		getJacobiPolynomials(pts(ip), degree, 0, 0, &P[0]);
+		getJacobiPolynomials(pts(ip), degree-1, 1, 1, &dP[0]);
+		for(int n = 0; n <= degree; n++) {
+			const a_real norm = std::sqrt(n+0.5);
+			vals(ip,n) = norm*P[n];
+			ders(ip,n) = n > 0 ? norm*0.5*(n+1)*dP[n-1] : 0;
+		}
+	}
+}
+
+/** With \f$ r = 2\xi-1 \f$ and \f$ s = 2\eta-1 \f$, the collapsed coordinates are \f$ a = 2(1+r)/(1-s)-1 \f$, \f$ b = s \f$ and
+ * \f[ \psi_{ij} = \sqrt{2(2i+1)(i+j+1)} P_i(a) \left(\frac{1-b}{2}\right)^i P_j^{(2i+1,0)}(b). \f]
+ * The gradients are computed in forms that stay bounded at the collapsed vertex (0,1),
+ * where a is arbitrary and is taken as -1.
+ */
+static void getDubinerBasis(const Matrix& __restrict__ gp, const int degree, Matrix *const basisv, std::vector<Matrix> *const basisG)
+{
+	std::vector<a_real> pa(degree+1), dpa(degree+1), pb(degree+1), dpb(degree+1);
+
+	for(int ip = 0; ip < gp.rows(); ip++)
+	{
+		const a_real r = 2*gp(ip,0)-1, s = 2*gp(ip,1)-1;
+		const a_real a = (1-s > ZERO_TOL) ? 2*(1+r)/(1-s)-1 : -1.0;
+		const a_real c = 0.5*(1-s);
+		getJacobiPolynomials(a, degree, 0, 0, &pa[0]);
+		getJacobiPolynomials(a, degree-1, 1, 1, &dpa[0]);
+
+		int idof = 0;
+		for(int n = 0; n <= degree; n++)
+			for(int j = 0; j <= n; j++)
+			{
+				const int i = n-j;
+				getJacobiPolynomials(s, j, 2*i+1, 0, &pb[0]);
+				getJacobiPolynomials(s, j-1, 2*i+2, 1, &dpb[0]);
+
+				const a_real norm = std::sqrt(2.0*(2*i+1)*(i+j+1));
+				const a_real ci = std::pow(c,i);
+				if(basisv)
+					(*basisv)(ip,idof) = norm*pa[i]*ci*pb[j];
+				if(basisG) {
+					const a_real cim1 = i > 0 ? std::pow(c,i-1) : 0;
+					const a_real dfa = i > 0 ? 0.5*(i+1)*dpa[i-1] : 0;
+					const a_real dgb = j > 0 ? 0.5*(j+2*i+2)*dpb[j-1] : 0;
+					const a_real dr = dfa*cim1*pb[j];
+					const a_real ds = dfa*0.5*(1+a)*cim1*pb[j] + pa[i]*(-0.5*i*cim1*pb[j] + ci*dgb);
+					// d/dxi = 2 d/dr, d/deta = 2 d/ds
+					(*basisG)[ip](idof,0) = 2*norm*dr;
+					(*basisG)[ip](idof,1) = 2*norm*ds;
+				}
+				idof++;
+			}
+	}
+}
+
+/** Evaluates the tensor product of normalized Legendre polynomials on quadrangles.
+ */
+static void getLegendreTensorBasis(const Matrix& __restrict__ gp, const int degree, Matrix *const basisv, std::vector<Matrix> *const basisG)
+{
+	Matrix vx, dx, vy, dy;
+	getLegendreBasis1D(gp.col(0), degree, vx, dx);
+	getLegendreBasis1D(gp.col(1), degree, vy, dy);
+
+	for(int ip = 0; ip < gp.rows(); ip++)
+		for(int a = 0; a <= degree; a++)
+			for(int b = 0; b <= degree; b++)
+			{
+				const int idof = a*(degree+1)+b;
+				if(basisv)
+					(*basisv)(ip,idof) = vx(ip,a)*vy(ip,b);
+				if(basisG) {
+					(*basisG)[ip](idof,0) = dx(ip,a)*vy(ip,b);
+					(*basisG)[ip](idof,1) = vx(ip,a)*dy(ip,b);
+				}
+			}
+}
+
+void getOrthonormalBasis(const Matrix& __restrict__ gp, const Shape shape, const int degree, Matrix& __restrict__ basisv)
+{
+	if(shape == TRIANGLE)
+		getDubinerBasis(gp, degree, &basisv, nullptr);
+	else
+		getLegendreTensorBasis(gp, degree, &basisv, nullptr);
+}
+
+void getOrthonormalBasisGrads(const Matrix& __restrict__ gp, const Shape shape, const int degree, std::vector<Matrix>& __restrict__ basisG)
+{
+	if(shape == TRIANGLE)
+		getDubinerBasis(gp, degree, nullptr, &basisG);
+	else
+		getLegendreTensorBasis(gp, degree, nullptr, &basisG);
+}
+
+/** The Gauss-Lobatto family is only defined on quadrangles; on triangles, it is the equispaced Lagrange basis.
+ */
+void getReferenceBasis(const Matrix& __restrict__ gp, const Shape shape, const int degree, const char family, Matrix& __restrict__ basisv)
+{
+	if(family == 'o')
+		getOrthonormalBasis(gp, shape, degree, basisv);
+	else if(family == 'g' && shape == QUADRANGLE)
+		getLobattoTensorBasis(gp, degree, &basisv, nullptr);
+	else
+		getLagrangeBasis(gp, shape, degree, basisv);
+}
+
+void getReferenceBasisGrads(const Matrix& __restrict__ gp, const Shape shape, const int degree, const char family, 
+		std::vector<Matrix>& __restrict__ basisG)
+{
+	if(family == 'o')
+		getOrthonormalBasisGrads(gp, shape, degree, basisG);
+	else if(family == 'g' && shape == QUADRANGLE)
+		getLobattoTensorBasis(gp, degree, nullptr, &basisG);
+	else
+		getLagrangeBasisGrads(gp, shape, degree, basisG);
+}
+
 /// A global function for computing 2D Lagrange mapping derivatives
 /** Mappings upto P2 are implemented.
  */
@@ -310,15 +609,52 @@ void LagrangeMapping2D::calculateJacobianDetAndInverse(const Matrix& __restrict_
 	getLagrangeJacobianDetAndInverse(po, shape, degree, phyNodes, jacoi, jacod);
 }
 
+/** Compares the positions of the nodes that are not vertices with those they would have under the map
+ * defined by the vertices alone, relative to the size of the element.
+ */
+bool LagrangeMapping2D::checkAffine() const
+{
+	const int nv = (shape == QUADRANGLE) ? 4 : 3;
+	const int nnode = phyNodes.cols();
+
+	a_real size = 0;
+	for(int idim = 0; idim < NDIM; idim++)
+		size = std::max(size, std::fabs(phyNodes(idim,1)-phyNodes(idim,0)) + std::fabs(phyNodes(idim,nv-1)-phyNodes(idim,0)));
+	const a_real tol = SMALL_NUMBER*size;
+
+	// a bilinear quad is affine only if it is a parallelogram
+	if(shape == QUADRANGLE)
+		for(int idim = 0; idim < NDIM; idim++)
+			if(std::fabs(phyNodes(idim,0)+phyNodes(idim,2)-phyNodes(idim,1)-phyNodes(idim,3)) > tol)
+				return false;
+
+	// mid-side nodes
+	for(int ino = nv; ino < std::min(nnode, 2*nv); ino++)
+		for(int idim = 0; idim < NDIM; idim++)
+			if(std::fabs(phyNodes(idim,ino) - 0.5*(phyNodes(idim,ino-nv)+phyNodes(idim,(ino-nv+1)%nv))) > tol)
+				return false;
+
+	// centre node of biquadratic quads
+	for(int ino = 2*nv; ino < nnode; ino++)
+		for(int idim = 0; idim < NDIM; idim++)
+			if(std::fabs(phyNodes(idim,ino) - 0.25*(phyNodes(idim,0)+phyNodes(idim,1)+phyNodes(idim,2)+phyNodes(idim,3))) > tol)
+				return false;
+
+	return true;
+}
+
+/** For affine maps, the Jacobian is computed only at the first quadrature point.
+ */
 void LagrangeMapping2D::computeForReferenceElement()
 {
 	const Matrix& points = quadrature->points();
 	shape = quadrature->getShape();
-	int npoin = points.rows();
+	affine = checkAffine();
+	int npoin = affine ? 1 : points.rows();
 	jacoinv.resize(npoin);
 	jacodet.resize(npoin);
 
-	getLagrangeJacobianDetAndInverse(points, shape, degree, phyNodes, jacoinv, jacodet);
+	getLagrangeJacobianDetAndInverse(points.topRows(npoin), shape, degree, phyNodes, jacoinv, jacodet);
 }
 
 /** We can make this more efficient by not computing the Jacobian inverse below.
@@ -328,13 +664,15 @@ void LagrangeMapping2D::computeForPhysicalElement()
 {
 	const Matrix& points = quadrature->points();
 	shape = quadrature->getShape();
+	affine = checkAffine();
 	int npoin = points.rows();
-	jacodet.resize(npoin);
+	int njac = affine ? 1 : npoin;
+	jacodet.resize(njac);
 	mapping.resize(npoin,NDIM);
 
-	std::vector<MatrixDim> jacoi(npoin);
+	std::vector<MatrixDim> jacoi(njac);
 	getLagrangeMap(points, shape, degree, phyNodes, mapping);
-	getLagrangeJacobianDetAndInverse(points, shape, degree, phyNodes, jacoi, jacodet);
+	getLagrangeJacobianDetAndInverse(points.topRows(njac), shape, degree, phyNodes, jacoi, jacodet);
 }
 
 void LagrangeMapping2D::computePhysicalCoordsOfDomainQuadraturePoints()
@@ -346,6 +684,398 @@ void LagrangeMapping2D::computePhysicalCoordsOfDomainQuadraturePoints()
 	getLagrangeMap(points, shape, degree, phyNodes, mapping);
 }
 
+/** Note that the order of points has to be reversed for the right element.
+ * We use lr for this.
+ */
+a_real getFaceReferenceCoords(const Matrix& __restrict__ facepoints, const Shape shape,
+		const int llfn, const int lr, Matrix& __restrict__ dompoints)
+{
+	int ng = facepoints.rows();
+#ifdef DEBUG
+	if(ng != dompoints.rows())
+		printf("!  getFaceReferenceCoords: Size mismatch!\n");
+#endif
+	if(shape == TRIANGLE) {
+		if(llfn == 0)
+		{
+			for(int ig = 0; ig < ng; ig++) {
+				dompoints(ig,0) = 0.5*(1.0 + lr*facepoints(ig));
+				dompoints(ig,1) = 0;
+			}
+			return 0.5;
+		}
+		else if(llfn == 1)
+		{
+			for(int ig = 0; ig < ng; ig++) {
+				dompoints(ig,0) = 0.5*(1.0 - lr*facepoints(ig));
+				dompoints(ig,1) = 0.5*(1.0 + lr*facepoints(ig));
+			}
+			return 1/SQRT2;
+		}
+		else
+		{
+			for(int ig = 0; ig < ng; ig++) {
+				dompoints(ig,0) = 0;
+				dompoints(ig,1) = 0.5*(1.0 - lr*facepoints(ig));
+			}
+			return 0.5;
+		}
+	}
+	else if(shape == QUADRANGLE) {
+		if(llfn == 0)
+		{
+			for(int ig = 0; ig < ng; ig++) {
+				dompoints(ig,0) = lr*facepoints(ig);
+				dompoints(ig,1) = -1.0;
+			}
+		}
+		else if(llfn == 1)
+		{
+			for(int ig = 0; ig < ng; ig++) {
+				dompoints(ig,0) = 1.0;
+				dompoints(ig,1) = lr*facepoints(ig);
+			}
+		}
+		else if(llfn == 2)
+		{
+			for(int ig = 0; ig < ng; ig++) {
+				dompoints(ig,0) = lr*(-facepoints(ig));
+				dompoints(ig,1) = 1.0;
+			}
+		}
+		else
+		{
+			for(int ig = 0; ig < ng; ig++) {
+				dompoints(ig,0) = -1.0;
+				dompoints(ig,1) = lr*(-facepoints(ig));
+			}
+		}
+		return 1.0;
+	}
+
+	else return 0;
+}
+
+BasisRegistry::~BasisRegistry()
+{
+	for(size_t i = 0; i < sets.size(); i++)
+		delete sets[i];
+	for(size_t i = 0; i < traces.size(); i++)
+		delete traces[i];
+}
+
+/// Finds, for each point at which a basis is evaluated, the DOF whose node is at that point
+/** \param[in] basis Basis function values at the points (npoints x ndofs)
+ * \param[in|out] nodes The DOF at each point if each row of basis is a unit vector; empty otherwise
+ */
+static void findCollocatedNodes(const Matrix& basis, std::vector<int>& nodes)
+{
+	const a_real tol = 1e3*ZERO_TOL;
+	nodes.resize(basis.rows());
+	for(int ip = 0; ip < basis.rows(); ip++)
+	{
+		int idof;
+		const a_real maxval = basis.row(ip).maxCoeff(&idof);
+		if(std::fabs(maxval-1.0) > tol || basis.row(ip).cwiseAbs().sum()-maxval > tol) {
+			nodes.clear();
+			return;
+		}
+		nodes[ip] = idof;
+	}
+}
+
+const BasisSet* BasisRegistry::get(const Shape shape, const int degree, const Quadrature2D *const quad, const char family)
+{
+	for(size_t i = 0; i < sets.size(); i++)
+		if(sets[i]->shape == shape && sets[i]->degree == degree && sets[i]->family == family && sets[i]->quadrature == quad)
+			return sets[i];
+
+	int ndof;
+	if(shape == QUADRANGLE)
+		ndof = (degree+1)*(degree+1);
+	else
+		ndof = (degree+1)*(degree+2)/2;
+
+	BasisSet* bs = new BasisSet;
+	bs->shape = shape;
+	bs->degree = degree;
+	bs->family = family;
+	bs->quadrature = quad;
+
+	const Matrix& gp = quad->points();
+	int ngauss = quad->numGauss();
+	bs->basis.resize(ngauss,ndof);
+	bs->basisGrad.resize(ngauss);
+	for(int i = 0; i < ngauss; i++)
+		bs->basisGrad[i].resize(ndof,NDIM);
+
+	getReferenceBasis(gp, shape, degree, family, bs->basis);
+	getReferenceBasisGrads(gp, shape, degree, family, bs->basisGrad);
+
+	// 1D factors for sum factorization; the quadrature on the square is a tensor product of a 1D rule
+	const int nq = static_cast<int>(std::sqrt(static_cast<double>(ngauss)) + 0.5);
+	if(shape == QUADRANGLE && nq*nq == ngauss && nq <= TENSOR_MAX_1D && degree+1 <= TENSOR_MAX_1D)
+	{
+		TensorBasis1D& tb = bs->tensor;
+		tb.ndof1d = degree+1;
+		tb.npoin1d = nq;
+		Vector pts(nq);
+		for(int i = 0; i < nq; i++)
+			pts(i) = gp(i*nq,0);
+		if(family == 'o' || family == 'g') {
+			if(family == 'o')
+				getLegendreBasis1D(pts, degree, tb.val, tb.der);
+			else
+				getLobattoBasis1D(pts, degree, tb.val, tb.der);
+			tb.lexindex.resize(ndof);
+			for(int idof = 0; idof < ndof; idof++)
+				tb.lexindex[idof] = idof;
+		}
+		else {
+			getLagrangeBasis1D(pts, degree, tb.val, tb.der);
+			getQuadrangleTensorIndices(degree, tb.lexindex);
+		}
+		tb.sumfactorize = (degree >= SUMFACT_MIN_DEGREE);
+	}
+
+	std::vector<int> nodes;
+	findCollocatedNodes(bs->basis, nodes);
+	bs->collocated = (ngauss == ndof && !nodes.empty());
+	for(size_t ig = 0; ig < nodes.size(); ig++)
+		if(nodes[ig] != static_cast<int>(ig))
+			bs->collocated = false;
+
+	sets.push_back(bs);
+	return bs;
+}
+
+const FaceTraceSet* BasisRegistry::getTrace(const Shape shape, const int degree, const int lfn, const int orientation,
+		const Quadrature1D *const fquad, const char family)
+{
+	for(size_t i = 0; i < traces.size(); i++)
+		if(traces[i]->shape == shape && traces[i]->degree == degree && traces[i]->family == family && traces[i]->lfn == lfn 
+				&& traces[i]->orientation == orientation && traces[i]->facequadrature == fquad)
+			return traces[i];
+
+	int ndof;
+	if(shape == QUADRANGLE)
+		ndof = (degree+1)*(degree+1);
+	else
+		ndof = (degree+1)*(degree+2)/2;
+
+	FaceTraceSet* ts = new FaceTraceSet;
+	ts->shape = shape;
+	ts->degree = degree;
+	ts->family = family;
+	ts->quadrature = nullptr;
+	ts->lfn = lfn;
+	ts->orientation = orientation;
+	ts->facequadrature = fquad;
+
+	const int ng = fquad->numGauss();
+	Matrix points(ng,NDIM);
+	getFaceReferenceCoords(fquad->points(), shape, lfn, orientation, points);
+
+	ts->basis.resize(ng,ndof);
+	ts->basisGrad.resize(ng);
+	for(int i = 0; i < ng; i++)
+		ts->basisGrad[i].resize(ndof,NDIM);
+
+	getReferenceBasis(points, shape, degree, family, ts->basis);
+	getReferenceBasisGrads(points, shape, degree, family, ts->basisGrad);
+	findCollocatedNodes(ts->basis, ts->nodes);
+
+	traces.push_back(ts);
+	return ts;
+}
+
+size_t BasisRegistry::bytes() const
+{
+	size_t b = 0;
+	for(size_t i = 0; i < sets.size(); i++)
+		b += sets[i]->bytes();
+	for(size_t i = 0; i < traces.size(); i++)
+		b += traces[i]->bytes() + sizeof(FaceTraceSet) - sizeof(BasisSet) + traces[i]->nodes.size()*sizeof(int);
+	return b;
+}
+
+/// Applies a 1D operator A (nq x n) along both directions of an (n x n) array: out = A u B^T, with B (nq x n)
+/** The arrays are row-major; t is workspace of size n*nq.
+ */
+static inline void tensorContract(const int n, const int nq, const a_real *const __restrict__ A, const a_real *const __restrict__ B,
+		const a_real *const __restrict__ u, a_real *const __restrict__ t, a_real *const __restrict__ out)
+{
+	// t = u B^T  (n x nq)
+	for(int a = 0; a < n; a++)
+		for(int j = 0; j < nq; j++) {
+			a_real sum = 0;
+			for(int b = 0; b < n; b++)
+				sum += u[a*n+b]*B[j*n+b];
+			t[a*nq+j] = sum;
+		}
+	// out = A t  (nq x nq)
+	for(int i = 0; i < nq; i++)
+		for(int j = 0; j < nq; j++) {
+			a_real sum = 0;
+			for(int a = 0; a < n; a++)
+				sum += A[i*n+a]*t[a*nq+j];
+			out[i*nq+j] = sum;
+		}
+}
+
+/// Transpose of [tensorContract](@ref tensorContract): adds A^T f B to out (n x n), f being (nq x nq)
+static inline void tensorContractTranspose(const int n, const int nq, const a_real *const __restrict__ A, const a_real *const __restrict__ B,
+		const a_real *const __restrict__ f, a_real *const __restrict__ t, a_real *const __restrict__ out)
+{
+	// t = A^T f  (n x nq)
+	for(int a = 0; a < n; a++)
+		for(int j = 0; j < nq; j++) {
+			a_real sum = 0;
+			for(int i = 0; i < nq; i++)
+				sum += A[i*n+a]*f[i*nq+j];
+			t[a*nq+j] = sum;
+		}
+	// out += t B  (n x n)
+	for(int a = 0; a < n; a++)
+		for(int b = 0; b < n; b++) {
+			a_real sum = 0;
+			for(int j = 0; j < nq; j++)
+				sum += t[a*nq+j]*B[j*n+b];
+			out[a*n+b] += sum;
+		}
+}
+
+/** For each variable, the DOFs are arranged as an (ndof1d x ndof1d) array U, and the values at the quadrature points
+ * are V = B U B^T, where B is the matrix of 1D basis values.
+ */
+void tensorEvaluateFunctions(const TensorBasis1D& tb, const ConstMatrixRef& dofs, Matrix& __restrict__ interp)
+{
+	const int n = tb.ndof1d, nq = tb.npoin1d;
+	interp.resize(nq*nq, dofs.rows());
+	a_real u[TENSOR_MAX_1D*TENSOR_MAX_1D], t[TENSOR_MAX_1D*TENSOR_MAX_1D], v[TENSOR_MAX_1D*TENSOR_MAX_1D];
+
+	for(int ivar = 0; ivar < dofs.rows(); ivar++)
+	{
+		for(int idof = 0; idof < dofs.cols(); idof++)
+			u[tb.lexindex[idof]] = dofs(ivar,idof);
+
+		tensorContract(n, nq, tb.val.data(), tb.val.data(), u, t, v);
+
+		for(int iq = 0; iq < nq*nq; iq++)
+			interp(iq,ivar) = v[iq];
+	}
+}
+
+/** The derivatives are \f$ D U B^T \f$ and \f$ B U D^T \f$, D being the matrix of 1D basis derivatives.
+ */
+void tensorEvaluateGradients(const TensorBasis1D& tb, const ConstMatrixRef& dofs, Matrix& __restrict__ dxi, Matrix& __restrict__ deta)
+{
+	const int n = tb.ndof1d, nq = tb.npoin1d;
+	dxi.resize(nq*nq, dofs.rows());
+	deta.resize(nq*nq, dofs.rows());
+	a_real u[TENSOR_MAX_1D*TENSOR_MAX_1D], t[TENSOR_MAX_1D*TENSOR_MAX_1D], v[TENSOR_MAX_1D*TENSOR_MAX_1D];
+
+	for(int ivar = 0; ivar < dofs.rows(); ivar++)
+	{
+		for(int idof = 0; idof < dofs.cols(); idof++)
+			u[tb.lexindex[idof]] = dofs(ivar,idof);
+
+		tensorContract(n, nq, tb.der.data(), tb.val.data(), u, t, v);
+		for(int iq = 0; iq < nq*nq; iq++)
+			dxi(iq,ivar) = v[iq];
+
+		tensorContract(n, nq, tb.val.data(), tb.der.data(), u, t, v);
+		for(int iq = 0; iq < nq*nq; iq++)
+			deta(iq,ivar) = v[iq];
+	}
+}
+
+/** This is the transpose of [gradient evaluation](@ref tensorEvaluateGradients): with the fields at the quadrature
+ * points arranged as (npoin1d x npoin1d) arrays, the integrals are \f$ D^T F_\xi B + B^T F_\eta D \f$.
+ */
+void tensorIntegrateGradients(const TensorBasis1D& tb, const ConstMatrixRef& fxi, const ConstMatrixRef& feta, Matrix& __restrict__ term)
+{
+	const int n = tb.ndof1d, nq = tb.npoin1d;
+	a_real f[TENSOR_MAX_1D*TENSOR_MAX_1D], t[TENSOR_MAX_1D*TENSOR_MAX_1D], w[TENSOR_MAX_1D*TENSOR_MAX_1D];
+
+	for(int ivar = 0; ivar < term.rows(); ivar++)
+	{
+		for(int i = 0; i < n*n; i++)
+			w[i] = 0;
+
+		for(int iq = 0; iq < nq*nq; iq++)
+			f[iq] = fxi(iq,ivar);
+		tensorContractTranspose(n, nq, tb.der.data(), tb.val.data(), f, t, w);
+
+		for(int iq = 0; iq < nq*nq; iq++)
+			f[iq] = feta(iq,ivar);
+		tensorContractTranspose(n, nq, tb.val.data(), tb.der.data(), f, t, w);
+
+		for(int idof = 0; idof < term.cols(); idof++)
+			term(ivar,idof) += w[tb.lexindex[idof]];
+	}
+}
+
+/** With D the 1D derivative matrix (tb.der) and u the DOFs as an (n x n) array,
+ * \f$ \partial_\xi u = D u \f$ and \f$ \partial_\eta u = u D^T \f$.
+ */
+void collocatedEvaluateGradients(const TensorBasis1D& tb, const ConstMatrixRef& dofs, Matrix& __restrict__ dxi, Matrix& __restrict__ deta)
+{
+	const int n = tb.ndof1d;
+	const a_real *const D = tb.der.data();
+	dxi.resize(n*n, dofs.rows());
+	deta.resize(n*n, dofs.rows());
+	for(int ivar = 0; ivar < dofs.rows(); ivar++)
+		for(int i = 0; i < n; i++)
+			for(int j = 0; j < n; j++)
+			{
+				a_real sx = 0, sy = 0;
+				for(int k = 0; k < n; k++) {
+					sx += D[i*n+k]*dofs(ivar,k*n+j);
+					sy += D[j*n+k]*dofs(ivar,i*n+k);
+				}
+				dxi(i*n+j,ivar) = sx;
+				deta(i*n+j,ivar) = sy;
+			}
+}
+
+/** The transpose of [collocatedEvaluateGradients](@ref collocatedEvaluateGradients):
+ * term += \f$ D^T f_\xi + f_\eta D \f$, with the fields as (n x n) arrays.
+ */
+void collocatedIntegrateGradients(const TensorBasis1D& tb, const ConstMatrixRef& fxi, const ConstMatrixRef& feta, Matrix& __restrict__ term)
+{
+	const int n = tb.ndof1d;
+	const a_real *const D = tb.der.data();
+	for(int ivar = 0; ivar < term.rows(); ivar++)
+		for(int a = 0; a < n; a++)
+			for(int b = 0; b < n; b++)
+			{
+				a_real s = 0;
+				for(int k = 0; k < n; k++)
+					s += D[k*n+a]*fxi(k*n+b,ivar) + D[k*n+b]*feta(a*n+k,ivar);
+				term(ivar,a*n+b) += s;
+			}
+}
+
+void Element::physicalBasisGrads(std::vector<Matrix>& pgrads) const
+{
+	const std::vector<Matrix>& bgrad = bset->basisGrad;
+	pgrads.resize(bgrad.size());
+	if(type == REFERENTIAL) {
+		/** To compute gradients in physical space, we use the following.
+		 * Let \f$ a := \nabla_x B(x(\xi)) \f$ and \f$ b = \nabla_\xi B(x(\xi)) \f$. Then,
+		 * we need \f$ a = J^{-T} b \f$. Instead, we can compute \f$ a^T = b^T J^{-1} \f$,
+		 * for efficiency reasons since we have a row-major storage. This latter equation is used.
+		 */
+		for(size_t ip = 0; ip < bgrad.size(); ip++)
+			pgrads[ip].noalias() = bgrad[ip]*gmap->jacInv(ip);
+	}
+	else {
+		for(size_t ip = 0; ip < bgrad.size(); ip++)
+			pgrads[ip] = bgrad[ip];
+	}
+}
+
 /** We currently have upto P2 elements.
  * The number of DOFs is computed as \f$ \sum_{i=1}^{p+1} i \f$ for p = 0,1,2...
  * For computing the element centers and area, we use the all quadrature points of the quadrature object in the gmap.
@@ -364,10 +1094,14 @@ void TaylorElement::initialize(int degr, GeomMapping2D* geommap)
 		ndof += i;
 
 	int ngauss = gmap->getQuadrature()->numGauss();
-	basis.resize(ngauss,ndof);
-	basisGrad.resize(ngauss);
+	tbasis.shape = gmap->getShape();
+	tbasis.degree = degree;
+	tbasis.family = 't';
+	tbasis.quadrature = gmap->getQuadrature();
+	tbasis.basis.resize(ngauss,ndof);
+	tbasis.basisGrad.resize(ngauss);
 	for(int i = 0; i < ngauss; i++) {
-		basisGrad[i].resize(ndof,NDIM);
+		tbasis.basisGrad[i].resize(ndof,NDIM);
 	}
 
 	area = 0;
@@ -411,9 +1145,9 @@ void TaylorElement::initialize(int degr, GeomMapping2D* geommap)
 #endif
 	for(int ig = 0; ig < ng; ig++)
 	{
-		area += gmap->jacDet()[ig] * gw(ig);
+		area += gmap->jacDet(ig) * gw(ig);
 		for(int idim = 0; idim < NDIM; idim++)
-			center[idim] += gmap->map()(ig,idim) * gmap->jacDet()[ig] * gw(ig);
+			center[idim] += gmap->map()(ig,idim) * gmap->jacDet(ig) * gw(ig);
 	}
 	for(int idim = 0; idim < NDIM; idim++)
 		center[idim] /= area;
@@ -438,9 +1172,9 @@ void TaylorElement::initialize(int degr, GeomMapping2D* geommap)
 	if(degree >= 2) {
 		for(int ig = 0; ig < ng; ig++)
 		{
-			basisOffset[0][0] += (gmap->map()(ig,0)-center[0])*(gmap->map()(ig,0)-center[0]) * gmap->jacDet()[ig] * gw(ig);
-			basisOffset[0][2] += (gmap->map()(ig,1)-center[1])*(gmap->map()(ig,1)-center[1]) * gmap->jacDet()[ig] * gw(ig);
-			basisOffset[0][1] += (gmap->map()(ig,0)-center[0])*(gmap->map()(ig,1)-center[1]) * gmap->jacDet()[ig] * gw(ig);
+			basisOffset[0][0] += (gmap->map()(ig,0)-center[0])*(gmap->map()(ig,0)-center[0]) * gmap->jacDet(ig) * gw(ig);
+			basisOffset[0][2] += (gmap->map()(ig,1)-center[1])*(gmap->map()(ig,1)-center[1]) * gmap->jacDet(ig) * gw(ig);
+			basisOffset[0][1] += (gmap->map()(ig,0)-center[0])*(gmap->map()(ig,1)-center[1]) * gmap->jacDet(ig) * gw(ig);
 		}
 		basisOffset[0][0] *= 1.0/(area*2*delta[0]*delta[0]);
 		basisOffset[0][2] *= 1.0/(area*2*delta[1]*delta[1]);
@@ -449,8 +1183,8 @@ void TaylorElement::initialize(int degr, GeomMapping2D* geommap)
 
 	// Compute basis functions and gradients
 	const Matrix& gp = gmap->map();
-	getTaylorBasis(gp, degree, center, delta, basisOffset, basis);
-	getTaylorBasisGrads(gp, degree, center, delta, basisGrad);
+	getTaylorBasis(gp, degree, center, delta, basisOffset, tbasis.basis);
+	getTaylorBasisGrads(gp, degree, center, delta, tbasis.basisGrad);
 }
 
 void TaylorElement::computeBasis(const Matrix& __restrict__ gp, Matrix& __restrict__ basiss) const
@@ -463,7 +1197,7 @@ void TaylorElement::computeBasisGrads(const Matrix& __restrict__ gp, const std::
 	getTaylorBasisGrads(gp, degree, center, delta, basisG);
 }
 
-void LagrangeElement::initialize(int degr, GeomMapping2D* geommap)
+void ReferenceElement::initialize(int degr, GeomMapping2D* geommap)
 {
 	type = REFERENTIAL;
 	degree = degr;
@@ -478,28 +1212,11 @@ void LagrangeElement::initialize(int degr, GeomMapping2D* geommap)
 			ndof += i;
 	}
 
-	int ngauss = gmap->getQuadrature()->numGauss();
-	basis.resize(ngauss,ndof);
-	basisGrad.resize(ngauss);
-	for(int i = 0; i < ngauss; i++) {
-		basisGrad[i].resize(ndof,NDIM);
-	}
-
-	// Compute basis functions and gradients
-	const Matrix& gp = gmap->getQuadrature()->points();
-	const std::vector<MatrixDim>& jinv = gmap->jacInv();
-	getLagrangeBasis(gp, gmap->getShape(), degree, basis);
-	getLagrangeBasisGrads(gp, gmap->getShape(), degree, basisGrad);
-
-	for(int ip = 0; ip < gp.rows(); ip++)
-	{
-		/** To compute gradients in physical space, we use the following.
-		 * Let \f$ a := \nabla_x B(x(\xi)) \f$ and \f$ b = \nabla_\xi B(x(\xi)) \f$. Then,
-		 * we need \f$ a = J^{-T} b \f$. Instead, we can compute \f$ a^T = b^T J^{-1} \f$,
-		 * for efficiency reasons since we have a row-major storage. This latter equation is used.
-		 */
-		basisGrad[ip] = (basisGrad[ip]*jinv[ip]).eval();
+	if(!registry) {
+		std::cout << "! ReferenceElement: initialize(): No basis registry has been set!" << std::endl;
+		std::abort();
 	}
+	bset = registry->get(gmap->getShape(), degree, gmap->getQuadrature(), family);
 }
 
 Matrix LagrangeElement::getReferenceNodes() const
@@ -517,6 +1234,26 @@ Matrix LagrangeElement::getReferenceNodes() const
 			refs(4,0) = 0.5; refs(4,1) = 0.5;
 			refs(5,0) = 0.0; refs(5,1) = 0.5;
 		}
+		if(degree == 3) {
+			const a_real third = 1.0/3, twothirds = 2.0/3;
+			refs(3,0) = third;     refs(3,1) = 0.0;
+			refs(4,0) = twothirds; refs(4,1) = 0.0;
+			refs(5,0) = twothirds; refs(5,1) = third;
+			refs(6,0) = third;     refs(6,1) = twothirds;
+			refs(7,0) = 0.0;       refs(7,1) = twothirds;
+			refs(8,0) = 0.0;       refs(8,1) = third;
+			refs(9,0) = third;     refs(9,1) = third;
+		}
+	}
+	else if(gmap->getShape() == QUADRANGLE && basisFamily() == 'g')
+	{
+		Vector gll, wts;
+		getGaussLobattoPoints(degree+1, gll, wts);
+		for(int a = 0; a <= degree; a++)
+			for(int b = 0; b <= degree; b++) {
+				refs(a*(degree+1)+b,0) = gll(a);
+				refs(a*(degree+1)+b,1) = gll(b);
+			}
 	}
 	else if(gmap->getShape() == QUADRANGLE)
 	{
@@ -533,18 +1270,26 @@ Matrix LagrangeElement::getReferenceNodes() const
 			refs(7,0) = -1; refs(7,1) = 0;
 			refs(8,0) = 0;  refs(8,1) = 0;
 		}
+		if(degree >= 3) {
+			std::vector<int> lex;
+			getQuadrangleTensorIndices(degree, lex);
+			for(int idof = 0; idof < ndof; idof++) {
+				refs(idof,0) = -1.0 + 2.0*(lex[idof]/(degree+1))/degree;
+				refs(idof,1) = -1.0 + 2.0*(lex[idof]%(degree+1))/degree;
+			}
+		}
 	}
 	return refs;
 }
 
-void LagrangeElement::computeBasis(const Matrix& __restrict__ gp, Matrix& __restrict__ basisv) const
+void ReferenceElement::computeBasis(const Matrix& __restrict__ gp, Matrix& __restrict__ basisv) const
 {
-	getLagrangeBasis(gp, gmap->getShape(), degree, basisv);
+	getReferenceBasis(gp, gmap->getShape(), degree, family, basisv);
 }
 
-void LagrangeElement::computeBasisGrads(const Matrix& __restrict__ gp, const std::vector<MatrixDim>& __restrict__ jinv, std::vector<Matrix>& __restrict__ basisG) const
+void ReferenceElement::computeBasisGrads(const Matrix& __restrict__ gp, const std::vector<MatrixDim>& __restrict__ jinv, std::vector<Matrix>& __restrict__ basisG) const
 {
-	getLagrangeBasisGrads(gp, gmap->getShape(), degree, basisG);
+	getReferenceBasisGrads(gp, gmap->getShape(), degree, family, basisG);
 
 	for(int ip = 0; ip < gp.rows(); ip++)
 	{
@@ -590,54 +1335,48 @@ void FaceElement::initialize(const Element*const lelem, const Element*const rele
 {
 	gmap = gmapping; leftel = lelem; rightel = relem; llfn = l_lfn; rlfn = r_lfn;
 
+	leftbasis = setupBasis(leftel, llfn, 1, ownleftbasis, leftnodes);
+	rightbasis = setupBasis(rightel, rlfn, -1, ownrightbasis, rightnodes);
+}
+
+/** For elements with a reference-space basis, the values are taken from the trace table of the element's
+ * [registry](@ref ReferenceElement::basisRegistry), as they do not depend on the geometry.
+ * Otherwise they are computed at the physical coordinates of the face quadrature points and stored in this face.
+ */
+const Matrix* FaceElement::setupBasis(const Element *const elem, const int lfn, const int orientation, Matrix& ownbasis,
+		const std::vector<int>*& nodes)
+{
 	const int ng = gmap->getQuadrature()->numGauss();
+	nodes = nullptr;
 
-	if(lelem->getType() == PHYSICAL) {
-		leftbasis.resize(ng,lelem->getNumDOFs());
+	if(elem->getType() == PHYSICAL) {
+		ownbasis.resize(ng,elem->getNumDOFs());
 		const Matrix& points = gmap->map();
-		lelem->computeBasis(points, leftbasis);
+		elem->computeBasis(points, ownbasis);
 	}
-	else if(lelem->getType() == REFERENTIAL)
+	else if(elem->getType() == REFERENTIAL)
 	{
-		// compute element reference coordinates of face quadrature points from their face reference coordinates
-		Matrix lpoints(ng,NDIM);
-		const Matrix& facepoints = gmap->getQuadrature()->points();
-		getElementRefCoords(facepoints, leftel, llfn, 1, lpoints);
-
-		// now compute basis function values
-		leftbasis.resize(ng,lelem->getNumDOFs());
-		lelem->computeBasis(lpoints, leftbasis);
-	}
+		const ReferenceElement *const relem = static_cast<const ReferenceElement*>(elem);
+		BasisRegistry *const reg = relem->basisRegistry();
+		if(reg) {
+			const FaceTraceSet* trace = reg->getTrace(elem->getGeometricMapping()->getShape(), elem->getDegree(), lfn, orientation,
+					gmap->getQuadrature(), relem->basisFamily());
+			ownbasis.resize(0,0);
+			if(!trace->nodes.empty())
+				nodes = &trace->nodes;
+			return &trace->basis;
+		}
 
-	if(relem->getType() == PHYSICAL) {
-		rightbasis.resize(ng,relem->getNumDOFs());
-		const Matrix& points = gmap->map();
-		relem->computeBasis(points, rightbasis);
-	}
-	else if(relem->getType() == REFERENTIAL)
-	{
 		// compute element reference coordinates of face quadrature points from their face reference coordinates
-		Matrix rpoints(ng,NDIM);
+		Matrix lpoints(ng,NDIM);
 		const Matrix& facepoints = gmap->getQuadrature()->points();
-		getElementRefCoords(facepoints, rightel, rlfn, -1, rpoints);
-
-		/*std::vector<MatrixDim> jacinv(ng); std::vector<a_real> jacdet(ng);
-		const std::vector<a_real> facedet = gmap->speed();
-		rightel->getGeometricMapping()->calculateJacobianDetAndInverse(rpoints, jacinv, jacdet);*/
-		/*for(int ig = 0; ig < ng; ig++) {
-			a_real diff = std::fabs(jacdet[ig]*fspeed - facedet[ig]);
-			std::cout << "  Rightel: Diff = " << diff;
-			if(diff > ZERO_TOL) std::cout << "!! --- !!";
-			std::cout << std::endl;
-		}*/
+		getElementRefCoords(facepoints, elem, lfn, orientation, lpoints);
 
 		// now compute basis function values
-		rightbasis.resize(ng,relem->getNumDOFs());
-		relem->computeBasis(rpoints, rightbasis);
-
-		/*for(int ig = 0; ig < ng; ig++)
-			rightbasis.row(ig) *= jacdet[ig]*fspeed/facedet[ig];*/
+		ownbasis.resize(ng,elem->getNumDOFs());
+		elem->computeBasis(lpoints, ownbasis);
 	}
+	return &ownbasis;
 }
 
 void FaceElement::computeBasisGrads()
@@ -693,76 +1432,10 @@ void FaceElement::computeBasisGrads()
 	}
 }
 
-/** Note that the order of points has to be reversed for the right element.
- * We use lr for this.
- */
 a_real FaceElement::getElementRefCoords(const Matrix& __restrict__ facepoints, const Element *const __restrict__ elem,
 		const int llfn, const int lr, Matrix& __restrict__ dompoints)
 {
-	int ng = facepoints.rows();
-#ifdef DEBUG
-	if(ng != dompoints.rows())
-		printf("!  FaceElement: getElementRefCoords: Size mismatch!\n");
-#endif
-	if(elem->getGeometricMapping()->getShape() == TRIANGLE) {
-		if(llfn == 0)
-		{
-			for(int ig = 0; ig < ng; ig++) {
-				dompoints(ig,0) = 0.5*(1.0 + lr*facepoints(ig));
-				dompoints(ig,1) = 0;
-			}
-			return 0.5;
-		}
-		else if(llfn == 1)
-		{
-			for(int ig = 0; ig < ng; ig++) {
-				dompoints(ig,0) = 0.5*(1.0 - lr*facepoints(ig));
-				dompoints(ig,1) = 0.5*(1.0 + lr*facepoints(ig));
-			}
-			return 1/SQRT2;
-		}
-		else
-		{
-			for(int ig = 0; ig < ng; ig++) {
-				dompoints(ig,0) = 0;
-				dompoints(ig,1) = 0.5*(1.0 - lr*facepoints(ig));
-			}
-			return 0.5;
-		}
-	}
-	else if(elem->getGeometricMapping()->getShape() == QUADRANGLE) {
-		if(llfn == 0)
-		{
-			for(int ig = 0; ig < ng; ig++) {
-				dompoints(ig,0) = lr*facepoints(ig);
-				dompoints(ig,1) = -1.0;
-			}
-		}
-		else if(llfn == 1)
-		{
-			for(int ig = 0; ig < ng; ig++) {
-				dompoints(ig,0) = 1.0;
-				dompoints(ig,1) = lr*facepoints(ig);
-			}
-		}
-		else if(llfn == 2)
-		{
-			for(int ig = 0; ig < ng; ig++) {
-				dompoints(ig,0) = lr*(-facepoints(ig));
-				dompoints(ig,1) = 1.0;
-			}
-		}
-		else
-		{
-			for(int ig = 0; ig < ng; ig++) {
-				dompoints(ig,0) = -1.0;
-				dompoints(ig,1) = lr*(-facepoints(ig));
-			}
-		}
-		return 1.0;
-	}
-
-	else return 0;
+	return getFaceReferenceCoords(facepoints, elem->getGeometricMapping()->getShape(), llfn, lr, dompoints);
 }
 
 }
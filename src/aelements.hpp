@@ -110,7 +110,14 @@ protected:
 	Matrix mapping;								///< Physical coords of the quadrature points
 	const Quadrature2D* quadrature;				///< Gauss points and weights for integrating quantities
 
+	/// Whether the map is affine, ie, its Jacobian is constant over the element
+	/** For affine maps, only one Jacobian inverse and determinant are stored, instead of one per quadrature point.
+	 */
+	bool affine;
+
 public:
+	GeomMapping2D() : affine(false) { }
+
 	/// Return the order
 	int getDegree() const {
 		return degree;
@@ -128,12 +135,13 @@ public:
 	}
 
 	/// Allocates and sets the Jacobian inverses and Jacobian determinants corresponding to the quadrature points
-	/** Call this function only after [setting up](@ref setAll).
+	/** Call this function only after [setting up](@ref setAll). Also decides whether the map is [affine](@ref affine).
 	 */
 	virtual void computeForReferenceElement() = 0;
 
 	/// Computes basis function values and Jacobian determinants at quadrature points
 	/** Note that storage is allocated only for mapping and jacodet, not for Jacobian matrix or its inverse.
+	 * Also decides whether the map is [affine](@ref affine).
 	 */
 	virtual void computeForPhysicalElement() = 0;
 
@@ -161,14 +169,25 @@ public:
 		return jaco;
 	}
 
-	/// Read-only access to inverse of jacobians at domain quadrature points
-	const std::vector<MatrixDim>& jacInv() const {
-		return jacoinv;
+	/// Inverse of the Jacobian at the domain quadrature point ig
+	const MatrixDim& jacInv(const int ig) const {
+		return jacoinv[affine ? 0 : ig];
+	}
+
+	/// Jacobian determinant at the domain quadrature point ig
+	a_real jacDet(const int ig) const {
+		return jacodet[affine ? 0 : ig];
 	}
 
-	/// Jacobian determinant at domain quadrature points
-	const std::vector<a_real>& jacDet() const {
-		return jacodet;
+	/// Returns true if the Jacobian of the map is constant over the element
+	bool isAffine() const {
+		return affine;
+	}
+
+	/// Approximate memory held by the map, in bytes, not counting the object itself
+	size_t bytes() const {
+		return (phyNodes.size() + mapping.size() + jacodet.size())*sizeof(a_real)
+			+ (jaco.size() + jacoinv.size())*sizeof(MatrixDim);
 	}
 
 	/// Access to quadrature context
@@ -187,6 +206,12 @@ public:
  */
 class LagrangeMapping2D: public GeomMapping2D
 {
+	/// Checks whether the physical nodes describe an affine map
+	/** This is the case for straight-sided triangles, including P2 triangles whose mid-side nodes
+	 * are at the mid-points of the sides, and for parallelograms. 
+	 */
+	bool checkAffine() const;
+
 public:
 	void computeForReferenceElement();
 
@@ -207,24 +232,243 @@ public:
  */
 enum BasisType {REFERENTIAL, PHYSICAL, NONEXISTENT};
 
-/// Stores the values of a set of basis function matrices and gradient tensors at a set of points, such as
+/// Largest number of 1D basis functions or 1D quadrature points for which sum factorization is set up
+#define TENSOR_MAX_1D 8
+
+/// Lowest degree at which the element kernels use sum factorization on quadrangles
+/** Below this, the dense products are faster. The crossover is measured by benchmarks/benchsumfactorization.cpp.
+ */
+#define SUMFACT_MIN_DEGREE 4
+
+/// One-dimensional factors of a tensor-product basis on quadrangles, at the 1D points of a tensor-product quadrature
+/** With these, functions and their gradients can be evaluated at the quadrature points, and integrated against
+ * the test functions, by sum factorization, which costs O(p^3) per element instead of the O(p^4) of the 
+ * dense (npoints x ndofs) products. A DOF with 1D node indices a (along \f$ \xi \f$) and b (along \f$ \eta \f$)
+ * has the lexicographic index a*ndof1d+b; a quadrature point with 1D indices i and j has the index i*npoin1d+j,
+ * as in [Quadrature2DSquare](@ref Quadrature2DSquare).
+ */
+struct TensorBasis1D
+{
+	int ndof1d;										///< Number of 1D basis functions, degree+1
+	int npoin1d;									///< Number of 1D quadrature points
+	Matrix val;										///< 1D basis function values at the 1D points (npoin1d x ndof1d)
+	Matrix der;										///< 1D basis function derivatives at the 1D points (npoin1d x ndof1d)
+	std::vector<int> lexindex;						///< Lexicographic index of each DOF of the element
+
+	/// Whether the kernels should use sum factorization for this basis; false if there are no tensor factors
+	bool sumfactorize;
+
+	TensorBasis1D() : ndof1d(0), npoin1d(0), sumfactorize(false) { }
+};
+
+/// Stores the values of a set of basis functions and their gradients at a set of points, such as
 /// the quadrature points of the reference element
-/** The gradient tensor contains values of x- and y-derivatives of each basis at the set of points
+/** The gradient `tensor' contains values of x- and y-derivatives of each basis at the set of points.
  * Currently a gradient `tensor' is stored as a vector of Matrices. 
  * TODO: Replace with Eigen's Tensor.
  */
 struct BasisSet
 {
-	std::vector<int> deg;
-	std::vector<Matrix> basis;
-	std::vector<std::vector<Matrix>> basisGrad;
+	Shape shape;									///< Shape of the element
+	int degree;										///< Polynomial degree of the basis
+	char family;									///< Lagrange ('l'), orthonormal ('o') or Taylor ('t')
+	const Quadrature2D* quadrature;					///< The quadrature at whose points the basis is evaluated
+	Matrix basis;									///< Basis function values (npoints x ndofs)
+	std::vector<Matrix> basisGrad;					///< Basis function gradients at each point (ndofs x ndim)
+	TensorBasis1D tensor;							///< 1D factors of the basis, if it is a tensor product
+
+	/// True if the points are the nodes of the basis, in DOF order, so that [basis](@ref basis) is the identity
+	bool collocated;
+
+	BasisSet() : collocated(false) { }
+
+	/// Approximate memory used by the basis values and gradients, in bytes
+	size_t bytes() const {
+		size_t b = sizeof(BasisSet) + basis.size()*sizeof(a_real);
+		for(size_t i = 0; i < basisGrad.size(); i++)
+			b += sizeof(Matrix) + basisGrad[i].size()*sizeof(a_real);
+		b += (tensor.val.size() + tensor.der.size())*sizeof(a_real) + tensor.lexindex.size()*sizeof(int);
+		return b;
+	}
+};
+
+/// Values and reference gradients of an element's basis functions at the quadrature points of one of its faces
+/** For a reference-space basis, these depend only on the element's shape and degree, the local face number,
+ * the face quadrature and whether the element is to the left or right of the face (which reverses the order
+ * of the face quadrature points). [quadrature](@ref BasisSet::quadrature) is unused.
+ */
+struct FaceTraceSet : public BasisSet
+{
+	int lfn;										///< Local face number in the element
+	int orientation;								///< 1 if the element is the face's left element, -1 if it is the right
+	const Quadrature1D* facequadrature;				///< Face quadrature
+
+	/// The DOF whose node is at each face quadrature point, if all of them are nodes of the basis; empty otherwise
+	/** With these, the values at the face quadrature points are just the DOFs at these nodes.
+	 */
+	std::vector<int> nodes;
+};
+
+/// Evaluates functions at the quadrature points of a tensor-product element by sum factorization
+/** Equivalent to [evaluateFunctions](@ref evaluateFunctions) with the full basis matrix.
+ * \param[in] dofs The matrix of DOFs (nvars x ndofs)
+ * \param[in|out] interp Values at the quadrature points (npoints x nvars); resized if needed
+ */
+void tensorEvaluateFunctions(const TensorBasis1D& tb, const ConstMatrixRef& dofs, Matrix& __restrict__ interp);
+
+/// Evaluates the reference gradients of functions at the quadrature points of a tensor-product element by sum factorization
+/** \param[in] dofs The matrix of DOFs (nvars x ndofs)
+ * \param[in|out] dxi Derivatives w.r.t. \f$ \xi \f$ at the quadrature points (npoints x nvars); resized if needed
+ * \param[in|out] deta Derivatives w.r.t. \f$ \eta \f$ at the quadrature points (npoints x nvars); resized if needed
+ */
+void tensorEvaluateGradients(const TensorBasis1D& tb, const ConstMatrixRef& dofs, Matrix& __restrict__ dxi, Matrix& __restrict__ deta);
+
+/// Integrates vector fields against the reference gradients of the test functions by sum factorization
+/** Adds \f$ \sum_g f_\xi(g) \partial_\xi B_i(g) + f_\eta(g) \partial_\eta B_i(g) \f$ to term(ivar,i) for each DOF i.
+ * Quadrature weights and Jacobian determinants must already be included in the fields.
+ * \param[in] fxi The \f$ \xi \f$-components at the quadrature points (npoints x nvars)
+ * \param[in] feta The \f$ \eta \f$-components at the quadrature points (npoints x nvars)
+ * \param[in|out] term The integrals are added to this (nvars x ndofs)
+ */
+void tensorIntegrateGradients(const TensorBasis1D& tb, const ConstMatrixRef& fxi, const ConstMatrixRef& feta, Matrix& __restrict__ term);
+
+/// Evaluates the reference gradients of functions at the nodes of a collocated tensor-product basis
+/** The 1D derivative matrix is applied along each direction; this needs only O(p^3) operations per element.
+ * The DOFs must be in lexicographic order, as for the [Gauss-Lobatto](@ref LobattoElement) basis.
+ * \param[in] dofs The matrix of DOFs (nvars x ndofs)
+ * \param[in|out] dxi Derivatives w.r.t. \f$ \xi \f$ at the nodes (ndofs x nvars); resized if needed
+ * \param[in|out] deta Derivatives w.r.t. \f$ \eta \f$ at the nodes (ndofs x nvars); resized if needed
+ */
+void collocatedEvaluateGradients(const TensorBasis1D& tb, const ConstMatrixRef& dofs, Matrix& __restrict__ dxi, Matrix& __restrict__ deta);
+
+/// Integrates vector fields at the nodes of a collocated tensor-product basis against the reference gradients of the test functions
+/** The counterpart of [tensorIntegrateGradients](@ref tensorIntegrateGradients) for collocated bases.
+ */
+void collocatedIntegrateGradients(const TensorBasis1D& tb, const ConstMatrixRef& fxi, const ConstMatrixRef& feta, Matrix& __restrict__ term);
+
+/// Evaluates the gradients of functions at the points of a basis set with dense products
+/** The counterpart of [tensorEvaluateGradients](@ref tensorEvaluateGradients) for any basis set;
+ * the gradients are w.r.t. the coordinates of the gradients stored in the set.
+ */
+inline void evaluateGradients(const BasisSet& bs, const ConstMatrixRef& dofs, Matrix& __restrict__ dx, Matrix& __restrict__ dy)
+{
+	const int ng = static_cast<int>(bs.basisGrad.size());
+	dx.resize(ng, dofs.rows());
+	dy.resize(ng, dofs.rows());
+	for(int ig = 0; ig < ng; ig++)
+		for(int ivar = 0; ivar < dofs.rows(); ivar++)
+		{
+			dx(ig,ivar) = 0; dy(ig,ivar) = 0;
+			for(int idof = 0; idof < dofs.cols(); idof++) {
+				dx(ig,ivar) += dofs(ivar,idof)*bs.basisGrad[ig](idof,0);
+				dy(ig,ivar) += dofs(ivar,idof)*bs.basisGrad[ig](idof,1);
+			}
+		}
+}
+
+/// Integrates vector fields against the basis gradients of a basis set with dense products
+/** The counterpart of [tensorIntegrateGradients](@ref tensorIntegrateGradients) for any basis set;
+ * the gradients are those stored in the set.
+ */
+inline void integrateGradients(const BasisSet& bs, const ConstMatrixRef& fxi, const ConstMatrixRef& feta, Matrix& __restrict__ term)
+{
+	for(size_t ig = 0; ig < bs.basisGrad.size(); ig++)
+		for(int ivar = 0; ivar < term.rows(); ivar++)
+			for(int idof = 0; idof < term.cols(); idof++)
+				term(ivar,idof) += fxi(ig,ivar)*bs.basisGrad[ig](idof,0) + feta(ig,ivar)*bs.basisGrad[ig](idof,1);
+}
+
+/// Computes Lagrange basis function values at points given in reference coordinates (npoints x ndofs)
+void getLagrangeBasis(const Matrix& gp, const Shape shape, const int degree, Matrix& basisv);
+
+/// Computes Lagrange basis function gradients w.r.t. reference coordinates at points given in reference coordinates
+void getLagrangeBasisGrads(const Matrix& gp, const Shape shape, const int degree, std::vector<Matrix>& basisG);
+
+/// Computes 1D Lagrange basis functions on equispaced nodes in [-1,1] and their derivatives at some points
+/** \param[in] pts The points
+ * \param[in|out] vals Basis function values (npoints x degree+1); resized here
+ * \param[in|out] ders Basis function derivatives (npoints x degree+1); resized here
+ */
+void getLagrangeBasis1D(const Vector& pts, const int degree, Matrix& vals, Matrix& ders);
+
+/// Computes 1D Lagrange basis functions on the degree+1 Gauss-Lobatto-Legendre nodes and their derivatives at some points
+/** \param[in|out] vals Basis function values (npoints x degree+1); resized here
+ * \param[in|out] ders Basis function derivatives (npoints x degree+1); resized here
+ */
+void getLobattoBasis1D(const Vector& pts, const int degree, Matrix& vals, Matrix& ders);
+
+/// Lexicographic tensor indices of the nodes of a quadrangle Lagrange element of any degree \sa TensorBasis1D
+void getQuadrangleTensorIndices(const int degree, std::vector<int>& lex);
+
+/// Computes 1D Legendre polynomials normalized to unit L2 norm on [-1,1], and their derivatives, at some points
+/** \param[in|out] vals Basis function values (npoints x degree+1); resized here
+ * \param[in|out] ders Basis function derivatives (npoints x degree+1); resized here
+ */
+void getLegendreBasis1D(const Vector& pts, const int degree, Matrix& vals, Matrix& ders);
+
+/// Computes orthonormal basis function values at points given in reference coordinates (npoints x ndofs)
+/** On triangles, this is the Dubiner basis, ordered by total degree. On quadrangles, it is the tensor product
+ * of [normalized Legendre polynomials](@ref getLegendreBasis1D); DOF a*(degree+1)+b is the product of the
+ * polynomials of degree a in \f$ \xi \f$ and degree b in \f$ \eta \f$. The functions are orthonormal on
+ * the reference element, so the mass matrix of an affine element is the identity times the Jacobian determinant.
+ * In either case, the first basis function is a constant.
+ */
+void getOrthonormalBasis(const Matrix& gp, const Shape shape, const int degree, Matrix& basisv);
+
+/// Computes orthonormal basis function gradients w.r.t. reference coordinates at points given in reference coordinates
+void getOrthonormalBasisGrads(const Matrix& gp, const Shape shape, const int degree, std::vector<Matrix>& basisG);
+
+/// Computes values of the reference-space basis functions of a family - Lagrange ('l'), orthonormal ('o') or Gauss-Lobatto ('g')
+void getReferenceBasis(const Matrix& gp, const Shape shape, const int degree, const char family, Matrix& basisv);
+
+/// Computes reference gradients of the reference-space basis functions of a family - Lagrange ('l'), orthonormal ('o') or Gauss-Lobatto ('g')
+void getReferenceBasisGrads(const Matrix& gp, const Shape shape, const int degree, const char family, std::vector<Matrix>& basisG);
+
+/// Holds one set of reference-element basis values and gradients for each (shape, degree, basis family, quadrature)
+/** These values do not depend on the physical element, so all reference elements of a discretization share them.
+ * The same holds for the traces of the basis on the faces of the reference element, which the face elements share.
+ * Sets are created on first request and live as long as the registry.
+ */
+class BasisRegistry
+{
+	std::vector<BasisSet*> sets;
+	std::vector<FaceTraceSet*> traces;
+
+public:
+	~BasisRegistry();
+
+	/// Returns the basis set for the arguments, computing it if it does not exist yet
+	/** Not thread-safe; elements are expected to be set up serially.
+	 */
+	const BasisSet* get(const Shape shape, const int degree, const Quadrature2D *const quad, const char family = 'l');
+
+	/// Returns the face trace set for the arguments, computing it if it does not exist yet
+	/** \param orientation is 1 for the left element of a face and -1 for the right element
+	 * Not thread-safe.
+	 */
+	const FaceTraceSet* getTrace(const Shape shape, const int degree, const int lfn, const int orientation, 
+			const Quadrature1D *const fquad, const char family = 'l');
+
+	/// Number of distinct basis sets held
+	size_t numSets() const {
+		return sets.size();
+	}
+
+	/// Number of distinct face trace sets held
+	size_t numTraces() const {
+		return traces.size();
+	}
+
+	/// Memory used by all the basis sets, in bytes
+	size_t bytes() const;
 };
 
 /// Abstract finite element
-/** \todo Note that this implementation is not very good for elements with basis functions defined on the reference element.
- * Such elements would only need to store 1 set of basis function values for all elements of a given polynomial order.
- * In contrast, elements defined in physical coordinates need to hold different basis function values for different elements.
- * So a better option is to leave storage of basis and basis gradients to child classes and have pure virtual accessors here.
+/** The values and gradients of the basis functions at the domain quadrature points are held in a [BasisSet](@ref bset).
+ * For elements with basis functions defined on the reference element, this set is shared by all elements
+ * of the same shape and degree, and the gradients are with respect to reference coordinates.
+ * For elements with basis functions defined in physical coordinates, each element owns its set and the gradients
+ * are with respect to physical coordinates. \sa BasisType
  */
 class Element
 {
@@ -232,12 +476,11 @@ protected:
 	BasisType type;									///< Where are the basis functions defined? \sa BasisType
 	int degree;										///< Polynomial degree
 	int ndof;										///< Number of local DOFs
-	Matrix basis;									///< Values of basis functions at quadrature points
-	std::vector<Matrix> basisGrad;					///< Values of derivatives of the basis functions at the quadrature points
 	const GeomMapping2D* gmap;						///< The 2D geometric map which maps this element to the reference element
-	const BasisSet* bset;							///< This can be used to store basis and basis gradient values too
+	const BasisSet* bset;							///< Values of basis functions and their gradients at quadrature points
 
 public:
+	Element() : gmap(nullptr), bset(nullptr) { }
 
 	/// Set the data, compute geom map, and compute basis and basis grad
 	/** \param[in] geommap The geometric mapping should be initialized beforehand;
@@ -248,7 +491,7 @@ public:
 	/// Computes values of basis functions at given points in either reference space or physical space
 	virtual void computeBasis(const Matrix& points, Matrix& basisvalues) const = 0;
 
-	/// Computes basis functions' gradients at given points in either reference space or physical space
+	/// Computes basis functions' gradients (w.r.t. physical coordinates) at given points in either reference space or physical space
 	virtual void computeBasisGrads(const Matrix& points, const std::vector<MatrixDim>& jinv, std::vector<Matrix>& basisgrads) const = 0;
 
 	virtual ~Element() { }
@@ -258,7 +501,7 @@ public:
 	{
 		a_real val = 0;
 		for(int i = 0; i < ndof; i++)
-			val += dofs[i]*basis(ig,i);
+			val += dofs[i]*bset->basis(ig,i);
 		return val;
 	}
 
@@ -268,27 +511,71 @@ public:
 	 * CANNOT be the same as dofs, the first argument.
 	 * DEPRECATED in favor of [this global function](@ref evaluateFunctions)
 	 */
-	void interpolateAll(const Matrix& __restrict__ dofs, Matrix& __restrict__ values) const
+	void interpolateAll(const ConstMatrixRef& dofs, Matrix& __restrict__ values) const
+	{
+		if(bset->tensor.sumfactorize)
+			tensorEvaluateFunctions(bset->tensor, dofs, values);
+		else
+			values.noalias() = bset->basis * dofs.transpose();
+	}
+
+	/// Computes the gradients of a function at domain quadrature points using DOFs supplied
+	/** The gradients are w.r.t. the coordinates in which the basis is defined, as for [bGrad](@ref bGrad).
+	 * \param[in] dofs The rowmajor matrix of local DOFs (1 row per physical variable)
+	 * \param[in|out] dx First components of the gradients at each quadrature point (npoints x nvars)
+	 * \param[in|out] dy Second components of the gradients at each quadrature point (npoints x nvars)
+	 */
+	void interpolateGradients(const ConstMatrixRef& dofs, Matrix& __restrict__ dx, Matrix& __restrict__ dy) const
+	{
+		if(bset->tensor.sumfactorize)
+			tensorEvaluateGradients(bset->tensor, dofs, dx, dy);
+		else
+			acfd::evaluateGradients(*bset, dofs, dx, dy);
+	}
+
+	/// Adds the integrals of vector fields against the gradients of the test functions
+	/** The gradients are w.r.t. the coordinates in which the basis is defined, as for [bGrad](@ref bGrad).
+	 * \param[in] fx First components of the fields at the quadrature points, including weights and Jacobians (npoints x nvars)
+	 * \param[in] fy Second components of the fields at the quadrature points (npoints x nvars)
+	 * \param[in|out] term Pre-allocated (nvars x ndofs) matrix to which the integrals are added
+	 */
+	void integrateGradients(const ConstMatrixRef& fx, const ConstMatrixRef& fy, Matrix& __restrict__ term) const
 	{
-		values.noalias() = basis * dofs.transpose();
+		if(bset->tensor.sumfactorize)
+			tensorIntegrateGradients(bset->tensor, fx, fy, term);
+		else
+			acfd::integrateGradients(*bset, fx, fy, term);
 	}
 	
 	/// Computes values of the specified component at domain quadrature points using DOFs supplied
 	/** \param[in] comp specifies the row to use in the matrix of DOFs
 	 */
-	void interpolateComponent(const int comp, const Matrix& __restrict__ dofs, Vector& __restrict__ values) const
+	void interpolateComponent(const int comp, const ConstMatrixRef& dofs, Vector& __restrict__ values) const
 	{
-		values.noalias() = basis * dofs.row(comp).transpose();
+		values.noalias() = bset->basis * dofs.row(comp).transpose();
 	}
 
-	/// Read-only access to basis at a given quadrature point
-	virtual const Matrix& bFunc() const {
-		return basis;
+	/// Read-only access to basis function values at the domain quadrature points
+	const Matrix& bFunc() const {
+		return bset->basis;
+	}
+
+	/// Read-only access to basis gradients at the element's domain quadrature points
+	/** These are w.r.t. reference coordinates for REFERENTIAL elements and w.r.t. physical coordinates otherwise.
+	 * Use [physicalBasisGrads](@ref physicalBasisGrads) if physical gradients are needed regardless.
+	 */
+	const std::vector<Matrix>& bGrad() const {
+		return bset->basisGrad;
 	}
 
-	/// Read-only access to basis gradients at the element's domain quadrature point
-	virtual const std::vector<Matrix>& bGrad() const {
-		return basisGrad;
+	/// Computes basis gradients w.r.t. physical coordinates at the domain quadrature points
+	/** For REFERENTIAL elements, this applies the inverse Jacobian of the geometric map to the reference gradients.
+	 */
+	void physicalBasisGrads(std::vector<Matrix>& pgrads) const;
+
+	/// Read-only access to the basis set used by this element
+	const BasisSet* basisSet() const {
+		return bset;
 	}
 
 	int getDegree() const {
@@ -323,9 +610,11 @@ class TaylorElement : public Element
 	a_real center[NDIM];								///< Physical location of element's geometric center
 	a_real delta[NDIM];									///< Maximum extent of the element in the coordinate directions
 	std::vector<std::vector<a_real>> basisOffset;		///< The quantities by which the basis functions are offset from actual Taylor polynomial basis
+	BasisSet tbasis;									///< Basis function values and gradients for this element
 public:
 	TaylorElement() {
 		type = PHYSICAL;
+		bset = &tbasis;
 	}
 
 	/// Sets data, computes geometric map data and computes basis functions and their gradients
@@ -360,23 +649,41 @@ public:
 	}
 };
 
-/// Lagrange finite element with equi-spaced nodes
+/// Finite element with basis functions defined on the reference element
 /** Computation of basis function gradients requires geometric Jacobian.
  * \f[ 
  * \nabla B(x) = \nabla \hat{B}(F^{-1}(x)) = J^{-T} \nabla_\xi \hat{B}(F^{-1}(F(\xi)))
  * = \nabla_\xi \hat{B}(\xi)
  * \f]
- *
- * \todo TODO: Use BasisSet instead of storing basis and gradients at quadrature points for all elements separately.
+ * The basis values and reference gradients at quadrature points are not stored here but in a [BasisSet](@ref BasisSet)
+ * shared with all other elements of the same shape, degree and basis family, which must be 
+ * [set](@ref setBasisRegistry) before [initialization](@ref initialize).
  */
-class LagrangeElement : public Element
+class ReferenceElement : public Element
 {
+	BasisRegistry* registry;						///< Source of the shared basis sets
+	char family;									///< The family of basis functions - Lagrange ('l'), orthonormal ('o') or Gauss-Lobatto ('g')
+
 public:
-	LagrangeElement() {
+	ReferenceElement(const char basisfamily) : registry(nullptr), family(basisfamily) {
 		type = REFERENTIAL;
 	}
 
-	/// Sets data and computes basis functions and their gradients
+	/// Sets the registry from which the basis set is obtained
+	void setBasisRegistry(BasisRegistry *const reg) {
+		registry = reg;
+	}
+
+	/// The registry from which basis sets and face traces are obtained
+	BasisRegistry* basisRegistry() const {
+		return registry;
+	}
+
+	char basisFamily() const {
+		return family;
+	}
+
+	/// Sets data and computes geometric data; the basis set is obtained from the registry
 	void initialize(int degr, GeomMapping2D* geommap);
 	
 	/// Computes values of basis functions at a given point in reference space
@@ -384,19 +691,44 @@ public:
 	
 	/// Computes basis functions' gradients at given points in reference space
 	void computeBasisGrads(const Matrix& points, const std::vector<MatrixDim>& jinv, std::vector<Matrix>& basisgrads) const;
-	
+};
+
+/// Lagrange finite element with equi-spaced nodes
+class LagrangeElement : public ReferenceElement
+{
+protected:
+	/// For Lagrange elements with other nodes
+	LagrangeElement(const char basisfamily) : ReferenceElement(basisfamily) { }
+
+public:
+	LagrangeElement() : ReferenceElement('l') { }
+
 	/// Returns the locations of nodes in reference space
 	Matrix getReferenceNodes() const;
-	
-	/// Read-only access to basis at a given quadrature point
-	const Matrix& bFunc() const {
-		return basis;
-	}
+};
 
-	/// Read-only access to basis gradients at the element's domain quadrature point
-	const std::vector<Matrix>& bGrad() const {
-		return basisGrad;
-	}
+/// Lagrange finite element on quadrangles with nodes at the tensor-product Gauss-Lobatto-Legendre points
+/** When the domain quadrature is the [Gauss-Lobatto rule](@ref Quadrature2DSquareLobatto) with the same points,
+ * the basis is [collocated](@ref BasisSet::collocated): interpolation to the quadrature points is the identity,
+ * the mass matrix (computed with that quadrature) is diagonal for any geometry, and values at face
+ * quadrature points are just the DOFs at the face's nodes. This is the DG spectral element method (DGSEM).
+ * DOF a*(p+1)+b is at the ath node in \f$ \xi \f$ and the bth node in \f$ \eta \f$.
+ * On triangles, this is the same as a [LagrangeElement](@ref LagrangeElement).
+ */
+class LobattoElement : public LagrangeElement
+{
+public:
+	LobattoElement() : LagrangeElement('g') { }
+};
+
+/// Finite element with a basis that is orthonormal on the reference element \sa getOrthonormalBasis
+/** The mass matrix of an affine element is diagonal, so inverting it is just a scaling.
+ * The DOFs are modal; the first DOF times the value of the first (constant) basis function is the mean value.
+ */
+class OrthonormalElement : public ReferenceElement
+{
+public:
+	OrthonormalElement() : ReferenceElement('o') { }
 };
 
 /// Just that - a dummy element
@@ -419,12 +751,56 @@ class FaceElement
 	const Element* leftel;								///< "Left" element
 	const Element* rightel;								///< "Right" element
 	int llfn, rlfn;										///< Local face number of this face w.r.t the left and right elements
-	Matrix leftbasis;									///< Values of the left element's basis functions at the face quadrature points
-	Matrix rightbasis;									///< Values of the left element's basis functions at the face quadrature points
+	
+	/// Values of the left element's basis functions at the face quadrature points
+	/** Points to a shared [trace table](@ref FaceTraceSet) for reference-space bases, or to ownleftbasis otherwise.
+	 */
+	const Matrix* leftbasis;
+	const Matrix* rightbasis;							///< Values of the right element's basis functions at the face quadrature points
+	const std::vector<int>* leftnodes;					///< DOFs of the left element at the face quadrature points, if collocated
+	const std::vector<int>* rightnodes;					///< DOFs of the right element at the face quadrature points, if collocated
+	Matrix ownleftbasis;								///< Storage for left basis values, if they cannot be shared
+	Matrix ownrightbasis;								///< Storage for right basis values, if they cannot be shared
 	std::vector<Matrix> leftbgrad;						///< left element's basis gradients at face quadrature points
 	std::vector<Matrix> rightbgrad;						///< right element's basis gradients at face quadrature points
 	const GeomMapping1D* gmap;							///< 1D geometric mapping (parameterization) of the face
 
+	/// Sets the basis values of one side of the face, from a trace table if possible
+	/** \param[out] nodes Set to the trace's [nodes](@ref FaceTraceSet::nodes) if the face quadrature points are nodes 
+	 * of the element's basis, and to nullptr otherwise
+	 */
+	const Matrix* setupBasis(const Element *const elem, const int lfn, const int orientation, Matrix& ownbasis,
+			const std::vector<int>*& nodes);
+
+	/// Adds factor times the integrals of fields at the face quadrature points against one element's basis functions
+	static void integrateAll(const Matrix& basis, const std::vector<int> *const nodes, const ConstMatrixRef& f, 
+			const a_real factor, MatrixMap& term)
+	{
+		if(nodes)
+			for(int ig = 0; ig < f.rows(); ig++)
+				for(int ivar = 0; ivar < term.rows(); ivar++)
+					term(ivar,(*nodes)[ig]) += factor*f(ig,ivar);
+		else
+			for(int ig = 0; ig < f.rows(); ig++)
+				for(int ivar = 0; ivar < term.rows(); ivar++)
+					for(int idof = 0; idof < term.cols(); idof++)
+						term(ivar,idof) += factor*f(ig,ivar)*basis(ig,idof);
+	}
+
+	/// Gets values at the face quadrature points from the DOFs of one element
+	static void interpolateAll(const Matrix& basis, const std::vector<int> *const nodes, const ConstMatrixRef& dofs, 
+			Matrix& __restrict__ values)
+	{
+		if(nodes) {
+			values.resize(nodes->size(), dofs.rows());
+			for(size_t ig = 0; ig < nodes->size(); ig++)
+				for(int ivar = 0; ivar < dofs.rows(); ivar++)
+					values(ig,ivar) = dofs(ivar,(*nodes)[ig]);
+		}
+		else
+			values.noalias() = basis*dofs.transpose();
+	}
+
 	/// Computes 2D reference coordinates on the face of an element that shares this face corresponding to face reference points
 	/** \param[in] facepoints 1D coordinate on the face
 	 * \param[in] elem Pointer to element
@@ -436,6 +812,8 @@ class FaceElement
 	a_real getElementRefCoords(const Matrix& facepoints, const Element *const elem,
 		const int lfn, const int isright, Matrix& lpoints);
 public:
+	FaceElement() : leftbasis(&ownleftbasis), rightbasis(&ownrightbasis), leftnodes(nullptr), rightnodes(nullptr) { }
+
 	/// Sets data; computes basis function values of left and right element at each quadrature point
 	/** \note Call only after element data has been precomputed, ie, by calling the compute function on the elements, first!
 	 * \param[in] geommap The geometric mapping must be [initialized](@ref GeomMapping1D::setAll) and map and normals [computed externally](@ref GeomMapping1D::computeAll)
@@ -451,22 +829,32 @@ public:
 	void computeBasisGrads();
 
 	/// Read-only access to basis function values from left element
-	const Matrix& leftBasis() {
-		return leftbasis;
+	const Matrix& leftBasis() const {
+		return *leftbasis;
 	}
 
 	/// Read-only access to basis function values from right element
-	const Matrix& rightBasis() {
-		return rightbasis;
+	const Matrix& rightBasis() const {
+		return *rightbasis;
+	}
+
+	/// True if the left basis values are stored in a shared trace table rather than in this face
+	bool sharesLeftBasis() const {
+		return leftbasis != &ownleftbasis;
+	}
+
+	/// True if the right basis values are stored in a shared trace table rather than in this face
+	bool sharesRightBasis() const {
+		return rightbasis != &ownrightbasis;
 	}
 
 	/// Read access to left basis gradients
-	const std::vector<Matrix>& leftBasisGrad() {
+	const std::vector<Matrix>& leftBasisGrad() const {
 		return leftbgrad;
 	}
 
 	/// Read access to right basis gradients
-	const std::vector<Matrix>& rightBasisGrad() {
+	const std::vector<Matrix>& rightBasisGrad() const {
 		return rightbgrad;
 	}
 
@@ -475,7 +863,7 @@ public:
 	{
 		a_real val = 0;
 		for(int i = 0; i < leftel->getNumDOFs(); i++)
-			val += dofs[i]*leftbasis(ig,i);
+			val += dofs[i]*(*leftbasis)(ig,i);
 		return val;
 	}
 
@@ -484,16 +872,31 @@ public:
 	{
 		a_real val = 0;
 		for(int i = 0; i < rightel->getNumDOFs(); i++)
-			val += dofs[i]*rightbasis(ig,i);
+			val += dofs[i]*(*rightbasis)(ig,i);
 		return val;
 	}
 
-	void interpolateAll_left(const Matrix& __restrict__ dofs, Matrix& __restrict__ values) {
-		values.noalias() = leftbasis*dofs.transpose();
+	/// Values at the face quadrature points from the left element's DOFs; for collocated bases, these are just read
+	void interpolateAll_left(const ConstMatrixRef& dofs, Matrix& __restrict__ values) const {
+		interpolateAll(*leftbasis, leftnodes, dofs, values);
+	}
+
+	/// Values at the face quadrature points from the right element's DOFs; for collocated bases, these are just read
+	void interpolateAll_right(const ConstMatrixRef& dofs, Matrix& __restrict__ values) const {
+		interpolateAll(*rightbasis, rightnodes, dofs, values);
+	}
+
+	/// Adds factor times the integrals of fields against the left element's basis functions to term
+	/** \param[in] f Fields at the face quadrature points, including quadrature weights and face speeds (npoints x nvars)
+	 * \param[in|out] term Residual-like (nvars x ndofs) matrix of the left element
+	 */
+	void integrateAll_left(const ConstMatrixRef& f, const a_real factor, MatrixMap& term) const {
+		integrateAll(*leftbasis, leftnodes, f, factor, term);
 	}
 
-	void interpolateAll_right(const Matrix& __restrict__ dofs, Matrix& __restrict__ values) {
-		values.noalias() = rightbasis*dofs.transpose();
+	/// Adds factor times the integrals of fields against the right element's basis functions to term
+	void integrateAll_right(const ConstMatrixRef& f, const a_real factor, MatrixMap& term) const {
+		integrateAll(*rightbasis, rightnodes, f, factor, term);
 	}
 };
 
@@ -503,7 +906,7 @@ public:
  * each row has all basis function values corresponding to a given point in space (npoints x ndofs)
  * \param[in|out] interp Pre-allocated matrix for storing interpolated values (npoints x nvars)
  */
-inline void evaluateFunctions(const Matrix& __restrict__ dofs, const Matrix& __restrict__ basisv, Matrix& __restrict__ interp)
+inline void evaluateFunctions(const ConstMatrixRef& dofs, const Matrix& __restrict__ basisv, Matrix& __restrict__ interp)
 {
 	interp.noalias() = basisv * dofs.transpose();
 }
@@ -515,7 +918,7 @@ inline void evaluateFunctions(const Matrix& __restrict__ dofs, const Matrix& __r
  * \param[in|out] interp Pre-allocated set of matrices for storing interpolated values (npoints x (nvars x ndim))
  */
 template <typename T>
-inline void evaluateGradients(const Matrix& __restrict__ dofs, const std::vector<Matrix>& __restrict__ basisg, std::vector<T>& __restrict__ interp)
+inline void evaluateGradients(const ConstMatrixRef& dofs, const std::vector<Matrix>& __restrict__ basisg, std::vector<T>& __restrict__ interp)
 {
 	for(size_t ig = 0; ig < basisg.size(); ig++)
 		interp[ig].noalias() = dofs * basisg[ig];
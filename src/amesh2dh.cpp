@@ -1,5 +1,13 @@
 #include "amesh2dh.hpp"
 
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 namespace acfd {
 
 
@@ -445,10 +453,76 @@ void UMesh2dh::writeGmsh2(std::string mfile)
 	outf.close();
 }
 
-/// \todo: TODO: There is an issue with psup for some boundary nodes belonging to elements of different types. Correct this.
-void UMesh2dh::compute_topological()
+void UMesh2dh::generateRectangle(const a_real xmin, const a_real xmax, const a_real ymin, const a_real ymax, 
+		const a_int nx, const a_int ny, const Shape shape)
+{
+	const int nv = shape == QUADRANGLE ? 4 : 3;
+	ndim = 2; g_degree = 1;
+	npoin = (nx+1)*(ny+1);
+	nelem = shape == QUADRANGLE ? nx*ny : 2*nx*ny;
+	nface = 2*(nx+ny);
+	maxnnode = maxnfael = nv; maxnnofa = 2;
+	nbtag = 2; ndtag = 2;
+	isTopology = isBoundaryMaps = false;
+
+	coords.setup(npoin,ndim);
+	for(a_int j = 0; j <= ny; j++)
+		for(a_int i = 0; i <= nx; i++) {
+			coords(j*(nx+1)+i,0) = xmin + i*(xmax-xmin)/nx;
+			coords(j*(nx+1)+i,1) = ymin + j*(ymax-ymin)/ny;
+		}
+
+	nnode.assign(nelem,nv); nfael.assign(nelem,nv); nintnodel.assign(nelem,0);
+	inpoel.setup(nelem,maxnnode);
+	vol_regions.setup(nelem,ndtag);
+	a_int iel = 0;
+	for(a_int j = 0; j < ny; j++)
+		for(a_int i = 0; i < nx; i++)
+		{
+			const a_int p00 = j*(nx+1)+i, p10 = p00+1, p01 = p00+nx+1, p11 = p01+1;
+			if(shape == QUADRANGLE) {
+				inpoel(iel,0) = p00; inpoel(iel,1) = p10; inpoel(iel,2) = p11; inpoel(iel,3) = p01;
+				iel++;
+			}
+			else {
+				inpoel(iel,0) = p00; inpoel(iel,1) = p10; inpoel(iel,2) = p11;
+				iel++;
+				inpoel(iel,0) = p00; inpoel(iel,1) = p11; inpoel(iel,2) = p01;
+				iel++;
+			}
+		}
+	for(iel = 0; iel < nelem; iel++) {
+		vol_regions(iel,0) = 7; vol_regions(iel,1) = 6;
+	}
+
+	// boundary faces, counter-clockwise along the boundary
+	nnobfa.assign(nface,2);
+	bface.setup(nface, maxnnofa+nbtag);
+	a_int ib = 0;
+	for(a_int i = 0; i < nx; i++, ib++) {
+		bface(ib,0) = i; bface(ib,1) = i+1; bface(ib,2) = 2; bface(ib,3) = 1;
+	}
+	for(a_int j = 0; j < ny; j++, ib++) {
+		bface(ib,0) = j*(nx+1)+nx; bface(ib,1) = (j+1)*(nx+1)+nx; bface(ib,2) = 1; bface(ib,3) = 2;
+	}
+	for(a_int i = nx; i > 0; i--, ib++) {
+		bface(ib,0) = ny*(nx+1)+i; bface(ib,1) = ny*(nx+1)+i-1; bface(ib,2) = 2; bface(ib,3) = 3;
+	}
+	for(a_int j = ny; j > 0; j--, ib++) {
+		bface(ib,0) = j*(nx+1); bface(ib,1) = (j-1)*(nx+1); bface(ib,2) = 1; bface(ib,3) = 4;
+	}
+
+	flag_bpoin.setup(npoin,1);
+	flag_bpoin.zeros();
+	for(a_int i = 0; i < nface; i++)
+		for(int j = 0; j < nnobfa[i]; j++)
+			flag_bpoin(bface(i,j)) = 1;
+
+	std::cout << "UMesh2dh: generateRectangle(): Generated " << nelem << " elements and " << npoin << " points." << std::endl;
+}
+
+void UMesh2dh::compute_esup()
 {
-	/// 1. Elements surrounding points. Note that we only consider the vertices, not high-order points for this.
 	//std::cout << "UMesh2d: compute_topological(): Elements surrounding points\n";
 	esup_p.setup(npoin+1,1);
 	esup_p.zeros();
@@ -481,6 +555,57 @@ void UMesh2dh::compute_topological()
 		esup_p(i,0) = esup_p(i-1,0);
 	esup_p(0,0) = 0;
 	// Elements surrounding points is now done.
+}
+
+void UMesh2dh::compute_sizes()
+{
+	//first get number of bpoints
+	nbpoin = 0;
+	amat::Array2d<int > isbpflag(npoin,1);
+	isbpflag.zeros();
+	for(int i = 0; i < nface; i++)
+	{
+		for(int j = 0; j < nnobfa[i]; j++)
+			isbpflag(bface(i,j)) = 1;
+	}
+	for(int i = 0; i < npoin; i++)
+		if(isbpflag(i)==1) nbpoin++;
+		
+	// get edge sizes
+	els.resize(gnaface());
+#pragma omp parallel for default(shared)
+	for(a_int iface = 0; iface < gnaface(); iface++)
+	{
+		a_real length = std::pow(gcoords(gintfac(iface,2),0)-gcoords(gintfac(iface,3),0),2);
+		length += std::pow(gcoords(gintfac(iface,2),1)-gcoords(gintfac(iface,3),1),2);
+		els[iface] = length;
+	}
+
+	// get element diameters
+	eldiam.resize(nelem);
+#pragma omp parallel for default(shared)
+	for(int iel = 0; iel < nelem; iel++) 
+	{
+		a_real diam = 0;
+		for(int i = 0; i < nnode[iel]; i++) {
+			for(int j = i+1; j < nnode[iel]; j++) 
+			{
+				a_real dist[NDIM];
+				for(int idim = 0; idim < NDIM; idim++) 
+					dist[idim] = fabs(coords(inpoel(iel,i),idim) - coords(inpoel(iel,j),idim));
+				a_real l = dist[0]*dist[0]+dist[1]*dist[1];
+				if(diam < l) diam = l;
+			}
+		}
+		eldiam[iel] = std::sqrt(diam);
+	}
+}
+
+/// \todo: TODO: There is an issue with psup for some boundary nodes belonging to elements of different types. Correct this.
+void UMesh2dh::compute_topological()
+{
+	/// 1. Elements surrounding points. Note that we only consider the vertices, not high-order points for this.
+	compute_esup();
 
 	/// 2. Points surrounding points
 	
@@ -768,48 +893,371 @@ void UMesh2dh::compute_topological()
 		}
 	}
 
-	/// Finally, calculates bpoints.
+	/// Finally, calculates bpoints, edge lengths and element diameters.
+	compute_sizes();
 
-	//first get number of bpoints
-	nbpoin = 0;
-	amat::Array2d<int > isbpflag(npoin,1);
-	isbpflag.zeros();
-	for(int i = 0; i < nface; i++)
+	isTopology = true;
+	//std::cout << "UMesh2dh: compute_topological(): Number of boundary points = " << nbpoin << std::endl;
+}
+
+namespace {
+
+/// Marks an unused slot in the edge hash table
+const std::uint64_t EMPTY_EDGE_KEY = ~static_cast<std::uint64_t>(0);
+
+/// Open-addressing hash table of element edges, keyed by the sorted pair of vertex indices of the edge
+/** Each slot remembers the first element (and its local face number) that inserted the edge.
+ * Linear probing is used; the table is sized to a power of two at least twice the number of edge insertions,
+ * so that the load factor stays below one half.
+ */
+class EdgeHashTable
+{
+	std::vector<std::uint64_t> keys;
+	std::vector<a_int> elem;
+	std::vector<int> lface;
+	std::uint64_t mask;
+
+	static std::uint64_t mix(std::uint64_t k)
 	{
-		for(int j = 0; j < nnobfa[i]; j++)
-			isbpflag(bface(i,j)) = 1;
+		k ^= k >> 33;
+		k *= 0xff51afd7ed558ccdULL;
+		k ^= k >> 33;
+		return k;
 	}
-	for(int i = 0; i < npoin; i++)
-		if(isbpflag(i)==1) nbpoin++;
-		
-	// get edge sizes
-	els.resize(gnaface());
-	for(a_int iface = 0; iface < gnaface(); iface++)
+
+public:
+	EdgeHashTable(const a_int ninsertions)
 	{
-		a_real length = std::pow(gcoords(gintfac(iface,2),0)-gcoords(gintfac(iface,3),0),2);
-		length += std::pow(gcoords(gintfac(iface,2),1)-gcoords(gintfac(iface,3),1),2);
-		els[iface] = length;
+		std::uint64_t cap = 16;
+		while(cap < 2*static_cast<std::uint64_t>(ninsertions))
+			cap <<= 1;
+		mask = cap-1;
+		keys.assign(cap, EMPTY_EDGE_KEY);
+		elem.resize(cap);
+		lface.resize(cap);
 	}
 
-	// get element diameters
-	eldiam.resize(nelem);
-	for(int iel = 0; iel < nelem; iel++) 
+	/// Inserts the edge (a,b) of element iel, or finds it if it was already inserted by another element
+	/** \return true if the edge was found. In that case, jel and jface are set to the other element 
+	 * and the edge's local face number therein.
+	 */
+	bool insert(const a_int a, const a_int b, const a_int iel, const int iface, a_int& jel, int& jface)
 	{
-		a_real diam = 0;
-		for(int i = 0; i < nnode[iel]; i++) {
-			for(int j = i+1; j < nnode[iel]; j++) 
+		const std::uint64_t key = a < b ? 
+			(static_cast<std::uint64_t>(a) << 32) | static_cast<std::uint32_t>(b) 
+			: (static_cast<std::uint64_t>(b) << 32) | static_cast<std::uint32_t>(a);
+		std::uint64_t slot = mix(key) & mask;
+		while(keys[slot] != EMPTY_EDGE_KEY)
+		{
+			if(keys[slot] == key) {
+				jel = elem[slot];
+				jface = lface[slot];
+				return true;
+			}
+			slot = (slot+1) & mask;
+		}
+		keys[slot] = key;
+		elem[slot] = iel;
+		lface[slot] = iface;
+		return false;
+	}
+};
+
+}
+
+void UMesh2dh::compute_topological_hashed()
+{
+	/// 1. Elements surrounding points
+	compute_esup();
+
+	/** 2. Points surrounding points. The neighbours of each point are collected in the same order as 
+	 * in compute_topological(), but duplicates are detected by searching the (short) list of neighbours
+	 * found so far for the current point instead of through a global marker array, so one pass suffices.
+	 */
+	psup_p.setup(npoin+1,1);
+	psup_p(0) = 0;
+	std::vector<a_int> psupv;
+	psupv.reserve(2*esup_p(npoin));
+	for(a_int ip = 0; ip < npoin; ip++)
+	{
+		const size_t start = psupv.size();
+		for(a_int ie = esup_p(ip); ie < esup_p(ip+1); ie++)
+		{
+			const a_int ielem = esup(ie);
+			const int nf = nfael[ielem];
+			int inode = 0;
+			for(int jnode = 0; jnode < nf; jnode++)
+				if(inpoel(ielem,jnode) == ip) inode = jnode;
+
+			for(int jnode = 0; jnode < nf; jnode++)
 			{
-				a_real dist[NDIM];
-				for(int idim = 0; idim < NDIM; idim++) 
-					dist[idim] = fabs(coords(inpoel(iel,i),idim) - coords(inpoel(iel,j),idim));
-				a_real l = dist[0]*dist[0]+dist[1]*dist[1];
-				if(diam < l) diam = l;
+				// in a quadrangle, only the two vertices adjacent to ip are connected to it
+				if(jnode == inode || (nf == 4 && jnode != (inode+1)%nf && jnode != (inode+nf-1)%nf))
+					continue;
+				const a_int jpoin = inpoel(ielem,jnode);
+				bool found = false;
+				for(size_t k = start; k < psupv.size(); k++)
+					if(psupv[k] == jpoin) {
+						found = true;
+						break;
+					}
+				if(!found)
+					psupv.push_back(jpoin);
 			}
 		}
-		eldiam[iel] = std::sqrt(diam);
+		psup_p(ip+1) = psupv.size();
 	}
+	psup.setup(psupv.size(),1);
+	if(psupv.size() > 0)
+		std::copy(psupv.begin(), psupv.end(), psup.row_pointer(0));
 
-	//std::cout << "UMesh2dh: compute_topological(): Number of boundary points = " << nbpoin << std::endl;
+	/// 3. Elements surrounding elements, along with the local face number of each face in the neighbouring element
+	esuel.setup(nelem, maxnfael);
+	amat::Array2d<int> nbrlocal(nelem, maxnfael);
+	a_int nedges = 0;
+	for(a_int ie = 0; ie < nelem; ie++)
+		nedges += nfael[ie];
+
+	a_int nintfaces = 0;
+	{
+		EdgeHashTable table(nedges);
+		for(a_int ie = 0; ie < nelem; ie++)
+			for(int in = 0; in < nfael[ie]; in++)
+			{
+				a_int je; int jn;
+				esuel(ie,in) = -1;
+				if(table.insert(inpoel(ie,in), inpoel(ie,(in+1)%nfael[ie]), ie, in, je, jn))
+				{
+					esuel(ie,in) = je; nbrlocal(ie,in) = jn;
+					esuel(je,jn) = ie; nbrlocal(je,jn) = in;
+					nintfaces++;
+				}
+			}
+	}
+
+	nbface = nedges - 2*nintfaces;
+	naface = nbface + nintfaces;
+	std::cout << "UMesh2dh: compute_topological_hashed(): Number of boundary faces = " << nbface 
+		<< ", number of all faces = " << naface << std::endl;
+
+	/** 4. Faces. Boundary faces are numbered first, then interior faces, each in the order of 
+	 * the (element, local face) pair that owns them - as in compute_topological().
+	 */
+	nnofa.resize(naface);
+	intfac.setup(naface,maxnnofa+2);
+	facelocalnum.setup(naface,2);
+	elemface.setup(nelem,maxnfael);
+
+	a_int ibf = 0, iif = nbface;
+	for(a_int ie = 0; ie < nelem; ie++)
+	{
+		const int nhighperface = (nnode[ie]-nfael[ie]-nintnodel[ie])/nfael[ie];
+		for(int in = 0; in < nfael[ie]; in++)
+		{
+			const a_int je = esuel(ie,in);
+			a_int iface;
+			if(je == -1) {
+				iface = ibf++;
+				esuel(ie,in) = nelem+iface;
+				intfac(iface,1) = nelem+iface;
+				facelocalnum(iface,1) = 0;
+			}
+			else if(je > ie) {
+				iface = iif++;
+				intfac(iface,1) = je;
+				facelocalnum(iface,1) = nbrlocal(ie,in);
+				elemface(je,nbrlocal(ie,in)) = iface;
+			}
+			else
+				continue;
+
+			intfac(iface,0) = ie;
+			intfac(iface,2) = inpoel(ie,in);
+			intfac(iface,3) = inpoel(ie,(in+1)%nfael[ie]);
+			for(int i = 0; i < nhighperface; i++)
+				intfac(iface,i+4) = inpoel(ie, nfael[ie] + in*nhighperface + i);
+			nnofa[iface] = nhighperface + 2;
+			elemface(ie,in) = iface;
+			facelocalnum(iface,0) = in;
+		}
+	}
+
+	/// 5. Boundary points, edge lengths and element diameters
+	compute_sizes();
+	isTopology = true;
+}
+
+/** Elements surrounding points are computed by a counting sort in which the counting and the scattering
+ * are done by all threads using atomic updates. Since the order in which the threads scatter is not fixed, 
+ * each point's list is sorted afterwards; this gives the same ascending order as the serial fill.
+ */
+void UMesh2dh::compute_topological_parallel()
+{
+	/// 1. Elements surrounding points
+	esup_p.setup(npoin+1,1);
+	esup_p.zeros();
+#pragma omp parallel for default(shared)
+	for(a_int ie = 0; ie < nelem; ie++)
+		for(int j = 0; j < nfael[ie]; j++)
+		{
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+			esup_p(inpoel(ie,j)+1) += 1;
+		}
+	for(a_int ip = 1; ip < npoin+1; ip++)
+		esup_p(ip) += esup_p(ip-1);
+
+	esup.setup(esup_p(npoin),1);
+	{
+		std::vector<a_int> fill(npoin, 0);
+#pragma omp parallel for default(shared)
+		for(a_int ie = 0; ie < nelem; ie++)
+			for(int j = 0; j < nfael[ie]; j++)
+			{
+				const a_int ip = inpoel(ie,j);
+				a_int pos;
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+				pos = fill[ip]++;
+				esup(esup_p(ip)+pos) = ie;
+			}
+	}
+#pragma omp parallel for default(shared) schedule(dynamic,1024)
+	for(a_int ip = 0; ip < npoin; ip++)
+		if(esup_p(ip+1)-esup_p(ip) > 1)
+			std::sort(esup.row_pointer(esup_p(ip)), esup.row_pointer(esup_p(ip))+(esup_p(ip+1)-esup_p(ip)));
+
+	/// 2. Points surrounding points - one pass to count, one to fill; each point is handled independently
+	psup_p.setup(npoin+1,1);
+	psup_p(0) = 0;
+	std::vector<a_int> nbrs;
+	for(int pass = 0; pass < 2; pass++)
+	{
+#pragma omp parallel for default(shared) private(nbrs) schedule(dynamic,1024)
+		for(a_int ip = 0; ip < npoin; ip++)
+		{
+			nbrs.clear();
+			for(a_int ie = esup_p(ip); ie < esup_p(ip+1); ie++)
+			{
+				const a_int ielem = esup(ie);
+				const int nf = nfael[ielem];
+				int inode = 0;
+				for(int jnode = 0; jnode < nf; jnode++)
+					if(inpoel(ielem,jnode) == ip) inode = jnode;
+
+				for(int jnode = 0; jnode < nf; jnode++)
+				{
+					if(jnode == inode || (nf == 4 && jnode != (inode+1)%nf && jnode != (inode+nf-1)%nf))
+						continue;
+					const a_int jpoin = inpoel(ielem,jnode);
+					if(std::find(nbrs.begin(), nbrs.end(), jpoin) == nbrs.end())
+						nbrs.push_back(jpoin);
+				}
+			}
+			if(pass == 0)
+				psup_p(ip+1) = nbrs.size();
+			else if(nbrs.size() > 0)
+				std::copy(nbrs.begin(), nbrs.end(), psup.row_pointer(psup_p(ip)));
+		}
+
+		if(pass == 0) {
+			for(a_int ip = 1; ip < npoin+1; ip++)
+				psup_p(ip) += psup_p(ip-1);
+			psup.setup(psup_p(npoin) > 0 ? psup_p(npoin) : 1, 1);
+		}
+	}
+
+	/** 3. Elements surrounding elements. The neighbour across each face is the other element, among those
+	 * surrounding the first vertex of the face, which contains the same edge. Each element only writes its own rows.
+	 */
+	esuel.setup(nelem, maxnfael);
+	amat::Array2d<int> nbrlocal(nelem, maxnfael);
+	std::vector<a_int> nbfaceel(nelem+1), nifaceel(nelem+1);
+	nbfaceel[0] = nifaceel[0] = 0;
+#pragma omp parallel for default(shared)
+	for(a_int ie = 0; ie < nelem; ie++)
+	{
+		a_int nb = 0, ni = 0;
+		for(int in = 0; in < nfael[ie]; in++)
+		{
+			const a_int a = inpoel(ie,in), b = inpoel(ie,(in+1)%nfael[ie]);
+			esuel(ie,in) = -1;
+			for(a_int istor = esup_p(a); istor < esup_p(a+1) && esuel(ie,in) == -1; istor++)
+			{
+				const a_int je = esup(istor);
+				if(je == ie) continue;
+				for(int jn = 0; jn < nfael[je]; jn++)
+				{
+					const a_int c = inpoel(je,jn), d = inpoel(je,(jn+1)%nfael[je]);
+					if((c == a && d == b) || (c == b && d == a)) {
+						esuel(ie,in) = je;
+						nbrlocal(ie,in) = jn;
+						break;
+					}
+				}
+			}
+			if(esuel(ie,in) == -1) nb++;
+			else if(esuel(ie,in) > ie) ni++;
+		}
+		nbfaceel[ie+1] = nb;
+		nifaceel[ie+1] = ni;
+	}
+
+	/// 4. Faces - each element numbers the faces it owns starting from the prefix sums of the face counts
+	for(a_int ie = 0; ie < nelem; ie++) {
+		nbfaceel[ie+1] += nbfaceel[ie];
+		nifaceel[ie+1] += nifaceel[ie];
+	}
+	nbface = nbfaceel[nelem];
+	naface = nbface + nifaceel[nelem];
+	std::cout << "UMesh2dh: compute_topological_parallel(): Number of boundary faces = " << nbface 
+		<< ", number of all faces = " << naface << std::endl;
+
+	nnofa.resize(naface);
+	intfac.setup(naface,maxnnofa+2);
+	facelocalnum.setup(naface,2);
+	elemface.setup(nelem,maxnfael);
+
+#pragma omp parallel for default(shared)
+	for(a_int ie = 0; ie < nelem; ie++)
+	{
+		const int nhighperface = (nnode[ie]-nfael[ie]-nintnodel[ie])/nfael[ie];
+		a_int ibf = nbfaceel[ie], iif = nbface + nifaceel[ie];
+		for(int in = 0; in < nfael[ie]; in++)
+		{
+			const a_int je = esuel(ie,in);
+			a_int iface;
+			if(je == -1) {
+				iface = ibf++;
+				esuel(ie,in) = nelem+iface;
+				intfac(iface,1) = nelem+iface;
+				facelocalnum(iface,1) = 0;
+			}
+			else if(je > ie) {
+				iface = iif++;
+				intfac(iface,1) = je;
+				facelocalnum(iface,1) = nbrlocal(ie,in);
+				elemface(je,nbrlocal(ie,in)) = iface;
+			}
+			else
+				continue;
+
+			intfac(iface,0) = ie;
+			intfac(iface,2) = inpoel(ie,in);
+			intfac(iface,3) = inpoel(ie,(in+1)%nfael[ie]);
+			for(int i = 0; i < nhighperface; i++)
+				intfac(iface,i+4) = inpoel(ie, nfael[ie] + in*nhighperface + i);
+			nnofa[iface] = nhighperface + 2;
+			elemface(ie,in) = iface;
+			facelocalnum(iface,0) = in;
+		}
+	}
+
+	/// 5. Boundary points, edge lengths and element diameters
+	compute_sizes();
+	isTopology = true;
 }
 
 void UMesh2dh::compute_boundary_maps()
@@ -873,6 +1321,245 @@ void UMesh2dh::compute_boundary_maps()
 	}
 }
 
+void UMesh2dh::compute_boundary_maps_parallel()
+{
+	bifmap.setup(nbface,1);
+	ifbmap.setup(nbface,1);
+	bool allfound = true;
+
+#pragma omp parallel for default(shared)
+	for(a_int ibface = 0; ibface < nface; ibface++)
+	{
+		const a_int a = bface(ibface,0), b = bface(ibface,1);
+		a_int inface = -1;
+		for(a_int istor = esup_p(a); istor < esup_p(a+1) && inface == -1; istor++)
+		{
+			const a_int ie = esup(istor);
+			for(int in = 0; in < nfael[ie]; in++)
+			{
+				if(esuel(ie,in) < nelem) continue;
+				const a_int iface = elemface(ie,in);
+				if((intfac(iface,2) == a && intfac(iface,3) == b) || (intfac(iface,2) == b && intfac(iface,3) == a)) {
+					inface = iface;
+					break;
+				}
+			}
+		}
+
+		if(inface != -1) {
+			bifmap(inface) = ibface;
+			ifbmap(ibface) = inface;
+		}
+		else {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+			{
+				std::cout << "! UMesh2d: compute_boundary_maps_parallel(): ! intfac face corresponding to " << ibface << "th bface not found!!" << std::endl;
+				allfound = false;
+			}
+		}
+	}
+
+	isBoundaryMaps = true;
+	
+	intfacbtags.setup(nbface,nbtag);
+	if(!allfound)
+		return;
+#pragma omp parallel for default(shared)
+	for(a_int ibface = 0; ibface < nface; ibface++)
+	{
+		for(int j = 0; j < nbtag; j++)
+			intfacbtags(ifbmap(ibface),j) = bface(ibface,nnobfa[ibface]+j);
+	}
+}
+
+namespace {
+
+/// Index of the point (x,y) of a 2^bits x 2^bits grid along the Hilbert curve filling the grid
+std::uint64_t hilbertIndex(const int bits, std::uint32_t x, std::uint32_t y)
+{
+	std::uint64_t d = 0;
+	for(std::uint32_t s = 1U << (bits-1); s > 0; s >>= 1)
+	{
+		const std::uint32_t rx = (x & s) > 0;
+		const std::uint32_t ry = (y & s) > 0;
+		d += static_cast<std::uint64_t>(s) * s * ((3*rx) ^ ry);
+		// rotate the quadrant
+		if(ry == 0) {
+			if(rx == 1) {
+				x = s-1 - (x & (s-1));
+				y = s-1 - (y & (s-1));
+			}
+			std::swap(x,y);
+		}
+	}
+	return d;
+}
+
+}
+
+void UMesh2dh::reorder_elements(const char ordering)
+{
+	std::vector<a_int> order(nelem);
+	for(a_int iel = 0; iel < nelem; iel++)
+		order[iel] = iel;
+
+	if(ordering == 'h')
+	{
+		// centroids of vertices, scaled to a 2^16 x 2^16 grid over the bounding box
+		const int bits = 16;
+		a_real bmin[NDIM], bmax[NDIM];
+		for(int j = 0; j < NDIM; j++) {
+			bmin[j] = coords.minincol(j);
+			bmax[j] = coords.maxincol(j);
+		}
+		std::vector<std::uint64_t> keys(nelem);
+#pragma omp parallel for default(shared)
+		for(a_int iel = 0; iel < nelem; iel++)
+		{
+			std::uint32_t ic[NDIM];
+			for(int j = 0; j < NDIM; j++) {
+				a_real c = 0;
+				for(int inode = 0; inode < nfael[iel]; inode++)
+					c += coords(inpoel(iel,inode),j);
+				c /= nfael[iel];
+				const a_real frac = bmax[j] > bmin[j] ? (c-bmin[j])/(bmax[j]-bmin[j]) : 0;
+				ic[j] = static_cast<std::uint32_t>(frac*((1U << bits)-1));
+			}
+			keys[iel] = hilbertIndex(bits, ic[0], ic[1]);
+		}
+		std::stable_sort(order.begin(), order.end(), [&keys](const a_int a, const a_int b) { return keys[a] < keys[b]; });
+	}
+	else if(ordering == 'r')
+	{
+		// element adjacency graph through shared edges
+		std::vector<a_int> adj_p(nelem+1), adj;
+		{
+			a_int nedges = 0;
+			for(a_int iel = 0; iel < nelem; iel++)
+				nedges += nfael[iel];
+			EdgeHashTable table(nedges);
+			amat::Array2d<a_int> nbr(nelem,maxnfael);
+			for(a_int ie = 0; ie < nelem; ie++)
+				for(int in = 0; in < nfael[ie]; in++)
+				{
+					a_int je; int jn;
+					nbr(ie,in) = -1;
+					if(table.insert(inpoel(ie,in), inpoel(ie,(in+1)%nfael[ie]), ie, in, je, jn)) {
+						nbr(ie,in) = je;
+						nbr(je,jn) = ie;
+					}
+				}
+			adj_p[0] = 0;
+			for(a_int ie = 0; ie < nelem; ie++) {
+				adj_p[ie+1] = adj_p[ie];
+				for(int in = 0; in < nfael[ie]; in++)
+					if(nbr(ie,in) != -1) {
+						adj.push_back(nbr(ie,in));
+						adj_p[ie+1]++;
+					}
+			}
+		}
+
+		// Cuthill-McKee by breadth-first search from a minimum-degree element of each connected component,
+		// visiting the neighbours of each element in order of increasing degree
+		std::vector<a_int> byDegree(order);
+		std::stable_sort(byDegree.begin(), byDegree.end(), [&adj_p](const a_int a, const a_int b) {
+				return adj_p[a+1]-adj_p[a] < adj_p[b+1]-adj_p[b]; });
+		std::vector<char> visited(nelem, 0);
+		a_int nordered = 0;
+		std::vector<a_int> nbrs;
+		for(a_int is = 0; is < nelem; is++)
+		{
+			if(visited[byDegree[is]]) continue;
+			a_int head = nordered;
+			order[nordered++] = byDegree[is];
+			visited[byDegree[is]] = 1;
+			while(head < nordered)
+			{
+				const a_int iel = order[head++];
+				nbrs.assign(adj.begin()+adj_p[iel], adj.begin()+adj_p[iel+1]);
+				std::stable_sort(nbrs.begin(), nbrs.end(), [&adj_p](const a_int a, const a_int b) {
+						return adj_p[a+1]-adj_p[a] < adj_p[b+1]-adj_p[b]; });
+				for(size_t k = 0; k < nbrs.size(); k++)
+					if(!visited[nbrs[k]]) {
+						visited[nbrs[k]] = 1;
+						order[nordered++] = nbrs[k];
+					}
+			}
+		}
+		std::reverse(order.begin(), order.end());
+	}
+	else {
+		std::cout << "! UMesh2dh: reorder_elements(): Ordering " << ordering << " not recognized!" << std::endl;
+		return;
+	}
+
+	permute_elements(order);
+}
+
+void UMesh2dh::permute_elements(const std::vector<a_int>& order)
+{
+	if(static_cast<a_int>(order.size()) != nelem) {
+		std::cout << "! UMesh2dh: permute_elements(): Permutation has the wrong size!" << std::endl;
+		return;
+	}
+	const bool recompute = isTopology;
+	const bool recomputemaps = isBoundaryMaps;
+
+	// new point numbers in order of first reference by the renumbered elements
+	std::vector<a_int> newpoin(npoin, -1), oldpoin(npoin);
+	a_int ip = 0;
+	for(a_int iel = 0; iel < nelem; iel++)
+		for(int inode = 0; inode < nnode[order[iel]]; inode++) {
+			const a_int jp = inpoel(order[iel],inode);
+			if(newpoin[jp] == -1) {
+				oldpoin[ip] = jp;
+				newpoin[jp] = ip++;
+			}
+		}
+	// points not referenced by any element go at the end
+	for(a_int jp = 0; jp < npoin; jp++)
+		if(newpoin[jp] == -1) {
+			oldpoin[ip] = jp;
+			newpoin[jp] = ip++;
+		}
+
+	amat::Array2d<a_real> tcoords(coords);
+	amat::Array2d<int> tflag(flag_bpoin);
+	for(ip = 0; ip < npoin; ip++) {
+		for(int j = 0; j < ndim; j++)
+			coords(ip,j) = tcoords(oldpoin[ip],j);
+		flag_bpoin(ip) = tflag(oldpoin[ip]);
+	}
+
+	amat::Array2d<a_int> tinpoel(inpoel);
+	amat::Array2d<int> tvolr(vol_regions);
+	std::vector<int> tnnode(nnode), tnfael(nfael), tnintnodel(nintnodel);
+	for(a_int iel = 0; iel < nelem; iel++)
+	{
+		const a_int jel = order[iel];
+		nnode[iel] = tnnode[jel];
+		nfael[iel] = tnfael[jel];
+		nintnodel[iel] = tnintnodel[jel];
+		for(int inode = 0; inode < nnode[iel]; inode++)
+			inpoel(iel,inode) = newpoin[tinpoel(jel,inode)];
+		for(int j = 0; j < vol_regions.cols(); j++)
+			vol_regions(iel,j) = tvolr(jel,j);
+	}
+
+	for(a_int iface = 0; iface < nface; iface++)
+		for(int inode = 0; inode < nnobfa[iface]; inode++)
+			bface(iface,inode) = newpoin[bface(iface,inode)];
+
+	isTopology = isBoundaryMaps = false;
+	if(recompute)
+		compute_topological_parallel();
+	if(recomputemaps)
+		compute_boundary_maps_parallel();
+}
+
 a_real UMesh2dh::meshSizeParameter() const
 {
 	a_real hh = 0;
@@ -922,4 +1609,400 @@ void UMesh2dh::readBoundaryMapsFromFile(std::string mapfile)
 }
 
 
+/* Binary mesh files.
+ * Layout: the magic string, the version, the sizes of a_real and a_int, a reserved word, the mesh hash and the scalar sizes,
+ * followed by a sequence of arrays. Each array is stored as its number of rows and columns (as 64-bit integers)
+ * followed by its raw contents, padded to a multiple of 8 bytes. Arrays describing the mesh itself come first,
+ * then the topological data, so that a reader interested only in the latter can skip the former.
+ */
+
+namespace {
+
+/// Number of 64-bit scalars stored in the header
+const int NBINSCALARS = 13;
+
+/// Feeds raw bytes into a 64-bit FNV-1a hash
+inline void fnv1a(std::uint64_t& hash, const void *const data, const size_t nbytes)
+{
+	const unsigned char *const bytes = reinterpret_cast<const unsigned char*>(data);
+	for(size_t i = 0; i < nbytes; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+}
+
+inline void writePadding(std::ofstream& fout, const size_t nbytes)
+{
+	const char zeros[8] = {0,0,0,0,0,0,0,0};
+	if(nbytes % 8 != 0)
+		fout.write(zeros, 8 - nbytes%8);
+}
+
+template <typename T>
+void writeBinaryArray(std::ofstream& fout, const amat::Array2d<T>& a)
+{
+	std::int64_t dims[2] = {a.rows(), a.cols()};
+	fout.write(reinterpret_cast<const char*>(dims), sizeof(dims));
+	if(a.msize() > 0) {
+		fout.write(reinterpret_cast<const char*>(a.const_row_pointer(0)), a.msize()*sizeof(T));
+		writePadding(fout, a.msize()*sizeof(T));
+	}
+}
+
+template <typename T>
+void writeBinaryArray(std::ofstream& fout, const std::vector<T>& a)
+{
+	std::int64_t dims[2] = {static_cast<std::int64_t>(a.size()), 1};
+	fout.write(reinterpret_cast<const char*>(dims), sizeof(dims));
+	if(a.size() > 0) {
+		fout.write(reinterpret_cast<const char*>(a.data()), a.size()*sizeof(T));
+		writePadding(fout, a.size()*sizeof(T));
+	}
+}
+
+/// Read-only memory mapping of a binary mesh file along with a cursor into it
+class BinaryMeshFile
+{
+	const char* data;
+	size_t len;
+	size_t pos;
+	bool good;
+
+	/// Reads the dimensions of the next array and returns a pointer to its contents
+	const char* next(const size_t elsize, std::int64_t& nr, std::int64_t& nc)
+	{
+		if(!good || pos + 2*sizeof(std::int64_t) > len) {
+			good = false;
+			return nullptr;
+		}
+		std::memcpy(&nr, data+pos, sizeof(std::int64_t));
+		std::memcpy(&nc, data+pos+sizeof(std::int64_t), sizeof(std::int64_t));
+		pos += 2*sizeof(std::int64_t);
+		const size_t nbytes = nr*nc*elsize;
+		if(nr < 0 || nc < 0 || pos + nbytes > len) {
+			good = false;
+			return nullptr;
+		}
+		const char* ptr = data+pos;
+		pos += nbytes;
+		if(nbytes % 8 != 0)
+			pos += 8 - nbytes%8;
+		return ptr;
+	}
+
+public:
+	BinaryMeshFile(const std::string mfile) : data(nullptr), len(0), pos(0), good(false)
+	{
+		const int fd = open(mfile.c_str(), O_RDONLY);
+		if(fd < 0)
+			return;
+		struct stat st;
+		if(fstat(fd, &st) == 0 && st.st_size > 0) {
+			void *const addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if(addr != MAP_FAILED) {
+				data = static_cast<const char*>(addr);
+				len = st.st_size;
+				good = true;
+			}
+		}
+		close(fd);
+	}
+
+	~BinaryMeshFile()
+	{
+		if(data)
+			munmap(const_cast<char*>(data), len);
+	}
+
+	/// Whether the file was mapped and all reads so far stayed within it
+	bool isGood() const { return good; }
+
+	void readRaw(void *const dest, const size_t nbytes)
+	{
+		if(!good || pos + nbytes > len) {
+			good = false;
+			return;
+		}
+		std::memcpy(dest, data+pos, nbytes);
+		pos += nbytes;
+	}
+
+	template <typename T>
+	void read(amat::Array2d<T>& a)
+	{
+		std::int64_t nr, nc;
+		const char* ptr = next(sizeof(T), nr, nc);
+		if(ptr && nr*nc > 0) {
+			a.setup(nr,nc);
+			std::memcpy(a.row_pointer(0), ptr, nr*nc*sizeof(T));
+		}
+	}
+
+	template <typename T>
+	void read(std::vector<T>& a)
+	{
+		std::int64_t nr, nc;
+		const char* ptr = next(sizeof(T), nr, nc);
+		if(ptr) {
+			a.resize(nr*nc);
+			std::memcpy(a.data(), ptr, nr*nc*sizeof(T));
+		}
+	}
+
+	template <typename T>
+	void skip()
+	{
+		std::int64_t nr, nc;
+		next(sizeof(T), nr, nc);
+	}
+};
+
+/// Reads and checks the header of a binary mesh file
+/** \return true if the header is valid and compatible with this build
+ */
+bool readBinaryHeader(BinaryMeshFile& bf, std::uint64_t& hash, std::int64_t *const scalars, const std::string caller)
+{
+	char magic[8];
+	std::uint32_t ver[4];
+	bf.readRaw(magic, 8);
+	bf.readRaw(ver, sizeof(ver));
+	bf.readRaw(&hash, sizeof(std::uint64_t));
+	bf.readRaw(scalars, NBINSCALARS*sizeof(std::int64_t));
+	if(!bf.isGood() || std::strncmp(magic, TADGENS_MESH_MAGIC, 8) != 0) {
+		std::cout << "! UMesh2dh: " << caller << ": Not a binary mesh file!" << std::endl;
+		return false;
+	}
+	if(ver[0] != TADGENS_MESH_VERSION || ver[1] != sizeof(a_real) || ver[2] != sizeof(a_int)) {
+		std::cout << "! UMesh2dh: " << caller << ": Binary mesh file version " << ver[0] << " with real size " << ver[1]
+			<< " and integer size " << ver[2] << " is incompatible!" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+}
+
+std::uint64_t UMesh2dh::computeHash() const
+{
+	std::uint64_t hash = 14695981039346656037ULL;
+	const std::int64_t sizes[6] = {ndim, g_degree, npoin, nelem, nface, nbtag};
+	fnv1a(hash, sizes, sizeof(sizes));
+	fnv1a(hash, coords.const_row_pointer(0), coords.msize()*sizeof(a_real));
+
+	// only the valid entries of each row enter the hash; the others are uninitialized
+	for(a_int iel = 0; iel < nelem; iel++) {
+		fnv1a(hash, &nnode[iel], sizeof(int));
+		fnv1a(hash, inpoel.const_row_pointer(iel), nnode[iel]*sizeof(a_int));
+	}
+	for(a_int iface = 0; iface < nface; iface++) {
+		fnv1a(hash, &nnobfa[iface], sizeof(int));
+		fnv1a(hash, bface.const_row_pointer(iface), (nnobfa[iface]+nbtag)*sizeof(a_int));
+	}
+	return hash;
+}
+
+void UMesh2dh::writeBinary(std::string mfile) const
+{
+	if(!isTopology || !isBoundaryMaps) {
+		std::cout << "! UMesh2dh: writeBinary(): Topological data and boundary maps must be computed first!" << std::endl;
+		return;
+	}
+	std::cout << "UMesh2dh: writeBinary(): Writing binary mesh file " << mfile << std::endl;
+
+	std::ofstream fout(mfile, std::ios::binary);
+	const std::uint32_t ver[4] = {TADGENS_MESH_VERSION, sizeof(a_real), sizeof(a_int), 0};
+	const std::uint64_t hash = computeHash();
+	const std::int64_t scalars[NBINSCALARS] = {ndim, g_degree, npoin, nelem, nface, maxnnode, maxnnofa, maxnfael,
+		naface, nbface, nbpoin, nbtag, ndtag};
+	fout.write(TADGENS_MESH_MAGIC, 8);
+	fout.write(reinterpret_cast<const char*>(ver), sizeof(ver));
+	fout.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+	fout.write(reinterpret_cast<const char*>(scalars), sizeof(scalars));
+
+	// the mesh
+	writeBinaryArray(fout, coords);
+	writeBinaryArray(fout, inpoel);
+	writeBinaryArray(fout, bface);
+	writeBinaryArray(fout, vol_regions);
+	writeBinaryArray(fout, flag_bpoin);
+	writeBinaryArray(fout, nnode);
+	writeBinaryArray(fout, nintnodel);
+	writeBinaryArray(fout, nfael);
+	writeBinaryArray(fout, nnobfa);
+
+	// topological data
+	writeBinaryArray(fout, esup_p);
+	writeBinaryArray(fout, esup);
+	writeBinaryArray(fout, psup_p);
+	writeBinaryArray(fout, psup);
+	writeBinaryArray(fout, esuel);
+	writeBinaryArray(fout, intfac);
+	writeBinaryArray(fout, facelocalnum);
+	writeBinaryArray(fout, elemface);
+	writeBinaryArray(fout, nnofa);
+	writeBinaryArray(fout, els);
+	writeBinaryArray(fout, eldiam);
+	writeBinaryArray(fout, bifmap);
+	writeBinaryArray(fout, ifbmap);
+	writeBinaryArray(fout, intfacbtags);
+
+	fout.close();
+}
+
+bool UMesh2dh::readBinary(std::string mfile)
+{
+	std::cout << "UMesh2dh: readBinary(): Reading binary mesh file " << mfile << std::endl;
+	BinaryMeshFile bf(mfile);
+	if(!bf.isGood()) {
+		std::cout << "! UMesh2dh: readBinary(): Could not open " << mfile << "!" << std::endl;
+		return false;
+	}
+
+	std::uint64_t hash;
+	std::int64_t sc[NBINSCALARS];
+	if(!readBinaryHeader(bf, hash, sc, "readBinary()"))
+		return false;
+
+	// read into temporaries so that the mesh is left untouched if the file turns out to be truncated or inconsistent
+	amat::Array2d<a_real> tcoords;
+	amat::Array2d<a_int> tinpoel, tbface, tesup_p, tesup, tpsup_p, tpsup, tesuel, tintfac, tfacelocalnum, telemface,
+		tbifmap, tifbmap;
+	amat::Array2d<int> tvol_regions, tflag_bpoin, tintfacbtags;
+	std::vector<int> tnnode, tnintnodel, tnfael, tnnobfa, tnnofa;
+	std::vector<a_real> tels, teldiam;
+	bf.read(tcoords);
+	bf.read(tinpoel);
+	bf.read(tbface);
+	bf.read(tvol_regions);
+	bf.read(tflag_bpoin);
+	bf.read(tnnode);
+	bf.read(tnintnodel);
+	bf.read(tnfael);
+	bf.read(tnnobfa);
+
+	bf.read(tesup_p);
+	bf.read(tesup);
+	bf.read(tpsup_p);
+	bf.read(tpsup);
+	bf.read(tesuel);
+	bf.read(tintfac);
+	bf.read(tfacelocalnum);
+	bf.read(telemface);
+	bf.read(tnnofa);
+	bf.read(tels);
+	bf.read(teldiam);
+	bf.read(tbifmap);
+	bf.read(tifbmap);
+	bf.read(tintfacbtags);
+
+	if(!bf.isGood()) {
+		std::cout << "! UMesh2dh: readBinary(): File " << mfile << " is truncated!" << std::endl;
+		return false;
+	}
+	if(tcoords.rows() != sc[2] || tinpoel.rows() != sc[3] || tbface.rows() != sc[4] || tnnode.size() != size_t(sc[3])
+		|| tnfael.size() != size_t(sc[3]) || tesuel.rows() != sc[3] || tintfac.rows() != sc[8] || tnnofa.size() != size_t(sc[8]))
+	{
+		std::cout << "! UMesh2dh: readBinary(): Array sizes in " << mfile << " do not match its header!" << std::endl;
+		return false;
+	}
+
+	ndim = sc[0]; g_degree = sc[1]; npoin = sc[2]; nelem = sc[3]; nface = sc[4]; maxnnode = sc[5];
+	maxnnofa = sc[6]; maxnfael = sc[7]; naface = sc[8]; nbface = sc[9]; nbpoin = sc[10]; nbtag = sc[11]; ndtag = sc[12];
+	coords = tcoords; inpoel = tinpoel; bface = tbface; vol_regions = tvol_regions; flag_bpoin = tflag_bpoin;
+	nnode.swap(tnnode); nintnodel.swap(tnintnodel); nfael.swap(tnfael); nnobfa.swap(tnnobfa);
+	esup_p = tesup_p; esup = tesup; psup_p = tpsup_p; psup = tpsup; esuel = tesuel;
+	intfac = tintfac; facelocalnum = tfacelocalnum; elemface = telemface;
+	nnofa.swap(tnnofa); els.swap(tels); eldiam.swap(teldiam);
+	bifmap = tbifmap; ifbmap = tifbmap; intfacbtags = tintfacbtags;
+	isTopology = isBoundaryMaps = true;
+
+	std::cout << "UMesh2dh: readBinary(): Done. No. of points: " << npoin << ", number of elements: " << nelem 
+		<< ", number of boundary faces " << nface << ", number of all faces " << naface << std::endl;
+	return true;
+}
+
+bool UMesh2dh::readTopologyCache(std::string mfile)
+{
+	BinaryMeshFile bf(mfile);
+	if(!bf.isGood())
+		return false;
+
+	std::uint64_t hash;
+	std::int64_t sc[NBINSCALARS];
+	if(!readBinaryHeader(bf, hash, sc, "readTopologyCache()"))
+		return false;
+	if(hash != computeHash() || sc[2] != npoin || sc[3] != nelem || sc[4] != nface) {
+		std::cout << "UMesh2dh: readTopologyCache(): Cache " << mfile << " belongs to a different mesh." << std::endl;
+		return false;
+	}
+
+	bf.skip<a_real>();
+	bf.skip<a_int>();
+	bf.skip<a_int>();
+	bf.skip<int>();
+	bf.skip<int>();
+	bf.skip<int>();
+	bf.skip<int>();
+	bf.skip<int>();
+	bf.skip<int>();
+
+	// read into temporaries so that the mesh is left untouched if the file turns out to be truncated
+	amat::Array2d<a_int> tesup_p, tesup, tpsup_p, tpsup, tesuel, tintfac, tfacelocalnum, telemface, tbifmap, tifbmap;
+	amat::Array2d<int> tintfacbtags;
+	std::vector<int> tnnofa;
+	std::vector<a_real> tels, teldiam;
+	bf.read(tesup_p);
+	bf.read(tesup);
+	bf.read(tpsup_p);
+	bf.read(tpsup);
+	bf.read(tesuel);
+	bf.read(tintfac);
+	bf.read(tfacelocalnum);
+	bf.read(telemface);
+	bf.read(tnnofa);
+	bf.read(tels);
+	bf.read(teldiam);
+	bf.read(tbifmap);
+	bf.read(tifbmap);
+	bf.read(tintfacbtags);
+	if(!bf.isGood()) {
+		std::cout << "! UMesh2dh: readTopologyCache(): File " << mfile << " is truncated!" << std::endl;
+		return false;
+	}
+
+	naface = sc[8]; nbface = sc[9]; nbpoin = sc[10];
+	esup_p = tesup_p; esup = tesup; psup_p = tpsup_p; psup = tpsup; esuel = tesuel;
+	intfac = tintfac; facelocalnum = tfacelocalnum; elemface = telemface;
+	nnofa.swap(tnnofa); els.swap(tels); eldiam.swap(teldiam);
+	bifmap = tbifmap; ifbmap = tifbmap; intfacbtags = tintfacbtags;
+	isTopology = isBoundaryMaps = true;
+
+	std::cout << "UMesh2dh: readTopologyCache(): Loaded topological data from " << mfile << std::endl;
+	return true;
+}
+
+void UMesh2dh::readMeshFile(std::string mfile, bool usecache)
+{
+	if(mfile.size() > 4 && mfile.compare(mfile.size()-4, 4, ".bin") == 0) {
+		if(!readBinary(mfile))
+			std::abort();
+		return;
+	}
+
+	readGmsh2(mfile, NDIM);
+
+	// the cache is named after the mesh file, with its extension (if any) replaced by .bin
+	const std::size_t dot = mfile.find_last_of('.');
+	const std::size_t slash = mfile.find_last_of('/');
+	const bool hasext = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+	const std::string cachefile = (hasext ? mfile.substr(0,dot) : mfile) + ".bin";
+	if(usecache && readTopologyCache(cachefile))
+		return;
+	compute_topological();
+	compute_boundary_maps();
+	if(usecache)
+		writeBinary(cachefile);
+}
+
+
 } // end namespace
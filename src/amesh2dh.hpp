@@ -14,8 +14,15 @@
 #include "aarray2d.hpp"
 #endif
 
+#include <cstdint>
+
 namespace acfd {
 
+/// Identifies TaDGENS binary mesh files; the 8 bytes at the start of such a file
+#define TADGENS_MESH_MAGIC "TADGMESH"
+/// Version of the binary mesh file layout written by [writeBinary](@ref UMesh2dh::writeBinary)
+#define TADGENS_MESH_VERSION 1
+
 /// General hybrid unstructured mesh class supporting triangular and quadrangular elements
 class UMesh2dh
 {
@@ -83,8 +90,17 @@ private:
 	amat::Array2d<a_int> bifmap;				///< relates boundary faces in intfac with bface, ie, bifmap(intfac no.) = bface no.
 	amat::Array2d<a_int> ifbmap;				///< relates boundary faces in bface with intfac, ie, ifbmap(bface no.) = intfac no.
 	bool isBoundaryMaps;						///< Specifies whether bface-intfac maps have been created
+	bool isTopology;							///< Specifies whether topological data has been computed or loaded
+
+	/// Computes elements surrounding points by a counting sort
+	void compute_esup();
+
+	/// Counts boundary points and computes edge lengths and element diameters; needs intfac
+	void compute_sizes();
 
 public:
+	UMesh2dh() : isBoundaryMaps(false), isTopology(false)
+	{ }
 		
 	/* Functions to get mesh data. */
 
@@ -170,6 +186,13 @@ public:
 	void printmeshstats();
 	void writeGmsh2(std::string mfile);
 
+	/// Generates a structured mesh of a rectangle, with nx x ny quadrangles or 2 nx ny triangles
+	/** Boundary faces on the left and right sides get the marker 1, those at the bottom and top get the marker 2.
+	 * The second boundary tag is the index of the side, numbered counter-clockwise from the bottom starting at 1.
+	 */
+	void generateRectangle(const a_real xmin, const a_real xmax, const a_real ymin, const a_real ymax, 
+			const a_int nx, const a_int ny, const Shape shape);
+
 	/** Computes data structures for 
 	 * elements surrounding point (esup), 
 	 * points surrounding point (psup), 
@@ -184,12 +207,53 @@ public:
 	 */
 	void compute_topological();
 
+	/// Computes the same data as [compute_topological](@ref compute_topological), using an edge hash table
+	/** Each element edge is keyed by its sorted vertex pair in an open-addressing hash table, so that
+	 * neighbouring elements are found in a single pass over the elements. A linear sweep then numbers the faces
+	 * and fills intfac, esuel, elemface and facelocalnum. Points surrounding points are found from
+	 * elements surrounding points in one pass without the global marker array.
+	 * The result is identical to that of compute_topological() for consistently oriented meshes.
+	 */
+	void compute_topological_hashed();
+
+	/// Computes the same data as [compute_topological](@ref compute_topological) using multiple threads when OpenMP is enabled
+	/** Neighbouring elements are found by each element independently through elements surrounding points,
+	 * and faces are numbered using prefix sums of per-element face counts, so that the result is identical 
+	 * to that of the serial builders irrespective of the number of threads.
+	 */
+	void compute_topological_parallel();
+
 	/// Iterates over bfaces and finds the corresponding intfac face for each bface
 	/** Stores this data in the boundary label maps [ifbmap](@ref ifbmap) and [bifmap](@ref bifmap).
 	 * Also stores boundary markers in [intfacbtags](@ref intfacbtags).
 	 */
 	void compute_boundary_maps();
 
+	/// Computes the same data as [compute_boundary_maps](@ref compute_boundary_maps) using multiple threads when OpenMP is enabled
+	/** Each boundary face is matched with its intfac face through the elements surrounding its first vertex,
+	 * instead of by a search over all boundary faces.
+	 * \note Call only after topological data has been computed.
+	 */
+	void compute_boundary_maps_parallel();
+
+	/// Renumbers elements to improve locality of access in element and face loops
+	/** \param ordering 'h' to order elements along a Hilbert space-filling curve through their centroids, 
+	 * or 'r' for the reverse Cuthill-McKee ordering of the element adjacency graph.
+	 * See [permute_elements](@ref permute_elements) for the effect on other data.
+	 */
+	void reorder_elements(const char ordering);
+
+	/// Applies a given permutation to the elements
+	/** \param order The element to be numbered i in the new ordering is the one numbered order[i] currently.
+	 * 
+	 * Points are then renumbered in the order in which they are first referenced by the renumbered elements,
+	 * and the element and boundary-face connectivity, volume markers and per-element data are permuted accordingly.
+	 * If topological data or boundary maps had been computed, they are recomputed. Since faces are numbered 
+	 * in the order of the elements that own them, intfac ends up sorted so that consecutive faces 
+	 * touch nearby elements.
+	 */
+	void permute_elements(const std::vector<a_int>& order);
+
 	/// Computes the "mesh size" h
 	/** Call only after compute_topological() has been called.
 	 */
@@ -199,6 +263,45 @@ public:
 	void writeBoundaryMapsToFile(std::string mapfile);
 	/// Reads the boundary point maps [ifbmap](@ref ifbmap) and [bifmap](@ref bifmap) from a file
 	void readBoundaryMapsFromFile(std::string mapfile);
+
+	/// Computes a 64-bit FNV-1a hash of the mesh as read from file
+	/** Only the primary data - coordinates, element and boundary face connectivity and markers - enter the hash,
+	 * so it identifies the mesh independently of any derived connectivity.
+	 */
+	std::uint64_t computeHash() const;
+
+	/// Writes the mesh along with all topological data and boundary maps to a binary file
+	/** The file starts with a versioned header containing the [hash](@ref computeHash) of the mesh,
+	 * followed by the raw contents of each array. It can be used both as a mesh file in its own right
+	 * and as a topology cache for the mesh it was generated from.
+	 * \note Call only after compute_topological() and compute_boundary_maps().
+	 */
+	void writeBinary(std::string mfile) const;
+
+	/// Reads a mesh, its topological data and boundary maps from a binary file written by [writeBinary](@ref writeBinary)
+	/** The file is memory-mapped and the arrays are copied out directly, so there is no parsing,
+	 * and compute_topological() and compute_boundary_maps() need not be called afterwards.
+	 * \return false, without modifying the mesh, if the file cannot be opened or is invalid, truncated or inconsistent
+	 */
+	bool readBinary(std::string mfile);
+
+	/// Loads only the topological data and boundary maps from a binary mesh file, if it belongs to this mesh
+	/** The mesh itself should already have been read, eg. by readGmsh2().
+	 * \return true if the file exists and the stored hash matches that of this mesh; in that case
+	 * compute_topological() and compute_boundary_maps() need not be called. Returns false otherwise,
+	 * without modifying the mesh.
+	 */
+	bool readTopologyCache(std::string mfile);
+
+	/// Reads a mesh from a Gmsh 2 file, or from a binary file if its name ends in .bin, and sets up its topology
+	/** For a Gmsh file, if usecache is true, the topological data and boundary maps are
+	 * [loaded](@ref readTopologyCache) from the file of the same name with the extension .bin, when it
+	 * belongs to the mesh. Otherwise they are computed and, if usecache is true, written to that file
+	 * by [writeBinary](@ref writeBinary) for later runs.
+	 * Either way, compute_topological() and compute_boundary_maps() need not be called afterwards.
+	 * Aborts if a binary mesh file cannot be read.
+	 */
+	void readMeshFile(std::string mfile, bool usecache = false);
 };
 
 
@@ -7,19 +7,25 @@
 #ifndef __ANUMERICALFLUXEULER_H
 
 #ifndef __ACONSTANTS_H
-#include <aconstants.hpp>
+#include "aconstants.hpp"
 #endif
 
 #ifndef __AARRAY2D_H
-#include <aarray2d.hpp>
+#include "aarray2d.hpp"
 #endif
 
+#include <memory>
+
 #define __ANUMERICALFLUXEULER_H 1
 
 namespace acfd {
 
 /// Abstract class from which to derive all inviscid numerical flux classes
 /** The class is such that given the left and right states and a face normal, the numerical flux is computed.
+ *
+ * The concrete fluxes are final and defined inline in this file. A spatial discretization that is templated
+ * on the flux type, such as CompressibleEuler, therefore calls them without virtual dispatch and can inline them
+ * into its face loops. For run-time selection through the virtual functions, see DynamicFlux.
  */
 class InviscidNumericalFlux
 {
@@ -37,43 +43,577 @@ public:
 	 * \param[in|out] flux contains the computed flux
 	 */
 	virtual void get_flux(const a_real *const uleft, const a_real *const uright, const a_real* const n, a_real *const flux) = 0;
+
+	/** Computes fluxes at a batch of points, such as the quadrature points of a face, with
+	 * \param[in] npoin is the number of points
+	 * \param[in] uleft is the array of left states, stored as structure of arrays:
+	 *   variable ivar at point i is uleft[ivar*npoin+i], as in a row-major 4 x npoin matrix
+	 * \param[in] uright is the array of right states, stored like uleft
+	 * \param[in] n is the array of normal vectors, component idim at point i being n[idim*npoin+i]
+	 * \param[in|out] flux contains the computed fluxes, stored like uleft
+	 *
+	 * The arrays must not overlap. The loop over points has no branches, so that it is vectorised across points.
+	 */
+	virtual void get_fluxes(const int npoin, const a_real *const uleft, const a_real *const uright, const a_real *const n, 
+			a_real *const flux) = 0;
+
 	virtual ~InviscidNumericalFlux();
 };
 
 /// Local Lax-Friedrichs flux, also known as scalar dissipation
-class LocalLaxFriedrichsFlux : public InviscidNumericalFlux
+class LocalLaxFriedrichsFlux final : public InviscidNumericalFlux
 {
 public:
 	LocalLaxFriedrichsFlux(const a_real gamma);
 	void get_flux(const a_real *const ul, const a_real *const ur, const a_real* const n, a_real *const flux);
+	void get_fluxes(const int npoin, const a_real *const ul, const a_real *const ur, const a_real *const n, a_real *const flux);
 };
 
 /// Given left and right states at each face, the Van-Leer flux-vector-splitting is calculated at each face
-class VanLeerFlux : public InviscidNumericalFlux
+class VanLeerFlux final : public InviscidNumericalFlux
 {
 public:
 	VanLeerFlux(const a_real gamma);
 	void get_flux(const a_real *const ul, const a_real *const ur, const a_real* const n, a_real *const flux);
+	void get_fluxes(const int npoin, const a_real *const ul, const a_real *const ur, const a_real *const n, a_real *const flux);
 };
 
 /// Roe flux-difference splitting Riemann solver for the Euler equations
-class RoeFlux : public InviscidNumericalFlux
+class RoeFlux final : public InviscidNumericalFlux
 {
 public:
 	RoeFlux(const a_real gamma);
 	void get_flux(const a_real *const ul, const a_real *const ur, const a_real* const n, a_real *const flux);
+	void get_fluxes(const int npoin, const a_real *const ul, const a_real *const ur, const a_real *const n, a_real *const flux);
 };
 
 /// Harten Lax Van-Leer numerical flux with contact restoration by Toro
 /** From Remaki et. al., "Aerodynamic computations using FVM and HLLC".
  */
-class HLLCFlux : public InviscidNumericalFlux
+class HLLCFlux final : public InviscidNumericalFlux
 {
 public:
 	HLLCFlux(const a_real gamma);
 	void get_flux(const a_real *const ul, const a_real *const ur, const a_real* const n, a_real *const flux);
+	void get_fluxes(const int npoin, const a_real *const ul, const a_real *const ur, const a_real *const n, a_real *const flux);
+};
+
+/// Creates the numerical flux named LLF, VANLEER, ROE or HLLC; aborts for any other name
+InviscidNumericalFlux* createInviscidFlux(const std::string& name, const a_real gamma);
+
+/// Numerical flux selected at run time, called through the virtual interface of InviscidNumericalFlux
+/** This can be used in place of a concrete flux type as the template argument of a spatial discretization
+ * which is templated on the flux, when the flux should be chosen at run time (or to compare with compile-time selection).
+ */
+class DynamicFlux
+{
+	std::shared_ptr<InviscidNumericalFlux> flux;
+
+public:
+	/// Creates the flux by name, as [createInviscidFlux](@ref createInviscidFlux) does
+	DynamicFlux(const std::string& name, const a_real gamma) : flux(createInviscidFlux(name, gamma))
+	{ }
+
+	void get_flux(const a_real *const ul, const a_real *const ur, const a_real* const n, a_real *const f) {
+		flux->get_flux(ul, ur, n, f);
+	}
+
+	void get_fluxes(const int npoin, const a_real *const ul, const a_real *const ur, const a_real *const n, a_real *const f) {
+		flux->get_fluxes(npoin, ul, ur, n, f);
+	}
 };
 
+inline void LocalLaxFriedrichsFlux::get_flux(const a_real *const ul, const a_real *const ur, const a_real* const n, a_real *const flux)
+{
+	a_real pi, pj, vni, vnj, ci, cj, eig;
+
+	//calculate presures from u
+	pi = (g-1)*(ul[3] - 0.5*(pow(ul[1],2)+pow(ul[2],2))/ul[0]);
+	pj = (g-1)*(ur[3] - 0.5*(pow(ur[1],2)+pow(ur[2],2))/ur[0]);
+	//calculate speeds of sound
+	ci = sqrt(g*pi/ul[0]);
+	cj = sqrt(g*pj/ur[0]);
+	//calculate normal velocities
+	vni = (ul[1]*n[0] + ul[2]*n[1])/ul[0];
+	vnj = (ur[1]*n[0] + ur[2]*n[1])/ur[0];
+	// max eigenvalue
+	eig = fabs(vni)+ci > fabs(vnj)+cj ? fabs(vni)+ci : fabs(vnj)+cj;
+	
+	flux[0] = 0.5*( ul[0]*vni + ur[0]*vnj - eig*(ur[0]-ul[0]) );
+	flux[1] = 0.5*( vni*ul[1]+pi*n[0] + vnj*ur[1]+pj*n[0] - eig*(ur[1]-ul[1]) );
+	flux[2] = 0.5*( vni*ul[2]+pi*n[1] + vnj*ur[2]+pj*n[1] - eig*(ur[2]-ul[2]) );
+	flux[3] = 0.5*( vni*(ul[3]+pi) + vnj*(ur[3]+pj) - eig*(ur[3] - ul[3]) );
+}
+
+inline void LocalLaxFriedrichsFlux::get_fluxes(const int npoin, const a_real *const __restrict__ ul, const a_real *const __restrict__ ur, 
+		const a_real *const __restrict__ n, a_real *const __restrict__ flux)
+{
+#pragma omp simd
+	for(int i = 0; i < npoin; i++)
+	{
+		const a_real nx = n[i], ny = n[npoin+i];
+		const a_real rhoi = ul[i], mxi = ul[npoin+i], myi = ul[2*npoin+i], ei = ul[3*npoin+i];
+		const a_real rhoj = ur[i], mxj = ur[npoin+i], myj = ur[2*npoin+i], ej = ur[3*npoin+i];
+
+		const a_real pi = (g-1)*(ei - 0.5*(mxi*mxi+myi*myi)/rhoi);
+		const a_real pj = (g-1)*(ej - 0.5*(mxj*mxj+myj*myj)/rhoj);
+		const a_real ci = std::sqrt(g*pi/rhoi);
+		const a_real cj = std::sqrt(g*pj/rhoj);
+		const a_real vni = (mxi*nx + myi*ny)/rhoi;
+		const a_real vnj = (mxj*nx + myj*ny)/rhoj;
+		const a_real eigi = std::fabs(vni)+ci, eigj = std::fabs(vnj)+cj;
+		const a_real eig = eigi > eigj ? eigi : eigj;
+
+		flux[i] = 0.5*( rhoi*vni + rhoj*vnj - eig*(rhoj-rhoi) );
+		flux[npoin+i] = 0.5*( vni*mxi+pi*nx + vnj*mxj+pj*nx - eig*(mxj-mxi) );
+		flux[2*npoin+i] = 0.5*( vni*myi+pi*ny + vnj*myj+pj*ny - eig*(myj-myi) );
+		flux[3*npoin+i] = 0.5*( vni*(ei+pi) + vnj*(ej+pj) - eig*(ej-ei) );
+	}
+}
+
+inline void VanLeerFlux::get_flux(const a_real *const ul, const a_real *const ur, const a_real* const n, a_real *const flux)
+{
+	a_real nx, ny, pi, ci, vni, Mni, pj, cj, vnj, Mnj, vmags;
+	a_real fiplus[4], fjminus[4];
+
+	nx = n[0];
+	ny = n[1];
+
+	//calculate presures from u
+	pi = (g-1)*(ul[3] - 0.5*(pow(ul[1],2)+pow(ul[2],2))/ul[0]);
+	pj = (g-1)*(ur[3] - 0.5*(pow(ur[1],2)+pow(ur[2],2))/ur[0]);
+	//calculate speeds of sound
+	ci = sqrt(g*pi/ul[0]);
+	cj = sqrt(g*pj/ur[0]);
+	//calculate normal velocities
+	vni = (ul[1]*nx +ul[2]*ny)/ul[0];
+	vnj = (ur[1]*nx + ur[2]*ny)/ur[0];
+
+	//Normal mach numbers
+	Mni = vni/ci;
+	Mnj = vnj/cj;
+
+	//Calculate split fluxes
+	if(Mni < -1.0)
+		for(int i = 0; i < 4; i++)
+			fiplus[i] = 0;
+	else if(Mni > 1.0)
+	{
+		fiplus[0] = ul[0]*vni;
+		fiplus[1] = vni*ul[1] + pi*nx;
+		fiplus[2] = vni*ul[2] + pi*ny;
+		fiplus[3] = vni*(ul[3] + pi);
+	}
+	else
+	{
+		vmags = pow(ul[1]/ul[0], 2) + pow(ul[2]/ul[0], 2);	// square of velocity magnitude
+		fiplus[0] = ul[0]*ci*pow(Mni+1, 2)/4.0;
+		fiplus[1] = fiplus[0] * (ul[1]/ul[0] + nx*(2.0*ci - vni)/g);
+		fiplus[2] = fiplus[0] * (ul[2]/ul[0] + ny*(2.0*ci - vni)/g);
+		fiplus[3] = fiplus[0] * ( (vmags - vni*vni)/2.0 + pow((g-1)*vni+2*ci, 2)/(2*(g*g-1)) );
+	}
+
+	if(Mnj > 1.0)
+		for(int i = 0; i < 4; i++)
+			fjminus[i] = 0;
+	else if(Mnj < -1.0)
+	{
+		fjminus[0] = ur[0]*vnj;
+		fjminus[1] = vnj*ur[1] + pj*nx;
+		fjminus[2] = vnj*ur[2] + pj*ny;
+		fjminus[3] = vnj*(ur[3] + pj);
+	}
+	else
+	{
+		vmags = pow(ur[1]/ur[0], 2) + pow(ur[2]/ur[0], 2);	// square of velocity magnitude
+		fjminus[0] = -ur[0]*cj*pow(Mnj-1, 2)/4.0;
+		fjminus[1] = fjminus[0] * (ur[1]/ur[0] + nx*(-2.0*cj - vnj)/g);
+		fjminus[2] = fjminus[0] * (ur[2]/ur[0] + ny*(-2.0*cj - vnj)/g);
+		fjminus[3] = fjminus[0] * ( (vmags - vnj*vnj)/2.0 + pow((g-1)*vnj-2*cj, 2)/(2*(g*g-1)) );
+	}
+
+	//Update the flux vector
+	for(int i = 0; i < 4; i++)
+		flux[i] = fiplus[i] + fjminus[i];
+}
+
+/** The three regimes of each split flux are all computed, and the right one is selected per point.
+ */
+inline void VanLeerFlux::get_fluxes(const int npoin, const a_real *const __restrict__ ul, const a_real *const __restrict__ ur, 
+		const a_real *const __restrict__ n, a_real *const __restrict__ flux)
+{
+#pragma omp simd
+	for(int i = 0; i < npoin; i++)
+	{
+		const a_real nx = n[i], ny = n[npoin+i];
+		const a_real rhoi = ul[i], mxi = ul[npoin+i], myi = ul[2*npoin+i], ei = ul[3*npoin+i];
+		const a_real rhoj = ur[i], mxj = ur[npoin+i], myj = ur[2*npoin+i], ej = ur[3*npoin+i];
+
+		const a_real pi = (g-1)*(ei - 0.5*(mxi*mxi+myi*myi)/rhoi);
+		const a_real pj = (g-1)*(ej - 0.5*(mxj*mxj+myj*myj)/rhoj);
+		const a_real ci = std::sqrt(g*pi/rhoi);
+		const a_real cj = std::sqrt(g*pj/rhoj);
+		const a_real vxi = mxi/rhoi, vyi = myi/rhoi, vxj = mxj/rhoj, vyj = myj/rhoj;
+		const a_real vni = vxi*nx + vyi*ny;
+		const a_real vnj = vxj*nx + vyj*ny;
+		const a_real Mni = vni/ci;
+		const a_real Mnj = vnj/cj;
+
+		// subsonic split fluxes
+		const a_real fsi0 = rhoi*ci*(Mni+1)*(Mni+1)/4.0;
+		const a_real fsi1 = fsi0 * (vxi + nx*(2.0*ci - vni)/g);
+		const a_real fsi2 = fsi0 * (vyi + ny*(2.0*ci - vni)/g);
+		const a_real fsi3 = fsi0 * ( (vxi*vxi+vyi*vyi - vni*vni)/2.0 + ((g-1)*vni+2*ci)*((g-1)*vni+2*ci)/(2*(g*g-1)) );
+		const a_real fsj0 = -rhoj*cj*(Mnj-1)*(Mnj-1)/4.0;
+		const a_real fsj1 = fsj0 * (vxj + nx*(-2.0*cj - vnj)/g);
+		const a_real fsj2 = fsj0 * (vyj + ny*(-2.0*cj - vnj)/g);
+		const a_real fsj3 = fsj0 * ( (vxj*vxj+vyj*vyj - vnj*vnj)/2.0 + ((g-1)*vnj-2*cj)*((g-1)*vnj-2*cj)/(2*(g*g-1)) );
+
+		// select among zero, full and subsonic split fluxes
+		const a_real fp0 = Mni < -1.0 ? 0.0 : (Mni > 1.0 ? rhoi*vni : fsi0);
+		const a_real fp1 = Mni < -1.0 ? 0.0 : (Mni > 1.0 ? vni*mxi + pi*nx : fsi1);
+		const a_real fp2 = Mni < -1.0 ? 0.0 : (Mni > 1.0 ? vni*myi + pi*ny : fsi2);
+		const a_real fp3 = Mni < -1.0 ? 0.0 : (Mni > 1.0 ? vni*(ei + pi) : fsi3);
+		const a_real fm0 = Mnj > 1.0 ? 0.0 : (Mnj < -1.0 ? rhoj*vnj : fsj0);
+		const a_real fm1 = Mnj > 1.0 ? 0.0 : (Mnj < -1.0 ? vnj*mxj + pj*nx : fsj1);
+		const a_real fm2 = Mnj > 1.0 ? 0.0 : (Mnj < -1.0 ? vnj*myj + pj*ny : fsj2);
+		const a_real fm3 = Mnj > 1.0 ? 0.0 : (Mnj < -1.0 ? vnj*(ej + pj) : fsj3);
+
+		flux[i] = fp0 + fm0;
+		flux[npoin+i] = fp1 + fm1;
+		flux[2*npoin+i] = fp2 + fm2;
+		flux[3*npoin+i] = fp3 + fm3;
+	}
+}
+
+inline void RoeFlux::get_flux(const a_real *const ul, const a_real *const ur, const a_real* const n, a_real *const flux)
+{
+	a_real Hi, Hj, ci, cj, pi, pj, vxi, vxj, vyi, vyj, vmag2i, vmag2j, vni, vnj;
+	int ivar;
+
+	vxi = ul[1]/ul[0]; vyi = ul[2]/ul[0];
+	vxj = ur[1]/ur[0]; vyj = ur[2]/ur[0];
+	vni = vxi*n[0] + vyi*n[1];
+	vnj = vxj*n[0] + vyj*n[1];
+	vmag2i = vxi*vxi + vyi*vyi;
+	vmag2j = vxj*vxj + vyj*vyj;
+	// pressures
+	pi = (g-1.0)*(ul[3] - 0.5*ul[0]*vmag2i);
+	pj = (g-1.0)*(ur[3] - 0.5*ur[0]*vmag2j);
+	// speeds of sound
+	ci = sqrt(g*pi/ul[0]);
+	cj = sqrt(g*pj/ur[0]);
+	// enthalpies  ( NOT E + p/rho = u(3)/u(0) + p/u(0) )
+	Hi = g/(g-1.0)* pi/ul[0] + 0.5*vmag2i;
+	Hj = g/(g-1.0)* pj/ur[0] + 0.5*vmag2j;
+
+	// compute Roe-averages
+	
+	a_real Rij, rhoij, vxij, vyij, Hij, cij, vm2ij, vnij;
+	Rij = sqrt(ur[0]/ul[0]);
+	rhoij = Rij*ul[0];
+	vxij = (Rij*vxj + vxi)/(Rij + 1.0);
+	vyij = (Rij*vyj + vyi)/(Rij + 1.0);
+	Hij = (Rij*Hj + Hi)/(Rij + 1.0);
+	vm2ij = vxij*vxij + vyij*vyij;
+	vnij = vxij*n[0] + vyij*n[1];
+	cij = sqrt( (g-1.0)*(Hij - vm2ij*0.5) );
+
+	// eigenvalues
+	a_real l[4];
+	l[0] = vnij; l[1] = vnij; l[2] = vnij + cij; l[3] = vnij - cij;
+
+	// Harten-Hyman entropy fix
+	a_real eps = 0;
+	if(eps < l[0]-vni) eps = l[0]-vni;
+	if(eps < vnj-l[0]) eps = vnj-l[0];
+	if(fabs(l[0]) < eps) l[0] = eps;
+	if(fabs(l[1]) < eps) l[1] = eps;
+
+	eps = 0;
+	if(eps < l[2]-(vni+ci)) eps = l[2]-(vni+ci);
+	if(eps < vnj+cj - l[2]) eps = vnj+cj - l[2];
+	if(fabs(l[2]) < eps) l[2] = eps;
+
+	eps = 0;
+	if(eps < l[3] - (vni-ci)) eps = l[3] - (vni-ci);
+	if(eps < vnj-cj - l[3]) eps = vnj-cj - l[3];
+	if(fabs(l[3]) < eps) l[3] = eps;
+
+	// eigenvectors (column vectors of r below)
+	a_real r[4][4];
+	
+	// according to Dr Luo's notes
+	r[0][0] = 1.0;		r[0][1] = 0;							r[0][2] = 1.0;				r[0][3] = 1.0;
+	r[1][0] = vxij;		r[1][1] = cij*n[1];						r[1][2] = vxij + cij*n[0];	r[1][3] = vxij - cij*n[0];
+	r[2][0] = vyij;		r[2][1] = -cij*n[0];					r[2][2] = vyij + cij*n[1];	r[2][3] = vyij - cij*n[1];
+	r[3][0]= vm2ij*0.5;	r[3][1] = cij*(vxij*n[1]-vyij*n[0]);	r[3][2] = Hij + cij*vnij;	r[3][3] = Hij - cij*vnij;
+
+	// according to Fink (just a hack to make the overall flux equal the Roe flux in Fink's paper;
+	// the second eigenvector is obviously not what is given below
+	/*r(0,0) = 1.0;		r(0,2) = 1.0;				r(0,3) = 1.0;
+	r(1,0) = vxij;		r(1,2) = vxij + cij*n[0];	r(1,3) = vxij - cij*n[0];
+	r(2,0) = vyij;		r(2,2) = vyij + cij*n[1];	r(2,3) = vyij - cij*n[1];
+	r(3,0)= vm2ij*0.5;	r(3,2) = Hij + cij*vnij;	r(3,3) = Hij - cij*vnij;
+	
+	r(0,1) = 0.0;
+	r(1,1) = (vxj-vxi) - n[0]*(vnj-vni);
+	r(2,1) = (vyj-vyi) - n[1]*(vnj-vni);
+	r(3,1) = vxij*(vxj-vxi) + vyij*(vyj-vyi) - vnij*(vnj-vni);*/
+	
+	for(ivar = 0; ivar < 4; ivar++)
+	{
+		r[ivar][2] *= rhoij/(2.0*cij);
+		r[ivar][3] *= rhoij/(2.0*cij);
+	}
+
+	// R^(-1)(qR-qL)
+	a_real dw[4];
+	dw[0] = (ur[0]-ul[0]) - (pj-pi)/(cij*cij);
+	dw[1] = rhoij/cij*((vxj-vxi)*n[1] - (vyj-vyi)*n[0]);		// Dr Luo
+	//dw(1) = rhoij;										// hack for conformance with Fink
+	dw[2] = vnj-vni + (pj-pi)/(rhoij*cij);
+	dw[3] = -(vnj-vni) + (pj-pi)/(rhoij*cij);
+
+	// get one-sided flux vectors
+	a_real fi[4], fj[4];
+	fi[0] = ul[0]*vni;						fj[0] = ur[0]*vnj;
+	fi[1] = ul[0]*vni*vxi + pi*n[0];		fj[1] = ur[0]*vnj*vxj + pj*n[0];
+	fi[2] = ul[0]*vni*vyi + pi*n[1];		fj[2] = ur[0]*vnj*vyj + pj*n[1];
+	fi[3] = vni*(ul[3] + pi);				fj[3] = vnj*(ur[3] + pj);
+
+	// finally compute fluxes
+	a_real sum; int j;
+	for(ivar = 0; ivar < 4; ivar++)
+	{
+		sum = 0;
+		for(j = 0; j < 4; j++)
+			sum += fabs(l[j])*dw[j]*r[ivar][j];
+		flux[ivar] = 0.5*(fi[ivar]+fj[ivar] - sum);
+	}
+}
+
+inline void RoeFlux::get_fluxes(const int npoin, const a_real *const __restrict__ ul, const a_real *const __restrict__ ur, 
+		const a_real *const __restrict__ n, a_real *const __restrict__ flux)
+{
+#pragma omp simd
+	for(int i = 0; i < npoin; i++)
+	{
+		const a_real nx = n[i], ny = n[npoin+i];
+		const a_real rhoi = ul[i], ei = ul[3*npoin+i];
+		const a_real rhoj = ur[i], ej = ur[3*npoin+i];
+
+		const a_real vxi = ul[npoin+i]/rhoi, vyi = ul[2*npoin+i]/rhoi;
+		const a_real vxj = ur[npoin+i]/rhoj, vyj = ur[2*npoin+i]/rhoj;
+		const a_real vni = vxi*nx + vyi*ny;
+		const a_real vnj = vxj*nx + vyj*ny;
+		const a_real vmag2i = vxi*vxi + vyi*vyi;
+		const a_real vmag2j = vxj*vxj + vyj*vyj;
+		const a_real pi = (g-1.0)*(ei - 0.5*rhoi*vmag2i);
+		const a_real pj = (g-1.0)*(ej - 0.5*rhoj*vmag2j);
+		const a_real ci = std::sqrt(g*pi/rhoi);
+		const a_real cj = std::sqrt(g*pj/rhoj);
+		const a_real Hi = g/(g-1.0)* pi/rhoi + 0.5*vmag2i;
+		const a_real Hj = g/(g-1.0)* pj/rhoj + 0.5*vmag2j;
+
+		// Roe averages
+		const a_real Rij = std::sqrt(rhoj/rhoi);
+		const a_real rhoij = Rij*rhoi;
+		const a_real vxij = (Rij*vxj + vxi)/(Rij + 1.0);
+		const a_real vyij = (Rij*vyj + vyi)/(Rij + 1.0);
+		const a_real Hij = (Rij*Hj + Hi)/(Rij + 1.0);
+		const a_real vm2ij = vxij*vxij + vyij*vyij;
+		const a_real vnij = vxij*nx + vyij*ny;
+		const a_real cij = std::sqrt( (g-1.0)*(Hij - vm2ij*0.5) );
+
+		// absolute eigenvalues with the Harten-Hyman entropy fix
+		a_real eps, l0, l2, l3;
+		l0 = vnij;
+		eps = l0-vni > vnj-l0 ? l0-vni : vnj-l0;
+		eps = eps > 0 ? eps : 0;
+		l0 = std::fabs(l0) < eps ? eps : std::fabs(l0);
+
+		l2 = vnij + cij;
+		eps = l2-(vni+ci) > vnj+cj-l2 ? l2-(vni+ci) : vnj+cj-l2;
+		eps = eps > 0 ? eps : 0;
+		l2 = std::fabs(l2) < eps ? eps : std::fabs(l2);
+
+		l3 = vnij - cij;
+		eps = l3-(vni-ci) > vnj-cj-l3 ? l3-(vni-ci) : vnj-cj-l3;
+		eps = eps > 0 ? eps : 0;
+		l3 = std::fabs(l3) < eps ? eps : std::fabs(l3);
+
+		// wave strengths scaled by the absolute eigenvalues
+		const a_real dp = pj-pi, dvn = vnj-vni;
+		const a_real a0 = l0 * ((rhoj-rhoi) - dp/(cij*cij));
+		const a_real a1 = l0 * rhoij*((vxj-vxi)*ny - (vyj-vyi)*nx);
+		const a_real a2 = l2 * (dvn + dp/(rhoij*cij)) * rhoij/(2.0*cij);
+		const a_real a3 = l3 * (-dvn + dp/(rhoij*cij)) * rhoij/(2.0*cij);
+
+		flux[i] = 0.5*( rhoi*vni + rhoj*vnj - (a0 + a2 + a3) );
+		flux[npoin+i] = 0.5*( rhoi*vni*vxi + pi*nx + rhoj*vnj*vxj + pj*nx
+				- (a0*vxij + a1*ny + a2*(vxij + cij*nx) + a3*(vxij - cij*nx)) );
+		flux[2*npoin+i] = 0.5*( rhoi*vni*vyi + pi*ny + rhoj*vnj*vyj + pj*ny
+				- (a0*vyij - a1*nx + a2*(vyij + cij*ny) + a3*(vyij - cij*ny)) );
+		flux[3*npoin+i] = 0.5*( vni*(ei + pi) + vnj*(ej + pj)
+				- (a0*vm2ij*0.5 + a1*(vxij*ny-vyij*nx) + a2*(Hij + cij*vnij) + a3*(Hij - cij*vnij)) );
+	}
+}
+
+/** Currently, the estimated signal speeds are the classical estimates, not the corrected ones given by Remaki et. al.
+ */
+inline void HLLCFlux::get_flux(const a_real *const ul, const a_real *const ur, const a_real* const n, a_real *const flux)
+{
+	a_real Hi, Hj, ci, cj, pi, pj, vxi, vxj, vyi, vyj, vmag2i, vmag2j, vni, vnj, pstar;
+	a_real utemp[4];
+	int ivar;
+
+	vxi = ul[1]/ul[0]; vyi = ul[2]/ul[0];
+	vxj = ur[1]/ur[0]; vyj = ur[2]/ur[0];
+	vni = vxi*n[0] + vyi*n[1];
+	vnj = vxj*n[0] + vyj*n[1];
+	vmag2i = vxi*vxi + vyi*vyi;
+	vmag2j = vxj*vxj + vyj*vyj;
+	// pressures
+	pi = (g-1.0)*(ul[3] - 0.5*ul[0]*vmag2i);
+	pj = (g-1.0)*(ur[3] - 0.5*ur[0]*vmag2j);
+	// speeds of sound
+	ci = sqrt(g*pi/ul[0]);
+	cj = sqrt(g*pj/ur[0]);
+	// enthalpies (E + p/rho = u(3)/u(0) + p/u(0) (actually specific enthalpy := enthalpy per unit mass)
+	Hi = (ul[3] + pi)/ul[0];
+	Hj = (ur[3] + pj)/ur[0];
+
+	// compute Roe-averages
+	a_real Rij, vxij, vyij, Hij, cij, vm2ij, vnij;
+	Rij = sqrt(ur[0]/ul[0]);
+	vxij = (Rij*vxj + vxi)/(Rij + 1.0);
+	vyij = (Rij*vyj + vyi)/(Rij + 1.0);
+	Hij = (Rij*Hj + Hi)/(Rij + 1.0);
+	vm2ij = vxij*vxij + vyij*vyij;
+	vnij = vxij*n[0] + vyij*n[1];
+	cij = sqrt( (g-1.0)*(Hij - vm2ij*0.5) );
+
+	// estimate signal speeds (classical; not Remaki corrected)
+	a_real sr, sl, sm;
+	sl = vni - ci;
+	if (sl > vnij-cij)
+		sl = vnij-cij;
+	sr = vnj+cj;
+	if(sr < vnij+cij)
+		sr = vnij+cij;
+	sm = ( ur[0]*vnj*(sr-vnj) - ul[0]*vni*(sl-vni) + pi-pj ) / ( ur[0]*(sr-vnj) - ul[0]*(sl-vni) );
+
+	// compute fluxes
+	
+	if(sl > 0)
+	{
+		flux[0] = vni*ul[0];
+		flux[1] = vni*ul[1] + pi*n[0];
+		flux[2] = vni*ul[2] + pi*n[1];
+		flux[3] = vni*(ul[3] + pi);
+	}
+	else if(sl <= 0 && sm > 0)
+	{
+		flux[0] = vni*ul[0];
+		flux[1] = vni*ul[1] + pi*n[0];
+		flux[2] = vni*ul[2] + pi*n[1];
+		flux[3] = vni*(ul[3] + pi);
+
+		pstar = ul[0]*(vni-sl)*(vni-sm) + pi;
+		utemp[0] = ul[0] * (sl - vni)/(sl-sm);
+		utemp[1] = ( (sl-vni)*ul[1] + (pstar-pi)*n[0] )/(sl-sm);
+		utemp[2] = ( (sl-vni)*ul[2] + (pstar-pi)*n[1] )/(sl-sm);
+		utemp[3] = ( (sl-vni)*ul[3] - pi*vni + pstar*sm )/(sl-sm);
+
+		for(ivar = 0; ivar < 4; ivar++)
+			flux[ivar] += sl * ( utemp[ivar] - ul[ivar]);
+	}
+	else if(sm <= 0 && sr >= 0)
+	{
+		flux[0] = vnj*ur[0];
+		flux[1] = vnj*ur[1] + pj*n[0];
+		flux[2] = vnj*ur[2] + pj*n[1];
+		flux[3] = vnj*(ur[3] + pj);
+
+		pstar = ur[0]*(vnj-sr)*(vnj-sm) + pj;
+		utemp[0] = ur[0] * (sr - vnj)/(sr-sm);
+		utemp[1] = ( (sr-vnj)*ur[1] + (pstar-pj)*n[0] )/(sr-sm);
+		utemp[2] = ( (sr-vnj)*ur[2] + (pstar-pj)*n[1] )/(sr-sm);
+		utemp[3] = ( (sr-vnj)*ur[3] - pj*vnj + pstar*sm )/(sr-sm);
+
+		for(ivar = 0; ivar < 4; ivar++)
+			flux[ivar] += sr * ( utemp[ivar] - ur[ivar]);
+	}
+	else
+	{
+		flux[0] = vnj*ur[0];
+		flux[1] = vnj*ur[1] + pj*n[0];
+		flux[2] = vnj*ur[2] + pj*n[1];
+		flux[3] = vnj*(ur[3] + pj);
+	}
+}
+
+/** The fluxes of all four regions of the Riemann fan are computed, and the right one is selected per point.
+ */
+inline void HLLCFlux::get_fluxes(const int npoin, const a_real *const __restrict__ ul, const a_real *const __restrict__ ur, 
+		const a_real *const __restrict__ n, a_real *const __restrict__ flux)
+{
+#pragma omp simd
+	for(int i = 0; i < npoin; i++)
+	{
+		const a_real nx = n[i], ny = n[npoin+i];
+		const a_real rhoi = ul[i], mxi = ul[npoin+i], myi = ul[2*npoin+i], ei = ul[3*npoin+i];
+		const a_real rhoj = ur[i], mxj = ur[npoin+i], myj = ur[2*npoin+i], ej = ur[3*npoin+i];
+
+		const a_real vxi = mxi/rhoi, vyi = myi/rhoi;
+		const a_real vxj = mxj/rhoj, vyj = myj/rhoj;
+		const a_real vni = vxi*nx + vyi*ny;
+		const a_real vnj = vxj*nx + vyj*ny;
+		const a_real pi = (g-1.0)*(ei - 0.5*rhoi*(vxi*vxi + vyi*vyi));
+		const a_real pj = (g-1.0)*(ej - 0.5*rhoj*(vxj*vxj + vyj*vyj));
+		const a_real ci = std::sqrt(g*pi/rhoi);
+		const a_real cj = std::sqrt(g*pj/rhoj);
+		const a_real Hi = (ei + pi)/rhoi;
+		const a_real Hj = (ej + pj)/rhoj;
+
+		// Roe averages
+		const a_real Rij = std::sqrt(rhoj/rhoi);
+		const a_real vxij = (Rij*vxj + vxi)/(Rij + 1.0);
+		const a_real vyij = (Rij*vyj + vyi)/(Rij + 1.0);
+		const a_real Hij = (Rij*Hj + Hi)/(Rij + 1.0);
+		const a_real vnij = vxij*nx + vyij*ny;
+		const a_real cij = std::sqrt( (g-1.0)*(Hij - (vxij*vxij + vyij*vyij)*0.5) );
+
+		// signal speeds
+		const a_real sl = vni-ci < vnij-cij ? vni-ci : vnij-cij;
+		const a_real sr = vnj+cj > vnij+cij ? vnj+cj : vnij+cij;
+		const a_real sm = ( rhoj*vnj*(sr-vnj) - rhoi*vni*(sl-vni) + pi-pj ) / ( rhoj*(sr-vnj) - rhoi*(sl-vni) );
+
+		// one-sided fluxes
+		const a_real fi0 = vni*rhoi, fi1 = vni*mxi + pi*nx, fi2 = vni*myi + pi*ny, fi3 = vni*(ei + pi);
+		const a_real fj0 = vnj*rhoj, fj1 = vnj*mxj + pj*nx, fj2 = vnj*myj + pj*ny, fj3 = vnj*(ej + pj);
+
+		// fluxes from the star states
+		const a_real psi = rhoi*(vni-sl)*(vni-sm) + pi;
+		const a_real psj = rhoj*(vnj-sr)*(vnj-sm) + pj;
+		const a_real dsi = 1.0/(sl-sm), dsj = 1.0/(sr-sm);
+		const a_real fsi0 = fi0 + sl*( rhoi*(sl-vni)*dsi - rhoi );
+		const a_real fsi1 = fi1 + sl*( ((sl-vni)*mxi + (psi-pi)*nx)*dsi - mxi );
+		const a_real fsi2 = fi2 + sl*( ((sl-vni)*myi + (psi-pi)*ny)*dsi - myi );
+		const a_real fsi3 = fi3 + sl*( ((sl-vni)*ei - pi*vni + psi*sm)*dsi - ei );
+		const a_real fsj0 = fj0 + sr*( rhoj*(sr-vnj)*dsj - rhoj );
+		const a_real fsj1 = fj1 + sr*( ((sr-vnj)*mxj + (psj-pj)*nx)*dsj - mxj );
+		const a_real fsj2 = fj2 + sr*( ((sr-vnj)*myj + (psj-pj)*ny)*dsj - myj );
+		const a_real fsj3 = fj3 + sr*( ((sr-vnj)*ej - pj*vnj + psj*sm)*dsj - ej );
+
+		flux[i] = sl > 0 ? fi0 : (sm > 0 ? fsi0 : (sr >= 0 ? fsj0 : fj0));
+		flux[npoin+i] = sl > 0 ? fi1 : (sm > 0 ? fsi1 : (sr >= 0 ? fsj1 : fj1));
+		flux[2*npoin+i] = sl > 0 ? fi2 : (sm > 0 ? fsi2 : (sr >= 0 ? fsj2 : fj2));
+		flux[3*npoin+i] = sl > 0 ? fi3 : (sm > 0 ? fsi3 : (sr >= 0 ? fsj3 : fj3));
+	}
+}
+
 } // end namespace acfd
 
 #endif
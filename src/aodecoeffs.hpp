@@ -25,6 +25,19 @@ amat::Array2d<double> tvdrk3(3,3);
 tvdrk3[1][0] = 0.75;	tvdrk3[1][1] = 0.25;	tvdrk3[1][2] = 0.25;
 tvdrk3[2][0] = 0.3333333333333333; tvdrk3[2][1] = 0.6666666666666667; tvdrk3[2][2] = 0.6666666666666667;*/
 
+/* Low-storage (2N) RK schemes: for i = 1..s, dU <- a_i dU + dt L(u); u <- u + b_i dU, with a_1 = 0.
+ */
+
+/// Williamson's three-stage third-order scheme
+const double lsrk3a[3] = {0.0, -5.0/9.0, -153.0/128.0};
+const double lsrk3b[3] = {1.0/3.0, 15.0/16.0, 8.0/15.0};
+
+/// Carpenter and Kennedy's five-stage fourth-order scheme
+const double lsrk4a[5] = {0.0, -567301805773.0/1357537059087.0, -2404267990393.0/2016746695238.0,
+	-3550918686646.0/2091501179385.0, -1275806237668.0/842570457699.0};
+const double lsrk4b[5] = {1432997174477.0/9575080441755.0, 5161836677717.0/13612068292357.0,
+	1720146321549.0/2090206949498.0, 3134564353537.0/4481467310338.0, 2277821191437.0/14882151754819.0};
+
 void initializeOdeCoeffs() {
 	tvdrk1[0][0] = 1.0;	tvdrk1[0][1] = 0.0; tvdrk1[0][2] = 1.0;
 
@@ -8,298 +8,377 @@
 
 namespace acfd {
 
+/** The initial guesses are the Chebyshev points \f$ -\cos(\pi (k+3/4)/(n+1/2)) \f$, which are close enough to the roots
+ * of \f$ P_n \f$ for Newton iterations to converge to each of them. The weights are \f$ 2/((1-x^2) P'_n(x)^2) \f$.
+ */
+void getGaussLegendrePoints(const int n, Vector& points, Vector& weights)
+{
+	points.resize(n);
+	weights.resize(n);
+	for(int k = 0; k < n; k++)
+	{
+		a_real x = -std::cos(PI*(k+0.75)/(n+0.5)), dp = 1.0;
+		for(int it = 0; it < 100; it++)
+		{
+			// Legendre polynomials P_{n-1} and P_n at x, and the derivative of P_n
+			a_real pm = 0.0, pn = 1.0;
+			for(int j = 1; j <= n; j++) {
+				const a_real pj = ((2*j-1)*x*pn - (j-1)*pm)/j;
+				pm = pn;
+				pn = pj;
+			}
+			dp = n*(x*pn - pm)/(x*x-1.0);
+			const a_real dx = pn/dp;
+			x -= dx;
+			if(std::fabs(dx) < ZERO_TOL)
+				break;
+		}
+		points(k) = x;
+		weights(k) = 2.0/((1.0-x*x)*dp*dp);
+	}
+}
+
 /** Note that Gauss-Legendre quadrature (1D) with n quadrature points integrates
  * polynomials upto degree 2n-1 exactly.
  */
 void Quadrature1D::initialize(const int n_poly)
 {
-	using std::sqrt;
-	amat::Array2d<a_real> gptemp;
-
 	nPoly = n_poly;
 	shape = LINE;
+	ngauss = std::max((n_poly+2)/2, 1);
 
-	if(nPoly <= 1) {
-		ngauss = 1;
-		gweights.resize(ngauss,1);
-		gptemp.resize(ngauss,1);
-		ggpoints.resize(ngauss,1);
-		gptemp(0) = 0.0;
-		gweights(0) = 2.0;
-	}
-	else if(nPoly <= 3){
-		ngauss = 2;
-		gweights.resize(ngauss,1);
-		gptemp.resize(ngauss,1);
-		ggpoints.resize(ngauss,1);
-		gptemp(0) = -1.0/sqrt(3); gptemp(1) = 1.0/sqrt(3);
-		gweights(0) = 1.0; gweights(1) = 1.0;
-	}
-	else if(nPoly <= 5) {
-		ngauss = 3;
-		gweights.resize(ngauss,1);
-		gptemp.resize(ngauss,1);
-		ggpoints.resize(ngauss,1);
-		gptemp(0) = -sqrt(3.0/5.0); gptemp(1) = 0.0; gptemp(2) = sqrt(3.0/5.0);
-		gweights(0) = 5.0/9.0;  gweights(1) = 8.0/9.0, gweights(2) = 5.0/9.0;
-	}
-	else if(nPoly <= 7) {
-		ngauss = 4;
-		gweights.resize(ngauss,1);
-		gptemp.resize(ngauss,1);
-		ggpoints.resize(ngauss,1);
-		gptemp(0) = -sqrt(3.0/7 + 2.0/7*sqrt(6.0/5)); gptemp(1) = -sqrt(3.0/7 - 2.0/7*sqrt(6.0/5));
-		gptemp(2) = sqrt(3.0/7 + 2.0/7*sqrt(6.0/5)); gptemp(3) = sqrt(3.0/7 + 2.0/7*sqrt(6.0/5));
-		gweights(0) = (18.0-sqrt(30))/36.0; gweights(1) = (18.0+sqrt(30))/36.0;
-		gweights(2) = (18.0+sqrt(30))/36.0; gweights(3) = (18.0-sqrt(30))/36.0;
-	}
-	else if(nPoly <= 9) {
-		ngauss = 5;
-		gweights.resize(ngauss,1);
-		gptemp.resize(ngauss,1);
-		ggpoints.resize(ngauss,1);
-		gptemp(0) = -1.0/3*sqrt(5.0 + 2.0*sqrt(10.0/7)); gptemp(1) = -1.0/3*sqrt(5.0 - 2.0*sqrt(10.0/7));
-		gptemp(2) = 0.0;
-		gptemp(3) = 1.0/3*sqrt(5.0 - 2.0*sqrt(10.0/7)); gptemp(4) = 1.0/3*sqrt(5.0 + 2.0*sqrt(10.0/7));
-		gweights(0) = (322.0-13*sqrt(70.0))/900; gweights(1) = (322.0+13*sqrt(70.0))/900;
-		gweights(2) = 128.0/225;
-		gweights(3) = (322.0+13*sqrt(70.0))/900; gweights(4) = (322.0-13*sqrt(70.0))/900;
-	}
-	else {
-		nPoly = 15;
-		ngauss = 8;
-		gweights.resize(ngauss,1);
-		gptemp.resize(ngauss,1);
-		ggpoints.resize(ngauss,1);
-		printf("! Quadrature1D: Quadrature with this strength is not supported! Setting to 15.\n");
-		
-		a_real gp[][1] = {{-0.960289856497536231684},
-							{-0.796666477413626739592},
-							{-0.525532409916328985818},
-							{-0.183434642495649804939},
-							{0.183434642495649804939},
-							{0.525532409916328985818},
-							{0.796666477413626739592},
-							{0.960289856497536231684}};
-
-		a_real gw[][1] = {{0.10122853629037625915},
-		                  {0.22238103445337447054},
-		                  {0.31370664587788728733},
-		                  {0.36268378337836198296},
-		                  {0.36268378337836198296},
-		                  {0.31370664587788728733},
-		                  {0.22238103445337447054},
-		                  {0.10122853629037625915}};
-		gptemp.initialize(ngauss, 1, (a_real*)gp);
-		gweights.initialize(ngauss, 1, (a_real*)gw);
+	Vector pts, wts;
+	getGaussLegendrePoints(ngauss, pts, wts);
+	gweights.resize(ngauss,1);
+	ggpoints.resize(ngauss,1);
+	for(int i = 0; i < ngauss; i++) {
+		ggpoints(i,0) = pts(i);
+		gweights(i) = wts(i);
 	}
-
-	for(int i = 0; i < ggpoints.rows(); i++)
-		ggpoints(i,0) = gptemp(i,0);
 }
 
 void Quadrature2DSquare::initialize(const int n_poly)
 {
-	using std::sqrt;
-	amat::Array2d<a_real> gptemp;
-	amat::Array2d<a_real> gwtemp;
-
 	nPoly = n_poly;
 	shape = QUADRANGLE;
-	int ngaussdim;
+	const int ngaussdim = std::max((n_poly+2)/2, 1);
+	ngauss = ngaussdim*ngaussdim;
 
-	if(nPoly <= 1) {
-		ngaussdim = 1;
-		ngauss = 1;
-		a_real gp[] = {0.0};
-		a_real gw[] = {2.0};
-		gptemp.initialize(ngaussdim, 1, gp);
-		gwtemp.initialize(ngaussdim, 1, gw);
-	}
-	else if(nPoly <= 3){
-		ngaussdim = 2;
-		ngauss = 4;
-		a_real gp[] = {-1.0/sqrt(3), 1.0/sqrt(3) };
-		a_real gw[] = { 1.0, 1.0 };
-		gptemp.initialize(ngaussdim, 1, gp);
-		gwtemp.initialize(ngaussdim, 1, gw);
-	}
-	else if(nPoly <= 5) {
-		ngaussdim = 3;
-		ngauss = 9;
-		a_real gp[] = { -sqrt(3.0/5.0), 0.0, sqrt(3.0/5.0) };
-		a_real gw[] = { 5.0/9.0, 8.0/9.0, 5.0/9.0 };
-		gptemp.initialize(ngaussdim, 1, gp);
-		gwtemp.initialize(ngaussdim, 1, gw);
-	}
-	else if(nPoly <= 7) {
-		ngaussdim = 4;
-		ngauss = 16;
-		a_real gp[] = {-sqrt(3.0/7 + 2.0/7*sqrt(6.0/5)), -sqrt(3.0/7 - 2.0/7*sqrt(6.0/5)),
-		               sqrt(3.0/7 + 2.0/7*sqrt(6.0/5)), sqrt(3.0/7 + 2.0/7*sqrt(6.0/5)) };
-		a_real gw[] = { (18.0-sqrt(30))/36.0, (18.0+sqrt(30))/36.0,
-		                (18.0+sqrt(30))/36.0, (18.0-sqrt(30))/36.0 };
-		gptemp.initialize(ngaussdim, 1, gp);
-		gwtemp.initialize(ngaussdim, 1, gw);
-	}
-	else if(nPoly <= 9) {
-		ngaussdim = 5;
-		ngauss = 25;
-		a_real gp[] = { -1.0/3*sqrt(5.0 + 2.0*sqrt(10.0/7)), -1.0/3*sqrt(5.0 - 2.0*sqrt(10.0/7)), 0.0,
-		                1.0/3*sqrt(5.0 - 2.0*sqrt(10.0/7)), 1.0/3*sqrt(5.0 + 2.0*sqrt(10.0/7)) };
-		a_real gw[] = {(322.0-13*sqrt(70.0))/900, (322.0+13*sqrt(70.0))/900, 128.0/225,
-		               (322.0+13*sqrt(70.0))/900, (322.0-13*sqrt(70.0))/900 };
-		gptemp.initialize(ngaussdim, 1, gp);
-		gwtemp.initialize(ngaussdim, 1, gw);
+	Vector pts, wts;
+	getGaussLegendrePoints(ngaussdim, pts, wts);
+	gweights.resize(ngauss,1);
+	ggpoints.resize(ngauss,2);
+	for(int i = 0; i < ngaussdim; i++)
+		for(int j = 0; j < ngaussdim; j++) {
+			ggpoints(i*ngaussdim+j,0) = pts(i);
+			ggpoints(i*ngaussdim+j,1) = pts(j);
+			gweights(i*ngaussdim+j) = wts(i)*wts(j);
+		}
+}
+
+/** The initial guesses are the Chebyshev-Gauss-Lobatto points. With N = n-1, the Newton update for the
+ * interior points is \f$ x \leftarrow x - (x P_N - P_{N-1})/(n P_N) \f$, which leaves the end points unchanged.
+ * The weights are \f$ 2/(N n P_N(x)^2) \f$.
+ */
+void getGaussLobattoPoints(const int n, Vector& points, Vector& weights)
+{
+	const int N = n-1;
+	points.resize(n);
+	weights.resize(n);
+	for(int k = 0; k < n; k++)
+	{
+		a_real x = -std::cos(PI*k/N), pn = 1.0;
+		for(int it = 0; it < 100; it++)
+		{
+			// Legendre polynomials P_{N-1} and P_N at x
+			a_real pm = 1.0;
+			pn = x;
+			for(int j = 2; j <= N; j++) {
+				const a_real pj = ((2*j-1)*x*pn - (j-1)*pm)/j;
+				pm = pn;
+				pn = pj;
+			}
+			const a_real dx = (x*pn - pm)/(n*pn);
+			x -= dx;
+			if(std::fabs(dx) < ZERO_TOL)
+				break;
+		}
+		// P_N at the converged point
+		a_real pm = 1.0;
+		pn = x;
+		for(int j = 2; j <= N; j++) {
+			const a_real pj = ((2*j-1)*x*pn - (j-1)*pm)/j;
+			pm = pn;
+			pn = pj;
+		}
+		points(k) = x;
+		weights(k) = 2.0/(N*n*pn*pn);
 	}
-	else {
-		nPoly = 15;
-		ngaussdim = 8;
-		ngauss = 64;
-		printf("! Quadrature1D: Quadrature with this strength is not supported! Setting to 15th degree polynomial.\n");
-		
-		a_real gp[] =      {-0.960289856497536231684,
-							-0.796666477413626739592,
-							-0.525532409916328985818,
-							-0.183434642495649804939,
-							0.183434642495649804939,
-							0.525532409916328985818,
-							0.796666477413626739592,
-							0.960289856497536231684};
+}
+
+void Quadrature1DLobatto::initialize(const int n_poly)
+{
+	nPoly = n_poly;
+	shape = LINE;
+	ngauss = std::max((n_poly+4)/2, 2);
 
-		a_real gw[] =    {0.10122853629037625915,
-		                  0.22238103445337447054,
-		                  0.31370664587788728733,
-		                  0.36268378337836198296,
-		                  0.36268378337836198296,
-		                  0.31370664587788728733,
-		                  0.22238103445337447054,
-		                  0.10122853629037625915};
-		gptemp.initialize(ngaussdim, 1, gp);
-		gwtemp.initialize(ngaussdim, 1, gw);
+	Vector pts, wts;
+	getGaussLobattoPoints(ngauss, pts, wts);
+	gweights.resize(ngauss,1);
+	ggpoints.resize(ngauss,1);
+	for(int i = 0; i < ngauss; i++) {
+		ggpoints(i,0) = pts(i);
+		gweights(i) = wts(i);
 	}
+}
 
+void Quadrature2DSquareLobatto::initialize(const int n_poly)
+{
+	nPoly = n_poly;
+	shape = QUADRANGLE;
+	const int ngaussdim = std::max((n_poly+4)/2, 2);
+	ngauss = ngaussdim*ngaussdim;
+
+	Vector pts, wts;
+	getGaussLobattoPoints(ngaussdim, pts, wts);
 	gweights.resize(ngauss,1);
 	ggpoints.resize(ngauss,2);
 	for(int i = 0; i < ngaussdim; i++)
-	{
-		for(int j = 0; j < ngaussdim; j++){
-			ggpoints(i*ngaussdim+j,0) = gptemp(i);
-			ggpoints(i*ngaussdim+j,1) = gptemp(j);
-			gweights(i*ngaussdim+j) = gwtemp(i)*gwtemp(j);
+		for(int j = 0; j < ngaussdim; j++) {
+			ggpoints(i*ngaussdim+j,0) = pts(i);
+			ggpoints(i*ngaussdim+j,1) = pts(j);
+			gweights(i*ngaussdim+j) = wts(i)*wts(j);
 		}
-	}
 }
 
+/// A set of points of a triangle rule that is invariant under permutations of the barycentric coordinates
+/** The points have barycentric coordinates (a, b, 1-a-b) and their permutations, and the same weight.
+ * An orbit of 1 point is the centroid, one of 3 points has a = b, and one of 6 points has distinct coordinates.
+ */
+struct TriangleOrbit
+{
+	int npoints;
+	a_real a;
+	a_real b;
+	a_real weight;
+};
+
+/* Fully symmetric rules with positive weights and all points inside the triangle, with the fewest points known
+ * for such rules. The weights add up to 1/2, the area of the reference triangle. The data were computed by
+ * solving the moment equations for each arrangement of orbits, starting from random guesses.
+ * The rule of strength s is triangleOrbits[triangleRuleStart[s-1]] to triangleOrbits[triangleRuleStart[s]-1];
+ * there is none of strength 3.
+ */
+static const TriangleOrbit triangleOrbits[] = {
+	// strength 1, 1 point
+	{1, 1.0/3, 1.0/3, 0.5},
+	// strength 2, 3 points
+	{3, 0.16666666666666666, 0.16666666666666666, 0.16666666666666666},
+	// strength 4, 6 points
+	{3, 0.44594849091596489, 0.44594849091596489, 0.11169079483900574},
+	{3, 0.091576213509770743, 0.091576213509770743, 0.054975871827660935},
+	// strength 5, 7 points
+	{1, 1.0/3, 1.0/3, 0.1125},
+	{3, 0.10128650732345634, 0.10128650732345634, 0.06296959027241357},
+	{3, 0.47014206410511511, 0.47014206410511511, 0.066197076394253096},
+	// strength 6, 12 points
+	{3, 0.24928674517091043, 0.24928674517091043, 0.058393137863189684},
+	{3, 0.063089014491502227, 0.063089014491502227, 0.025422453185103409},
+	{6, 0.053145049844816945, 0.31035245103378439, 0.041425537809186785},
+	// strength 7, 15 points
+	{3, 0.24325913983560754, 0.24325913983560754, 0.062696803724651529},
+	{6, 0.086636631341748996, 0.86764253881193065, 0.013831762300736714},
+	{6, 0.050714384307207046, 0.63064142584525595, 0.038153169170270854},
+	// strength 8, 16 points
+	{1, 1.0/3, 1.0/3, 0.072157803838893586},
+	{3, 0.45929258829272318, 0.45929258829272318, 0.04754581713364231},
+	{3, 0.050547228317030977, 0.050547228317030977, 0.01622924881159904},
+	{3, 0.17056930775176021, 0.17056930775176021, 0.051608685267359122},
+	{6, 0.26311282963463811, 0.72849239295540424, 0.013615157087217496},
+	// strength 9, 19 points
+	{1, 1.0/3, 1.0/3, 0.048567898141399418},
+	{3, 0.48968251919873762, 0.48968251919873762, 0.015667350113569536},
+	{3, 0.43708959149293664, 0.43708959149293664, 0.038913770502387139},
+	{3, 0.044729513394452712, 0.044729513394452712, 0.012788837829349016},
+	{3, 0.18820353561903272, 0.18820353561903272, 0.039823869463605124},
+	{6, 0.036838412054736286, 0.22196298916076571, 0.021641769688644688},
+	// strength 10, 25 points
+	{1, 1.0/3, 1.0/3, 0.039947252370619857},
+	{3, 0.023308867510000192, 0.023308867510000192, 0.0041119093452320976},
+	{3, 0.42508621060209056, 0.42508621060209056, 0.03556190111618867},
+	{6, 0.029946031954170886, 0.35874014186443148, 0.018679928117152637},
+	{6, 0.22376697357697301, 0.14792562620953445, 0.022715296148085009},
+	{6, 0.035632559587503485, 0.14329537042686716, 0.015443328442281995},
+	// strength 11, 28 points
+	{1, 1.0/3, 1.0/3, 0.040944272149411147},
+	{3, 0.21412791552263391, 0.21412791552263391, 0.03404448325616441},
+	{3, 0.43690338300819936, 0.43690338300819936, 0.031769172706897233},
+	{3, 0.11237977417479204, 0.11237977417479204, 0.019988097891970796},
+	{3, 0.030685041499291812, 0.030685041499291812, 0.0060589144999950743},
+	{3, 0.49844787097242826, 0.49844787097242826, 0.0064379979320237576},
+	{6, 0.82757748034951828, 0.013884670568304591, 0.0071018533880368691},
+	{6, 0.64379734689743728, 0.047526198458968508, 0.020258101443535639},
+	// strength 12, 33 points
+	{3, 0.48821738977380486, 0.48821738977380486, 0.012865533220227668},
+	{3, 0.021317350453210371, 0.021317350453210371, 0.0030831305257795088},
+	{3, 0.27121038501211592, 0.27121038501211592, 0.031429112108942552},
+	{3, 0.12757614554158592, 0.12757614554158592, 0.017398056465354472},
+	{3, 0.43972439229446025, 0.43972439229446025, 0.021846272269019203},
+	{6, 0.60894323577978782, 0.27571326968551418, 0.020185778883190463},
+	{6, 0.6958360867878034, 0.28132558098993954, 0.011178386601151722},
+	{6, 0.02573405054833023, 0.11625191590759715, 0.0086581155543294461},
+	// strength 13, 37 points
+	{1, 1.0/3, 1.0/3, 0.03398001829341582},
+	{3, 0.42694141425980042, 0.42694141425980042, 0.027800983765226665},
+	{3, 0.021509681108843184, 0.021509681108843184, 0.0030261685517695858},
+	{3, 0.48907694645253935, 0.48907694645253935, 0.011997200964447365},
+	{3, 0.22137228629183289, 0.22137228629183289, 0.029139242559599991},
+	{6, 0.62354599555367562, 0.30844176089211778, 0.017320638070424187},
+	{6, 0.27251581777342965, 0.0051263891023823685, 0.0047953405017716316},
+	{6, 0.02437018690109383, 0.11092204280346339, 0.0074827005525828338},
+	{6, 0.74850711589995222, 0.16359740106785048, 0.01208951990579691},
+	// strength 14, 42 points
+	{3, 0.17720553241254344, 0.17720553241254344, 0.021081294368496508},
+	{3, 0.48896391036217862, 0.48896391036217862, 0.010941790684714445},
+	{3, 0.41764471934045394, 0.41764471934045394, 0.016394176772062674},
+	{3, 0.27347752830883865, 0.27347752830883865, 0.025887052253645793},
+	{3, 0.019390961248701048, 0.019390961248701048, 0.0024617018012000409},
+	{3, 0.061799883090872601, 0.061799883090872601, 0.0072168498348883338},
+	{6, 0.87975717137017118, 0.11897449769695685, 0.002505114419250336},
+	{6, 0.77060855477499646, 0.17226668782135557, 0.012332876606281837},
+	{6, 0.01464695005565441, 0.68698016780808779, 0.0072181540567669202},
+	{6, 0.57022229084668319, 0.33686145979634502, 0.019285755393530342},
+	// strength 15, 49 points
+	{1, 1.0/3, 1.0/3, 0.024777380743035579},
+	{3, 0.49250168823249668, 0.49250168823249668, 0.0067052581900064146},
+	{3, 0.40886316907744108, 0.40886316907744108, 0.019011381726930579},
+	{3, 0.079031013655541632, 0.079031013655541632, 0.0092433943023307735},
+	{3, 0.018789501810770076, 0.018789501810770076, 0.0022485768962175402},
+	{6, 0.09876591135571211, 0.20250549804829998, 0.015087322572773133},
+	{6, 0.53877851064220139, 0.26709528567005225, 0.01460544538747189},
+	{6, 0.012563596287784997, 0.092290158424266175, 0.0032209366452594663},
+	{6, 0.36883948374857539, 0.077663767064308165, 0.015630213780078804},
+	{6, 0.32515745241110783, 0.015082654870922784, 0.0058747373242569699},
+	{6, 0.7834502256732081, 0.19495514589281163, 0.0061808086085778204},
+	// strength 16, 55 points
+	{1, 1.0/3, 1.0/3, 0.023058769666595848},
+	{3, 0.4539993753017012, 0.4539993753017012, 0.003677989461939563},
+	{3, 0.0067097451719645559, 0.0067097451719645559, 0.00053688824809664003},
+	{3, 0.18211790655504143, 0.18211790655504143, 0.015573572058770734},
+	{3, 0.49209685422873467, 0.49209685422873467, 0.0070871651370723399},
+	{6, 0.22533886297513769, 0.079240111325690782, 0.011941400158349892},
+	{6, 0.66443854063042995, 0.01533833739211783, 0.0064382186684264495},
+	{6, 0.06157495992373186, 0.016162562842922227, 0.0034018354312568499},
+	{6, 0.37121334632593439, 0.078902605353667443, 0.012771489970983688},
+	{6, 0.485318991359865, 0.19050785078371715, 0.020153064514672334},
+	{6, 0.81406304740052382, 0.015254311741389649, 0.00511976822843374},
+	{6, 0.072724735634509777, 0.8166311728594865, 0.0062266206305047677},
+	// strength 17, 60 points
+	{3, 0.49299908483602467, 0.49299908483602467, 0.0056073658149686876},
+	{3, 0.1697094309673049, 0.1697094309673049, 0.011686229433458446},
+	{3, 0.46460596554534145, 0.46460596554534145, 0.01220306563975489},
+	{3, 0.070311169611369517, 0.070311169611369517, 0.0063088442890766715},
+	{3, 0.28661252432964462, 0.28661252432964462, 0.018322496686893765},
+	{3, 0.41719510152416933, 0.41719510152416933, 0.014832558373524605},
+	{6, 0.08572497056489245, 0.013708002381358338, 0.0031787234787635853},
+	{6, 0.021090996331740275, 0.9667653870032098, 0.00090175235488273151},
+	{6, 0.17146140925303924, 0.7548391496584721, 0.0097686462777542837},
+	{6, 0.62210563112878803, 0.31052672399296177, 0.011316499589856584},
+	{6, 0.19636670248163562, 0.014372542103585186, 0.0047084221014235261},
+	{6, 0.5516996683728429, 0.28706486657252928, 0.014027347017618227},
+	{6, 0.012764128457657434, 0.33817448834951042, 0.0049516623941958616},
+	// strength 18, 67 points
+	{1, 1.0/3, 1.0/3, 0.015374260619557928},
+	{3, 0.47491821132404571, 0.47491821132404571, 0.0065535137458693779},
+	{3, 0.072438705567332867, 0.072438705567332867, 0.0068951433023834692},
+	{3, 0.15163850697260486, 0.15163850697260486, 0.010159169422729198},
+	{3, 0.003758944341068346, 0.003758944341068346, 0.00026600280847389026},
+	{3, 0.26561460990537422, 0.26561460990537422, 0.015558198301003065},
+	{3, 0.41106710187591949, 0.41106710187591949, 0.016735997029923948},
+	{6, 0.012498932483495441, 0.047276141832651782, 0.0021087583873722216},
+	{6, 0.75539841640570893, 0.17847912556588763, 0.0084558269587400401},
+	{6, 0.14906691012577383, 0.58235978347821227, 0.01379644324428974},
+	{6, 0.010505018819241936, 0.25650615977424152, 0.0038649176400031137},
+	{6, 0.38504403441316365, 0.090427040354340613, 0.00766412909727657},
+	{6, 0.13277883027138934, 0.85288964494966868, 0.0038208524863598179},
+	{6, 0.30206195771287081, 0.054011735339024237, 0.0081829542069932829},
+	{6, 0.57724250665071453, 0.41106566867461836, 0.0047930622371807523},
+	// strength 19, 73 points
+	{1, 1.0/3, 1.0/3, 0.010335871991637626},
+	{3, 0.49417753608933451, 0.49417753608933451, 0.0046415138201604941},
+	{3, 0.45758482403378736, 0.45758482403378736, 0.0095672250090680384},
+	{3, 0.040066748098113891, 0.040066748098113891, 0.0034098384596870819},
+	{3, 0.27708477199827281, 0.27708477199827281, 0.013230299476702966},
+	{3, 0.21809783356084228, 0.21809783356084228, 0.010816343676809431},
+	{3, 0.40716646693397801, 0.40716646693397801, 0.015132462483465383},
+	{6, 0.78541181255157544, 0.2020790656372361, 0.0038038430029404247},
+	{6, 0.57431533356889419, 0.3787041597841474, 0.0072104210372762956},
+	{6, 0.024842665241433446, 0.0024881810816972244, 0.00061185672397282888},
+	{6, 0.69349931098770756, 0.25015401571134654, 0.0078430981653974385},
+	{6, 0.059736047833849337, 0.12359675018429322, 0.0068940068285102997},
+	{6, 0.0086518438729730716, 0.3376591947099809, 0.0034112072381356504},
+	{6, 0.12216758014618243, 0.69480890838596632, 0.0082917069790929276},
+	{6, 0.096951686402602488, 0.89269363528580903, 0.0023979242910336638},
+	{6, 0.30915874857708614, 0.13136914898078492, 0.012747782272087501},
+	// strength 20, 79 points
+	{1, 1.0/3, 1.0/3, 0.001999689449878684},
+	{3, 0.4910287328831523, 0.4910287328831523, 0.0035171034690755923},
+	{3, 0.46651186450882759, 0.46651186450882759, 0.0091638780121437238},
+	{3, 0.37588647216014281, 0.37588647216014281, 0.015484063914929397},
+	{3, 0.11281929816630953, 0.11281929816630953, 0.0077507315830413516},
+	{3, 0.17107305294503095, 0.17107305294503095, 0.0077473230109234162},
+	{3, 0.24394447497064978, 0.24394447497064978, 0.015122495429188473},
+	{3, 0.033214661470459199, 0.033214661470459199, 0.0019024598163184441},
+	{3, 0.0098828346121804713, 0.0098828346121804713, 0.00066431736384338},
+	{6, 0.86390648591940089, 0.040294623544508121, 0.0042715048972463655},
+	{6, 0.009281943619584461, 0.15564108377649652, 0.0025171263732847622},
+	{6, 0.93189282698930054, 0.063361304259387685, 0.0011042955422475686},
+	{6, 0.4010032092859499, 0.0082338651399416242, 0.0028062164516186126},
+	{6, 0.74709514153752254, 0.055113038273260938, 0.007330482431810093},
+	{6, 0.35739825433495248, 0.14296506031885728, 0.012913633276474096},
+	{6, 0.71793410438754857, 0.01146051252531197, 0.0036201340796933098},
+	{6, 0.05239382282416058, 0.60984181412058291, 0.0084707989657108896},
+	{6, 0.24888402535203336, 0.63163592607508612, 0.0092896734405359671},
+};
+static const int triangleRuleStart[] = {0, 1, 2, 2, 4, 7, 10, 13, 18, 24, 30, 38, 46, 55, 65, 76, 88, 101, 116, 132, 150};
+
+/** The rule of the requested strength, or of strength 20 if more is requested, is expanded from its orbits.
+ */
 void Quadrature2DTriangle::initialize(const int n_poly)
 {
-	amat::Array2d<a_real> gptemp;
 	nPoly = n_poly;
 	shape = TRIANGLE;
-
-	if(nPoly == 1) {
-		ngauss = 1;
-		a_real gp[][2] = {{1.0/3, 1.0/3}};
-		a_real gw[][1] = {{0.5}};
-		gptemp.initialize(ngauss, 2, (a_real*)gp);
-		gweights.initialize(ngauss, 1, (a_real*)gw);
-		printf("  Quadrature2DTriangle: Ngauss = 1.\n");
-		ggpoints.resize(ngauss,2);
-	}
-	else if(nPoly == 2) {
-		ngauss = 3;
-		a_real gp[][2] = {{0.6666666666667,0.1666666666667}, {0.1666666666667,0.6666666666667}, {0.1666666666667,0.1666666666667}};
-		a_real gw[][1] = {{0.1666666666667}, {0.1666666666667}, {0.1666666666667}};
-		gptemp.initialize(ngauss, 2, (a_real*)gp);
-		gweights.initialize(ngauss, 1, (a_real*)gw);
-		printf("  Quadrature2DTriangle: Ngauss = 3.\n");
-		ggpoints.resize(ngauss,2);
-	}
-	else if(nPoly == 3) {
-		ngauss = 4;
-		a_real gp[][2] = {{0.33333333333,0.33333333333}, {0.20000000000,0.20000000000}, {0.20000000000, 0.60000000000}, {0.60000000000, 0.20000000000}};
-		a_real gw[][1] = {{-0.28125000000}, {0.26041666667}, {0.26041666667}, {0.26041666667}};
-		gptemp.initialize(ngauss, 2, (a_real*)gp);
-		gweights.initialize(ngauss, 1, (a_real*)gw);
-		printf("  Quadrature2DTriangle: Ngauss = 4.\n");
-		ggpoints.resize(ngauss,2);
-	}
-	else if(nPoly == 4) {
-		ngauss = 6;
-		a_real gp[][2] = {{0.108103018168070,0.445948490915965},
-							{0.445948490915965,0.108103018168070},
-							{0.445948490915965,0.445948490915965},
-							{0.816847572980459,0.091576213509771},
-							{0.091576213509771,0.816847572980459},
-							{0.091576213509771,0.091576213509771}};
-		a_real gw[][1] = {{0.1116907948390055},
-							{0.1116907948390055},
-							{0.1116907948390055},
-							{0.0549758718276610},
-							{0.0549758718276610},
-							{0.0549758718276610}};
-		gptemp.initialize(ngauss, 2, (a_real*)gp);
-		gweights.initialize(ngauss, 1, (a_real*)gw);
-		printf("  Quadrature2DTriangle: Ngauss = 6.\n");
-		ggpoints.resize(ngauss,2);
+	if(nPoly < 1)
+		nPoly = 1;
+	if(nPoly > 20) {
+		printf("! Quadrature2DTriangle: Quadrature with this strength is not supported! Setting to 20.\n");
+		nPoly = 20;
 	}
-	else if(nPoly == 5) {
-		ngauss = 7;
-		a_real gp[][2] = {
-							{0.33333333333333, 0.33333333333333},
-							{0.47014206410511, 0.47014206410511},
-							{0.47014206410511, 0.05971587178977},
-							{0.05971587178977, 0.47014206410511},
-							{0.10128650732346, 0.10128650732346},
-							{0.10128650732346, 0.79742698535309},
-							{0.79742698535309, 0.10128650732346}};
-		a_real gw[][1] ={{0.11250000000000},
-		                 {0.066197076394255},
-		                 {0.066197076394255},
-		                 {0.066197076394255},
-		                 {0.062969590272415},
-		                 {0.062969590272415},
-		                 {0.062969590272415}};
-		gptemp.initialize(ngauss, 2, (a_real*)gp);
-		gweights.initialize(ngauss, 1, (a_real*)gw);
-		printf("  Quadrature2DTriangle: Ngauss = 7.\n");
-		ggpoints.resize(ngauss,2);
-	}
-	else { /* npoly == 6 */
-		nPoly = 6;
-		ngauss = 12;
-		a_real gp[][2] = {{0.873821971016996,0.063089014491502},
-							{0.063089014491502,0.873821971016996},
-							{0.063089014491502,0.063089014491502},
-							{0.501426509658179,0.249286745170910},
-							{0.249286745170910,0.501426509658179},
-							{0.249286745170910,0.249286745170910},
-							{0.636502499121399,0.310352451033785},
-							{0.636502499121399,0.053145049844816},
-							{0.310352451033785,0.636502499121399},
-							{0.310352451033785,0.053145049844816},
-							{0.053145049844816,0.310352451033785},
-							{0.053145049844816,0.636502499121399}};
-		a_real gw[][1] = {{0.0254224531851035},
-							{0.0254224531851035},
-							{0.0254224531851035},
-							{0.0583931378631895},
-							{0.0583931378631895},
-							{0.0583931378631895},
-							{0.0414255378091870},
-							{0.0414255378091870},
-							{0.0414255378091870},
-							{0.0414255378091870},
-							{0.0414255378091870},
-							{0.0414255378091870}};
-		gptemp.initialize(ngauss, 2, (a_real*)gp);
-		gweights.initialize(ngauss, 1, (a_real*)gw);
-		printf("  Quadrature2DTriangle: Ngauss = 12.\n");
-		ggpoints.resize(ngauss,2);
+
+	// no rule of strength 3 with positive weights and interior points has fewer points than the one of strength 4
+	const int strength = nPoly == 3 ? 4 : nPoly;
+	const int start = triangleRuleStart[strength-1], end = triangleRuleStart[strength];
+	ngauss = 0;
+	for(int io = start; io < end; io++)
+		ngauss += triangleOrbits[io].npoints;
+
+	// ordered pairs of distinct barycentric coordinates; the first 1 or 3 are the distinct points of the smaller orbits
+	const int perms[6][2] = {{0,1}, {1,2}, {2,0}, {1,0}, {2,1}, {0,2}};
+	ggpoints.resize(ngauss,2);
+	gweights.resize(ngauss,1);
+	int ig = 0;
+	for(int io = start; io < end; io++)
+	{
+		const TriangleOrbit& orb = triangleOrbits[io];
+		const a_real l[3] = {orb.a, orb.b, 1.0-orb.a-orb.b};
+		for(int ip = 0; ip < orb.npoints; ip++) {
+			ggpoints(ig,0) = l[perms[ip][0]];
+			ggpoints(ig,1) = l[perms[ip][1]];
+			gweights(ig) = orb.weight;
+			ig++;
+		}
 	}
-	for(int i = 0; i < ggpoints.rows(); i++)
-		for(int j = 0; j < 2; j++)
-			ggpoints(i,j) = gptemp(i,j);
+	printf("  Quadrature2DTriangle: Ngauss = %d.\n", ngauss);
 }
 
 }
@@ -47,20 +47,43 @@ public:
 	}
 };
 
+/// Computes the n Gauss-Legendre points in [-1,1], in increasing order, and their weights
+/** The points are the roots of the Legendre polynomial \f$ P_n \f$, found by Newton iterations.
+ * With n points, polynomials upto degree 2n-1 are integrated exactly.
+ */
+void getGaussLegendrePoints(const int n, Vector& points, Vector& weights);
+
 /// 1D Gauss-Legendre quadrature
+/** The rule with the fewest points that integrates polynomials of the requested degree exactly is generated.
+ */
 class Quadrature1D : public QuadratureRule
 {
 public:
 	void initialize(const int n_poly);
 };
 
+/// Computes the n Gauss-Lobatto-Legendre points in [-1,1], in increasing order, and their weights
+/** The points are the end points and the roots of \f$ P'_{n-1} \f$, which are found by Newton iterations.
+ * With n points, polynomials upto degree 2n-3 are integrated exactly. n must be at least 2.
+ */
+void getGaussLobattoPoints(const int n, Vector& points, Vector& weights);
+
+/// 1D Gauss-Lobatto-Legendre quadrature
+/** The end points of the interval are quadrature points. At least 2 points are used.
+ */
+class Quadrature1DLobatto : public Quadrature1D
+{
+public:
+	void initialize(const int n_poly);
+};
+
 class Quadrature2D : public QuadratureRule
 {
 public:
 	virtual void initialize(const int n_poly) = 0;
 };
 
-/// Integration over the reference square
+/// Integration over the reference square by tensor-product Gauss-Legendre rules
 /** Note that currently, this is restricted to having the same number of quadrature points in the x- and y-directions.
  */
 class Quadrature2DSquare : public Quadrature2D
@@ -69,7 +92,19 @@ public:
 	void initialize(const int n_poly);
 };
 
+/// Tensor-product Gauss-Lobatto-Legendre quadrature on the reference square
+/** The points are ordered as in [Quadrature2DSquare](@ref Quadrature2DSquare).
+ * Used for collocated spectral-element (DGSEM) discretizations, where they are also the nodes of the basis.
+ */
+class Quadrature2DSquareLobatto : public Quadrature2DSquare
+{
+public:
+	void initialize(const int n_poly);
+};
+
 /// Integration over the reference triangle [(0,0), (1,0), (0,1)]
+/** Uses tabulated symmetric rules with positive weights and interior points, of strengths upto 20.
+ */
 class Quadrature2DTriangle : public Quadrature2D
 {
 public:
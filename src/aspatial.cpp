@@ -5,30 +5,44 @@
  */
 
 #include "aspatial.hpp"
+#include <cstdlib>
 
 namespace acfd {
 
 template <short nvars>
-SpatialBase<nvars>::SpatialBase(const UMesh2dh* mesh, const int _p_degree, char basistype)
-	: m(mesh), p_degree(_p_degree), basis_type(basistype)
+SpatialBase<nvars>::SpatialBase(const UMesh2dh* mesh, const int _p_degree, char basistype, const bool linear_flux)
+	: m(mesh), p_degree(_p_degree), basis_type(basistype), linearflux(linear_flux), residual_mode('s')
 {
 	std::cout << " SpatialBase: Setting up spatal integrator for FE polynomial degree " << p_degree << std::endl;
 
-	// set quadrature strength
-	//int dom_quaddegree = 2*p_degree + m->degree()-1;
-	//int boun_quaddegree = 2*p_degree + m->degree()-1;
-	int dom_quaddegree = 2*p_degree;
-	int boun_quaddegree = 2*p_degree;
-	if(dom_quaddegree == 0) dom_quaddegree = 1;
-	if(boun_quaddegree == 0) boun_quaddegree = 1;
-	std::cout << " SpatialBase: Quadrature strengths for domain and boundary integrals set at " << dom_quaddegree << ", " << boun_quaddegree << std::endl;
-
-	dtquad = new Quadrature2DTriangle();
-	dtquad->initialize(dom_quaddegree);
-	dsquad = new Quadrature2DSquare();
-	dsquad->initialize(dom_quaddegree);
-	bquad = new Quadrature1D();
-	bquad->initialize(boun_quaddegree);
+	// one for the serial parts; more are added before the first parallel region by reserveWorkspaces
+	workspaces.resize(1);
+
+	// set quadrature strength; domain rules are chosen per element in computeElementGroups,
+	// while the face rule is shared by all faces and so must suit the most curved element
+	int maxgeomdegree = 1;
+	if(m->degree() > 1)
+		for(a_int iel = 0; iel < m->gnelem(); iel++)
+			maxgeomdegree = std::max(maxgeomdegree, elementGeometricDegree(iel));
+	const int dom_quaddegree = domainQuadratureStrength(1);
+	const int boun_quaddegree = faceQuadratureStrength(maxgeomdegree);
+	std::cout << " SpatialBase: Quadrature strengths for domain integrals over straight elements and boundary integrals set at " 
+		<< dom_quaddegree << ", " << boun_quaddegree << std::endl;
+
+	if(basistype == 'g') {
+		// Gauss-Lobatto rules with p+1 points in each direction, collocated with the nodes of the basis
+		if(p_degree < 1) {
+			std::cout << "! SpatialBase: The Gauss-Lobatto basis needs a degree of at least 1!" << std::endl;
+			std::abort();
+		}
+		bquad = new Quadrature1DLobatto();
+		bquad->initialize(2*p_degree-1);
+		std::cout << " SpatialBase: Using Gauss-Lobatto quadrature with " << bquad->numGauss() << " points per direction\n";
+	}
+	else {
+		bquad = new Quadrature1D();
+		bquad->initialize(boun_quaddegree);
+	}
 
 	map2d = new LagrangeMapping2D[m->gnelem()];
 	elems = new Element*[m->gnelem()];
@@ -37,12 +51,34 @@ SpatialBase<nvars>::SpatialBase(const UMesh2dh* mesh, const int _p_degree, char
 			elems[iel] = new TaylorElement();
 		}
 	}
+	else if(basistype == 'g') {
+		for(int iel = 0; iel < m->gnelem(); iel++) {
+			LobattoElement* gelem = new LobattoElement();
+			gelem->setBasisRegistry(&basisreg);
+			elems[iel] = gelem;
+		}
+		// the Gauss-Lobatto face rule would under-integrate the non-collocated basis of a triangle
+		for(int iel = 0; iel < m->gnelem(); iel++)
+			if(m->gnfael(iel) != 4) {
+				std::cout << "! SpatialBase: The Gauss-Lobatto basis needs a mesh of quadrangles only!" << std::endl;
+				std::abort();
+			}
+	}
+	else if(basistype == 'o') {
+		for(int iel = 0; iel < m->gnelem(); iel++) {
+			OrthonormalElement* oelem = new OrthonormalElement();
+			oelem->setBasisRegistry(&basisreg);
+			elems[iel] = oelem;
+		}
+	}
 	else {
 		/*elems[0] = new LagrangeElement();
 		for(int iel = 1; iel < m->gnelem(); iel++)
 			elems[iel] = elems[0];*/
 		for(int iel = 0; iel < m->gnelem(); iel++) {
-			elems[iel] = new LagrangeElement();
+			LagrangeElement* lelem = new LagrangeElement();
+			lelem->setBasisRegistry(&basisreg);
+			elems[iel] = lelem;
 		}
 	}
 
@@ -55,8 +91,8 @@ SpatialBase<nvars>::SpatialBase(const UMesh2dh* mesh, const int _p_degree, char
 template <short nvars>
 SpatialBase<nvars>::~SpatialBase()
 {
-	delete dtquad;
-	delete dsquad;
+	for(size_t igr = 0; igr < elemgroups.size(); igr++)
+		delete elemgroups[igr].quad;
 	delete bquad;
 	delete [] map2d;
 	delete [] map1d;
@@ -67,11 +103,115 @@ SpatialBase<nvars>::~SpatialBase()
 	delete dummyelem;
 }
 
+template <short nvars>
+int SpatialBase<nvars>::domainQuadratureStrength(const int geomdegree) const
+{
+	const int strength = (linearflux ? 2*p_degree : 3*p_degree) + 2*(geomdegree-1);
+	return strength > 0 ? strength : 1;
+}
+
+template <short nvars>
+int SpatialBase<nvars>::faceQuadratureStrength(const int geomdegree) const
+{
+	const int strength = (linearflux ? 2*p_degree : 3*p_degree) + geomdegree-1;
+	return strength > 0 ? strength : 1;
+}
+
+/** Only meshes of degree 2 are checked: an element is straight if its edge nodes are at the midpoints
+ * of its edges and, for 9-node quadrangles, its centre node is at the mean of its vertices.
+ */
+template <short nvars>
+int SpatialBase<nvars>::elementGeometricDegree(const a_int iel) const
+{
+	const int nv = m->gnfael(iel);
+	if(m->gnnode(iel) == nv)
+		return 1;
+	if(m->degree() != 2)
+		return m->degree();
+
+	a_real hsq = 0;
+	for(int iv = 0; iv < nv; iv++)
+		for(int idim = 0; idim < NDIM; idim++) {
+			const a_real dx = m->gcoords(m->ginpoel(iel,(iv+1)%nv),idim) - m->gcoords(m->ginpoel(iel,iv),idim);
+			hsq += dx*dx;
+		}
+	const a_real tol = 1e3*SMALL_NUMBER*std::sqrt(hsq);
+
+	for(int ino = nv; ino < m->gnnode(iel); ino++)
+		for(int idim = 0; idim < NDIM; idim++)
+		{
+			a_real linear = 0;
+			if(ino < 2*nv)
+				linear = 0.5*(m->gcoords(m->ginpoel(iel,ino-nv),idim) + m->gcoords(m->ginpoel(iel,(ino-nv+1)%nv),idim));
+			else {
+				for(int iv = 0; iv < nv; iv++)
+					linear += m->gcoords(m->ginpoel(iel,iv),idim);
+				linear /= nv;
+			}
+			if(std::fabs(m->gcoords(m->ginpoel(iel,ino),idim) - linear) > tol)
+				return m->degree();
+		}
+	return 1;
+}
+
+template <short nvars>
+void SpatialBase<nvars>::computeElementGroups()
+{
+	for(size_t igr = 0; igr < elemgroups.size(); igr++)
+		delete elemgroups[igr].quad;
+	elemgroups.clear();
+	elemgroup.resize(m->gnelem());
+
+	for(a_int iel = 0; iel < m->gnelem(); iel++)
+	{
+		const Shape shape = m->gnfael(iel) == 4 ? QUADRANGLE : TRIANGLE;
+		// the collocated Gauss-Lobatto basis needs the rule on its nodes, whatever the geometry
+		const bool lobatto = (basis_type == 'g' && shape == QUADRANGLE);
+		const int geomdegree = lobatto ? 1 : elementGeometricDegree(iel);
+
+		size_t igr = 0;
+		while(igr < elemgroups.size() && (elemgroups[igr].shape != shape || elemgroups[igr].geomdegree != geomdegree))
+			igr++;
+
+		if(igr == elemgroups.size())
+		{
+			ElementGroup grp;
+			grp.shape = shape;
+			grp.geomdegree = geomdegree;
+			if(lobatto) {
+				grp.quad = new Quadrature2DSquareLobatto();
+				grp.quad->initialize(2*p_degree-1);
+			}
+			else {
+				if(shape == QUADRANGLE)
+					grp.quad = new Quadrature2DSquare();
+				else
+					grp.quad = new Quadrature2DTriangle();
+				grp.quad->initialize(domainQuadratureStrength(geomdegree));
+			}
+			elemgroups.push_back(grp);
+		}
+
+		elemgroup[iel] = static_cast<int>(igr);
+		elemgroups[igr].elements.push_back(iel);
+	}
+}
+
 template <short nvars>
 void SpatialBase<nvars>::computeFEData()
 {
+	computeElementGroups();
+
 	minv.resize(m->gnelem());
+	minvscale.assign(m->gnelem(), 0);
+	minvdiag.assign(m->gnelem(), Vector());
 	ntotaldofs = 0;
+	a_int naffine = 0, ndiagonal = 0;
+
+	// reference inverse mass matrices of the basis sets used by affine elements, and whether they are the identity
+	std::vector<const BasisSet*> refsets;
+	std::vector<Matrix> refminv;
+	std::vector<bool> refidentity;
 
 	// loop over elements to setup maps and elements and compute mass matrices
 	for(int iel = 0; iel < m->gnelem(); iel++)
@@ -81,36 +221,78 @@ void SpatialBase<nvars>::computeFEData()
 			for(int j = 0; j < NDIM; j++)
 				phynodes(j,i) = m->gcoords(m->ginpoel(iel,i),j);
 
-		if(m->gnnode(iel) == 4 || m->gnnode(iel) == 9 || m->gnnode(iel) == 16)
-			map2d[iel].setAll(m->degree(), phynodes, dsquad);
-		else {
-			map2d[iel].setAll(m->degree(), phynodes, dtquad);
-		}
+		map2d[iel].setAll(m->degree(), phynodes, elemgroups[elemgroup[iel]].quad);
 
 		elems[iel]->initialize(p_degree, &map2d[iel]);
 		ntotaldofs += elems[iel]->getNumDOFs();
 
-		// allocate mass matrix
-		minv[iel] = Matrix::Zero(elems[iel]->getNumDOFs(), elems[iel]->getNumDOFs());
+		if(map2d[iel].isAffine())
+			naffine++;
 
-		// compute mass matrix
-		for(int ig = 0; ig < map2d[iel].getQuadrature()->numGauss(); ig++)
+		/* With a collocated basis, the mass matrix is diagonal: the basis functions are nonzero at only one quadrature point.
+		 * For an affine element with a reference-space basis, the mass matrix is the reference mass matrix
+		 * scaled by the (constant) Jacobian determinant, so its inverse is the scaled reference inverse.
+		 */
+		if(elems[iel]->basisSet()->collocated)
 		{
-			a_real weightandjdet = map2d[iel].jacDet()[ig] * map2d[iel].getQuadrature()->weights()(ig);
-			for(int idof = 0; idof < elems[iel]->getNumDOFs(); idof++)
-				for(int jdof = 0; jdof < elems[iel]->getNumDOFs(); jdof++)
-					minv[iel](idof,jdof) += elems[iel]->bFunc()(ig,idof)*elems[iel]->bFunc()(ig,jdof) * weightandjdet;
+			const int ng = map2d[iel].getQuadrature()->numGauss();
+			minvdiag[iel].resize(ng);
+			for(int ig = 0; ig < ng; ig++)
+				minvdiag[iel](ig) = 1.0/(map2d[iel].getQuadrature()->weights()(ig) * map2d[iel].jacDet(ig));
+			minv[iel].resize(0,0);
+			ndiagonal++;
+		}
+		else if(map2d[iel].isAffine() && elems[iel]->getType() == REFERENTIAL)
+		{
+			const BasisSet* bset = elems[iel]->basisSet();
+			size_t iset = 0;
+			while(iset < refsets.size() && refsets[iset] != bset)
+				iset++;
+
+			if(iset == refsets.size()) {
+				Matrix refmass = Matrix::Zero(elems[iel]->getNumDOFs(), elems[iel]->getNumDOFs());
+				for(int ig = 0; ig < map2d[iel].getQuadrature()->numGauss(); ig++)
+					refmass += map2d[iel].getQuadrature()->weights()(ig) * bset->basis.row(ig).transpose()*bset->basis.row(ig);
+				refsets.push_back(bset);
+				refminv.push_back(refmass.inverse());
+				// checked rather than assumed, as it requires the domain quadrature to be exact for the mass matrix
+				refidentity.push_back((refmass - Matrix::Identity(refmass.rows(),refmass.cols())).cwiseAbs().maxCoeff() 
+						< 1e3*SMALL_NUMBER);
+			}
+
+			if(refidentity[iset]) {
+				minvscale[iel] = 1.0/map2d[iel].jacDet(0);
+				minv[iel].resize(0,0);
+				ndiagonal++;
+			}
+			else
+				minv[iel] = refminv[iset] * (1.0/map2d[iel].jacDet(0));
+		}
+		else
+		{
+			minv[iel] = Matrix::Zero(elems[iel]->getNumDOFs(), elems[iel]->getNumDOFs());
+
+			// compute mass matrix
+			for(int ig = 0; ig < map2d[iel].getQuadrature()->numGauss(); ig++)
+			{
+				a_real weightandjdet = map2d[iel].jacDet(ig) * map2d[iel].getQuadrature()->weights()(ig);
+				for(int idof = 0; idof < elems[iel]->getNumDOFs(); idof++)
+					for(int jdof = 0; jdof < elems[iel]->getNumDOFs(); jdof++)
+						minv[iel](idof,jdof) += elems[iel]->bFunc()(ig,idof)*elems[iel]->bFunc()(ig,jdof) * weightandjdet;
+			}
+
+			minv[iel] = minv[iel].inverse().eval();
 		}
-
-		minv[iel] = minv[iel].inverse().eval();
 
 		/** \note Computation of physical coordinates of domain quadrature points is required separately for Lagrange elements
 		 * only for the purpose of computing source term contributions and errors.
 		 */
-		if(basis_type == 'l')
+		if(elems[iel]->getType() == REFERENTIAL)
 			map2d[iel].computePhysicalCoordsOfDomainQuadraturePoints();
 	}
 	std::printf(" SpatialBase: computeFEData: Total number of DOFs = %d\n", ntotaldofs);
+	std::printf(" SpatialBase: computeFEData: %d of %d elements are affine, %d have diagonal mass matrices\n", 
+			naffine, m->gnelem(), ndiagonal);
 
 	dummyelem->initialize(p_degree, &map2d[0]);
 
@@ -146,26 +328,222 @@ void SpatialBase<nvars>::computeFEData()
 			<< ": " << m->gfacelocalnum(iface,0) << ", " << m->gfacelocalnum(iface,1) << std::endl;*/
 	}
 
+	for(size_t igr = 0; igr < elemgroups.size(); igr++)
+	{
+		ElementGroup& grp = elemgroups[igr];
+		grp.kernels = getElementKernels<nvars>(grp.shape, p_degree, basis_type, grp.quad);
+		std::printf(" SpatialBase: computeFEData: Group %d: %d %s of geometric degree %d, %d quadrature points, %s kernels\n",
+				static_cast<int>(igr), static_cast<int>(grp.elements.size()), grp.shape == TRIANGLE ? "triangles" : "quadrangles",
+				grp.geomdegree, grp.quad->numGauss(), grp.kernels.name);
+	}
+
 	std::cout << " SpatialBase: computeFEData: Mesh degree = " << m->degree() << ", geom map degee = " << map2d[0].getDegree()
 		 << ", element degree = " << elems[0]->getDegree() << std::endl;
+	std::printf(" SpatialBase: computeFEData: FE data uses about %.1f bytes per DOF; %d shared basis sets, %d shared face traces\n", 
+			static_cast<double>(feDataBytes())/ntotaldofs, static_cast<int>(basisreg.numSets()), static_cast<int>(basisreg.numTraces()));
+
+	computeFaceColouring();
+}
+
+/** Counts the storage held by Eigen and STL containers in the elements, geometric maps, face elements
+ * and mass matrices, plus the size of the objects themselves. Allocator overheads are not included.
+ */
+template <short nvars>
+size_t SpatialBase<nvars>::feDataBytes() const
+{
+	auto matbytes = [](const Matrix& a) { return sizeof(Matrix) + a.size()*sizeof(a_real); };
+	auto matvecbytes = [&matbytes](const std::vector<Matrix>& a) { 
+		size_t b = sizeof(a);
+		for(size_t i = 0; i < a.size(); i++)
+			b += matbytes(a[i]);
+		return b;
+	};
+
+	size_t bytes = basisreg.bytes() + elemgroup.size()*sizeof(int);
+	for(size_t igr = 0; igr < elemgroups.size(); igr++)
+		bytes += sizeof(ElementGroup) + elemgroups[igr].elements.size()*sizeof(a_int);
+	for(a_int iel = 0; iel < m->gnelem(); iel++)
+	{
+		if(basis_type == 't')
+			bytes += sizeof(TaylorElement);
+		else if(basis_type == 'o')
+			bytes += sizeof(OrthonormalElement);
+		else if(basis_type == 'g')
+			bytes += sizeof(LobattoElement);
+		else
+			bytes += sizeof(LagrangeElement);
+		bytes += sizeof(Element*);
+		if(elems[iel]->getType() == PHYSICAL)
+			bytes += elems[iel]->basisSet()->bytes();
+
+		const GeomMapping2D& gm = map2d[iel];
+		bytes += sizeof(LagrangeMapping2D) + gm.bytes();
+
+		bytes += matbytes(minv[iel]) + sizeof(a_real) + sizeof(Vector) + minvdiag[iel].size()*sizeof(a_real);
+	}
+
+	for(a_int iface = 0; iface < m->gnaface(); iface++)
+	{
+		const GeomMapping1D& gm = map1d[iface];
+		bytes += sizeof(LagrangeMapping1D) + gm.getPhyNodes().size()*sizeof(a_real) + gm.map().size()*sizeof(a_real)
+			+ gm.speed().size()*sizeof(a_real);
+		for(size_t ig = 0; ig < gm.normal().size(); ig++)
+			bytes += sizeof(Vector) + gm.normal()[ig].size()*sizeof(a_real);
+
+		bytes += sizeof(FaceElement) + matvecbytes(faces[iface].leftBasisGrad()) + matvecbytes(faces[iface].rightBasisGrad());
+		if(!faces[iface].sharesLeftBasis())
+			bytes += faces[iface].leftBasis().size()*sizeof(a_real);
+		if(!faces[iface].sharesRightBasis())
+			bytes += faces[iface].rightBasis().size()*sizeof(a_real);
+	}
+	return bytes;
+}
+
+template <short nvars>
+void SpatialBase<nvars>::computeFaceColouring()
+{
+	const a_int nelem = m->gnelem();
+	const a_int naface = m->gnaface();
+
+	// bit j of usedcolours[iel] is set if a face of element iel has colour j
+	std::vector<std::uint64_t> usedcolours(nelem, 0);
+	std::vector<int> facecolour(naface);
+	int ncolours = 0;
+	for(a_int iface = 0; iface < naface; iface++)
+	{
+		const a_int lelem = m->gintfac(iface,0);
+		const a_int relem = m->gintfac(iface,1);
+		std::uint64_t used = usedcolours[lelem];
+		if(relem < nelem)
+			used |= usedcolours[relem];
+
+		int ic = 0;
+		while(ic < 64 && (used >> ic) & 1)
+			ic++;
+		if(ic == 64) {
+			std::cout << "! SpatialBase: computeFaceColouring: More than 64 colours needed!" << std::endl;
+			std::abort();
+		}
+
+		facecolour[iface] = ic;
+		usedcolours[lelem] |= static_cast<std::uint64_t>(1) << ic;
+		if(relem < nelem)
+			usedcolours[relem] |= static_cast<std::uint64_t>(1) << ic;
+		if(ic+1 > ncolours) ncolours = ic+1;
+	}
+
+	// bucket the faces by colour, keeping their order within each colour
+	colour_p.assign(ncolours+1, 0);
+	for(a_int iface = 0; iface < naface; iface++)
+		colour_p[facecolour[iface]+1]++;
+	for(int ic = 0; ic < ncolours; ic++)
+		colour_p[ic+1] += colour_p[ic];
+	colourfaces.resize(naface);
+	std::vector<a_int> pos(colour_p.begin(), colour_p.end()-1);
+	for(a_int iface = 0; iface < naface; iface++)
+		colourfaces[pos[facecolour[iface]]++] = iface;
+
+	std::cout << " SpatialBase: computeFaceColouring: Number of face colours = " << ncolours << std::endl;
+}
+
+template <short nvars>
+void SpatialBase<nvars>::setResidualMode(const char mode)
+{
+	if(mode != 's' && mode != 'g') {
+		std::cout << "! SpatialBase: setResidualMode(): Unknown residual mode " << mode << "; using scatter." << std::endl;
+		residual_mode = 's';
+	}
+	else
+		residual_mode = mode;
 }
 
 template <short nvars>
-void SpatialBase<nvars>::spatialSetup(std::vector<Matrix>& u, std::vector<Matrix>& res, std::vector<a_real>& mets)
+void SpatialBase<nvars>::spatialSetup(DOFVector& u, DOFVector& res, std::vector<a_real>& mets)
 {
 	computeFEData();
 	
 	// allocate
-	u.resize(m->gnelem());
-	res.resize(m->gnelem());
+	std::vector<int> ndofs(m->gnelem());
+	for(a_int iel = 0; iel < m->gnelem(); iel++)
+		ndofs[iel] = elems[iel]->getNumDOFs();
+	u.setup(nvars, ndofs);
+	res.setup(nvars, ndofs);
 	mets.resize(m->gnelem());
+}
+
+template <short nvars>
+void SpatialBase<nvars>::applyMassInverse(DOFVector& r) const
+{
+	reserveWorkspaces();
+#pragma omp parallel for default(shared)
 	for(a_int iel = 0; iel < m->gnelem(); iel++)
 	{
-		u[iel].resize(nvars, elems[iel]->getNumDOFs());
-		res[iel].resize(nvars, elems[iel]->getNumDOFs());
+		if(minvscale[iel] != 0)
+			r[iel] *= minvscale[iel];
+		else if(minvdiag[iel].size() > 0)
+			r[iel].array().rowwise() *= minvdiag[iel].transpose().array();
+		else {
+			Matrix& prod = workspace().matrix(WS_TERM, nvars, minv[iel].cols());
+			prod.noalias() = r[iel]*minv[iel];
+			r[iel] = prod;
+		}
 	}
 }
 
+template <short nvars>
+void SpatialBase<nvars>::addMassInverse(const a_int iel, const a_real a, const DOFVector& r, DOFVector& u) const
+{
+	MatrixMap ue = u[iel];
+	if(minvscale[iel] != 0)
+		ue += (a*minvscale[iel])*r[iel];
+	else if(minvdiag[iel].size() > 0)
+		ue.array() += a * (r[iel].array().rowwise() * minvdiag[iel].transpose().array());
+	else
+		ue.noalias() += a * (r[iel]*minv[iel]);
+}
+
+template <short nvars>
+a_real SpatialBase<nvars>::estimateSpectralRadius(const DOFVector& u, const int niter)
+{
+	if(niter < 1) {
+		std::cout << "! SpatialBase: estimateSpectralRadius(): Number of iterations must be positive!" << std::endl;
+		std::abort();
+	}
+	std::vector<a_real> mets(m->gnelem());
+	DOFVector r0 = u, up = u, jv = u, v = u;
+	r0.setZero();
+	update_residual(u, r0, mets);
+
+	// a start vector with components in the directions of all eigenvectors, in all likelihood
+	for(a_int i = 0; i < v.size(); i++)
+		v.data()[i] = std::sin(1.0 + i);
+	v.scale(1.0/v.norm());
+
+	const a_real eps = std::sqrt(ZERO_TOL)*(1.0 + u.norm());
+	a_real logsum = 0;
+	int nsum = 0;
+	for(int it = 0; it < niter; it++)
+	{
+		up = u;
+		up.axpy(eps, v);
+		jv.setZero();
+		update_residual(up, jv, mets);
+		jv.axpy(-1.0, r0);
+		applyMassInverse(jv);
+
+		const a_real jvnorm = jv.norm();
+		if(jvnorm == 0)
+			return 0;
+		if(2*it >= niter-1) {
+			logsum += std::log(jvnorm/eps);
+			nsum++;
+		}
+		v = jv;
+		v.scale(1.0/jvnorm);
+	}
+	return std::exp(logsum/nsum);
+}
+
 template <short nvars>
 a_real SpatialBase<nvars>::computeElemL2Norm2(const int ielem, const Vector& __restrict__ ug) const
 {
@@ -183,14 +561,14 @@ a_real SpatialBase<nvars>::computeElemL2Norm2(const int ielem, const Vector& __r
 		for(int j = 0; j < ndofs; j++) {
 			lu += ug(j)*bfunc(ig,j);
 		}
-		l2error += lu*lu * wts(ig) * gmap->jacDet()[ig];
+		l2error += lu*lu * wts(ig) * gmap->jacDet(ig);
 	}
 
 	return l2error;
 }
 
 template <short nvars>
-a_real SpatialBase<nvars>::computeL2Norm(const std::vector<Matrix> w, const int comp) const
+a_real SpatialBase<nvars>::computeL2Norm(const DOFVector& w, const int comp) const
 {
 	a_real l2norm = 0;
 	for(int ielem = 0; ielem < m->gnelem(); ielem++)
@@ -198,12 +576,12 @@ a_real SpatialBase<nvars>::computeL2Norm(const std::vector<Matrix> w, const int
 		const GeomMapping2D* gmap = elems[ielem]->getGeometricMapping();
 		int ng = gmap->getQuadrature()->numGauss();
 		const amat::Array2d<a_real>& wts = gmap->getQuadrature()->weights();
-		Vector vals(ng);
-		elems[ielem]->interpolateComponent(comp,w[ielem],vals);
+		const Matrix& bfunc = elems[ielem]->bFunc();
 
 		for(int ig = 0; ig < ng; ig++)
 		{
-			l2norm += vals(ig)*vals(ig) * wts(ig) * gmap->jacDet()[ig];
+			const a_real val = bfunc.row(ig).dot(w[ielem].row(comp));
+			l2norm += val*val * wts(ig) * gmap->jacDet(ig);
 		}
 	}
 
@@ -212,7 +590,7 @@ a_real SpatialBase<nvars>::computeL2Norm(const std::vector<Matrix> w, const int
 
 template <short nvars>
 a_real SpatialBase<nvars>::computeElemL2Error2(const int ielem, const int comp,
-	const Matrix& __restrict__ ug, a_real (* const exact)(a_real, a_real, a_real), const double time) const
+	const ConstMatrixRef& ug, a_real (* const exact)(a_real, a_real, a_real), const double time) const
 {
 	int ndofs = elems[ielem]->getNumDOFs();
 	a_real l2error = 0;
@@ -230,14 +608,14 @@ a_real SpatialBase<nvars>::computeElemL2Error2(const int ielem, const int comp,
 		for(int j = 0; j < ndofs; j++) {
 			lu += ug(comp,j)*bfunc(ig,j);
 		}
-		l2error += std::pow(lu-exact(qp(ig,0),qp(ig,1),time),2) * wts(ig) * gmap->jacDet()[ig];
+		l2error += std::pow(lu-exact(qp(ig,0),qp(ig,1),time),2) * wts(ig) * gmap->jacDet(ig);
 	}
 
 	return l2error;
 }
 
 template <short nvars>
-a_real SpatialBase<nvars>::computeL2Error(double (*const exact)(double,double,double), const double time, const std::vector<Matrix>& u) const
+a_real SpatialBase<nvars>::computeL2Error(double (*const exact)(double,double,double), const double time, const DOFVector& u) const
 {
 	double l2error = 0;
 	for(int iel = 0; iel < m->gnelem(); iel++)
@@ -248,9 +626,9 @@ a_real SpatialBase<nvars>::computeL2Error(double (*const exact)(double,double,do
 }
 
 template <short nvars>
-void SpatialBase<nvars>::setInitialConditionNodal(const int comp, double (**const init)(a_real, a_real), std::vector<Matrix>& u)
+void SpatialBase<nvars>::setInitialConditionNodal(const int comp, double (**const init)(a_real, a_real), DOFVector& u)
 {
-	if(basis_type != 'l') {
+	if(basis_type != 'l' && basis_type != 'g') {
 		printf("!  SpatialBase: setInitialConditionNodal: Not nodal basis!\n");
 		return;
 	}
@@ -267,7 +645,7 @@ void SpatialBase<nvars>::setInitialConditionNodal(const int comp, double (**cons
 }
 
 template <short nvars>
-void SpatialBase<nvars>::setInitialConditionModal(const int comp, double (**const init)(a_real, a_real), std::vector<Matrix>& u)
+void SpatialBase<nvars>::setInitialConditionModal(const int comp, double (**const init)(a_real, a_real), DOFVector& u)
 {
 	if(basis_type != 't') {
 		printf("!  SpatialBase: setInitialConditionModal: Not Taylor basis!\n");
@@ -292,9 +670,44 @@ void SpatialBase<nvars>::setInitialConditionModal(const int comp, double (**cons
 	}
 }
 
+/** The right hand side of the projection is integrated with the domain quadrature,
+ * and the mass matrix is then inverted just as for the residual.
+ */
 template <short nvars>
-void SpatialBase<nvars>::add_source( a_real (*const rhs)(a_real, a_real, a_real), a_real t, std::vector<Matrix>& res) { }
+void SpatialBase<nvars>::setInitialConditionProjection(const int comp, double (*const init)(a_real, a_real), DOFVector& u)
+{
+	DOFVector rhs = u;
+	rhs.setZero();
+	for(int iel = 0; iel < m->gnelem(); iel++)
+	{
+		const Matrix& bfunc = elems[iel]->bFunc();
+		const Matrix& qp = map2d[iel].map();
+		const amat::Array2d<a_real>& wts = map2d[iel].getQuadrature()->weights();
+		for(int ig = 0; ig < map2d[iel].getQuadrature()->numGauss(); ig++)
+		{
+			const a_real f = init(qp(ig,0),qp(ig,1)) * wts(ig) * map2d[iel].jacDet(ig);
+			for(int idof = 0; idof < elems[iel]->getNumDOFs(); idof++)
+				rhs[iel](comp,idof) += f*bfunc(ig,idof);
+		}
+	}
+
+	applyMassInverse(rhs);
+	for(int iel = 0; iel < m->gnelem(); iel++)
+		u[iel].row(comp) = rhs[iel].row(comp);
+}
+
+template <short nvars>
+void SpatialBase<nvars>::add_source( a_real (*const rhs)(a_real, a_real, a_real), a_real t, DOFVector& res) { }
+
+template <short nvars>
+void SpatialBase<nvars>::update_residual_elements(const DOFVector& u, DOFVector& res, std::vector<a_real>& mets,
+		const a_int *const elements, const a_int nelements)
+{
+	std::cout << "! SpatialBase: update_residual_elements(): Not implemented for this discretization!" << std::endl;
+	std::abort();
+}
 
 template class SpatialBase<1>;
+template class SpatialBase<4>;
 
 }	// end namespace
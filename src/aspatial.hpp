@@ -27,10 +27,37 @@
 #include "areconstruction.hpp"
 #endif
 
+#ifndef __ADOFVECTOR_H
+#include "adofvector.hpp"
+#endif
+
+#ifndef __AELEMENTKERNELS_H
+#include "aelementkernels.hpp"
+#endif
+
+#ifndef __AWORKSPACE_H
+#include "aworkspace.hpp"
+#endif
+
 #include <Eigen/LU>
+#include <cstdlib>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace acfd {
 
+/// Elements of one shape that use the same domain quadrature rule, and hence share basis sets and element kernels
+struct ElementGroup
+{
+	Shape shape;								///< Shape of the elements
+	int geomdegree;								///< Degree of the geometric map of the elements; 1 for straight elements
+	Quadrature2D* quad;							///< Domain quadrature rule, owned by the group
+	ElementKernels kernels;						///< Kernels for integrating over the elements
+	std::vector<a_int> elements;				///< Elements of the group, in increasing order
+};
+
 /// Base class for spatial discretization and integration of weak forms of PDEs
 /**
  * Provides residual computation, and potentially residual Jacobian evaluation, interface for all solvers.
@@ -43,20 +70,96 @@ class SpatialBase
 protected:
 	const UMesh2dh* m;							///< Mesh context; requires compute_topological() and compute_boundary_maps() to have been called
 	std::vector<Matrix> minv;					///< Inverse of mass matrix for each variable of each element
+
+	/// For elements whose mass matrix is a multiple of the identity, the inverse of that multiple, and 0 otherwise
+	/** This is the case for affine elements with an [orthonormal](@ref OrthonormalElement) basis.
+	 * The dense inverse [minv](@ref minv) of such elements is not stored.
+	 */
+	std::vector<a_real> minvscale;
+
+	/// For elements with a [collocated](@ref BasisSet::collocated) basis, the inverse of the diagonal mass matrix
+	/** The mass matrix is computed with the domain quadrature, whose points are the nodes, so it is diagonal
+	 * even for curved elements. Empty for other elements.
+	 */
+	std::vector<Vector> minvdiag;
 	int p_degree;								///< Polynomial degree of trial/test functions
 	a_int ntotaldofs;							///< Total number of DOFs in the discretization (for 1 physical variable)
-	char basis_type;							///< Type of basis to use - Lagrange ('l') or Taylor ('t')
+	/// Type of basis to use - Lagrange ('l'), orthonormal ('o'), Gauss-Lobatto ('g') or Taylor ('t')
+	/** With Gauss-Lobatto, the domain and boundary quadratures are Gauss-Lobatto rules with the same points as the 
+	 * nodes of the basis on quadrangles, which gives the DG spectral element method (DGSEM) on quadrangle meshes.
+	 */
+	char basis_type;
 	bool reconstruct;							///< Use reconstruction or not
 
-	Quadrature2DTriangle* dtquad;				///< Domain quadrature context
-	Quadrature2DSquare* dsquad;					///< Domain quadrature context
+	bool linearflux;							///< Whether the flux is linear in the state; decides the domain quadrature strength
 	Quadrature1D* bquad;						///< Boundary quadrature context
 	LagrangeMapping2D* map2d;					///< Array containing geometric mapping data for each element
 	LagrangeMapping1D* map1d;					///< Array containing geometric mapping data for each face
 	Element** elems;							///< List of finite elements
+	BasisRegistry basisreg;						///< Reference basis sets shared by the Lagrange and orthonormal elements
 	Element* dummyelem;							///< Empty element used for ghost elements
 	FaceElement* faces;							///< List of face elements
 
+	/// Elements grouped by shape and domain quadrature rule
+	/** Each element uses the rule of the [strength](@ref domainQuadratureStrength) its geometric degree needs, 
+	 * so that straight elements are not integrated with the stronger rules that curved elements need.
+	 * The kernels of each group are selected in computeFEData by [getElementKernels](@ref getElementKernels).
+	 */
+	std::vector<ElementGroup> elemgroups;
+	std::vector<int> elemgroup;					///< Index of the [group](@ref elemgroups) of each element
+
+	/// Faces grouped by colour: the faces of colour ic are colourfaces[colour_p[ic]] to colourfaces[colour_p[ic+1]-1]
+	/** No two faces of the same colour share an element, so the face integrals of one colour 
+	 * can be scattered into the residuals of the neighbouring elements concurrently.
+	 */
+	std::vector<a_int> colourfaces;
+	std::vector<a_int> colour_p;				///< Start index of each colour in [colourfaces](@ref colourfaces)
+
+	/// How face integrals are assembled into the residual - scatter ('s') or gather ('g')
+	/** In scatter mode, each face is visited once and adds its contribution to both neighbouring elements,
+	 * one [colour](@ref colourfaces) at a time. In gather mode, each element walks its own faces and 
+	 * only writes to its own residual; the flux at interior faces is then computed twice.
+	 */
+	char residual_mode;
+
+	/// Slots of the [workspace](@ref workspace) for the temporaries of residual computations
+	/** Functions that call one another use different slots for the temporaries they hold across the call.
+	 */
+	enum WorkspaceSlot {
+		WS_LSTATE, WS_RSTATE, WS_FLUX,			///< Left and right states and fluxes at face quadrature points
+		WS_XFLUX, WS_YFLUX, WS_TERM,			///< Fluxes at domain quadrature points and their integrals
+		WS_SOALSTATE, WS_SOARSTATE, WS_SOANORMAL, WS_SOAFLUX	///< Structure-of-arrays copies for batched fluxes
+	};
+
+	/// Scratch matrices of each thread, so that residual computations do not allocate once they have run
+	mutable std::vector<Workspace> workspaces;
+
+	/// Adds workspaces, if needed, for all the threads that the next parallel region may have
+	/** The number of threads can be raised after construction, eg. by omp_set_num_threads, so this is called
+	 * before each parallel region that uses [workspace](@ref workspace). It does nothing inside a parallel region,
+	 * where the workspaces of other threads may be in use.
+	 */
+	void reserveWorkspaces() const {
+#ifdef _OPENMP
+		if(!omp_in_parallel() && static_cast<int>(workspaces.size()) < omp_get_max_threads())
+			workspaces.resize(omp_get_max_threads());
+#endif
+	}
+
+	/// Scratch matrices of the calling thread
+	Workspace& workspace() const {
+#ifdef _OPENMP
+		const size_t ithread = omp_get_thread_num();
+		if(ithread >= workspaces.size()) {
+			std::cout << "! SpatialBase: workspace(): No workspace for thread " << ithread << "!" << std::endl;
+			std::abort();
+		}
+		return workspaces[ithread];
+#else
+		return workspaces[0];
+#endif
+	}
+
 	amat::Array2d<a_real> scalars;				///< Holds density, Mach number and pressure for each mesh point
 	amat::Array2d<a_real> velocities;			///< Holds velocity components for each mesh point
 
@@ -79,11 +182,44 @@ protected:
 
 	/// Sets up geometric maps, elements and mass matrices 
 	void computeFEData();
+
+	/// Approximate memory used by the finite element data (elements, geometric maps, faces and mass matrices), in bytes
+	size_t feDataBytes() const;
+
+	/// Groups all faces (boundary and interior) into [colours](@ref colourfaces) by greedy colouring
+	/** Each face gets the smallest colour not yet taken by another face of either of its elements.
+	 * Within a colour, faces are kept in their original order.
+	 */
+	void computeFaceColouring();
 	
+	/// Kernels to use for integrating over an element
+	const ElementKernels& elementKernels(const a_int iel) const {
+		return elemgroups[elemgroup[iel]].kernels;
+	}
+
+	/// Strength of the domain quadrature for elements with geometric maps of a given degree
+	/** For a linear flux, the volume and mass matrix integrands on straight elements have degree 2p; a nonlinear
+	 * flux adds (at least) another p. On curved elements, the Jacobian determinant in the mass matrix adds 2(q-1)
+	 * for geometric degree q.
+	 */
+	int domainQuadratureStrength(const int geomdegree) const;
+
+	/// Strength of the face quadrature for faces of elements with geometric maps of a given degree
+	/** The integrands have the same degree as the domain integrands of straight elements, plus q-1 on curved faces
+	 * for the length element times the unit normal, whose components are polynomials of degree q-1.
+	 */
+	int faceQuadratureStrength(const int geomdegree) const;
+
+	/// Degree of the geometric map of an element: 1 if its high-order nodes are where its vertices put them, else the mesh degree
+	int elementGeometricDegree(const a_int iel) const;
+
+	/// Sorts the elements into [groups](@ref elemgroups) and creates the domain quadrature rule of each group
+	void computeElementGroups();
+
 	/// Computes the L2 error in a FE function on an element
 	/** \param[in] comp The index of the row of ug whose error is to be computed
 	 */
-	a_real computeElemL2Error2(const int ielem, const int comp, const Matrix& ug, a_real (* const exact)(a_real, a_real, a_real), const double time) const;
+	a_real computeElemL2Error2(const int ielem, const int comp, const ConstMatrixRef& ug, a_real (* const exact)(a_real, a_real, a_real), const double time) const;
 
 	/// Computes the L2 norm of a FE function on an element
 	a_real computeElemL2Norm2(const int ielem, const Vector& ug) const;
@@ -92,46 +228,93 @@ public:
 	/// Constructor
 	/** \param[in] mesh is the mesh context
 	 * \param _p_degree is the polynomial degree for FE basis functions
+	 * \param basistype is the [type of basis](@ref basis_type)
+	 * \param linear_flux should be false if the flux is a nonlinear function of the state
 	 */
-	SpatialBase(const UMesh2dh* mesh, const int _p_degree, char basistype);
+	SpatialBase(const UMesh2dh* mesh, const int _p_degree, char basistype, const bool linear_flux = true);
 
 	virtual ~SpatialBase();
 
 	/// Compute all finite element data, including mass matrix, amd allocates solution, residual and time-step arrays
-	void spatialSetup(std::vector<Matrix>& u, std::vector<Matrix>& res, std::vector<a_real>& mets);
+	/** The solution and residual are zeroed.
+	 */
+	void spatialSetup(DOFVector& u, DOFVector& res, std::vector<a_real>& mets);
 
 	/// Computes L2 norm of the the specified component of some vector quantity w
-	a_real computeL2Norm(const std::vector<Matrix> w, const int comp) const;
+	a_real computeL2Norm(const DOFVector& w, const int comp) const;
 
-	/// Inverse of mass matrix
-	const std::vector<Matrix>& massInv() const {
-		return minv;
-	}
+	/// Multiplies the DOFs of each element by the inverse of the element's mass matrix, in place
+	/** This is a scaling for elements with a [scalar](@ref minvscale) or [diagonal](@ref minvdiag) mass matrix
+	 * and a dense product otherwise.
+	 */
+	void applyMassInverse(DOFVector& r) const;
+
+	/// Adds a times the inverse mass matrix of element iel applied to r[iel] to u[iel]
+	/** Lets explicit time steppers apply the mass inverse and update the solution in one pass over the DOFs,
+	 * leaving r unchanged.
+	 */
+	void addMassInverse(const a_int iel, const a_real a, const DOFVector& r, DOFVector& u) const;
 
 	a_int numTotalDOFs() const { return ntotaldofs; }
 
+	/// Number of face colours
+	int numFaceColours() const { return static_cast<int>(colour_p.size())-1; }
+
+	/// Number of [element groups](@ref elemgroups)
+	int numElementGroups() const { return static_cast<int>(elemgroups.size()); }
+
+	/// Selects [scatter or gather](@ref residual_mode) assembly of face integrals
+	void setResidualMode(const char mode);
+
+	char residualMode() const { return residual_mode; }
+
 	/// Calls functions to add contribution to the RHS, and also compute max time steps
-	virtual void update_residual(const std::vector<Matrix>& u, std::vector<Matrix>& res, std::vector<a_real>& mets) = 0;
+	virtual void update_residual(const DOFVector& u, DOFVector& res, std::vector<a_real>& mets) = 0;
+
+	/// Adds the face and domain integrals of the listed elements to their residuals, and computes their time steps
+	/** Each listed element gathers the integrals over its faces as in [gather mode](@ref residual_mode), so the
+	 * residuals of other elements are not touched and only the DOFs of the listed elements and their face
+	 * neighbours are read. This lets local time stepping evaluate the residual on a part of the mesh.
+	 * As implemented in this class, prints an error and aborts; discretizations that override it should also
+	 * override [hasElementResiduals](@ref hasElementResiduals).
+	 */
+	virtual void update_residual_elements(const DOFVector& u, DOFVector& res, std::vector<a_real>& mets,
+			const a_int *const elements, const a_int nelements);
+
+	/// Whether [update_residual_elements](@ref update_residual_elements) is implemented; false in this class
+	virtual bool hasElementResiduals() const { return false; }
+
+	/// Estimates the spectral radius of the semi-discrete operator \f$ M^{-1} \frac{\partial R}{\partial u} \f$ at u
+	/** Power iteration, with the Jacobian-vector products approximated by finite differences of
+	 * [residuals](@ref update_residual), so each iteration costs one residual evaluation. Since the operator is
+	 * not normal, its dominant eigenvalues may be a complex pair; the estimate is therefore the geometric mean
+	 * of the growth factors over the second half of the iterations rather than the last one.
+	 * \param niter Number of power iterations, at least 1
+	 */
+	a_real estimateSpectralRadius(const DOFVector& u, const int niter);
 
 	/// Adds source term contribution to residual
 	/** As implemented in this class, does nothing.
 	 */
-	virtual void add_source( a_real (*const rhs)(a_real, a_real, a_real), a_real t, std::vector<Matrix>& res);
+	virtual void add_source( a_real (*const rhs)(a_real, a_real, a_real), a_real t, DOFVector& res);
 
 	/// Compute quantities to export
-	virtual void postprocess(const std::vector<Matrix>& u) = 0;
+	virtual void postprocess(const DOFVector& u) = 0;
 
 	/// Read-only access to output quantities
 	virtual const amat::Array2d<a_real>& getOutput() const = 0;
 
 	/// Computes the norm of the difference between a FE solution and an analytically defined function
-	a_real computeL2Error(double (*const exact)(double,double,double), const double time, const std::vector<Matrix>& u) const;
+	a_real computeL2Error(double (*const exact)(double,double,double), const double time, const DOFVector& u) const;
 
 	/// Sets initial conditions using a function describing a variable
-	void setInitialConditionNodal( const int comp, double (**const init)(a_real, a_real), std::vector<Matrix>& u);
+	void setInitialConditionNodal( const int comp, double (**const init)(a_real, a_real), DOFVector& u);
 
 	/// Sets initial conditions using functions for a variable and its space derivatives
-	void setInitialConditionModal( const int comp, double (**const init)(a_real, a_real), std::vector<Matrix>& u);
+	void setInitialConditionModal( const int comp, double (**const init)(a_real, a_real), DOFVector& u);
+
+	/// Sets initial conditions by L2 projection of a function describing a variable; works with any basis
+	void setInitialConditionProjection( const int comp, double (*const init)(a_real, a_real), DOFVector& u);
 };
 
 }	// end namespace
@@ -5,12 +5,15 @@
  */
 
 #include "aspatialadvection.hpp"
+#include <type_traits>
 
 namespace acfd {
 
-LinearAdvection::LinearAdvection(const UMesh2dh* mesh, const int _p_degree, const char basis, const Vector vel,
+template <class Flux>
+LinearAdvectionDG<Flux>::LinearAdvectionDG(const UMesh2dh* mesh, const int _p_degree, const char basis, const Vector vel,
 		const int inoutflag, const int extrapflag, a_real (*const bounfunc)(const a_real, const a_real))
-	: SpatialBase(mesh, _p_degree, basis), a(vel), inoutflow_flag(inoutflag), extrapolation_flag(extrapflag), bcfunc(bounfunc)
+	: SpatialBase(mesh, _p_degree, basis), a(vel), rflux(vel), inoutflow_flag(inoutflag), extrapolation_flag(extrapflag), bcfunc(bounfunc),
+	  quadfree(false)
 {
 	std::cout << " LinearAdvection: Velocity is (" << a(0) << ", " << a(1) << ")\n";
 	if(a.rows() != NDIM)
@@ -18,7 +21,8 @@ LinearAdvection::LinearAdvection(const UMesh2dh* mesh, const int _p_degree, cons
 	amag = std::sqrt(a[0]*a[0]+a[1]*a[1]);
 }
 
-void LinearAdvection::computeBoundaryState(const int iface, const Matrix& instate, Matrix& bstate)
+template <class Flux>
+void LinearAdvectionDG<Flux>::computeBoundaryState(const int iface, const Matrix& instate, Matrix& bstate)
 {
 	if(m->gintfacbtags(iface, 0) == inoutflow_flag)
 	{
@@ -39,109 +43,445 @@ void LinearAdvection::computeBoundaryState(const int iface, const Matrix& instat
 	}
 }
 
-void LinearAdvection::computeNumericalFlux(const a_real* const uleft, const a_real* const uright, const a_real* const n, a_real* const flux)
+template <class Flux>
+void LinearAdvectionDG<Flux>::boundaryFaceIntegral(const a_int iface, const DOFVector& u, DOFVector& res)
 {
-	a_real adotn = a[0]*n[0]+a[1]*n[1];
-	if(adotn >= 0)
-		flux[0] = adotn*uleft[0];
-	else
-		flux[0] = adotn*uright[0];
+	a_int lelem = m->gintfac(iface,0);
+	int ng = map1d[iface].getQuadrature()->numGauss();
+	const std::vector<Vector>& n = map1d[iface].normal();
+	MatrixMap lres = res[lelem];
+
+	Workspace& ws = workspace();
+	Matrix& linterps = ws.matrix(WS_LSTATE, ng, NVARS);
+	Matrix& rinterps = ws.matrix(WS_RSTATE, ng, NVARS);
+	Matrix& fluxes = ws.matrix(WS_FLUX, ng, NVARS);
+	
+	faces[iface].interpolateAll_left(u[lelem], linterps);
+	computeBoundaryState(iface, linterps, rinterps);
+
+	for(int ig = 0; ig < ng; ig++)
+	{
+		a_real weightandsp = map1d[iface].getQuadrature()->weights()(ig) * map1d[iface].speed()[ig];
+
+		rflux.get_flux(&linterps(ig,0), &rinterps(ig,0), &n[ig](0), &fluxes(ig,0));
+
+		for(int ivar = 0; ivar < NVARS; ivar++)
+			fluxes(ig,ivar) *= weightandsp;
+	}
+
+	faces[iface].integrateAll_left(fluxes, 1.0, lres);
+}
+
+template <class Flux>
+void LinearAdvectionDG<Flux>::interiorFaceFluxes(const a_int iface, const DOFVector& u, Matrix& fluxes)
+{
+	a_int lelem = m->gintfac(iface,0);
+	a_int relem = m->gintfac(iface,1);
+	int ng = map1d[iface].getQuadrature()->numGauss();
+	const std::vector<Vector>& n = map1d[iface].normal();
+
+	Workspace& ws = workspace();
+	Matrix& linterps = ws.matrix(WS_LSTATE, ng, NVARS);
+	Matrix& rinterps = ws.matrix(WS_RSTATE, ng, NVARS);
+	
+	faces[iface].interpolateAll_left(u[lelem], linterps);
+	faces[iface].interpolateAll_right(u[relem], rinterps);
+
+	for(int ig = 0; ig < ng; ig++)
+	{
+		a_real weightandsp = map1d[iface].getQuadrature()->weights()(ig) * map1d[iface].speed()[ig];
+
+		rflux.get_flux(&linterps(ig,0), &rinterps(ig,0), &n[ig](0), &fluxes(ig,0));
+
+		for(int ivar = 0; ivar < NVARS; ivar++)
+			fluxes(ig,ivar) *= weightandsp;
+	}
 }
 
-void LinearAdvection::update_residual(const std::vector<Matrix>& u, std::vector<Matrix>& res, std::vector<a_real>& mets)
+template <class Flux>
+void LinearAdvectionDG<Flux>::interiorFaceIntegral(const a_int iface, const DOFVector& u, DOFVector& res)
 {
-	for(a_int iface = 0; iface < m->gnbface(); iface++)
+	a_int lelem = m->gintfac(iface,0);
+	a_int relem = m->gintfac(iface,1);
+	int ng = map1d[iface].getQuadrature()->numGauss();
+	MatrixMap lres = res[lelem], rres = res[relem];
+
+	Matrix& fluxes = workspace().matrix(WS_FLUX, ng, NVARS);
+	interiorFaceFluxes(iface, u, fluxes);
+
+	faces[iface].integrateAll_left(fluxes, 1.0, lres);
+	faces[iface].integrateAll_right(fluxes, -1.0, rres);
+}
+
+template <class Flux>
+void LinearAdvectionDG<Flux>::gatherFaceIntegrals(const a_int iel, const DOFVector& u, DOFVector& res)
+{
+	MatrixMap eres = res[iel];
+	for(int ifa = 0; ifa < m->gnfael(iel); ifa++)
 	{
-		a_int lelem = m->gintfac(iface,0);
+		const a_int iface = m->gelemface(iel,ifa);
+		if(iface < m->gnbface()) {
+			if(quadfree)
+				quadratureFreeBoundaryFaceIntegral(iface, u, res);
+			else
+				boundaryFaceIntegral(iface, u, res);
+			continue;
+		}
+
+		if(quadfree) {
+			quadratureFreeInteriorFaceIntegral(iface, u, m->gintfac(iface,0) == iel, m->gintfac(iface,1) == iel, res);
+			continue;
+		}
+
+		// the flux is computed with the face's own left and right states, so both elements see the same value
 		int ng = map1d[iface].getQuadrature()->numGauss();
-		const std::vector<Vector>& n = map1d[iface].normal();
-		const Matrix& lbasis = faces[iface].leftBasis();
+		Matrix& fluxes = workspace().matrix(WS_FLUX, ng, NVARS);
+		interiorFaceFluxes(iface, u, fluxes);
 
-		Matrix linterps(ng,NVARS), rinterps(ng,NVARS);
-		Matrix fluxes(ng,NVARS);
-		
-		faces[iface].interpolateAll_left(u[lelem], linterps);
-		computeBoundaryState(iface, linterps, rinterps);
+		if(m->gintfac(iface,0) == iel)
+			faces[iface].integrateAll_left(fluxes, 1.0, eres);
+		else
+			faces[iface].integrateAll_right(fluxes, -1.0, eres);
+	}
+}
 
-		for(int ig = 0; ig < ng; ig++)
+/** The Jacobian is constant on an affine element, so the contravariant advection velocity \f$ J^{-1} a \f$
+ * and the Jacobian determinant are applied once per element rather than at each quadrature point.
+ */
+template <class Flux>
+void LinearAdvectionDG<Flux>::affineDomainIntegral(const a_int iel, const DOFVector& u, DOFVector& res)
+{
+	const int ng = map2d[iel].getQuadrature()->numGauss();
+	const int ndofs = elems[iel]->getNumDOFs();
+	const amat::Array2d<a_real>& wts = map2d[iel].getQuadrature()->weights();
+	const MatrixDim& jinv = map2d[iel].jacInv(0);
+	const a_real jdet = map2d[iel].jacDet(0);
+
+	const a_real ax = (jinv(0,0)*a[0] + jinv(0,1)*a[1]) * jdet;
+	const a_real ay = (jinv(1,0)*a[0] + jinv(1,1)*a[1]) * jdet;
+
+	const BasisSet& bs = *elems[iel]->basisSet();
+	const ElementKernels& kern = elementKernels(iel);
+
+	Workspace& ws = workspace();
+	Matrix& xflux = ws.matrix(WS_XFLUX, ng, NVARS);
+	Matrix& yflux = ws.matrix(WS_YFLUX, ng, NVARS);
+	kern.interpolate(bs, u[iel], xflux);
+	for(int ig = 0; ig < ng; ig++)
+		for(int ivar = 0; ivar < NVARS; ivar++)
 		{
-			a_real weightandsp = map1d[iface].getQuadrature()->weights()(ig) * map1d[iface].speed()[ig];
+			const a_real wu = xflux(ig,ivar) * wts(ig);
+			xflux(ig,ivar) = ax*wu;
+			yflux(ig,ivar) = ay*wu;
+		}
 
-			computeNumericalFlux(&linterps(ig,0), &rinterps(ig,0), &n[ig](0), &fluxes(ig,0));
+	Matrix& term = ws.matrix(WS_TERM, NVARS, ndofs);
+	term.setZero();
+	kern.integrateGradients(bs, xflux, yflux, term);
+	res[iel] -= term;
+}
 
-			for(int ivar = 0; ivar < NVARS; ivar++) {
-				for(int idof = 0; idof < elems[lelem]->getNumDOFs(); idof++)
-					res[lelem](ivar,idof) += fluxes(ig,ivar) * lbasis(ig,idof) * weightandsp;
-			}
+template <class Flux>
+void LinearAdvectionDG<Flux>::quadratureFreeBoundaryFaceIntegral(const a_int iface, const DOFVector& u, DOFVector& res)
+{
+	const a_int lelem = m->gintfac(iface,0);
+	MatrixMap lres = res[lelem];
+	if(qfinflow[iface].size() > 0)
+		lres.row(0) += qfinflow[iface].transpose();
+	else
+		lres.noalias() += qffacecoef[iface] * (u[lelem]*qffacemats[qffaceindex.get(iface,0)]);
+}
+
+/** The upwind flux is the normal speed times the state of the upwind element, so each contribution is
+ * the upwind element's DOFs times a face mass matrix (or its transpose).
+ */
+template <class Flux>
+void LinearAdvectionDG<Flux>::quadratureFreeInteriorFaceIntegral(const a_int iface, const DOFVector& u, 
+		const bool toleft, const bool toright, DOFVector& res)
+{
+	const a_int lelem = m->gintfac(iface,0);
+	const a_int relem = m->gintfac(iface,1);
+	const a_real c = qffacecoef[iface];
+	const Matrix& lrmat = qffacemats[qffaceindex.get(iface,2)];
+	MatrixMap lres = res[lelem], rres = res[relem];
+
+	if(c >= 0) {
+		if(toleft)
+			lres.noalias() += c * (u[lelem]*qffacemats[qffaceindex.get(iface,0)]);
+		if(toright)
+			rres.noalias() -= c * (u[lelem]*lrmat);
+	}
+	else {
+		if(toleft)
+			lres.noalias() += c * (u[relem]*lrmat.transpose());
+		if(toright)
+			rres.noalias() -= c * (u[relem]*qffacemats[qffaceindex.get(iface,1)]);
+	}
+}
+
+template <class Flux>
+void LinearAdvectionDG<Flux>::quadratureFreeDomainIntegral(const a_int iel, const DOFVector& u, DOFVector& res)
+{
+	const Shape shape = map2d[iel].getShape();
+	const MatrixDim& jinv = map2d[iel].jacInv(0);
+	const a_real jdet = map2d[iel].jacDet(0);
+
+	const a_real ax = (jinv(0,0)*a[0] + jinv(0,1)*a[1]) * jdet;
+	const a_real ay = (jinv(1,0)*a[0] + jinv(1,1)*a[1]) * jdet;
+
+	MatrixMap eres = res[iel];
+	eres.noalias() -= ax * (u[iel]*qfvolx[shape]);
+	eres.noalias() -= ay * (u[iel]*qfvoly[shape]);
+}
+
+/// Returns the index of the matrix lbasis^T W rbasis in mats, adding it if it is not there yet
+/** Matrices are identified by the addresses of the (shared) face basis tables they are computed from.
+ */
+static int findFaceMassMatrix(const Matrix& lbasis, const Matrix& rbasis, const amat::Array2d<a_real>& wts,
+		std::vector<std::pair<const Matrix*,const Matrix*>>& keys, std::vector<Matrix>& mats)
+{
+	for(size_t i = 0; i < keys.size(); i++)
+		if(keys[i].first == &lbasis && keys[i].second == &rbasis)
+			return static_cast<int>(i);
+
+	Matrix wrbasis = rbasis;
+	for(int ig = 0; ig < wrbasis.rows(); ig++)
+		wrbasis.row(ig) *= wts(ig);
+	keys.push_back(std::make_pair(&lbasis, &rbasis));
+	mats.push_back(lbasis.transpose()*wrbasis);
+	return static_cast<int>(mats.size())-1;
+}
+
+template <class Flux>
+bool LinearAdvectionDG<Flux>::setQuadratureFree(const bool flag)
+{
+	quadfree = false;
+	qffacemats.clear();
+	qffacecoef.clear();
+	qfinflow.clear();
+	for(int is = 0; is < 3; is++) {
+		qfvolx[is].resize(0,0);
+		qfvoly[is].resize(0,0);
+	}
+	if(!flag)
+		return false;
+
+	if(!std::is_same<Flux,UpwindAdvectionFlux>::value) {
+		std::cout << " LinearAdvection: setQuadratureFree(): The face matrices assume the upwind flux; using quadrature.\n";
+		return false;
+	}
+	if(minv.size() == 0) {
+		std::cout << "! LinearAdvection: setQuadratureFree(): Finite element data has not been computed yet!\n";
+		return false;
+	}
+
+	// every element must be affine with a reference basis, shared by all elements of its shape
+	a_int shapeelem[3] = {-1, -1, -1};
+	for(a_int iel = 0; iel < m->gnelem(); iel++)
+	{
+		const Shape shape = map2d[iel].getShape();
+		if(!map2d[iel].isAffine() || elems[iel]->getType() != REFERENTIAL || !elems[iel]->basisSet()) {
+			std::cout << " LinearAdvection: setQuadratureFree(): Element " << iel 
+				<< " is curved or has a physical-space basis; using quadrature.\n";
+			return false;
+		}
+		if(shapeelem[shape] < 0)
+			shapeelem[shape] = iel;
+		else if(elems[shapeelem[shape]]->basisSet() != elems[iel]->basisSet()) {
+			std::cout << " LinearAdvection: setQuadratureFree(): Elements do not share basis sets; using quadrature.\n";
+			return false;
 		}
 	}
-	
-	for(a_int iface = m->gnbface(); iface < m->gnaface(); iface++)
+
+	for(int is = 0; is < 3; is++)
 	{
-		a_int lelem = m->gintfac(iface,0);
-		a_int relem = m->gintfac(iface,1);
-		int ng = map1d[iface].getQuadrature()->numGauss();
-		const std::vector<Vector>& n = map1d[iface].normal();
-		const Matrix& lbasis = faces[iface].leftBasis();
-		const Matrix& rbasis = faces[iface].rightBasis();
+		if(shapeelem[is] < 0) continue;
+		const BasisSet& bs = *elems[shapeelem[is]]->basisSet();
+		const amat::Array2d<a_real>& wts = map2d[shapeelem[is]].getQuadrature()->weights();
+		const int ndofs = bs.basis.cols();
+		qfvolx[is] = Matrix::Zero(ndofs,ndofs);
+		qfvoly[is] = Matrix::Zero(ndofs,ndofs);
+		for(int ig = 0; ig < bs.basis.rows(); ig++)
+			for(int j = 0; j < ndofs; j++)
+				for(int i = 0; i < ndofs; i++) {
+					qfvolx[is](j,i) += wts(ig) * bs.basis(ig,j) * bs.basisGrad[ig](i,0);
+					qfvoly[is](j,i) += wts(ig) * bs.basis(ig,j) * bs.basisGrad[ig](i,1);
+				}
+	}
 
-		Matrix linterps(ng,NVARS), rinterps(ng,NVARS);
-		Matrix fluxes(ng,NVARS);
-		
-		faces[iface].interpolateAll_left(u[lelem], linterps);
-		faces[iface].interpolateAll_right(u[relem], rinterps);
+	// faces are straight, so the normal and speed are the same at every quadrature point
+	const a_real tol = 1e3*SMALL_NUMBER;
+	std::vector<std::pair<const Matrix*,const Matrix*>> keys;
+	qffaceindex.setup(m->gnaface(), 3);
+	qffacecoef.resize(m->gnaface());
+	qfinflow.resize(m->gnbface());
+	for(a_int iface = 0; iface < m->gnaface(); iface++)
+	{
+		const std::vector<Vector>& n = map1d[iface].normal();
+		const std::vector<a_real>& speed = map1d[iface].speed();
+		const amat::Array2d<a_real>& wts = map1d[iface].getQuadrature()->weights();
+		const bool boundary = iface < m->gnbface();
+		for(size_t ig = 1; ig < n.size(); ig++)
+			if((n[ig]-n[0]).norm() > tol || std::fabs(speed[ig]-speed[0]) > tol*speed[0]) {
+				std::cout << " LinearAdvection: setQuadratureFree(): Face " << iface << " is curved; using quadrature.\n";
+				return false;
+			}
+		if(!faces[iface].sharesLeftBasis() || (!boundary && !faces[iface].sharesRightBasis())) {
+			std::cout << " LinearAdvection: setQuadratureFree(): Face bases are not shared; using quadrature.\n";
+			return false;
+		}
 
-		for(int ig = 0; ig < ng; ig++)
+		const FaceElement& face = faces[iface];
+		qffacecoef[iface] = a.dot(n[0]) * speed[0];
+		qffaceindex(iface,0) = findFaceMassMatrix(face.leftBasis(), face.leftBasis(), wts, keys, qffacemats);
+		if(boundary)
 		{
-			a_real weightandsp = map1d[iface].getQuadrature()->weights()(ig) * map1d[iface].speed()[ig];
+			qffaceindex(iface,1) = qffaceindex(iface,2) = -1;
+			if(m->gintfacbtags(iface,0) == inoutflow_flag && qffacecoef[iface] < 0)
+			{
+				const Matrix& phypoints = map1d[iface].map();
+				qfinflow[iface] = Vector::Zero(face.leftBasis().cols());
+				for(int ig = 0; ig < wts.rows(); ig++)
+					qfinflow[iface] += qffacecoef[iface] * wts(ig) * bcfunc(phypoints(ig,0), phypoints(ig,1))
+						* face.leftBasis().row(ig).transpose();
+			}
+		}
+		else {
+			qffaceindex(iface,1) = findFaceMassMatrix(face.rightBasis(), face.rightBasis(), wts, keys, qffacemats);
+			qffaceindex(iface,2) = findFaceMassMatrix(face.leftBasis(), face.rightBasis(), wts, keys, qffacemats);
+		}
+	}
 
-			computeNumericalFlux(&linterps(ig,0), &rinterps(ig,0), &n[ig](0), &fluxes(ig,0));
+	quadfree = true;
+	std::cout << " LinearAdvection: setQuadratureFree(): Using quadrature-free residuals with " << qffacemats.size() 
+		<< " distinct face mass matrices\n";
+	return true;
+}
 
+template <class Flux>
+void LinearAdvectionDG<Flux>::domainIntegral(const a_int iel, const DOFVector& u, DOFVector& res, std::vector<a_real>& mets)
+{
+	if(p_degree > 0 && quadfree)
+		quadratureFreeDomainIntegral(iel, u, res);
+
+	else if(p_degree > 0 && map2d[iel].isAffine() && elems[iel]->getType() == REFERENTIAL)
+		affineDomainIntegral(iel, u, res);
+
+	else if(p_degree > 0) {	
+		int ng = map2d[iel].getQuadrature()->numGauss();
+		int ndofs = elems[iel]->getNumDOFs();
+		const BasisSet& bs = *elems[iel]->basisSet();
+		const ElementKernels& kern = elementKernels(iel);
+
+		Workspace& ws = workspace();
+		Matrix& xflux = ws.matrix(WS_XFLUX, ng, NVARS);
+		Matrix& yflux = ws.matrix(WS_YFLUX, ng, NVARS);
+		kern.interpolate(bs, u[iel], xflux);
+		yflux = a[1]*xflux;
+		xflux *= a[0];
+		Matrix& term = ws.matrix(WS_TERM, NVARS, ndofs);
+		term.setZero();
+
+		/* For reference-space bases, the gradients are w.r.t. reference coordinates. Instead of transforming them
+		 * to physical space, we transform the flux to its contravariant form J^{-1} F.
+		 */
+		if(elems[iel]->getType() == REFERENTIAL)
+		{
+			for(int ig = 0; ig < ng; ig++) {
+				const MatrixDim& jinv = map2d[iel].jacInv(ig);
+				for(int ivar = 0; ivar < NVARS; ivar++) {
+					const a_real fx = xflux(ig,ivar), fy = yflux(ig,ivar);
+					xflux(ig,ivar) = jinv(0,0)*fx + jinv(0,1)*fy;
+					yflux(ig,ivar) = jinv(1,0)*fx + jinv(1,1)*fy;
+				}
+			}
+		}
+
+		for(int ig = 0; ig < ng; ig++)
+		{
+			a_real weightjacdet = map2d[iel].jacDet(ig) * map2d[iel].getQuadrature()->weights()(ig);
 			for(int ivar = 0; ivar < NVARS; ivar++) {
-				for(int idof = 0; idof < elems[lelem]->getNumDOFs(); idof++)
-					res[lelem](ivar,idof) += fluxes(ig,ivar) * lbasis(ig,idof) * weightandsp;
-				for(int idof = 0; idof < elems[relem]->getNumDOFs(); idof++)
-					res[relem](ivar,idof) -= fluxes(ig,ivar) * rbasis(ig,idof) * weightandsp;
+				xflux(ig,ivar) *= weightjacdet;
+				yflux(ig,ivar) *= weightjacdet;
 			}
 		}
+
+		kern.integrateGradients(bs, xflux, yflux, term);
+		res[iel] -= term;
 	}
+	
+	a_real hsize = 1.0;
 
-	for(a_int iel = 0; iel < m->gnelem(); iel++)
+	for(int ifa = 0; ifa < m->gnfael(iel); ifa++) {
+		a_int iface = m->gelemface(iel,ifa);
+		if(hsize > m->gedgelengthsquared(iface)) hsize = m->gedgelengthsquared(iface);
+	}
+
+	mets[iel] = std::sqrt(hsize)/amag;
+}
+
+template <class Flux>
+void LinearAdvectionDG<Flux>::update_residual(const DOFVector& u, DOFVector& res, std::vector<a_real>& mets)
+{
+	reserveWorkspaces();
+	if(residual_mode == 'g')
 	{
-		if(p_degree > 0) {	
-			int ng = map2d[iel].getQuadrature()->numGauss();
-			int ndofs = elems[iel]->getNumDOFs();
-			const std::vector<Matrix>& bgrads = elems[iel]->bGrad();
-
-			Matrix xflux(ng, NVARS), yflux(ng, NVARS);
-			elems[iel]->interpolateAll(u[iel], xflux);
-			yflux = a[1]*xflux;
-			xflux *= a[0];
-			Matrix term = Matrix::Zero(NVARS, ndofs);
-
-			for(int ig = 0; ig < ng; ig++)
+#pragma omp parallel for default(shared) schedule(static)
+		for(a_int iel = 0; iel < m->gnelem(); iel++)
+		{
+			gatherFaceIntegrals(iel, u, res);
+			domainIntegral(iel, u, res, mets);
+		}
+		return;
+	}
+
+#pragma omp parallel default(shared)
+	{
+		for(int icol = 0; icol < numFaceColours(); icol++)
+		{
+#pragma omp for schedule(static)
+			for(a_int ic = colour_p[icol]; ic < colour_p[icol+1]; ic++)
 			{
-				a_real weightjacdet = map2d[iel].jacDet()[ig] * map2d[iel].getQuadrature()->weights()(ig);
-				for(int ivar = 0; ivar < NVARS; ivar++)
-					for(int idof = 0; idof < ndofs; idof++)
-						term(ivar,idof) += (xflux(ig,ivar)*bgrads[ig](idof,0) + yflux(ig,ivar)*bgrads[ig](idof,1)) * weightjacdet;
+				const a_int iface = colourfaces[ic];
+				if(quadfree) {
+					if(iface < m->gnbface())
+						quadratureFreeBoundaryFaceIntegral(iface, u, res);
+					else
+						quadratureFreeInteriorFaceIntegral(iface, u, true, true, res);
+				}
+				else if(iface < m->gnbface())
+					boundaryFaceIntegral(iface, u, res);
+				else
+					interiorFaceIntegral(iface, u, res);
 			}
-
-			res[iel] -= term;
 		}
-		
-		a_real hsize = 1.0;
 
-		for(int ifa = 0; ifa < m->gnfael(iel); ifa++) {
-			a_int iface = m->gelemface(iel,ifa);
-			if(hsize > m->gedgelengthsquared(iface)) hsize = m->gedgelengthsquared(iface);
+		// element by element within each group, so that consecutive elements use the same kernels and basis set
+		for(size_t igr = 0; igr < elemgroups.size(); igr++)
+		{
+			const std::vector<a_int>& grpelems = elemgroups[igr].elements;
+#pragma omp for schedule(static)
+			for(a_int i = 0; i < static_cast<a_int>(grpelems.size()); i++)
+				domainIntegral(grpelems[i], u, res, mets);
 		}
+	}
+}
 
-		mets[iel] = std::sqrt(hsize)/amag;
+template <class Flux>
+void LinearAdvectionDG<Flux>::update_residual_elements(const DOFVector& u, DOFVector& res, std::vector<a_real>& mets,
+		const a_int *const elements, const a_int nelements)
+{
+	reserveWorkspaces();
+#pragma omp parallel for default(shared) schedule(static)
+	for(a_int i = 0; i < nelements; i++)
+	{
+		gatherFaceIntegrals(elements[i], u, res);
+		domainIntegral(elements[i], u, res, mets);
 	}
 }
 
-void LinearAdvection::add_source( a_real (*const rhs)(a_real, a_real, a_real), a_real t, std::vector<Matrix>& res)
+template <class Flux>
+void LinearAdvectionDG<Flux>::add_source( a_real (*const rhs)(a_real, a_real, a_real), a_real t, DOFVector& res)
 {
 	for(a_int iel = 0; iel < m->gnelem(); iel++)
 	{
@@ -149,21 +489,20 @@ void LinearAdvection::add_source( a_real (*const rhs)(a_real, a_real, a_real), a
 		int ndofs = elems[iel]->getNumDOFs();
 		const Matrix& bas = elems[iel]->bFunc();
 		const Matrix& pts = elems[iel]->getGeometricMapping()->map();
-		Matrix term = Matrix::Zero(NVARS, ndofs);
+		MatrixMap eres = res[iel];
 
 		for(int ig = 0; ig < ng; ig++)
 		{
-			a_real weightjacdet = map2d[iel].jacDet()[ig] * map2d[iel].getQuadrature()->weights()(ig);
+			a_real weightjacdet = map2d[iel].jacDet(ig) * map2d[iel].getQuadrature()->weights()(ig);
 			for(int idof = 0; idof < ndofs; idof++)
-				term(0,idof) += rhs(pts(ig,0),pts(ig,1),t) * bas(ig,idof) * weightjacdet;
+				eres(0,idof) -= rhs(pts(ig,0),pts(ig,1),t) * bas(ig,idof) * weightjacdet;
 		}
-
-		res[iel] -= term;
 	}
 }
 
 // very crude
-void LinearAdvection::postprocess(const std::vector<Matrix>& u)
+template <class Flux>
+void LinearAdvectionDG<Flux>::postprocess(const DOFVector& u)
 {
 	output.resize(m->gnpoin(),1);
 	output.zeros();
@@ -171,22 +510,36 @@ void LinearAdvection::postprocess(const std::vector<Matrix>& u)
 
 	for(int iel = 0; iel < m->gnelem(); iel++)
 	{
-		if(basis_type == 'l')
+		if(basis_type != 't')
 		{
-			//int ndofs = elems[iel]->getNumDOFs();
+			// values at the vertices; for bases other than Lagrange, evaluate at the reference vertices
+			const int nv = m->gnfael(iel);
+			Vector vvals(nv);
+			if(basis_type == 'l')
+				vvals = u[iel].row(0).head(nv).transpose();
+			else {
+				Matrix refverts(nv,NDIM), bvals(nv,elems[iel]->getNumDOFs());
+				if(nv == 3)
+					refverts << 0,0, 1,0, 0,1;
+				else
+					refverts << -1,-1, 1,-1, 1,1, -1,1;
+				elems[iel]->computeBasis(refverts, bvals);
+				vvals = bvals*u[iel].row(0).transpose();
+			}
+
 			for(int ino = 0; ino < m->gnfael(iel); ino++) {
-				output(m->ginpoel(iel,ino)) += u[iel](0,ino);
+				output(m->ginpoel(iel,ino)) += vvals(ino);
 				surelems[m->ginpoel(iel,ino)] += 1;
 			}
 			if(m->gnnode(iel) > m->gnfael(iel)) {
 				for(int ino = m->gnfael(iel); ino < 2*m->gnfael(iel); ino++) {
-					output(m->ginpoel(iel,ino)) += (u[iel](0,ino-m->gnfael(iel)) + u[iel](0, (ino-m->gnfael(iel)+1) % m->gnfael(iel)))/2.0;
+					output(m->ginpoel(iel,ino)) += (vvals(ino-m->gnfael(iel)) + vvals((ino-m->gnfael(iel)+1) % m->gnfael(iel)))/2.0;
 					surelems[m->ginpoel(iel,ino)] += 1;
 				}
 				// for interior nodes, just use average of vertices
 				for(int ino = 2*m->gnfael(iel); ino < m->gnnode(iel); ino++) {
 					for(int jno = 0; jno < m->gnfael(iel); jno++)
-						output(m->ginpoel(iel,ino)) += u[iel](0,jno);
+						output(m->ginpoel(iel,ino)) += vvals(jno);
 					output(m->ginpoel(iel,ino)) /= m->gnfael(iel);
 					surelems[m->ginpoel(iel,ino)] += 1;
 				}
@@ -204,4 +557,6 @@ void LinearAdvection::postprocess(const std::vector<Matrix>& u)
 		output(ip) /= (a_real)surelems[ip];
 }
 
+template class LinearAdvectionDG<UpwindAdvectionFlux>;
+
 }
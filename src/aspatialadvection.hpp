@@ -13,15 +13,36 @@
 
 namespace acfd {
 
-/// Residual computation for linear advection
+/// Upwind numerical flux for linear advection with a constant velocity
+class UpwindAdvectionFlux final
+{
+	Vector a;								///< Advection velocity
+
+public:
+	UpwindAdvectionFlux(const Vector& vel) : a(vel) { }
+
+	/// Computes the flux across a face with unit normal n from its left state to its right state
+	void get_flux(const a_real *const uleft, const a_real *const uright, const a_real *const n, a_real *const flux) {
+		const a_real adotn = a[0]*n[0]+a[1]*n[1];
+		flux[0] = adotn >= 0 ? adotn*uleft[0] : adotn*uright[0];
+	}
+};
+
+/// Residual computation for linear advection, with the numerical flux Flux
 /** \note Make sure to call both compute_topological and compute_boundary_maps on the mesh object before using an object of this class!
  *
  * If the ODE is \f$ \frac{du}{dt} + R(u) = 0 \f$, [res](@ref res) holds \f$ R \f$.
+ *
+ * As for CompressibleEuler, the flux is a template parameter so that the face loops call it directly.
+ * Flux is constructed from the advection velocity and has the get_flux member of the Euler fluxes.
+ * Only the upwind flux is instantiated, as [LinearAdvection](@ref LinearAdvection).
  */
-class LinearAdvection : public SpatialBase<1>
+template <class Flux>
+class LinearAdvectionDG : public SpatialBase<1>
 {
 protected:
 	Vector a;								///< Advection velocity
+	Flux rflux;								///< Numerical flux
 	a_real amag;							///< Magnitude of advection velocity
 
 	int inoutflow_flag;						///< Boundary flag at faces where inflow or outflow is required
@@ -31,27 +52,98 @@ protected:
 	/// Pointer to function describing the boundary value
 	a_real (*const bcfunc)(const a_real, const a_real);
 
-	/// Computes upwind flux
-	void computeNumericalFlux(const a_real* const uleft, const a_real* const uright, const a_real* const n, a_real* const flux);
+	/// Whether the residual is computed without quadrature; see [setQuadratureFree](@ref setQuadratureFree)
+	bool quadfree;
+
+	/// For each shape, reference convection matrices for the quadrature-free mode, transposed (ndofs x ndofs)
+	/** Entry (j,i) of qfvolx is the integral over the reference element of basis function j times 
+	 * the derivative of test function i w.r.t. the first reference coordinate; likewise for qfvoly.
+	 */
+	Matrix qfvolx[3];
+	Matrix qfvoly[3];						///< See [qfvolx](@ref qfvolx)
+
+	/// Distinct face mass matrices, which only depend on the face traces of the two elements of a face
+	std::vector<Matrix> qffacemats;
+
+	/// For each face, indices into [qffacemats](@ref qffacemats) of the left-left, right-right and left-right matrices
+	amat::Array2d<int> qffaceindex;
+
+	/// For each face, the normal advection speed times the face speed (both are constant on straight faces)
+	std::vector<a_real> qffacecoef;
+
+	/// For inflow boundary faces, the inflow flux integrated against the test functions; empty for other faces
+	std::vector<Vector> qfinflow;
 
 	/// Computes face integrals from flow state described by the parameter
-	void computeFaceTerms(const std::vector<Matrix>& u);
+	void computeFaceTerms(const DOFVector& u);
+
+	/// Adds the integral over a boundary face to the residual of its element
+	void boundaryFaceIntegral(const a_int iface, const DOFVector& u, DOFVector& res);
+
+	/// Computes the numerical flux at each quadrature point of an interior face, scaled by the quadrature weight and face speed
+	void interiorFaceFluxes(const a_int iface, const DOFVector& u, Matrix& fluxes);
+
+	/// Adds the integral over an interior face to the residuals of both its elements
+	void interiorFaceIntegral(const a_int iface, const DOFVector& u, DOFVector& res);
+
+	/// Adds the integrals over all faces of an element to its residual, and to no other
+	void gatherFaceIntegrals(const a_int iel, const DOFVector& u, DOFVector& res);
+
+	/// Adds the domain integral over an affine element with a reference-space basis to its residual
+	void affineDomainIntegral(const a_int iel, const DOFVector& u, DOFVector& res);
+
+	/// Adds the domain integral over an element to its residual using the reference convection matrices
+	void quadratureFreeDomainIntegral(const a_int iel, const DOFVector& u, DOFVector& res);
+
+	/// Adds the integral over a boundary face to the residual of its element using the face mass matrix
+	void quadratureFreeBoundaryFaceIntegral(const a_int iface, const DOFVector& u, DOFVector& res);
+
+	/// Adds the integral over an interior face to the residuals of its left and/or right element using face mass matrices
+	void quadratureFreeInteriorFaceIntegral(const a_int iface, const DOFVector& u, const bool toleft, const bool toright,
+			DOFVector& res);
+
+	/// Adds the domain integral over an element to its residual and computes its time step
+	void domainIntegral(const a_int iel, const DOFVector& u, DOFVector& res, std::vector<a_real>& mets);
 
 	/// Computes boundary (ghost) states depending on face marker for the face denoted by the first argument
 	void computeBoundaryState(const int iface, const Matrix& instate, Matrix& bstate);
 
 public:
-	LinearAdvection(const UMesh2dh* mesh, const int _p_degree, const char basis, const Vector vel,
+	LinearAdvectionDG(const UMesh2dh* mesh, const int _p_degree, const char basis, const Vector vel,
 			const int inoutflag, const int extrapflag, a_real (*const bounfunc)(const a_real, const a_real));
 	
 	/// Adds face contributions and computes domain contribution to the [right hand side](@ref residual) 
-	void update_residual(const std::vector<Matrix>& u, std::vector<Matrix>& res, std::vector<a_real>& mets);
+	/** In scatter mode, faces are processed one [colour](@ref SpatialBase::colourfaces) at a time, so that
+	 * the face loop can run in parallel without write conflicts, and the domain integrals are then computed
+	 * one [element group](@ref SpatialBase::elemgroups) at a time. In gather mode, the faces and domain of
+	 * each element are integrated together in one parallel loop over elements.
+	 */
+	void update_residual(const DOFVector& u, DOFVector& res, std::vector<a_real>& mets);
+
+	/// Adds the integrals of the listed elements to their residuals; see SpatialBase::update_residual_elements
+	void update_residual_elements(const DOFVector& u, DOFVector& res, std::vector<a_real>& mets,
+			const a_int *const elements, const a_int nelements);
+
+	bool hasElementResiduals() const { return true; }
+
+	/// Selects quadrature-free computation of the residual, if possible; returns whether it is in use
+	/** Since the flux is linear, on affine elements with a reference-space basis every integral in the residual
+	 * is a reference matrix (volume convection matrices or face mass matrices) applied to the DOFs and scaled 
+	 * by constants of the element or face. These matrices are precomputed here, along with the integrals of 
+	 * the inflow boundary values, so that the residual needs no quadrature or boundary function evaluations.
+	 * The residual is the same as with quadrature, up to round-off.
+	 * \note Call after [spatialSetup](@ref SpatialBase::spatialSetup). The mode is refused if any element is curved
+	 * or has a basis defined in physical space (Taylor), or if the flux is not the upwind flux.
+	 */
+	bool setQuadratureFree(const bool flag);
+
+	bool quadratureFree() const { return quadfree; }
 	
 	/// Adds source term contribution to residual
-	void add_source( a_real (*const rhs)(a_real, a_real, a_real), a_real t, std::vector<Matrix>& res);
+	void add_source( a_real (*const rhs)(a_real, a_real, a_real), a_real t, DOFVector& res);
 
 	/// Compute quantities to export
-	void postprocess(const std::vector<Matrix>& u);
+	void postprocess(const DOFVector& u);
 
 	/// Read-only access to output quantities
 	const amat::Array2d<a_real>& getOutput() const {
@@ -59,5 +151,8 @@ public:
 	}
 };
 
+/// Linear advection with the upwind flux
+typedef LinearAdvectionDG<UpwindAdvectionFlux> LinearAdvection;
+
 }
 #endif
@@ -5,264 +5,402 @@
  */
 
 #include "aspatialeuler.hpp"
+#include <cstdlib>
 
 namespace acfd {
 
-CompressibleEuler::CompressibleEuler(const UMesh2dh* mesh, const int _p_degree, const char basis, const Vector vel, const a_real b_val, const int inoutflag, const int extrapflag)
-	: SpatialBase(mesh, _p_degree, basis), a(vel), bval(b_val), inoutflow_flag(inoutflag), extrapolation_flag(extrapflag)
+Vector eulerFreeStreamState(const a_real gamma, const a_real mach, const a_real alpha, const a_real rho, const a_real speed)
 {
-	std::cout << " CompressibleEuler: (" << ")\n";
-	computeFEData();
-	u.resize(m->gnelem());
-	res.resize(m->gnelem());
-	mets.resize(m->gnelem());
-	for(a_int iel = 0; iel < m->gnelem(); iel++) 
-	{
-		u[iel].resize(NVARS, elems[iel]->getNumDOFs());
-		res[iel].resize(NVARS, elems[iel]->getNumDOFs());
-		for(int i = 0; i < NVARS; i++)
-			for(int j = 0; j < elems[iel]->getNumDOFs(); j++) {
-				u[iel](i,j) = 0.0;
-				res[iel](i,j) = 0;
-			}
-		
-		a_real hsize = 1.0;
-
-		for(int ifa = 0; ifa < m->gnfael(iel); ifa++) {
-			a_int iface = m->gelemface(iel,ifa);
-			if(hsize > m->gedgelengthsquared(iface)) hsize = m->gedgelengthsquared(iface);
-		}
-
-		mets[iel] = std::sqrt(hsize)/amag;
-	}
-
-	leftfaceterms.resize(m->gnaface());
-	rightfaceterms.resize(m->gnaface());
-	for(a_int iface = 0; iface < m->gnaface(); iface++)
-		leftfaceterms[iface].resize(NVARS, elems[m->gintfac(iface,0)]->getNumDOFs());
-	for(a_int iface = m->gnbface(); iface < m->gnaface(); iface++)
-		rightfaceterms[iface].resize(NVARS, elems[m->gintfac(iface,1)]->getNumDOFs());
+	const a_real p = rho*speed*speed/(gamma*mach*mach);
+	Vector u(NEULERVARS);
+	u(0) = rho;
+	u(1) = rho*speed*std::cos(alpha);
+	u(2) = rho*speed*std::sin(alpha);
+	u(3) = p/(gamma-1.0) + 0.5*rho*speed*speed;
+	return u;
 }
 
-void CompressibleEuler::computeBoundaryState(const int iface, const Matrix& __restrict__ instate, Matrix& __restrict__ bstate)
+CompressibleEulerBase::CompressibleEulerBase(const UMesh2dh* mesh, const int _p_degree, const char basis, const a_real gamma,
+		const Vector& freestream, const int slipwallflag, const int farfieldflag)
+	: SpatialBase(mesh, _p_degree, basis, false), g(gamma), uinf(freestream), slipwall_flag(slipwallflag), farfield_flag(farfieldflag)
 {
-	if(m->gintfacbtags(iface, 0) == inoutflow_flag)
+	std::cout << " CompressibleEulerBase: Free-stream state is (" << uinf.transpose() << ")\n";
+	if(uinf.rows() != NEULERVARS)
+		printf("! CompressibleEulerBase: The free-stream state does not have %d variables!\n", NEULERVARS);
+
+	for(a_int iface = 0; iface < m->gnbface(); iface++)
 	{
-		/// \todo TODO: Implement proper characteristic-based boundary conditions
-		const std::vector<Vector>& n = map1d[iface].normal();
-		for(size_t ig = 0; ig < n.size(); ig++) 
-		{
-			bstate.row(ig) = bval;
+		const int tag = m->gintfacbtags(iface,0);
+		if(tag != slipwall_flag && tag != farfield_flag) {
+			printf("! CompressibleEulerBase: Boundary marker %d is neither slip wall nor far field; extrapolating there.\n", tag);
+			break;
 		}
 	}
-	else if(m->gintfacbtags(iface, 0) == extrapolation_flag)
+}
+
+void CompressibleEulerBase::computeBoundaryState(const a_int iface, const Matrix& instate, Matrix& bstate) const
+{
+	const int tag = m->gintfacbtags(iface,0);
+	if(tag == farfield_flag)
 	{
-		bstate = instate;
+		for(int ig = 0; ig < instate.rows(); ig++)
+			bstate.row(ig) = uinf.transpose();
 	}
-	else if(m->gintfacbtags(iface, 0) == slipwall_flag)
+	else if(tag == slipwall_flag)
 	{
+		// mirror the normal velocity
 		const std::vector<Vector>& n = map1d[iface].normal();
-		for(size_t ig = 0; ig < n.size(); ig++) 
+		for(int ig = 0; ig < instate.rows(); ig++)
 		{
-			a_real vn = (instate(ig,1)*n[ig](0) + instate(ig,2)*n[ig](1))/instate(ig,0);
+			const a_real vn = (instate(ig,1)*n[ig](0) + instate(ig,2)*n[ig](1))/instate(ig,0);
 			bstate(ig,0) = instate(ig,0);
 			bstate(ig,1) = instate(ig,1) - 2*vn*n[ig](0)*instate(ig,0);
 			bstate(ig,2) = instate(ig,2) - 2*vn*n[ig](1)*instate(ig,0);
 			bstate(ig,3) = instate(ig,3);
 		}
 	}
-	else {
-		std::printf("!  CompressibleEuler: computeBoundaryState: Invalid boundary flag!!\n");
-	}
+	else
+		bstate = instate;
 }
 
-void CompressibleEuler::computeFaceTerms(const std::vector<Matrix>& u)
+void CompressibleEulerBase::domainIntegral(const a_int iel, const DOFVector& u, DOFVector& res, std::vector<a_real>& mets)
 {
-	for(a_int iface = 0; iface < m->gnbface(); iface++)
-	{
-		a_int lelem = m->gintfac(iface,0);
-		int ng = map1d[iface].getQuadrature()->numGauss();
-		const std::vector<Vector>& n = map1d[iface].normal();
-		const Matrix& lbasis = faces[iface].leftBasis();
+	const int ng = map2d[iel].getQuadrature()->numGauss();
+	const int ndofs = elems[iel]->getNumDOFs();
+	const amat::Array2d<a_real>& wts = map2d[iel].getQuadrature()->weights();
+	const BasisSet& bs = *elems[iel]->basisSet();
+	const ElementKernels& kern = elementKernels(iel);
+	const bool referential = (elems[iel]->getType() == REFERENTIAL);
 
-		Matrix linterps(ng,NVARS), rinterps(ng,NVARS);
-		Matrix fluxes(ng,NVARS);
-		leftfaceterms[iface] = Matrix::Zero(NVARS, elems[lelem]->getNumDOFs());
-		
-		faces[iface].interpolateAll_left(u[lelem], linterps);
-		computeBoundaryState(iface, linterps, rinterps);
+	Workspace& ws = workspace();
+	Matrix& uq = ws.matrix(WS_LSTATE, ng, NEULERVARS);
+	Matrix& xflux = ws.matrix(WS_XFLUX, ng, NEULERVARS);
+	Matrix& yflux = ws.matrix(WS_YFLUX, ng, NEULERVARS);
+	kern.interpolate(bs, u[iel], uq);
 
-		for(int ig = 0; ig < ng; ig++)
-		{
-			a_real weightandsp = map1d[iface].getQuadrature()->weights()(ig) * map1d[iface].speed()[ig];
+	a_real area = 0;
+	for(int ig = 0; ig < ng; ig++)
+	{
+		const a_real rho = uq(ig,0), vx = uq(ig,1)/rho, vy = uq(ig,2)/rho;
+		const a_real p = (g-1.0)*(uq(ig,3) - 0.5*rho*(vx*vx+vy*vy));
 
-			rflux->get_flux(&linterps(ig,0), &rinterps(ig,0), &n[ig](0), &fluxes(ig,0));
+		const a_real fx[NEULERVARS] = {uq(ig,1), uq(ig,1)*vx + p, uq(ig,1)*vy, (uq(ig,3)+p)*vx};
+		const a_real fy[NEULERVARS] = {uq(ig,2), uq(ig,2)*vx, uq(ig,2)*vy + p, (uq(ig,3)+p)*vy};
+		const a_real weightjacdet = map2d[iel].jacDet(ig) * wts(ig);
+		area += weightjacdet;
 
-			for(int ivar = 0; ivar < NVARS; ivar++) {
-				for(int idof = 0; idof < elems[lelem]->getNumDOFs(); idof++)
-					leftfaceterms[iface](ivar,idof) += fluxes(ig,ivar) * lbasis(ig,idof) * weightandsp;
+		// contravariant flux J^{-1} F for reference-space bases, as for LinearAdvection
+		if(referential) {
+			const MatrixDim& jinv = map2d[iel].jacInv(ig);
+			for(int ivar = 0; ivar < NEULERVARS; ivar++) {
+				xflux(ig,ivar) = (jinv(0,0)*fx[ivar] + jinv(0,1)*fy[ivar]) * weightjacdet;
+				yflux(ig,ivar) = (jinv(1,0)*fx[ivar] + jinv(1,1)*fy[ivar]) * weightjacdet;
 			}
 		}
-	
-		// ! P0 only !
-		/*a_real length = std::pow(m->gcoords(m->gintfac(iface,2),0)-m->gcoords(m->gintfac(iface,3),0),2);
-		length += std::pow(m->gcoords(m->gintfac(iface,2),1)-m->gcoords(m->gintfac(iface,3),1),2);
-		length = std::sqrt(length);
-		leftfaceterms[iface](0,0) = fluxes(0,0)*length;*/
+		else
+			for(int ivar = 0; ivar < NEULERVARS; ivar++) {
+				xflux(ig,ivar) = fx[ivar] * weightjacdet;
+				yflux(ig,ivar) = fy[ivar] * weightjacdet;
+			}
 	}
-	
-	for(a_int iface = m->gnbface(); iface < m->gnaface(); iface++)
-	{
-		a_int lelem = m->gintfac(iface,0);
-		a_int relem = m->gintfac(iface,1);
-		int ng = map1d[iface].getQuadrature()->numGauss();
-		const std::vector<Vector>& n = map1d[iface].normal();
-		const Matrix& lbasis = faces[iface].leftBasis();
-		const Matrix& rbasis = faces[iface].rightBasis();
-
-		Matrix linterps(ng,NVARS), rinterps(ng,NVARS);
-		Matrix fluxes(ng,NVARS);
-		leftfaceterms[iface] = Matrix::Zero(NVARS, elems[lelem]->getNumDOFs());
-		rightfaceterms[iface] = Matrix::Zero(NVARS, elems[relem]->getNumDOFs());
-		
-		faces[iface].interpolateAll_left(u[lelem], linterps);
-		faces[iface].interpolateAll_right(u[relem], rinterps);
-
-		for(int ig = 0; ig < ng; ig++)
-		{
-			a_real weightandsp = map1d[iface].getQuadrature()->weights()(ig) * map1d[iface].speed()[ig];
 
-			rflux->get_flux(&linterps(ig,0), &rinterps(ig,0), &n[ig](0), &fluxes(ig,0));
+	if(p_degree > 0) {
+		Matrix& term = ws.matrix(WS_TERM, NEULERVARS, ndofs);
+		term.setZero();
+		kern.integrateGradients(bs, xflux, yflux, term);
+		res[iel] -= term;
+	}
 
-			for(int ivar = 0; ivar < NVARS; ivar++) {
-				for(int idof = 0; idof < elems[lelem]->getNumDOFs(); idof++)
-					leftfaceterms[iface](ivar,idof) += fluxes(ig,ivar) * lbasis(ig,idof) * weightandsp;
-				for(int idof = 0; idof < elems[relem]->getNumDOFs(); idof++)
-					rightfaceterms[iface](ivar,idof) += fluxes(ig,ivar) * rbasis(ig,idof) * weightandsp;
-			}
+	mets[iel] = area / ((2*p_degree+1)*mets[iel]);
+}
+
+void CompressibleEulerBase::setFreeStreamState(DOFVector& u) const
+{
+	for(a_int iel = 0; iel < m->gnelem(); iel++)
+	{
+		const Matrix& bfunc = elems[iel]->bFunc();
+		const amat::Array2d<a_real>& wts = map2d[iel].getQuadrature()->weights();
+		MatrixMap ue = u[iel];
+		for(int idof = 0; idof < elems[iel]->getNumDOFs(); idof++)
+		{
+			a_real integral = 0;
+			for(int ig = 0; ig < map2d[iel].getQuadrature()->numGauss(); ig++)
+				integral += bfunc(ig,idof) * wts(ig) * map2d[iel].jacDet(ig);
+			ue.col(idof) = integral*uinf;
 		}
-	
-		// ! P0 only !
-		/*a_real length = std::pow(m->gcoords(m->gintfac(iface,2),0)-m->gcoords(m->gintfac(iface,3),0),2);
-		length += std::pow(m->gcoords(m->gintfac(iface,2),1)-m->gcoords(m->gintfac(iface,3),1),2);
-		length = std::sqrt(length);
-		leftfaceterms[iface](0,0) = fluxes(0,0)*length;
-		rightfaceterms[iface](0,0) = fluxes(0,0)*length;*/
 	}
+	applyMassInverse(u);
 }
 
-void CompressibleEuler::update_residual(const std::vector<Matrix>& u)
+void CompressibleEulerBase::postprocess(const DOFVector& u)
 {
-	computeFaceTerms(u);
+	// conserved variables at the mesh points, averaged over the elements around each point
+	Matrix up = Matrix::Zero(m->gnpoin(), NEULERVARS);
+	std::vector<int> surelems(m->gnpoin(),0);
 
 	for(a_int iel = 0; iel < m->gnelem(); iel++)
 	{
-		if(p_degree > 0) {	
-			int ng = map2d[iel].getQuadrature()->numGauss();
-			int ndofs = elems[iel]->getNumDOFs();
-			const std::vector<Matrix>& bgrads = elems[iel]->bGrad();
-
-			Matrix xflux(ng, NVARS), yflux(ng, NVARS);
-			elems[iel]->interpolateAll(u[iel], xflux);
-			yflux = a[1]*xflux;
-			xflux *= a[0];
-			Matrix term = Matrix::Zero(NVARS, ndofs);
-
-			for(int ig = 0; ig < ng; ig++)
-			{
-				a_real weightjacdet = map2d[iel].jacDet()[ig] * map2d[iel].getQuadrature()->weights()(ig);
-				for(int ivar = 0; ivar < NVARS; ivar++)
-					for(int idof = 0; idof < ndofs; idof++)
-						term(ivar,idof) += (xflux(ig,ivar)*bgrads[ig](idof,0) + yflux(ig,ivar)*bgrads[ig](idof,1)) * weightjacdet;
-			}
-
-			res[iel] -= term;
+		const int nv = m->gnfael(iel);
+		Matrix vvals(nv, NEULERVARS);
+		if(basis_type == 't') {
+			// for Taylor, use only average values
+			for(int ino = 0; ino < nv; ino++)
+				vvals.row(ino) = u[iel].col(0).transpose();
+		}
+		else {
+			Matrix refverts(nv,NDIM), bvals(nv,elems[iel]->getNumDOFs());
+			if(nv == 3)
+				refverts << 0,0, 1,0, 0,1;
+			else
+				refverts << -1,-1, 1,-1, 1,1, -1,1;
+			elems[iel]->computeBasis(refverts, bvals);
+			vvals = bvals*u[iel].transpose();
 		}
 
-		for(int ifa = 0; ifa < m->gnfael(iel); ifa++) {
-			a_int iface = m->gelemface(iel,ifa);
-			a_int nbdelem = m->gesuel(iel,ifa);
-			if(iel < nbdelem) {
-				res[iel] += leftfaceterms[iface];
+		for(int ino = 0; ino < nv; ino++) {
+			up.row(m->ginpoel(iel,ino)) += vvals.row(ino);
+			surelems[m->ginpoel(iel,ino)] += 1;
+		}
+		if(m->gnnode(iel) > nv) {
+			for(int ino = nv; ino < 2*nv; ino++) {
+				up.row(m->ginpoel(iel,ino)) += (vvals.row(ino-nv) + vvals.row((ino-nv+1) % nv))/2.0;
+				surelems[m->ginpoel(iel,ino)] += 1;
 			}
-			else {
-				res[iel] -= rightfaceterms[iface];
+			// for interior nodes, just use average of vertices
+			for(int ino = 2*nv; ino < m->gnnode(iel); ino++) {
+				up.row(m->ginpoel(iel,ino)) += vvals.colwise().sum()/nv;
+				surelems[m->ginpoel(iel,ino)] += 1;
 			}
 		}
 	}
+
+	output.resize(m->gnpoin(),3);
+	velocities.resize(m->gnpoin(),NDIM);
+	for(a_int ip = 0; ip < m->gnpoin(); ip++)
+	{
+		up.row(ip) /= (a_real)surelems[ip];
+		const a_real rho = up(ip,0), vx = up(ip,1)/rho, vy = up(ip,2)/rho;
+		const a_real p = (g-1.0)*(up(ip,3) - 0.5*rho*(vx*vx+vy*vy));
+		output(ip,0) = rho;
+		output(ip,1) = std::sqrt((vx*vx+vy*vy)*rho/(g*p));
+		output(ip,2) = p;
+		velocities(ip,0) = vx;
+		velocities(ip,1) = vy;
+	}
 }
 
-void CompressibleEuler::add_source( a_real (*const rhs)(a_real, a_real, a_real), a_real t)
+template <class Flux>
+CompressibleEuler<Flux>::CompressibleEuler(const UMesh2dh* mesh, const int _p_degree, const char basis, const Flux& numflux,
+		const a_real gamma, const Vector& freestream, const int slipwallflag, const int farfieldflag)
+	: CompressibleEulerBase(mesh, _p_degree, basis, gamma, freestream, slipwallflag, farfieldflag), rflux(numflux)
+{ }
+
+template <class Flux>
+a_real CompressibleEuler<Flux>::faceFluxes(const a_int iface, const Matrix& linterps, const Matrix& rinterps, Matrix& fluxes)
 {
-	for(a_int iel = 0; iel < m->gnelem(); iel++)
-	{
-		int ng = map2d[iel].getQuadrature()->numGauss();
-		int ndofs = elems[iel]->getNumDOFs();
-		const Matrix& bas = elems[iel]->bFunc();
-		const Matrix& pts = elems[iel]->getGeometricMapping()->map();
-		Matrix term = Matrix::Zero(NVARS, ndofs);
+	const int ng = linterps.rows();
+	const std::vector<Vector>& n = map1d[iface].normal();
+	const amat::Array2d<a_real>& wts = map1d[iface].getQuadrature()->weights();
+	const std::vector<a_real>& speed = map1d[iface].speed();
 
-		for(int ig = 0; ig < ng; ig++)
-		{
-			a_real weightjacdet = map2d[iel].jacDet()[ig] * map2d[iel].getQuadrature()->weights()(ig);
-			for(int idof = 0; idof < ndofs; idof++)
-				term(0,idof) += rhs(pts(ig,0),pts(ig,1),t) * bas(ig,idof) * weightjacdet;
-		}
+	// all points of the face at once, with states and normals as structure of arrays
+	Workspace& ws = workspace();
+	Matrix& lstates = ws.matrix(WS_SOALSTATE, NEULERVARS, ng);
+	Matrix& rstates = ws.matrix(WS_SOARSTATE, NEULERVARS, ng);
+	Matrix& normals = ws.matrix(WS_SOANORMAL, NDIM, ng);
+	Matrix& soafluxes = ws.matrix(WS_SOAFLUX, NEULERVARS, ng);
+	lstates = linterps.transpose();
+	rstates = rinterps.transpose();
+	for(int ig = 0; ig < ng; ig++)
+		for(int idim = 0; idim < NDIM; idim++)
+			normals(idim,ig) = n[ig](idim);
+	rflux.get_fluxes(ng, lstates.data(), rstates.data(), normals.data(), soafluxes.data());
 
-		res[iel] -= term;
+	a_real specrad = 0;
+	for(int ig = 0; ig < ng; ig++)
+	{
+		const a_real weightandsp = wts(ig) * speed[ig];
+		for(int ivar = 0; ivar < NEULERVARS; ivar++)
+			fluxes(ig,ivar) = soafluxes(ivar,ig) * weightandsp;
+
+		const a_real vni = (lstates(1,ig)*normals(0,ig) + lstates(2,ig)*normals(1,ig))/lstates(0,ig);
+		const a_real vnj = (rstates(1,ig)*normals(0,ig) + rstates(2,ig)*normals(1,ig))/rstates(0,ig);
+		const a_real pi = (g-1.0)*(lstates(3,ig) - 0.5*(lstates(1,ig)*lstates(1,ig)+lstates(2,ig)*lstates(2,ig))/lstates(0,ig));
+		const a_real pj = (g-1.0)*(rstates(3,ig) - 0.5*(rstates(1,ig)*rstates(1,ig)+rstates(2,ig)*rstates(2,ig))/rstates(0,ig));
+		const a_real ri = std::fabs(vni) + std::sqrt(g*pi/lstates(0,ig));
+		const a_real rj = std::fabs(vnj) + std::sqrt(g*pj/rstates(0,ig));
+		specrad += (ri > rj ? ri : rj) * weightandsp;
 	}
+	return specrad;
 }
 
-a_real CompressibleEuler::computeL2Error(double (*const exact)(double,double,double), const double time) const
+template <class Flux>
+void CompressibleEuler<Flux>::boundaryFaceIntegral(const a_int iface, const DOFVector& u, DOFVector& res,
+		std::vector<a_real>& mets)
 {
-	double l2error = 0;
-	for(int iel = 0; iel < m->gnelem(); iel++)
+	const a_int lelem = m->gintfac(iface,0);
+	const int ng = map1d[iface].getQuadrature()->numGauss();
+	MatrixMap lres = res[lelem];
+
+	Workspace& ws = workspace();
+	Matrix& linterps = ws.matrix(WS_LSTATE, ng, NEULERVARS);
+	Matrix& rinterps = ws.matrix(WS_RSTATE, ng, NEULERVARS);
+	Matrix& fluxes = ws.matrix(WS_FLUX, ng, NEULERVARS);
+
+	faces[iface].interpolateAll_left(u[lelem], linterps);
+	computeBoundaryState(iface, linterps, rinterps);
+	mets[lelem] += faceFluxes(iface, linterps, rinterps, fluxes);
+
+	faces[iface].integrateAll_left(fluxes, 1.0, lres);
+}
+
+template <class Flux>
+a_real CompressibleEuler<Flux>::interiorFaceFluxes(const a_int iface, const DOFVector& u, Matrix& fluxes)
+{
+	const a_int lelem = m->gintfac(iface,0);
+	const a_int relem = m->gintfac(iface,1);
+	const int ng = map1d[iface].getQuadrature()->numGauss();
+
+	Workspace& ws = workspace();
+	Matrix& linterps = ws.matrix(WS_LSTATE, ng, NEULERVARS);
+	Matrix& rinterps = ws.matrix(WS_RSTATE, ng, NEULERVARS);
+	faces[iface].interpolateAll_left(u[lelem], linterps);
+	faces[iface].interpolateAll_right(u[relem], rinterps);
+	return faceFluxes(iface, linterps, rinterps, fluxes);
+}
+
+template <class Flux>
+void CompressibleEuler<Flux>::interiorFaceIntegral(const a_int iface, const DOFVector& u, DOFVector& res,
+		std::vector<a_real>& mets)
+{
+	const a_int lelem = m->gintfac(iface,0);
+	const a_int relem = m->gintfac(iface,1);
+	const int ng = map1d[iface].getQuadrature()->numGauss();
+	MatrixMap lres = res[lelem], rres = res[relem];
+
+	Matrix& fluxes = workspace().matrix(WS_FLUX, ng, NEULERVARS);
+	const a_real specrad = interiorFaceFluxes(iface, u, fluxes);
+	mets[lelem] += specrad;
+	mets[relem] += specrad;
+
+	faces[iface].integrateAll_left(fluxes, 1.0, lres);
+	faces[iface].integrateAll_right(fluxes, -1.0, rres);
+}
+
+template <class Flux>
+void CompressibleEuler<Flux>::gatherFaceIntegrals(const a_int iel, const DOFVector& u, DOFVector& res,
+		std::vector<a_real>& mets)
+{
+	MatrixMap eres = res[iel];
+	mets[iel] = 0;
+	for(int ifa = 0; ifa < m->gnfael(iel); ifa++)
 	{
-		l2error += computeElemL2Error2(iel, 0, u[iel], exact, time);
+		const a_int iface = m->gelemface(iel,ifa);
+		if(iface < m->gnbface()) {
+			boundaryFaceIntegral(iface, u, res, mets);
+			continue;
+		}
+
+		// the flux is computed with the face's own left and right states, so both elements see the same value
+		const int ng = map1d[iface].getQuadrature()->numGauss();
+		Matrix& fluxes = workspace().matrix(WS_FLUX, ng, NEULERVARS);
+		mets[iel] += interiorFaceFluxes(iface, u, fluxes);
+
+		if(m->gintfac(iface,0) == iel)
+			faces[iface].integrateAll_left(fluxes, 1.0, eres);
+		else
+			faces[iface].integrateAll_right(fluxes, -1.0, eres);
 	}
-	return sqrt(l2error);
 }
 
-// very crude
-void CompressibleEuler::postprocess()
+template <class Flux>
+void CompressibleEuler<Flux>::update_residual(const DOFVector& u, DOFVector& res, std::vector<a_real>& mets)
 {
-	output.resize(m->gnpoin(),1);
-	output.zeros();
-	std::vector<int> surelems(m->gnpoin(),0);
+	reserveWorkspaces();
+	if(residual_mode == 'g')
+	{
+#pragma omp parallel for default(shared) schedule(static)
+		for(a_int iel = 0; iel < m->gnelem(); iel++)
+		{
+			gatherFaceIntegrals(iel, u, res, mets);
+			domainIntegral(iel, u, res, mets);
+		}
+		return;
+	}
 
-	for(int iel = 0; iel < m->gnelem(); iel++)
+#pragma omp parallel default(shared)
 	{
-		if(basis_type == 'l')
+#pragma omp for schedule(static)
+		for(a_int iel = 0; iel < m->gnelem(); iel++)
+			mets[iel] = 0;
+
+		for(int icol = 0; icol < numFaceColours(); icol++)
 		{
-			//int ndofs = elems[iel]->getNumDOFs();
-			for(int ino = 0; ino < m->gnfael(iel); ino++) {
-				output(m->ginpoel(iel,ino)) += u[iel](0,ino);
-				surelems[m->ginpoel(iel,ino)] += 1;
-			}
-			if(m->gnnode(iel) > m->gnfael(iel)) {
-				for(int ino = m->gnfael(iel); ino < 2*m->gnfael(iel); ino++) {
-					output(m->ginpoel(iel,ino)) += (u[iel](0,ino-m->gnfael(iel)) + u[iel](0, (ino-m->gnfael(iel)+1) % m->gnfael(iel)))/2.0;
-					surelems[m->ginpoel(iel,ino)] += 1;
-				}
-				// for interior nodes, just use average of vertices
-				for(int ino = 2*m->gnfael(iel); ino < m->gnnode(iel); ino++) {
-					for(int jno = 0; jno < m->gnfael(iel); jno++)
-						output(m->ginpoel(iel,ino)) += u[iel](0,jno);
-					output(m->ginpoel(iel,ino)) /= m->gnfael(iel);
-					surelems[m->ginpoel(iel,ino)] += 1;
-				}
+#pragma omp for schedule(static)
+			for(a_int ic = colour_p[icol]; ic < colour_p[icol+1]; ic++)
+			{
+				const a_int iface = colourfaces[ic];
+				if(iface < m->gnbface())
+					boundaryFaceIntegral(iface, u, res, mets);
+				else
+					interiorFaceIntegral(iface, u, res, mets);
 			}
 		}
-		
-		// for Taylor, use only average values
-		else
-			for(int ino = 0; ino < m->gnnode(iel); ino++) {
-				output(m->ginpoel(iel,ino)) += u[iel](0,0);
-				surelems[m->ginpoel(iel,ino)] += 1;
-			}
+
+		for(size_t igr = 0; igr < elemgroups.size(); igr++)
+		{
+			const std::vector<a_int>& grpelems = elemgroups[igr].elements;
+#pragma omp for schedule(static)
+			for(a_int i = 0; i < static_cast<a_int>(grpelems.size()); i++)
+				domainIntegral(grpelems[i], u, res, mets);
+		}
+	}
+}
+
+template <class Flux>
+void CompressibleEuler<Flux>::update_residual_elements(const DOFVector& u, DOFVector& res, std::vector<a_real>& mets,
+		const a_int *const elements, const a_int nelements)
+{
+	reserveWorkspaces();
+#pragma omp parallel for default(shared) schedule(static)
+	for(a_int i = 0; i < nelements; i++)
+	{
+		gatherFaceIntegrals(elements[i], u, res, mets);
+		domainIntegral(elements[i], u, res, mets);
 	}
-	for(int ip = 0; ip < m->gnpoin(); ip++)
-		output(ip) /= (a_real)surelems[ip];
+}
+
+template class CompressibleEuler<LocalLaxFriedrichsFlux>;
+template class CompressibleEuler<VanLeerFlux>;
+template class CompressibleEuler<RoeFlux>;
+template class CompressibleEuler<HLLCFlux>;
+template class CompressibleEuler<DynamicFlux>;
+
+CompressibleEulerBase* createCompressibleEuler(const std::string& fluxname, const char dispatch,
+		const UMesh2dh* mesh, const int p_degree, const char basis, const a_real gamma, const Vector& freestream,
+		const int slipwallflag, const int farfieldflag)
+{
+	if(dispatch == 'v')
+		return new CompressibleEuler<DynamicFlux>(mesh, p_degree, basis, DynamicFlux(fluxname, gamma), gamma, freestream,
+				slipwallflag, farfieldflag);
+	else if(dispatch != 's')
+		std::cout << "! createCompressibleEuler(): Unknown dispatch " << dispatch << "; selecting the flux at compile time.\n";
+
+	if(fluxname == "LLF")
+		return new CompressibleEuler<LocalLaxFriedrichsFlux>(mesh, p_degree, basis, LocalLaxFriedrichsFlux(gamma), gamma,
+				freestream, slipwallflag, farfieldflag);
+	else if(fluxname == "VANLEER")
+		return new CompressibleEuler<VanLeerFlux>(mesh, p_degree, basis, VanLeerFlux(gamma), gamma,
+				freestream, slipwallflag, farfieldflag);
+	else if(fluxname == "HLLC")
+		return new CompressibleEuler<HLLCFlux>(mesh, p_degree, basis, HLLCFlux(gamma), gamma,
+				freestream, slipwallflag, farfieldflag);
+	else if(fluxname == "ROE")
+		return new CompressibleEuler<RoeFlux>(mesh, p_degree, basis, RoeFlux(gamma), gamma,
+				freestream, slipwallflag, farfieldflag);
+
+	std::cout << "! createCompressibleEuler(): Unknown numerical flux " << fluxname << "!" << std::endl;
+	std::abort();
 }
 
 }
@@ -7,56 +7,134 @@
 #ifndef __ASPATIALEULER_H
 #define __ASPATIALEULER_H
 
-#define NVARS 4
+/// Number of conserved variables of the 2D Euler equations
+#define NEULERVARS 4
 
 #include "aspatial.hpp"
 #include "anumericalfluxeuler.hpp"
 
 namespace acfd {
 
-/// Residual computation for compressible Euler equations
+/// Conserved free-stream state for a given Mach number, flow angle (in radians), density and speed
+Vector eulerFreeStreamState(const a_real gamma, const a_real mach, const a_real alpha, const a_real rho, const a_real speed);
+
+/// Parts of the compressible Euler discretization that do not depend on the numerical flux
 /** \note Make sure to call both compute_topological and compute_boundary_maps on the mesh object before using an object of this class!
  *
- * If the ODE is \f$ \frac{du}{dt} + R(u) = 0 \f$, [res](@ref res) holds \f$ R \f$.
+ * If the ODE is \f$ \frac{du}{dt} + R(u) = 0 \f$, res holds \f$ R \f$.
  */
-class CompressibleEuler : public SpatialBase
+class CompressibleEulerBase : public SpatialBase<NEULERVARS>
 {
 protected:
-	a_real g;								///< Adiabatic index
-	Vector instate;							///< State at inflow
-	a_real outstate;						///< State at exit
-	int inoutflow_flag;						///< Boundary flag at faces where inflow or outflow is required
-	int extrapolation_flag;					///< Boundary flag for extrapolation condition
-	int slipwall_flag;						///< Boundary flag for slip wall
-	int periodic_flag;						///< Boundary flag for periodic boundary
+	const a_real g;							///< Adiabatic index
+	Vector uinf;							///< Conserved free-stream state
+	int slipwall_flag;						///< Boundary flag for slip walls
+	int farfield_flag;						///< Boundary flag for far-field boundaries, where the free stream is imposed
 	amat::Array2d<a_real> output;			///< Pointwise values for output
-	InviscidNumericalFlux* rflux;			///< Inviscid Riemann flux context
 
-	/// Computes face integrals from flow state described by the parameter
-	void computeFaceTerms(const std::vector<Matrix>& ustage);
+	/// Computes boundary (ghost) states at the quadrature points of a boundary face depending on its marker
+	/** Faces with other markers get the interior state.
+	 */
+	void computeBoundaryState(const a_int iface, const Matrix& instate, Matrix& bstate) const;
 
-	/// Computes boundary (ghost) states depending on face marker for the face denoted by the first argument
-	void computeBoundaryState(const int iface, const Matrix& instate, Matrix& bstate);
+	/// Adds the domain integral over an element to its residual and computes its time step
+	/** On entry, mets[iel] must hold the integral of the spectral radius over the boundary of the element,
+	 * accumulated by the face loop. It is replaced by the time step
+	 * \f$ \frac{|\Omega_i|}{(2p+1) \sum_{j \in \partial\Omega_i} \int_j (|v_n| + c) d\Gamma} \f$.
+	 */
+	void domainIntegral(const a_int iel, const DOFVector& u, DOFVector& res, std::vector<a_real>& mets);
 
 public:
-	CompressibleEuler(const UMesh2dh* mesh, const int _p_degree, const char basis, const a_real b_val, const int inoutflag, const int extrapflag);
-	
-	/// Adds face contributions and computes domain contribution to the [right hand side](@ref residual) 
-	void update_residual(const std::vector<Matrix>& ustage);
-	
-	/// Adds source term contribution to residual
-	void add_source( a_real (*const rhs)(a_real, a_real, a_real), a_real t);
+	/** \param[in] mesh The mesh context
+	 * \param[in] _p_degree Polynomial degree
+	 * \param[in] basis Type of basis
+	 * \param[in] gamma Adiabatic index
+	 * \param[in] freestream Conserved free-stream state, imposed at far-field boundaries
+	 * \param[in] slipwallflag Boundary marker of slip walls
+	 * \param[in] farfieldflag Boundary marker of far-field boundaries
+	 */
+	CompressibleEulerBase(const UMesh2dh* mesh, const int _p_degree, const char basis, const a_real gamma,
+			const Vector& freestream, const int slipwallflag, const int farfieldflag);
+
+	/// Sets the solution to the free-stream state everywhere, by L2 projection (which is exact for any basis)
+	void setFreeStreamState(DOFVector& u) const;
 
-	/// Compute quantities to export
-	void postprocess();
+	/// Computes density, Mach number and pressure (in [output](@ref output)) and velocities at mesh points
+	void postprocess(const DOFVector& u);
 
 	/// Read-only access to output quantities
 	const amat::Array2d<a_real>& getOutput() const {
 		return output;
 	}
 
-	a_real computeL2Error(double (*const exact)(double,double,double), const double time) const;
+	/// Read-only access to the velocities at mesh points computed by [postprocess](@ref postprocess)
+	const amat::Array2d<a_real>& getVelocities() const {
+		return velocities;
+	}
+};
+
+/// Residual computation for compressible Euler equations, with the numerical flux Flux
+/** Flux is one of the concrete [numerical fluxes](@ref InviscidNumericalFlux), whose functions are then called
+ * without virtual dispatch and inlined into the face loops, or DynamicFlux to choose the flux at run time.
+ * The instantiations for all of these are compiled; [createCompressibleEuler](@ref createCompressibleEuler)
+ * selects one from the name of the flux.
+ */
+template <class Flux>
+class CompressibleEuler : public CompressibleEulerBase
+{
+protected:
+	Flux rflux;								///< Inviscid numerical flux
+
+	/// Computes the numerical flux at each quadrature point of a face from the left and right states there
+	/** The fluxes are scaled by the quadrature weight and face speed.
+	 * \return The integral over the face of the larger of the spectral radii \f$ |v_n|+c \f$ of the two states
+	 */
+	a_real faceFluxes(const a_int iface, const Matrix& linterps, const Matrix& rinterps, Matrix& fluxes);
+
+	/// Adds the integral over a boundary face to the residual of its element, and its spectral radius to mets
+	void boundaryFaceIntegral(const a_int iface, const DOFVector& u, DOFVector& res, std::vector<a_real>& mets);
+
+	/// Computes the scaled numerical fluxes at the quadrature points of an interior face
+	/// \return The integral of the spectral radius over the face
+	a_real interiorFaceFluxes(const a_int iface, const DOFVector& u, Matrix& fluxes);
+
+	/// Adds the integral over an interior face to the residuals of both its elements, and its spectral radius to their mets
+	void interiorFaceIntegral(const a_int iface, const DOFVector& u, DOFVector& res, std::vector<a_real>& mets);
+
+	/// Adds the integrals over all faces of an element to its residual, and to no other
+	/** mets[iel] is set to the integral of the spectral radius over the boundary of the element.
+	 */
+	void gatherFaceIntegrals(const a_int iel, const DOFVector& u, DOFVector& res, std::vector<a_real>& mets);
+
+public:
+	/// See [CompressibleEulerBase](@ref CompressibleEulerBase::CompressibleEulerBase); numflux is copied
+	CompressibleEuler(const UMesh2dh* mesh, const int _p_degree, const char basis, const Flux& numflux, const a_real gamma,
+			const Vector& freestream, const int slipwallflag, const int farfieldflag);
+
+	/// Adds face and domain integrals to the residual and computes local time steps
+	/** The face integrals are assembled by scatter (one [colour](@ref SpatialBase::colourfaces) at a time)
+	 * or gather, as for LinearAdvection. The time steps are computed from spectral radii at the face quadrature
+	 * points, which the face loop evaluates anyway; see [domainIntegral](@ref CompressibleEulerBase::domainIntegral).
+	 */
+	void update_residual(const DOFVector& u, DOFVector& res, std::vector<a_real>& mets);
+
+	/// Adds the integrals of the listed elements to their residuals and computes their local time steps
+	/** See SpatialBase::update_residual_elements. */
+	void update_residual_elements(const DOFVector& u, DOFVector& res, std::vector<a_real>& mets,
+			const a_int *const elements, const a_int nelements);
+
+	bool hasElementResiduals() const { return true; }
 };
 
+/// Creates the Euler discretization with the numerical flux named LLF, VANLEER, ROE or HLLC
+/** Other names are an error.
+ * \param dispatch 's' to use the instantiation for the flux, selected at compile time,
+ *   or 'v' to call the flux through its virtual interface (CompressibleEuler<DynamicFlux>)
+ * The other parameters are those of the [constructor](@ref CompressibleEuler::CompressibleEuler).
+ */
+CompressibleEulerBase* createCompressibleEuler(const std::string& fluxname, const char dispatch,
+		const UMesh2dh* mesh, const int p_degree, const char basis, const a_real gamma, const Vector& freestream,
+		const int slipwallflag, const int farfieldflag);
+
 }
 #endif
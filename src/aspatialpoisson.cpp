@@ -55,7 +55,8 @@ void LaplaceSIP::assemble()
 	for(int ielem = 0; ielem < m->gnelem(); ielem++)
 	{
 		const Matrix& basis = elems[ielem]->bFunc();
-		const std::vector<Matrix>& bgrad = elems[ielem]->bGrad();
+		std::vector<Matrix> bgrad;
+		elems[ielem]->physicalBasisGrads(bgrad);
 		const GeomMapping2D* gmap = elems[ielem]->getGeometricMapping();
 		int ng = gmap->getQuadrature()->numGauss();
 		const amat::Array2d<a_real>& wts = gmap->getQuadrature()->weights();
@@ -66,7 +67,7 @@ void LaplaceSIP::assemble()
 
 		for(int ig = 0; ig < ng; ig++)
 		{
-			a_real weightAndJDet = wts(ig)*map2d[ielem].jacDet()[ig];
+			a_real weightAndJDet = wts(ig)*map2d[ielem].jacDet(ig);
 			for(int i = 0; i < ndofs; i++) 
 			{
 				bl(i) += rhs(quadp(ig,0),quadp(ig,1)) * basis(ig,i) * weightAndJDet;
@@ -260,7 +261,8 @@ void LaplaceSIP::computeErrors(a_real& __restrict__ l2error, a_real& __restrict_
 	// domain integral
 	for(int ielem = 0; ielem < m->gnelem(); ielem++)
 	{
-		const std::vector<Matrix>& bgrad = elems[ielem]->bGrad();
+		std::vector<Matrix> bgrad;
+		elems[ielem]->physicalBasisGrads(bgrad);
 		const Matrix& bfunc = elems[ielem]->bFunc();
 		const GeomMapping2D* gmap = elems[ielem]->getGeometricMapping();
 		int ng = gmap->getQuadrature()->numGauss();
@@ -275,8 +277,8 @@ void LaplaceSIP::computeErrors(a_real& __restrict__ l2error, a_real& __restrict_
 				lux += ug(ielem*ndofs+j)*bgrad[ig](j,0);
 				luy += ug(ielem*ndofs+j)*bgrad[ig](j,1);
 			}
-			l2error += std::pow(lu-exact(qp(ig,0),qp(ig,1),0),2) * wts(ig) * gmap->jacDet()[ig];
-			siperror += ( std::pow(lux-exactgradx(qp(ig,0),qp(ig,1)),2) + std::pow(luy-exactgrady(qp(ig,0),qp(ig,1)),2) ) * wts(ig) * gmap->jacDet()[ig];
+			l2error += std::pow(lu-exact(qp(ig,0),qp(ig,1),0),2) * wts(ig) * gmap->jacDet(ig);
+			siperror += ( std::pow(lux-exactgradx(qp(ig,0),qp(ig,1)),2) + std::pow(luy-exactgrady(qp(ig,0),qp(ig,1)),2) ) * wts(ig) * gmap->jacDet(ig);
 		}
 	}
 
@@ -395,7 +397,8 @@ void LaplaceC::assemble()
 	for(int ielem = 0; ielem < m->gnelem(); ielem++)
 	{
 		const Matrix& basis = elems[ielem]->bFunc();
-		const std::vector<Matrix>& bgrad = elems[ielem]->bGrad();
+		std::vector<Matrix> bgrad;
+		elems[ielem]->physicalBasisGrads(bgrad);
 		const GeomMapping2D* gmap = elems[ielem]->getGeometricMapping();
 		int ng = gmap->getQuadrature()->numGauss();
 		const amat::Array2d<a_real>& wts = gmap->getQuadrature()->weights();
@@ -406,7 +409,7 @@ void LaplaceC::assemble()
 
 		for(int ig = 0; ig < ng; ig++)
 		{
-			a_real weightAndJDet = wts(ig)*map2d[ielem].jacDet()[ig];
+			a_real weightAndJDet = wts(ig)*map2d[ielem].jacDet(ig);
 			for(int i = 0; i < ndofs; i++) 
 			{
 				bl(i) += rhs(quadp(ig,0),quadp(ig,1)) * basis(ig,i) * weightAndJDet;
@@ -452,7 +455,7 @@ void LaplaceC::solve()
 	printf(" LaplaceC: solve: Done.\n");
 }
 
-void LaplaceC::postprocess(const std::vector<Matrix>& u)
+void LaplaceC::postprocess(const DOFVector& u)
 {
 	output.resize(m->gnpoin());
 	for(int i = 0; i < m->gnpoin(); i++)
@@ -467,7 +470,8 @@ void LaplaceC::computeErrors(a_real& __restrict__ l2error, a_real& __restrict__
 	
 	for(int ielem = 0; ielem < m->gnelem(); ielem++)
 	{
-		const std::vector<Matrix>& bgrad = elems[ielem]->bGrad();
+		std::vector<Matrix> bgrad;
+		elems[ielem]->physicalBasisGrads(bgrad);
 		const Matrix& bfunc = elems[ielem]->bFunc();
 		const GeomMapping2D* gmap = elems[ielem]->getGeometricMapping();
 		int ng = gmap->getQuadrature()->numGauss();
@@ -482,8 +486,8 @@ void LaplaceC::computeErrors(a_real& __restrict__ l2error, a_real& __restrict__
 				lux += ug(dofmap(ielem,j))*bgrad[ig](j,0);
 				luy += ug(dofmap(ielem,j))*bgrad[ig](j,1);
 			}
-			l2error += std::pow(lu-exact(qp(ig,0),qp(ig,1),0),2) * wts(ig) * gmap->jacDet()[ig];
-			siperror += ( std::pow(lux-exactgradx(qp(ig,0),qp(ig,1)),2) + std::pow(luy-exactgrady(qp(ig,0),qp(ig,1)),2) ) * wts(ig) * gmap->jacDet()[ig];
+			l2error += std::pow(lu-exact(qp(ig,0),qp(ig,1),0),2) * wts(ig) * gmap->jacDet(ig);
+			siperror += ( std::pow(lux-exactgradx(qp(ig,0),qp(ig,1)),2) + std::pow(luy-exactgrady(qp(ig,0),qp(ig,1)),2) ) * wts(ig) * gmap->jacDet(ig);
 		}
 	}
 
@@ -94,13 +94,13 @@ public:
 	/// Computes errors in L2 and H1 norms
 	void computeErrors(a_real& l2error, a_real& h1error) const;
 
-	void postprocess(const std::vector<Matrix>& u);
+	void postprocess(const DOFVector& u);
 
 	const amat::Array2d<a_real>& getOutput() const {
 		return output;
 	}
 
-	void update_residual(const std::vector<Matrix>& u, std::vector<Matrix>& res, std::vector<a_real>& mets) { }
+	void update_residual(const DOFVector& u, DOFVector& res, std::vector<a_real>& mets) { }
 };
 
 }	// end namespace
@@ -0,0 +1,377 @@
+/** @file atimeimplicit.cpp
+ * @brief Implementation of implicit time stepping with a Jacobian-free Newton-Krylov solver
+ */
+
+#include "atimeimplicit.hpp"
+
+namespace acfd {
+
+/* Kennedy and Carpenter's ESDIRK3(2)4L[2]SA: the strictly lower triangle of the Butcher tableau, row by row;
+ * the diagonal is esdirkgamma except for the explicit first stage, and the last row gives the weights.
+ */
+static const a_real esdirkgamma = 0.43586652150845899941601945;
+static const a_real esdirka[3][3] = {
+	{0.43586652150845899941601945, 0.0, 0.0},
+	{2746238789719.0/10658868560708.0, -640167445237.0/6845629431997.0, 0.0},
+	{1471266399579.0/7840856788654.0, -4482444167858.0/7529755066697.0, 11266239266428.0/11593286722821.0}};
+
+template <short nvars>
+ImplicitStepping<nvars>::ImplicitStepping(const UMesh2dh *const mesh, SpatialBase<nvars>* s, const int timeorder,
+		a_real final_time, a_real cflnumber, const char tc, const double time_step, const a_real newton_tol,
+		const int max_newton, const int gmres_restart, const a_real linear_tol, const int max_linear,
+		const int jac_interval)
+	: m(mesh), spatial(s), order(timeorder), cfl(cflnumber), ftime(final_time), tch(tc), timestep(time_step),
+	  newtontol(newton_tol), maxnewton(max_newton), restart(gmres_restart), lineartol(linear_tol),
+	  maxlinear(max_linear), jacinterval(jac_interval), factoredcdt(-1.0), nresiduals(0), nlinear(0), nnewton(0)
+{
+	if(order != 2 && order != 3) {
+		std::printf("! ImplicitStepping: Order %d not supported! Using 3.\n", order);
+		order = 3;
+	}
+	if(restart < 1)
+		restart = 1;
+	if(jacinterval < 1)
+		jacinterval = 1;
+
+	spatial->spatialSetup(u, R, tsl);
+	uprev = u; utilde = u; L = u; H = u; du = u; z = u; w = u;
+	if(order == 3)
+		Lstage.assign(3, u);
+	V.assign(restart+1, u);
+	hess.resize(restart+1, restart);
+	gcos.resize(restart); gsin.resize(restart); gres.resize(restart+1);
+
+	jacblocks.resize(m->gnelem());
+	precblocks.resize(m->gnelem());
+	for(a_int iel = 0; iel < m->gnelem(); iel++) {
+		const int n = nvars*u.ndofs(iel);
+		jacblocks[iel].resize(n,n);
+	}
+
+	computeElementColouring();
+}
+
+template <short nvars>
+void ImplicitStepping<nvars>::computeElementColouring()
+{
+	const a_int nelem = m->gnelem();
+	std::vector<int> colour(nelem, -1);
+	std::vector<a_int> taken;
+	int ncolours = 0;
+	for(a_int iel = 0; iel < nelem; iel++)
+	{
+		taken.assign(ncolours+1, -1);
+		for(int ifa = 0; ifa < m->gnfael(iel); ifa++)
+		{
+			const a_int iface = m->gelemface(iel,ifa);
+			if(iface < m->gnbface())
+				continue;
+			const a_int nbr = m->gintfac(iface,0) == iel ? m->gintfac(iface,1) : m->gintfac(iface,0);
+			if(colour[nbr] >= 0)
+				taken[colour[nbr]] = iel;
+		}
+		int c = 0;
+		while(taken[c] == iel)
+			c++;
+		colour[iel] = c;
+		if(c+1 > ncolours)
+			ncolours = c+1;
+	}
+
+	colourp.assign(ncolours+1, 0);
+	for(a_int iel = 0; iel < nelem; iel++)
+		colourp[colour[iel]+1]++;
+	for(int c = 0; c < ncolours; c++)
+		colourp[c+1] += colourp[c];
+	colelems.resize(nelem);
+	std::vector<a_int> pos(colourp.begin(), colourp.end()-1);
+	for(a_int iel = 0; iel < nelem; iel++)
+		colelems[pos[colour[iel]]++] = iel;
+
+	std::printf(" ImplicitStepping: computeElementColouring(): Number of element colours = %d\n", ncolours);
+}
+
+template <short nvars>
+void ImplicitStepping<nvars>::evaluateRHS(const DOFVector& wv, DOFVector& Lw)
+{
+	R.setZero();
+	spatial->update_residual(wv, R, tsl);
+	nresiduals++;
+#pragma omp parallel for default(shared)
+	for(a_int iel = 0; iel < m->gnelem(); iel++)
+	{
+		Lw[iel].setZero();
+		spatial->addMassInverse(iel, 1.0, R, Lw);
+	}
+}
+
+template <short nvars>
+void ImplicitStepping<nvars>::computeJacobianBlocks(const DOFVector& uj, const DOFVector& Luj)
+{
+	int maxndofs = 0;
+	for(a_int iel = 0; iel < m->gnelem(); iel++)
+		if(uj.ndofs(iel) > maxndofs)
+			maxndofs = uj.ndofs(iel);
+
+	std::vector<a_real> delta(m->gnelem());
+	w = uj;
+	for(int c = 0; c+1 < static_cast<int>(colourp.size()); c++)
+		for(int ivar = 0; ivar < nvars; ivar++)
+			for(int idof = 0; idof < maxndofs; idof++)
+			{
+#pragma omp parallel for default(shared)
+				for(a_int i = colourp[c]; i < colourp[c+1]; i++)
+				{
+					const a_int iel = colelems[i];
+					if(idof >= uj.ndofs(iel))
+						continue;
+					delta[iel] = std::sqrt(ZERO_TOL)*(1.0 + std::fabs(uj[iel](ivar,idof)));
+					w[iel](ivar,idof) += delta[iel];
+				}
+
+				evaluateRHS(w, z);
+
+#pragma omp parallel for default(shared)
+				for(a_int i = colourp[c]; i < colourp[c+1]; i++)
+				{
+					const a_int iel = colelems[i];
+					const int nd = uj.ndofs(iel);
+					if(idof >= nd)
+						continue;
+					const int n = nvars*nd;
+					jacblocks[iel].col(ivar*nd+idof) = (Eigen::Map<const Vector>(z[iel].data(), n)
+							- Eigen::Map<const Vector>(Luj[iel].data(), n)) / delta[iel];
+					w[iel](ivar,idof) = uj[iel](ivar,idof);
+				}
+			}
+
+	// the blocks must be factorized again
+	factoredcdt = -1.0;
+}
+
+template <short nvars>
+void ImplicitStepping<nvars>::factorPreconditioner(const a_real cdt)
+{
+#pragma omp parallel for default(shared)
+	for(a_int iel = 0; iel < m->gnelem(); iel++)
+	{
+		const int n = static_cast<int>(jacblocks[iel].rows());
+		precblocks[iel].compute(Matrix::Identity(n,n) + cdt*jacblocks[iel]);
+	}
+	factoredcdt = cdt;
+}
+
+template <short nvars>
+void ImplicitStepping<nvars>::applyPreconditioner(const DOFVector& r, DOFVector& zv) const
+{
+#pragma omp parallel for default(shared)
+	for(a_int iel = 0; iel < m->gnelem(); iel++)
+	{
+		const int n = nvars*r.ndofs(iel);
+		Eigen::Map<Vector>(zv[iel].data(), n) = precblocks[iel].solve(Eigen::Map<const Vector>(r[iel].data(), n));
+	}
+}
+
+template <short nvars>
+void ImplicitStepping<nvars>::jacobianVector(const a_real cdt, const DOFVector& v, DOFVector& jv)
+{
+	const a_real vnorm = v.norm();
+	if(vnorm == 0) {
+		jv.setZero();
+		return;
+	}
+	const a_real eps = std::sqrt(ZERO_TOL)*(1.0 + u.norm())/vnorm;
+	w = u;
+	w.axpy(eps, v);
+	evaluateRHS(w, jv);
+	jv.axpy(-1.0, L);
+	jv.axpby(cdt/eps, 1.0, v);
+}
+
+template <short nvars>
+int ImplicitStepping<nvars>::gmres(const a_real cdt, const DOFVector& b, DOFVector& x)
+{
+	x.setZero();
+	const a_real bnorm = b.norm();
+	if(bnorm == 0)
+		return 0;
+
+	int iters = 0;
+	bool converged = false;
+	while(!converged && iters < maxlinear)
+	{
+		if(iters == 0)
+			V[0] = b;
+		else {
+			jacobianVector(cdt, x, V[0]);
+			V[0].axpby(-1.0, 1.0, b);
+		}
+		const a_real beta = V[0].norm();
+		if(beta <= lineartol*bnorm)
+			break;
+		V[0].scale(1.0/beta);
+		gres.setZero();
+		gres(0) = beta;
+
+		int j = 0;
+		while(j < restart && iters < maxlinear)
+		{
+			applyPreconditioner(V[j], z);
+			jacobianVector(cdt, z, V[j+1]);
+			iters++;
+
+			// modified Gram-Schmidt
+			for(int i = 0; i <= j; i++) {
+				hess(i,j) = V[j+1].dot(V[i]);
+				V[j+1].axpy(-hess(i,j), V[i]);
+			}
+			hess(j+1,j) = V[j+1].norm();
+			if(hess(j+1,j) > 0)
+				V[j+1].scale(1.0/hess(j+1,j));
+
+			// apply the earlier rotations to the new column, and find the one that zeroes its subdiagonal entry
+			for(int i = 0; i < j; i++) {
+				const a_real t = gcos(i)*hess(i,j) + gsin(i)*hess(i+1,j);
+				hess(i+1,j) = -gsin(i)*hess(i,j) + gcos(i)*hess(i+1,j);
+				hess(i,j) = t;
+			}
+			const a_real denom = std::sqrt(hess(j,j)*hess(j,j) + hess(j+1,j)*hess(j+1,j));
+			gcos(j) = denom > 0 ? hess(j,j)/denom : 1.0;
+			gsin(j) = denom > 0 ? hess(j+1,j)/denom : 0.0;
+			hess(j,j) = denom;
+			hess(j+1,j) = 0;
+			gres(j+1) = -gsin(j)*gres(j);
+			gres(j) = gcos(j)*gres(j);
+			j++;
+
+			if(std::fabs(gres(j)) <= lineartol*bnorm || denom == 0) {
+				converged = true;
+				break;
+			}
+		}
+
+		// back substitution for the coefficients of the Krylov vectors, in place in gres
+		for(int i = j-1; i >= 0; i--) {
+			if(hess(i,i) == 0) {
+				gres(i) = 0;
+				continue;
+			}
+			for(int k = i+1; k < j; k++)
+				gres(i) -= hess(i,k)*gres(k);
+			gres(i) /= hess(i,i);
+		}
+		w.setZero();
+		for(int i = 0; i < j; i++)
+			w.axpy(gres(i), V[i]);
+		applyPreconditioner(w, z);
+		x.axpy(1.0, z);
+	}
+	return iters;
+}
+
+template <short nvars>
+void ImplicitStepping<nvars>::solveNonlinear(const a_real cdt)
+{
+	if(cdt != factoredcdt)
+		factorPreconditioner(cdt);
+
+	a_real h0 = 0;
+	for(int it = 0; ; it++)
+	{
+		evaluateRHS(u, L);
+		H = u;
+		H.axpy(-1.0, utilde);
+		H.axpy(cdt, L);
+		const a_real hnorm = H.norm();
+		if(it == 0)
+			h0 = hnorm;
+		if(hnorm <= newtontol*h0 || hnorm <= SMALL_NUMBER*(1.0 + u.norm()))
+			break;
+		if(it == maxnewton) {
+			std::printf("! ImplicitStepping: solveNonlinear(): Newton's method did not converge;"
+					" relative residual = %e\n", hnorm/h0);
+			break;
+		}
+
+		nlinear += gmres(cdt, H, du);
+		u.axpy(-1.0, du);
+		nnewton++;
+	}
+}
+
+template <short nvars>
+double ImplicitStepping<nvars>::integrate()
+{
+	int step = 0; double time = 0; double dt = timestep;
+	nresiduals = 0; nlinear = 0; nnewton = 0;
+
+	// M^{-1}R and the local time steps of the initial state
+	evaluateRHS(u, L);
+	if(tch == 'a') {
+		dt = tsl[0];
+		for(a_int iel = 1; iel < m->gnelem(); iel++)
+			if(tsl[iel] < dt)
+				dt = tsl[iel];
+		dt *= cfl;
+	}
+	std::printf(" ImplicitStepping: integrate: Time step = %e, option = %c, order = %d\n", dt, tch, order);
+
+	double dtprev = dt;
+	while(time < ftime-SMALL_NUMBER)
+	{
+		// the last step is shortened to end at the final time
+		const double dtn = time+dt > ftime ? ftime-time : dt;
+		if(step % jacinterval == 0)
+			computeJacobianBlocks(u, L);
+
+		if(order == 2)
+		{
+			/* u^{n+1} = a u^n - b u^{n-1} - c dt M^{-1}R(u^{n+1}), after a backward Euler step, where with the ratio
+			 * r of this step to the previous one, a = (1+r)^2/(1+2r), b = r^2/(1+2r) and c = (1+r)/(1+2r); for equal
+			 * steps, these are 4/3, 1/3 and 2/3. The initial guess is extrapolated linearly from the last two steps.
+			 */
+			w = u;
+			if(step == 0) {
+				utilde = u;
+				uprev = w;
+				solveNonlinear(dtn);
+			}
+			else {
+				const a_real r = dtn/dtprev;
+				utilde = u;
+				utilde.axpby((1+r)*(1+r)/(1+2*r), -r*r/(1+2*r), uprev);
+				u.axpby(1+r, -r, uprev);
+				uprev = w;
+				solveNonlinear((1+r)/(1+2*r)*dtn);
+			}
+		}
+		else
+		{
+			// the explicit first stage is the last stage of the previous step
+			uprev = u;
+			Lstage[0] = L;
+			for(int istage = 1; istage <= 3; istage++)
+			{
+				utilde = uprev;
+				for(int j = 0; j < istage; j++)
+					utilde.axpy(-dtn*esdirka[istage-1][j], Lstage[j]);
+				solveNonlinear(esdirkgamma*dtn);
+				if(istage < 3)
+					Lstage[istage] = L;
+			}
+		}
+
+		time += dtn; step++; dtprev = dtn;
+		if(step % 20 == 0)
+			std::printf("  ImplicitStepping: integrate: Step %d, time = %f\n", step, time);
+	}
+
+	std::printf(" ImplicitStepping: integrate: %d steps, %d Newton iterations, %ld GMRES iterations,"
+			" %ld residuals\n", step, nnewton, nlinear, nresiduals);
+	return time;
+}
+
+template class ImplicitStepping<1>;
+template class ImplicitStepping<4>;
+
+}
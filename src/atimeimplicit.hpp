@@ -0,0 +1,145 @@
+/** @file atimeimplicit.hpp
+ * @brief Implicit time stepping by BDF2 or ESDIRK schemes with a Jacobian-free Newton-Krylov solver
+ */
+
+#ifndef __ATIMEIMPLICIT_H
+#define __ATIMEIMPLICIT_H
+
+#ifndef __ASPATIAL_H
+#include "aspatial.hpp"
+#endif
+
+#include <Eigen/LU>
+
+namespace acfd {
+
+/// Implicit time stepping with Newton's method, where the linear systems are solved by preconditioned GMRES
+/** Order 2 is the two-step backward differentiation formula BDF2, whose first step is backward Euler; order 3 is
+ * Kennedy and Carpenter's four-stage, L-stable, stiffly accurate ESDIRK3(2)4L[2]SA, whose first stage is explicit.
+ * Both need the solution of systems
+ * \f[ H(u) = u - \tilde{u} + c\Delta t M^{-1} R(u) = 0, \f]
+ * where \f$ \tilde{u} \f$ collects the known terms and c is 2/3 for BDF2 or the diagonal coefficient of the ESDIRK.
+ *
+ * Newton's method for H is inexact: each correction is found by restarted GMRES with right preconditioning,
+ * stopping at a fixed reduction of the linear residual. No Jacobian is assembled; its products with a vector
+ * are finite differences of [residuals](@ref SpatialBase::update_residual), costing one residual each.
+ * The preconditioner is block Jacobi, with the blocks \f$ I + c\Delta t M_e^{-1}\frac{\partial R_e}{\partial u_e} \f$
+ * of each element. The blocks \f$ \frac{\partial R_e}{\partial u_e} \f$ are also finite differences of
+ * residuals: each DOF is perturbed at once in all elements of a colour, no two of which are face neighbours,
+ * so one residual gives a column of the blocks of all those elements. They are computed every few time steps
+ * and their LU factorizations are kept.
+ *
+ * Time steps are constant, except for a shorter last step ending at the final time: either given (option 'c')
+ * or cfl times the smallest local time step of the initial state (option 'a'). The initial condition must be set in [the solution](@ref solution)
+ * before calling [integrate](@ref integrate).
+ */
+template <short nvars>
+class ImplicitStepping
+{
+protected:
+	const UMesh2dh *const m;						///< Mesh context
+	SpatialBase<nvars>* spatial;					///< Spatial discretization context
+	DOFVector u;									///< Unknowns
+	DOFVector uprev;								///< Solution at the previous time step, for BDF2
+	DOFVector utilde;								///< Known part \f$ \tilde{u} \f$ of the current nonlinear system
+	DOFVector L;									///< \f$ M^{-1}R \f$ at the current Newton iterate
+	std::vector<DOFVector> Lstage;					///< \f$ M^{-1}R \f$ at each stage of ESDIRK
+	DOFVector R;									///< Residuals
+	DOFVector H;									///< Nonlinear residual
+	DOFVector du;									///< Newton correction
+	DOFVector z;									///< Preconditioned vector
+	DOFVector w;									///< Perturbed state, and work vector of GMRES
+	std::vector<DOFVector> V;						///< Orthonormal Krylov basis
+	std::vector<a_real> tsl;						///< Maximum allowable explicit time step for each element
+	int order;										///< Temporal order of accuracy, 2 (BDF2) or 3 (ESDIRK)
+	double cfl;										///< CFL number, if tch is 'a'
+	double ftime;									///< Physical time up to which simulation should proceed
+	char tch;										///< 'c' or 'a' for a time step given or from the local time steps
+	double timestep;								///< Fixed time step, if tch was 'c'
+
+	a_real newtontol;								///< Relative reduction of the nonlinear residual for each solve
+	int maxnewton;									///< Largest number of Newton iterations per solve
+	int restart;									///< Number of GMRES iterations between restarts
+	a_real lineartol;								///< Relative reduction of the linear residual for each Newton step
+	int maxlinear;									///< Largest number of GMRES iterations per Newton step
+	int jacinterval;								///< Number of time steps between updates of the preconditioner
+
+	std::vector<a_int> colelems;					///< Elements sorted by colour, such that face neighbours differ in colour
+	std::vector<a_int> colourp;						///< Start of each colour in colelems, and its size at the end
+	std::vector<Matrix> jacblocks;					///< \f$ M_e^{-1}\frac{\partial R_e}{\partial u_e} \f$ of each element
+	std::vector<Eigen::PartialPivLU<Matrix>> precblocks;	///< Factorized preconditioner blocks
+	a_real factoredcdt;								///< \f$ c\Delta t \f$ with which precblocks were computed
+
+	Matrix hess;									///< Hessenberg matrix of GMRES, triangularized by Givens rotations
+	Vector gcos, gsin, gres;						///< Givens rotations and rotated residual vector of GMRES
+
+	long nresiduals;								///< Number of residual evaluations
+	long nlinear;									///< Number of GMRES iterations
+	int nnewton;									///< Number of Newton iterations
+
+	/// Greedily colours the elements so that face neighbours get different colours
+	void computeElementColouring();
+
+	/// Computes M^{-1}R(w) in Lw
+	void evaluateRHS(const DOFVector& w, DOFVector& Lw);
+
+	/// Computes the diagonal blocks of \f$ M^{-1}\frac{\partial R}{\partial u} \f$ at uj, with Luj = M^{-1}R(uj)
+	void computeJacobianBlocks(const DOFVector& uj, const DOFVector& Luj);
+
+	/// Factorizes the preconditioner blocks for a given \f$ c\Delta t \f$
+	void factorPreconditioner(const a_real cdt);
+
+	/// Applies the inverse of the block-Jacobi preconditioner: z = P^{-1} r
+	void applyPreconditioner(const DOFVector& r, DOFVector& z) const;
+
+	/// Product of the Jacobian of H at the current iterate u with v; L must hold M^{-1}R(u)
+	void jacobianVector(const a_real cdt, const DOFVector& v, DOFVector& jv);
+
+	/// Solves \f$ \frac{\partial H}{\partial u} x = b \f$ by GMRES at the current iterate u, starting from x = 0
+	/** \return The number of iterations
+	 */
+	int gmres(const a_real cdt, const DOFVector& b, DOFVector& x);
+
+	/// Solves \f$ H(u) = u - \tilde{u} + c\Delta t M^{-1}R(u) = 0 \f$ by Newton's method, starting from u
+	/** On return, L holds \f$ M^{-1}R \f$ at the solution.
+	 */
+	void solveNonlinear(const a_real cdt);
+
+public:
+	/** \param timeorder 2 for BDF2 or 3 for ESDIRK3
+	 * \param tc 'c' to use time_step, or 'a' for cfl times the smallest local time step of the initial state
+	 * \param newton_tol Relative reduction of the nonlinear residual for each system
+	 * \param max_newton Largest number of Newton iterations per system
+	 * \param gmres_restart Number of GMRES iterations between restarts
+	 * \param linear_tol Relative reduction of the linear residual for each Newton step
+	 * \param max_linear Largest number of GMRES iterations for each Newton step
+	 * \param jac_interval Number of time steps between updates of the preconditioner
+	 */
+	ImplicitStepping(const UMesh2dh*const mesh, SpatialBase<nvars>* s, const int timeorder, a_real final_time,
+			a_real cflnumber, const char tc, const double time_step, const a_real newton_tol = 1e-6,
+			const int max_newton = 10, const int gmres_restart = 30, const a_real linear_tol = 1e-3,
+			const int max_linear = 100, const int jac_interval = 1);
+
+	/// Access to the solution, for setting the initial condition
+	DOFVector& solution() {
+		return u;
+	}
+
+	/// Read-only access to solution
+	const DOFVector& solution() const {
+		return u;
+	}
+
+	/// Number of residual evaluations in the last call to [integrate](@ref integrate), including those of
+	/// the Jacobian-vector products and the preconditioner
+	long residualCount() const { return nresiduals; }
+
+	/// Carries out the time stepping process and returns the final time
+	/** The last time step is shortened, if needed, so that the returned time is the requested final time
+	 * up to round-off; BDF2 then uses its variable-step coefficients for that step.
+	 */
+	double integrate();
+};
+
+}
+#endif
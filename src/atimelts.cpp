@@ -0,0 +1,275 @@
+/** @file atimelts.cpp
+ * @brief Implementation of local time stepping by multirate Adams-Bashforth schemes
+ */
+
+#include "atimelts.hpp"
+#include <cstdlib>
+
+namespace acfd {
+
+/// Weights of the Adams-Bashforth polynomial integrated from the start of a step to a fraction theta of it
+/** On entry, the right hand sides are at the start of the step and order-1 steps before.
+ */
+static inline void abWeights(const int order, const a_real theta, a_real *const beta)
+{
+	const a_real t2 = theta*theta, t3 = t2*theta;
+	if(order == 2) {
+		beta[0] = theta + 0.5*t2;
+		beta[1] = -0.5*t2;
+	}
+	else {
+		beta[0] = theta + 0.75*t2 + t3/6.0;
+		beta[1] = -t2 - t3/3.0;
+		beta[2] = 0.25*t2 + t3/6.0;
+	}
+}
+
+/// Exponent of the largest power of 2 dividing j > 0
+static inline int powerOf2Exponent(a_int j)
+{
+	int e = 0;
+	while(j % 2 == 0) {
+		j /= 2;
+		e++;
+	}
+	return e;
+}
+
+template <short nvars>
+LocalTimeStepping<nvars>::LocalTimeStepping(const UMesh2dh *const mesh, SpatialBase<nvars>* s, const int timeorder,
+		a_real final_time, a_real cflnumber, const char tc, const double time_step, const int max_levels)
+	: m(mesh), spatial(s), order(timeorder), cfl(cflnumber), ftime(final_time), tch(tc), timestep(time_step),
+	  maxlevels(max_levels), nlevels(1), nelemres(0)
+{
+	if(order != 2 && order != 3) {
+		std::printf("! LocalTimeStepping: Order %d not supported! Using 3.\n", order);
+		order = 3;
+	}
+	if(maxlevels < 1)
+		maxlevels = 1;
+	if(!spatial->hasElementResiduals()) {
+		std::printf("! LocalTimeStepping: The spatial discretization cannot compute residuals of some elements!\n");
+		std::abort();
+	}
+
+	spatial->spatialSetup(u, R, tsl);
+	ueval = u;
+}
+
+template <short nvars>
+void LocalTimeStepping<nvars>::computeLevels()
+{
+	const a_int nelem = m->gnelem();
+	a_real tslmin = tsl[0];
+	for(a_int iel = 1; iel < nelem; iel++)
+		if(tsl[iel] < tslmin)
+			tslmin = tsl[iel];
+
+	level.resize(nelem);
+	for(a_int iel = 0; iel < nelem; iel++) {
+		const int k = static_cast<int>(std::floor(std::log2(tsl[iel]/tslmin) + SMALL_NUMBER));
+		level[iel] = k < maxlevels-1 ? k : maxlevels-1;
+	}
+
+	// lower levels until face neighbours differ by at most one
+	bool changed = true;
+	while(changed)
+	{
+		changed = false;
+		for(a_int iel = 0; iel < nelem; iel++)
+			for(int ifa = 0; ifa < m->gnfael(iel); ifa++)
+			{
+				const a_int iface = m->gelemface(iel,ifa);
+				if(iface < m->gnbface())
+					continue;
+				const a_int nbr = m->gintfac(iface,0) == iel ? m->gintfac(iface,1) : m->gintfac(iface,0);
+				if(level[iel] > level[nbr]+1) {
+					level[iel] = level[nbr]+1;
+					changed = true;
+				}
+			}
+	}
+
+	nlevels = 1;
+	for(a_int iel = 0; iel < nelem; iel++)
+		if(level[iel]+1 > nlevels)
+			nlevels = level[iel]+1;
+
+	// sort by level, keeping the order of the elements within each level
+	levelp.assign(nlevels+1, 0);
+	for(a_int iel = 0; iel < nelem; iel++)
+		levelp[level[iel]+1]++;
+	for(int k = 0; k < nlevels; k++)
+		levelp[k+1] += levelp[k];
+	lelems.resize(nelem);
+	std::vector<a_int> pos(levelp.begin(), levelp.end()-1);
+	for(a_int iel = 0; iel < nelem; iel++)
+		lelems[pos[level[iel]]++] = iel;
+
+	// coarser neighbours of the elements of levels up to k
+	halos.assign(nlevels, std::vector<a_int>());
+	std::vector<int> marked(nelem, -1);
+	for(int k = 0; k < nlevels; k++)
+		for(a_int i = 0; i < levelp[k+1]; i++)
+		{
+			const a_int iel = lelems[i];
+			for(int ifa = 0; ifa < m->gnfael(iel); ifa++)
+			{
+				const a_int iface = m->gelemface(iel,ifa);
+				if(iface < m->gnbface())
+					continue;
+				const a_int nbr = m->gintfac(iface,0) == iel ? m->gintfac(iface,1) : m->gintfac(iface,0);
+				if(level[nbr] > k && marked[nbr] != k) {
+					marked[nbr] = k;
+					halos[k].push_back(nbr);
+				}
+			}
+		}
+
+	std::printf(" LocalTimeStepping: computeLevels(): Elements in each of %d levels:", nlevels);
+	for(int k = 0; k < nlevels; k++)
+		std::printf(" %d", levelp[k+1]-levelp[k]);
+	std::printf("\n");
+}
+
+template <short nvars>
+void LocalTimeStepping<nvars>::storeRHS(const a_int start, const a_int end, const int slot, const bool zerores)
+{
+	DOFVector& h = hist[slot];
+#pragma omp parallel for default(shared)
+	for(a_int i = start; i < end; i++)
+	{
+		const a_int iel = lelems[i];
+		h[iel].setZero();
+		spatial->addMassInverse(iel, -1.0, R, h);
+		if(zerores)
+			R[iel].setZero();
+	}
+}
+
+template <short nvars>
+void LocalTimeStepping<nvars>::addABIncrement(const a_int iel, const int k, const a_real dt, const a_real theta,
+		DOFVector& w) const
+{
+	a_real beta[3];
+	abWeights(order, theta, beta);
+	MatrixMap we = w[iel];
+	for(int j = 0; j < order; j++)
+		we += (dt*beta[j]) * hist[(head[k]-j+order) % order][iel];
+}
+
+template <short nvars>
+double LocalTimeStepping<nvars>::integrate()
+{
+	const a_int nelem = m->gnelem();
+	int step = 0; double time = 0;
+	nelemres = 0;
+
+	// local time steps of the initial state
+	R.setZero();
+	spatial->update_residual(u, R, tsl);
+	R.setZero();
+	computeLevels();
+
+	double dt0 = timestep;
+	if(tch == 'a') {
+		dt0 = tsl[0];
+		for(a_int iel = 1; iel < nelem; iel++)
+			if(tsl[iel] < dt0)
+				dt0 = tsl[iel];
+		dt0 *= cfl;
+	}
+	// reduce the finest step so that the final time is a whole number of steps of the coarsest level
+	const a_int nsub = static_cast<a_int>(1) << (nlevels-1);
+	const a_int nmacro = static_cast<a_int>(std::ceil(ftime/(dt0*nsub) - SMALL_NUMBER));
+	if(nmacro > 0)
+		dt0 = ftime/(nmacro*nsub);
+	std::printf(" LocalTimeStepping: integrate: Finest time step = %e, coarsest = %e, order = %d\n",
+			dt0, dt0*nsub, order);
+
+	hist.assign(order, u);
+	head.assign(nlevels, 0);
+
+	/* Start-up by SSP RK3 with the finest step over order-1 macro steps, recording the right hand sides each level
+	 * needs. At the first multirate step, the newest right hand side goes to slot 1, so j steps before it are in
+	 * slot 1-j modulo the order.
+	 */
+	const a_real rk[3][3] = {{1.0, 0.0, 1.0}, {0.75, 0.25, 0.25}, {1.0/3.0, 2.0/3.0, 2.0/3.0}};
+	const a_int nstart = (order-1)*nsub;
+	for(a_int istep = 0; istep < nstart && time < ftime-SMALL_NUMBER; istep++)
+	{
+		ueval = u;
+		for(int istage = 0; istage < 3; istage++)
+		{
+			spatial->update_residual(ueval, R, tsl);
+			nelemres += nelem;
+
+			if(istage == 0)
+				for(int k = 0; k < nlevels; k++) {
+					const a_int back = nstart - istep;
+					if(back % (static_cast<a_int>(1) << k) == 0 && (back >> k) < order)
+						storeRHS(levelp[k], levelp[k+1], (1 - (back >> k) + order) % order, false);
+				}
+
+#pragma omp parallel for default(shared)
+			for(a_int iel = 0; iel < nelem; iel++)
+			{
+				MatrixMap us = ueval[iel];
+				us = rk[istage][0]*u[iel] + rk[istage][1]*us;
+				spatial->addMassInverse(iel, -rk[istage][2]*dt0, R, ueval);
+				R[iel].setZero();
+			}
+		}
+		u = ueval;
+		time += dt0;
+	}
+
+	while(time < ftime-SMALL_NUMBER)
+	{
+		for(a_int j = 0; j < nsub; j++)
+		{
+			// levels 0 to ka start a step now; coarser neighbours are predicted at this time within their step
+			const int ka = j == 0 ? nlevels-1 : powerOf2Exponent(j);
+			const std::vector<a_int>& halo = halos[ka];
+#pragma omp parallel for default(shared)
+			for(a_int i = 0; i < static_cast<a_int>(halo.size()); i++)
+			{
+				const a_int iel = halo[i];
+				const int kc = level[iel];
+				const a_int nkc = static_cast<a_int>(1) << kc;
+				ueval[iel] = u[iel];
+				addABIncrement(iel, kc, dt0*nkc, static_cast<a_real>(j % nkc)/nkc, ueval);
+			}
+
+			spatial->update_residual_elements(ueval, R, tsl, &lelems[0], levelp[ka+1]);
+			nelemres += levelp[ka+1];
+			for(int k = 0; k <= ka; k++) {
+				head[k] = (head[k]+1) % order;
+				storeRHS(levelp[k], levelp[k+1], head[k], true);
+			}
+
+			// levels 0 to kf end their step at the next sub-step; they are evaluated there at their new states
+			const int kf = j+1 == nsub ? nlevels-1 : powerOf2Exponent(j+1);
+#pragma omp parallel for default(shared)
+			for(a_int i = 0; i < levelp[kf+1]; i++)
+			{
+				const a_int iel = lelems[i];
+				addABIncrement(iel, level[iel], dt0*(static_cast<a_int>(1) << level[iel]), 1.0, u);
+				ueval[iel] = u[iel];
+			}
+		}
+
+		time += dt0*nsub; step++;
+		if(step % 20 == 0)
+			std::printf("  LocalTimeStepping: integrate: Step %d, time = %f\n", step, time);
+	}
+
+	std::printf(" LocalTimeStepping: integrate: %ld element residuals, %f per element per finest time step\n",
+			nelemres, static_cast<double>(nelemres)/nelem/(time/dt0));
+	return time;
+}
+
+template class LocalTimeStepping<1>;
+template class LocalTimeStepping<4>;
+
+}
@@ -0,0 +1,101 @@
+/** @file atimelts.hpp
+ * @brief Local time stepping by multirate Adams-Bashforth schemes
+ */
+
+#ifndef __ATIMELTS_H
+#define __ATIMELTS_H
+
+#ifndef __ASPATIAL_H
+#include "aspatial.hpp"
+#endif
+
+namespace acfd {
+
+/// Multirate Adams-Bashforth time stepping, with elements clustered by their local time steps
+/** Each element is put into the cluster (level) k for which \f$ 2^k \Delta t_0 \f$ is the largest such step not
+ * exceeding its own allowed time step, where \f$ \Delta t_0 \f$ is the step of the finest cluster. Levels are limited
+ * to a maximum and then lowered until face neighbours differ by at most one level. Cluster k takes steps of
+ * \f$ \Delta t_k = 2^k \Delta t_0 \f$ with the Adams-Bashforth scheme of the given order, so one macro step of
+ * the coarsest cluster's size needs \f$ 2^{K-k} \f$ residual evaluations of each element of cluster k,
+ * instead of \f$ 2^K \f$ for all elements with a global time step.
+ *
+ * At each fine sub-step, the clusters that start a step there evaluate their residuals
+ * (see SpatialBase::update_residual_elements). Finer neighbours are then at the same time; coarser ones are
+ * in the middle of their step, and their states are taken from the Adams-Bashforth polynomial of their step,
+ * \f$ u(t_n + \theta\Delta t) = u_n + \Delta t \sum_j \beta_j(\theta) L_{n-j} \f$, which is as accurate as the scheme.
+ * The scheme is therefore of the same order as the single-rate one, but not exactly conservative at interfaces
+ * between clusters, as the two sides see the interface flux at different times.
+ *
+ * The history of residuals that the first steps need is generated by SSP RK3 steps of the finest size over
+ * the first order-1 macro steps, which therefore cost as much as with global time steps.
+ *
+ * The spatial discretization must implement SpatialBase::update_residual_elements; the constructor aborts otherwise.
+ * The clusters are set from the local time steps of the initial state and kept thereafter.
+ * The initial condition must be set in [the solution](@ref solution) before calling [integrate](@ref integrate).
+ */
+template <short nvars>
+class LocalTimeStepping
+{
+protected:
+	const UMesh2dh *const m;						///< Mesh context
+	SpatialBase<nvars>* spatial;					///< Spatial discretization context
+	DOFVector u;									///< Unknowns, at the start of the current step of each element
+	DOFVector ueval;								///< States at which residuals are evaluated
+	DOFVector R;									///< Residuals
+	std::vector<DOFVector> hist;					///< Last few right hand sides \f$ L = -M^{-1}R \f$ of each element
+	std::vector<a_real> tsl;						///< Maximum allowable explicit time step for each element
+	int order;										///< Order of the Adams-Bashforth scheme, 2 or 3
+	double cfl;										///< CFL number
+	double ftime;									///< Physical time up to which simulation should proceed
+	char tch;										///< 'c' or 'a' for the finest time step given or from the local time steps
+	double timestep;								///< Finest time step, if tch was 'c'
+	int maxlevels;									///< Largest number of levels allowed
+
+	std::vector<int> level;							///< Level of each element
+	int nlevels;									///< Number of levels in use
+	std::vector<a_int> lelems;						///< Elements sorted by level
+	std::vector<a_int> levelp;						///< Start of each level in lelems, and its size at the end
+	/// For each level k, the elements of coarser levels that are face neighbours of elements of levels up to k
+	std::vector<std::vector<a_int>> halos;
+	std::vector<int> head;							///< Index in hist of the newest right hand side of each level
+	long nelemres;									///< Number of element residuals evaluated
+
+	/// Sorts the elements into levels from their local time steps relative to the smallest one
+	void computeLevels();
+
+	/// Stores \f$ -M^{-1}R \f$ of elements lelems[start..end) in hist[slot], zeroing their residuals if asked to
+	void storeRHS(const a_int start, const a_int end, const int slot, const bool zerores);
+
+	/// Adds \f$ \Delta t \sum_j \beta_j(\theta) L_{n-j} \f$ of the element iel of level k to w[iel]
+	void addABIncrement(const a_int iel, const int k, const a_real dt, const a_real theta, DOFVector& w) const;
+
+public:
+	/** \param timeorder Order of the Adams-Bashforth schemes, 2 or 3
+	 * \param tc 'a' for a finest time step of cfl times the smallest local time step, 'c' to use time_step
+	 * \param max_levels Largest number of levels; 1 gives global time steps
+	 */
+	LocalTimeStepping(const UMesh2dh*const mesh, SpatialBase<nvars>* s, const int timeorder, a_real final_time,
+			a_real cflnumber, const char tc, const double time_step, const int max_levels);
+
+	/// Access to the solution, for setting the initial condition
+	DOFVector& solution() {
+		return u;
+	}
+
+	/// Read-only access to solution
+	const DOFVector& solution() const {
+		return u;
+	}
+
+	/// Number of residual evaluations of single elements in the last call to [integrate](@ref integrate)
+	long elementResidualCount() const { return nelemres; }
+
+	/// Carries out the time stepping process and returns the final time
+	/** The finest time step is reduced, if needed, so that the final time is a whole number of steps of the
+	 * coarsest level; the returned time is then the requested final time up to round-off.
+	 */
+	double integrate();
+};
+
+}
+#endif
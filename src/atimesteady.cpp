@@ -15,15 +15,7 @@ SteadyBase<nvars>::SteadyBase(const UMesh2dh *const mesh, SpatialBase<nvars>* s,
 	std::cout << " SteadyBase: CFL = " << cfl << ", use source? " << source << std::endl;
 
 	spatial->spatialSetup(u, R, tsl);
-
-	for(a_int iel = 0; iel < m->gnelem(); iel++)
-	{
-		for(int i = 0; i < u[iel].rows(); i++)
-			for(int j = 0; j < u[iel].cols(); j++) {
-				u[iel](i,j) = 1.0;
-				R[iel](i,j) = 0;
-			}
-	}
+	u.setConstant(1.0);
 }
 
 template <short nvars>
@@ -36,39 +28,39 @@ template <short nvars>
 void SteadyExplicit<nvars>::integrate()
 {
 	int step = 0;
-	double relresnorm = 1.0, resnorm0 = 1.0;
-	const std::vector<Matrix>& Mi = spatial->massInv();
+	double relresnorm = 1.0, resnorm0 = 0.0, resnorm = 0.0;
 
 	while((relresnorm > tol && step < maxiter))
 	{
-		for(int iel = 0; iel < m->gnelem(); iel++) {
-			for(int i = 0; i < R[iel].rows(); i++)
-				for(int j = 0; j < R[iel].cols(); j++)
-					R[iel](i,j) = 0.0;
-		}
+		R.setZero();
 
 		spatial->update_residual(u, R, tsl);
 		if(source)
 			spatial->add_source(rhs,0,R);
 
+		resnorm = spatial->computeL2Norm(R, 0);
+		// relative to the first nonzero residual, as the initial residual can vanish when starting from a uniform flow
+		if(resnorm0 == 0) resnorm0 = resnorm;
+		if(resnorm0 > 0) relresnorm = resnorm/resnorm0;
+
+		spatial->applyMassInverse(R);
+
 		// step
+#pragma omp parallel for default(shared)
 		for(int iel = 0; iel < m->gnelem(); iel++)
 		{
-			u[iel] = u[iel] - cfl*tsl[iel]*R[iel]*Mi[iel];
+			u[iel].noalias() -= cfl*tsl[iel]*R[iel];
 		}
 
-		double resnorm = spatial->computeL2Norm(R, 0);
-		if(step == 0) resnorm0 = resnorm;
-		else relresnorm = resnorm/resnorm0;
-
 		step++;
 		if(step % 20 == 0)
-			std::printf("  SteadyExplicit: integrate: Step %d, rel res = %e\n", step, relresnorm);
+			std::printf("  SteadyExplicit: integrate: Step %d, rel res = %e, res = %e\n", step, relresnorm, resnorm);
 	}
 
-	std::printf(" SteadyExplicit: integrate: Total steps %d, final rel res = %e\n", step, relresnorm);
+	std::printf(" SteadyExplicit: integrate: Total steps %d, final rel res = %e, res = %e\n", step, relresnorm, resnorm);
 }
 
 template class SteadyExplicit<1>;
+template class SteadyExplicit<4>;
 
 }
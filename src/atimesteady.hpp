@@ -23,12 +23,12 @@ protected:
 	const UMesh2dh *const m;						///< Mesh context
 	SpatialBase<nvars>* spatial;					///< Spatial discretization context
 
-	std::vector<Matrix> R;							///< Residuals
+	DOFVector R;									///< Residuals
 
 	/// vector of unknowns
-	/** Each Eigen3 (E3) Matrix contains the DOF values of all physical variables for an element.
+	/** The block of each element contains the DOF values of all physical variables for that element.
 	 */
-	std::vector<Matrix> u;
+	DOFVector u;
 
 	/// Maximum allowable explicit time step for each element
 	/** For Euler, stores (for each elem i) Vol(i) / \f$ \sum_{j \in \partial\Omega_I} \int_j( |v_n| + c) d \Gamma \f$, 
@@ -51,8 +51,13 @@ public:
 		rhs = source;
 	}
 
+	/// Access to the solution, for setting the initial guess
+	DOFVector& solution() {
+		return u;
+	}
+
 	/// Read-only access to solution
-	const std::vector<Matrix>& solution() const {
+	const DOFVector& solution() const {
 		return u;
 	}
 
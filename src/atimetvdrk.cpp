@@ -0,0 +1,280 @@
+/** @file atimetvdrk.cpp
+ * @brief Implementation of TVD, SSP and low-storage Runge-Kutta time stepping
+ * @author Aditya Kashi
+ * @date 2017 April 15
+ */
+
+#include "atimetvdrk.hpp"
+#include "aodecoeffs.hpp"
+
+namespace acfd {
+
+template <short nvars>
+TVDRKStepping<nvars>::TVDRKStepping(const UMesh2dh *const mesh, SpatialBase<nvars>* s, const int timeorder, a_real final_time, 
+		a_real cflnumber, const char tc, const double time_step)
+	: m(mesh), spatial(s), order(timeorder), cfl(cflnumber), ftime(final_time), tch(tc), timestep(time_step)
+{
+	spatial->spatialSetup(u, R, tsl);
+	ustage = u;
+}
+
+template <short nvars>
+double TVDRKStepping<nvars>::integrate()
+{
+	int step = 0; double time = 0; double tsg = timestep;
+	std::printf(" TVDRKStepping: integrate: Time step = %f, option = %c, order = %d\n", tsg, tch, order);
+	initializeOdeCoeffs();
+	amat::Array2d<a_real> tvdrk;
+	if(order == 1)
+		tvdrk = tvdrk1;
+	else if(order == 2)
+		tvdrk = tvdrk2;
+	else if(order == 3)
+		tvdrk = tvdrk3;
+	else {
+		std::printf(" TVDRKStepping: integrate: Order not supported! Using 3.\n");
+		tvdrk = tvdrk3;
+		order = 3;
+	}
+	
+	if(tch == 's') {
+		const a_real rho = spatial->estimateSpectralRadius(u, NPOWERITER);
+		tsg = cfl/rho;
+		std::printf(" TVDRKStepping: integrate: Spectral radius = %e, time step = %e\n", rho, tsg);
+	}
+
+	ustage = u;
+	R.setZero();
+	
+	while(time < ftime-SMALL_NUMBER)
+	{
+		for(int istage = 0; istage < order; istage++)
+		{
+			spatial->update_residual(ustage, R, tsl);
+			
+			if(istage == 0) {
+				// get global time step
+				if(tch == 'a') {
+					tsg = tsl[0];
+					for(int iel = 1; iel < m->gnelem(); iel++) {
+						if(tsl[iel] < tsg)
+							tsg = tsl[iel];
+					}
+					tsg = cfl*tsg;
+				}
+			}
+
+			// step, applying the mass inverse and zeroing the residual for the next stage in the same pass
+			const a_real a0 = tvdrk[istage][0], a1 = tvdrk[istage][1], a2 = tvdrk[istage][2];
+#pragma omp parallel for default(shared)
+			for(int iel = 0; iel < m->gnelem(); iel++)
+			{
+				MatrixMap us = ustage[iel];
+				us = a0*u[iel] + a1*us;
+				spatial->addMassInverse(iel, -a2*tsg, R, ustage);
+				R[iel].setZero();
+			}
+		}
+
+		u = ustage;
+
+		time += tsg; step++;
+		if(step % 20 == 0)
+			std::printf("  TVDRKStepping: integrate: Step %d, time = %f\n", step, time);
+	}
+	return time;
+}
+
+template class TVDRKStepping<1>;
+template class TVDRKStepping<4>;
+
+template <short nvars>
+SSPRKStepping<nvars>::SSPRKStepping(const UMesh2dh *const mesh, SpatialBase<nvars>* s, const int timeorder,
+		const int num_stages, a_real final_time, a_real cflnumber, const char tc, const double time_step)
+	: m(mesh), spatial(s), order(timeorder), nstages(num_stages), cfl(cflnumber), ftime(final_time), tch(tc),
+	  timestep(time_step)
+{
+	if(order != 3 && order != 4) {
+		std::printf("! SSPRKStepping: Order %d not supported! Using 3.\n", order);
+		order = 3;
+	}
+	if(order == 4)
+		nstages = 10;
+	else {
+		int n = static_cast<int>(std::sqrt(nstages+0.5));
+		if(n < 2) n = 2;
+		if(n*n != nstages)
+			std::printf("! SSPRKStepping: %d stages is not the square of an integer larger than 1; using %d.\n",
+					nstages, n*n);
+		nstages = n*n;
+	}
+	std::printf(" SSPRKStepping: SSPRK(%d,%d), SSP coefficient %f\n", nstages, order, sspCoefficient());
+
+	spatial->spatialSetup(u, R, tsl);
+	q = u;
+}
+
+template <short nvars>
+a_real SSPRKStepping<nvars>::sspCoefficient() const
+{
+	if(order == 4)
+		return 6.0;
+	const int n = static_cast<int>(std::sqrt(nstages+0.5));
+	return n*n - n;
+}
+
+template <short nvars>
+double SSPRKStepping<nvars>::integrate()
+{
+	const a_real sspc = sspCoefficient();
+	int step = 0; double time = 0; double tsg = timestep;
+
+	// stages of the low-storage forms of Ketcheson (2008), with q saved at step start unless a stage saves it
+	std::vector<Stage> stages(nstages);
+	bool saveatstart = true;
+	if(order == 4) {
+		for(int i = 0; i < 9; i++) {
+			stages[i].alpha = 1; stages[i].beta = 0; stages[i].gamma = 1.0/6.0; stages[i].post = 'n';
+		}
+		stages[4].post = 'm';
+		stages[9].alpha = 0.6; stages[9].beta = 1.0; stages[9].gamma = 0.1; stages[9].post = 'n';
+	}
+	else {
+		const int n = static_cast<int>(std::sqrt(nstages+0.5));
+		// indices from 1 of the last stage before q is saved and of the stage combining q and u
+		const int isave = (n-1)*(n-2)/2, icomb = n*(n+1)/2;
+		for(int i = 0; i < nstages; i++) {
+			stages[i].alpha = 1; stages[i].beta = 0; stages[i].gamma = 1.0/sspc; stages[i].post = 'n';
+		}
+		if(isave > 0) {
+			stages[isave-1].post = 's';
+			saveatstart = false;
+		}
+		stages[icomb-1].alpha = (n-1.0)/(2*n-1.0);
+		stages[icomb-1].beta = n/(2*n-1.0);
+		stages[icomb-1].gamma = (n-1.0)/((2*n-1.0)*sspc);
+	}
+
+	if(tch == 's') {
+		const a_real rho = spatial->estimateSpectralRadius(u, NPOWERITER);
+		tsg = cfl*sspc/rho;
+		std::printf(" SSPRKStepping: integrate: Spectral radius = %e, time step = %e\n", rho, tsg);
+	}
+	else
+		std::printf(" SSPRKStepping: integrate: Time step = %f, option = %c\n", tsg, tch);
+
+	R.setZero();
+
+	while(time < ftime-SMALL_NUMBER)
+	{
+		if(saveatstart)
+			q = u;
+
+		for(int istage = 0; istage < nstages; istage++)
+		{
+			spatial->update_residual(u, R, tsl);
+
+			if(istage == 0 && tch == 'a') {
+				tsg = tsl[0];
+				for(int iel = 1; iel < m->gnelem(); iel++) {
+					if(tsl[iel] < tsg)
+						tsg = tsl[iel];
+				}
+				tsg = cfl*sspc*tsg;
+			}
+
+			// stage update with the mass inverse, the update of q and the zeroing of the residual in one pass
+			const Stage st = stages[istage];
+#pragma omp parallel for default(shared)
+			for(int iel = 0; iel < m->gnelem(); iel++)
+			{
+				MatrixMap ue = u[iel];
+				if(st.alpha != 1 || st.beta != 0)
+					ue = st.alpha*ue + st.beta*q[iel];
+				spatial->addMassInverse(iel, -st.gamma*tsg, R, u);
+				R[iel].setZero();
+
+				if(st.post == 's')
+					q[iel] = ue;
+				else if(st.post == 'm') {
+					MatrixMap qe = q[iel];
+					qe = qe/25.0 + 0.36*ue;
+					ue = 15.0*qe - 5.0*ue;
+				}
+			}
+		}
+
+		time += tsg; step++;
+		if(step % 20 == 0)
+			std::printf("  SSPRKStepping: integrate: Step %d, time = %f\n", step, time);
+	}
+	return time;
+}
+
+template class SSPRKStepping<1>;
+template class SSPRKStepping<4>;
+
+template <short nvars>
+LowStorageRKStepping<nvars>::LowStorageRKStepping(const UMesh2dh *const mesh, SpatialBase<nvars>* s, const int timeorder,
+		a_real final_time, a_real cflnumber, const char tc, const double time_step)
+	: m(mesh), spatial(s), order(timeorder), cfl(cflnumber), ftime(final_time), tch(tc), timestep(time_step)
+{
+	spatial->spatialSetup(u, W, tsl);
+}
+
+template <short nvars>
+double LowStorageRKStepping<nvars>::integrate()
+{
+	int step = 0; double time = 0; double tsg = timestep;
+	std::printf(" LowStorageRKStepping: integrate: Time step = %f, option = %c, order = %d\n", tsg, tch, order);
+
+	const double *a = lsrk4a, *b = lsrk4b;
+	int nstages = 5;
+	if(order == 3) {
+		a = lsrk3a; b = lsrk3b;
+		nstages = 3;
+	}
+	else if(order != 4) {
+		std::printf(" LowStorageRKStepping: integrate: Order not supported! Using 4.\n");
+		order = 4;
+	}
+
+	W.setZero();
+
+	while(time < ftime-SMALL_NUMBER)
+	{
+		for(int istage = 0; istage < nstages; istage++)
+		{
+			spatial->update_residual(u, W, tsl);
+
+			if(istage == 0 && tch == 'a') {
+				tsg = tsl[0];
+				for(int iel = 1; iel < m->gnelem(); iel++) {
+					if(tsl[iel] < tsg)
+						tsg = tsl[iel];
+				}
+				tsg = cfl*tsg;
+			}
+
+			// update the solution and scale the accumulated residual for the next stage (the first has a = 0)
+			const a_real bdt = -b[istage]*tsg;
+			const a_real anext = a[(istage+1) % nstages];
+#pragma omp parallel for default(shared)
+			for(int iel = 0; iel < m->gnelem(); iel++)
+			{
+				spatial->addMassInverse(iel, bdt, W, u);
+				W[iel] *= anext;
+			}
+		}
+
+		time += tsg; step++;
+		if(step % 20 == 0)
+			std::printf("  LowStorageRKStepping: integrate: Step %d, time = %f\n", step, time);
+	}
+	return time;
+}
+
+template class LowStorageRKStepping<1>;
+template class LowStorageRKStepping<4>;
+
+}
@@ -1,5 +1,6 @@
 /** @file atimetvdrk.hpp
- * @brief Explicit total variation diminishing Runge-Kutta (TVDRK) time stepping scheme
+ * @brief Explicit total variation diminishing (TVD), strong stability preserving (SSP) and low-storage Runge-Kutta
+ * time stepping schemes
  * @author Aditya Kashi
  * @date 2017 April 15
  */
@@ -11,159 +12,162 @@
 #include "aspatial.hpp"
 #endif
 
-#ifndef __AODECOEFFS_H
-#include "aodecoeffs.hpp"
-#endif
+/// Number of power iterations for estimating the spectral radius, for time steps of option 's'
+#define NPOWERITER 30
 
 namespace acfd {
 
 /// TVD RK explicit time stepping
-/** The initial condition must be specified in the spatial discretization context [elsewhere](@ref SpatialBase::setInitialConditionModal).
+/** The initial condition must be set in [the solution](@ref solution) before calling [integrate](@ref integrate),
+ * using, for instance, SpatialBase::setInitialConditionModal.
  */
+template <short nvars>
 class TVDRKStepping
 {
 protected:
 	const UMesh2dh *const m;						///< Mesh context
-	SpatialBase* spatial;							///< Spatial discretization context
+	SpatialBase<nvars>* spatial;					///< Spatial discretization context
+	DOFVector u;									///< Unknowns
+	DOFVector ustage;								///< Unknowns at the current stage
+	DOFVector R;									///< Residuals
+	std::vector<a_real> tsl;						///< Maximum allowable explicit time step for each element
 	int order;										///< Desird temporal order of accuracy
 	double cfl;										///< CFL number
 	double ftime;									///< Physical time up to which simulation should proceed
-	char tch;										///< 'c' or 'a' for constant or automatic (non-constant) time steps respectively
+	/// 'c' for constant time steps, 'a' for automatic (non-constant) ones from the local time steps,
+	/// or 's' for a constant time step from the spectral radius of the initial state, see [integrate](@ref integrate)
+	char tch;
 	double timestep;								///< Fixed time step, if tch was 'c'
 
 public:
-	TVDRKStepping(const UMesh2dh*const mesh, SpatialBase* s, const int timeorder, a_real final_time, a_real cflnumber,
+	TVDRKStepping(const UMesh2dh*const mesh, SpatialBase<nvars>* s, const int timeorder, a_real final_time, a_real cflnumber,
 			const char tc, const double time_step);
-	void setInitialCondition();
+
+	/// Access to the solution, for setting the initial condition
+	DOFVector& solution() {
+		return u;
+	}
+
+	/// Read-only access to solution
+	const DOFVector& solution() const {
+		return u;
+	}
 
 	/// Carries out the time stepping process and returns the final time
+	/** With time-step option 's', the time step is cfl times the inverse of the
+	 * [spectral radius](@ref SpatialBase::estimateSpectralRadius) of the semi-discrete operator at the initial state.
+	 */
 	double integrate();
-	
-	double integrate_ForwardEuler();
 };
 
-TVDRKStepping::TVDRKStepping(const UMesh2dh *const mesh, SpatialBase* s, const int timeorder, a_real final_time, a_real cflnumber, 
-		const char tc, const double time_step)
-	: m(mesh), spatial(s), order(timeorder), cfl(cflnumber), ftime(final_time), tch(tc), timestep(time_step)
+/// Explicit SSP RK time stepping with many stages, for a larger stable time step per residual evaluation
+/** Ketcheson's optimal schemes SSPRK(s,3) with \f$ s = n^2 \f$ stages (n > 1) and SSPRK(10,4) are implemented in
+ * the low-storage forms he gives, needing the solution and one other DOF vector besides the residual. Their SSP
+ * coefficients, the ratio of the allowed time step to that of forward Euler, are \f$ n^2-n \f$ and 6
+ * respectively, against 1 for the three-stage scheme of TVDRKStepping. So SSPRK(9,3) takes a time step 6 times
+ * as large with 3 times as many stages, needing half as many residual evaluations per unit time.
+ *
+ * Time steps from the local time steps (option 'a') are cfl times the SSP coefficient times the smallest local
+ * time step. With option 's', the time step is cfl times the SSP coefficient over the
+ * [spectral radius](@ref SpatialBase::estimateSpectralRadius) at the initial state; as the stability region
+ * contains the disc of that radius centred at minus the SSP coefficient, cfl = 1 is stable when the dominant
+ * eigenvalues lie within 60 degrees of the negative real axis, as they do for upwind DG discretizations.
+ * The initial condition must be set in [the solution](@ref solution) before calling [integrate](@ref integrate).
+ */
+template <short nvars>
+class SSPRKStepping
 {
-}
+protected:
+	/// One stage: \f$ u \leftarrow \alpha u + \beta q - \gamma \Delta t M^{-1} R(u) \f$, followed by an update of q
+	struct Stage {
+		a_real alpha, beta, gamma;
+		char post;				///< 's' to save the solution in q, 'm' for the mid-step combination of SSPRK(10,4), else 'n'
+	};
 
-double TVDRKStepping::integrate()
-{
-	int step = 0; double time = 0; double tsg = timestep;
-	std::vector<Matrix>& u = spatial->unk();
-	
-	std::vector<Matrix> ustage(m->gnelem());
-	for(int iel = 0; iel < m->gnelem(); iel++)
-		ustage[iel] = Matrix::Zero(u[iel].rows(), u[iel].cols());
-
-	std::vector<Matrix>& R = spatial->residual();
-	const std::vector<Matrix>& Mi = spatial->massInv();
-	const std::vector<a_real>& tsl = spatial->maxExplicitTimeStep();
-	std::printf(" TVDRKStepping: integrate: Time step = %f, option = %c, order = %d\n", tsg, tch, order);
-	initializeOdeCoeffs();
-	amat::Array2d<a_real> tvdrk;
-	if(order == 1)
-		tvdrk = tvdrk1;
-	else if(order == 2)
-		tvdrk = tvdrk2;
-	else if(order == 3)
-		tvdrk = tvdrk3;
-	else {
-		std::printf(" TVDRKStepping: integrate: Order not supported! Using 3.\n");
-		tvdrk = tvdrk3;
-		order = 3;
+	const UMesh2dh *const m;						///< Mesh context
+	SpatialBase<nvars>* spatial;					///< Spatial discretization context
+	DOFVector u;									///< Unknowns
+	DOFVector q;									///< Solution saved at an earlier stage
+	DOFVector R;									///< Residuals
+	std::vector<a_real> tsl;						///< Maximum allowable explicit time step for each element
+	int order;										///< Temporal order of accuracy, 3 or 4
+	int nstages;									///< Number of stages
+	double cfl;										///< CFL number
+	double ftime;									///< Physical time up to which simulation should proceed
+	char tch;										///< Time-step option 'c', 'a' or 's', as for [TVDRKStepping](@ref TVDRKStepping::tch)
+	double timestep;								///< Fixed time step, if tch was 'c'
+
+public:
+	/** \param timeorder 3 or 4
+	 * \param num_stages Number of stages for order 3, which must be the square of an integer larger than 1;
+	 *   other numbers are rounded down to such a square, or up to 4. For order 4, there are always 10 stages.
+	 * The other parameters are as for [TVDRKStepping](@ref TVDRKStepping).
+	 */
+	SSPRKStepping(const UMesh2dh*const mesh, SpatialBase<nvars>* s, const int timeorder, const int num_stages,
+			a_real final_time, a_real cflnumber, const char tc, const double time_step);
+
+	/// Access to the solution, for setting the initial condition
+	DOFVector& solution() {
+		return u;
 	}
-	
-	for(int iel = 0; iel < m->gnelem(); iel++)
-		ustage[iel] = u[iel];
-	
-	while(time < ftime-SMALL_NUMBER)
-	{
-		for(int istage = 0; istage < order; istage++)
-		{
-			for(int iel = 0; iel < m->gnelem(); iel++) {
-				R[iel] = Matrix::Zero(R[iel].rows(), R[iel].cols());
-			}
-
-			spatial->update_residual(ustage);
-			
-			if(istage == 0) {
-				// get global time step
-				if(tch == 'a') {
-					for(int iel = 0; iel < m->gnelem(); iel++) {
-						if(tsl[iel] < tsg)
-							tsg = tsl[iel];
-					}
-					tsg = cfl*tsg;
-				}
-			}
-
-			// step
-			for(int iel = 0; iel < m->gnelem(); iel++)
-			{
-				ustage[iel] = tvdrk[istage][0]*u[iel] + tvdrk[istage][1]*ustage[iel] - tvdrk[istage][2] * tsg*R[iel]*Mi[iel];
-			}
-		}
-
-		for(int iel = 0; iel < m->gnelem(); iel++)
-			u[iel] = ustage[iel];
-
-		time += tsg; step++;
-		if(step % 20 == 0)
-			std::printf("  TVDRKStepping: integrate: Step %d, time = %f\n", step, time);
+
+	/// Read-only access to solution
+	const DOFVector& solution() const {
+		return u;
 	}
-	return time;
-}
 
-double TVDRKStepping::integrate_ForwardEuler()
+	/// Ratio of the largest time step to that of forward Euler for which the scheme is SSP
+	a_real sspCoefficient() const;
+
+	/// Carries out the time stepping process and returns the final time
+	double integrate();
+};
+
+/// Low-storage (2N) explicit RK time stepping
+/** Only the solution and one other DOF vector are stored. If the ODE is \f$ M\frac{du}{dt} + R(u) = 0 \f$,
+ * stage i of a scheme with coefficients \f$ a_i, b_i \f$ is
+ * \f$ W \leftarrow a_i W + R(u), \quad u \leftarrow u - b_i \Delta t M^{-1} W \f$.
+ * Since the mass inverse is linear and the time step is fixed within a step, this is the usual 2N-storage
+ * form with \f$ dU = -\Delta t M^{-1} W \f$; keeping W unscaled lets the residual be added to it directly.
+ * After each residual, a single pass over the elements applies the mass inverse, updates the solution
+ * and scales W for the next stage.
+ *
+ * Order 3 is Williamson's three-stage scheme and order 4 is Carpenter and Kennedy's five-stage scheme.
+ * The initial condition must be set in [the solution](@ref solution) before calling [integrate](@ref integrate).
+ */
+template <short nvars>
+class LowStorageRKStepping
 {
-	int step = 0; double time = 0; double tsg = timestep;
-	std::vector<Matrix>& u = spatial->unk();
-
-	std::vector<Matrix>& R = spatial->residual();
-	const std::vector<Matrix>& Mi = spatial->massInv();
-	const std::vector<a_real>& tsl = spatial->maxExplicitTimeStep();
-	std::printf(" TVDRKStepping: integrate: Time step = %f, option = %c, order = %d\n", tsg, tch, order);
-
-	// compare P1 area inverses
-	std::vector<a_real> mi(m->gnelem());
-	for(int i = 0; i < m->gnelem(); i++)
-	{
-		mi[i] = 2.0/( m->gcoords(m->ginpoel(i,0),0)*(m->gcoords(m->ginpoel(i,1),1) - m->gcoords(m->ginpoel(i,2),1)) 
-				- m->gcoords(m->ginpoel(i,0),1)*(m->gcoords(m->ginpoel(i,1),0)-m->gcoords(m->ginpoel(i,2),0)) 
-				+ m->gcoords(m->ginpoel(i,1),0)*m->gcoords(m->ginpoel(i,2),1) - m->gcoords(m->ginpoel(i,2),0)*m->gcoords(m->ginpoel(i,1),1) );
+protected:
+	const UMesh2dh *const m;						///< Mesh context
+	SpatialBase<nvars>* spatial;					///< Spatial discretization context
+	DOFVector u;									///< Unknowns
+	DOFVector W;									///< Residuals accumulated over the stages
+	std::vector<a_real> tsl;						///< Maximum allowable explicit time step for each element
+	int order;										///< Desired temporal order of accuracy, 3 or 4
+	double cfl;										///< CFL number
+	double ftime;									///< Physical time up to which simulation should proceed
+	char tch;										///< 'c' or 'a' for constant or automatic (non-constant) time steps respectively
+	double timestep;								///< Fixed time step, if tch was 'c'
+
+public:
+	/// Same arguments as for [TVDRKStepping](@ref TVDRKStepping)
+	LowStorageRKStepping(const UMesh2dh*const mesh, SpatialBase<nvars>* s, const int timeorder, a_real final_time, 
+			a_real cflnumber, const char tc, const double time_step);
+
+	/// Access to the solution, for setting the initial condition
+	DOFVector& solution() {
+		return u;
 	}
 
-	while(time < ftime-SMALL_NUMBER)
-	{
-		for(int iel = 0; iel < m->gnelem(); iel++) {
-			R[iel] = Matrix::Zero(R[iel].rows(), R[iel].cols());
-		}
-
-		spatial->update_residual(u);
-	
-		// get global time step
-		if(tch == 'a') {
-			for(int iel = 0; iel < m->gnelem(); iel++) {
-				if(tsl[iel] < tsg)
-					tsg = tsl[iel];
-			}
-			tsg = cfl*tsg;
-		}
-
-		// step
-		for(int iel = 0; iel < m->gnelem(); iel++)
-		{
-			u[iel](0,0) = u[iel](0,0) - tsg*R[iel](0,0)*Mi[iel](0,0);
-		}
-
-		time += tsg; step++;
-		if(step % 20 == 0)
-			std::printf("  TVDRKStepping: integrate: Step %d, time = %f\n", step, time);
+	/// Read-only access to solution
+	const DOFVector& solution() const {
+		return u;
 	}
-	return time;
-}
+
+	/// Carries out the time stepping process and returns the final time
+	double integrate();
+};
 
 }
 #endif
@@ -0,0 +1,44 @@
+/** @file aworkspace.hpp
+ * @brief Scratch matrices for the temporaries of loops over faces and elements
+ */
+
+#ifndef __AWORKSPACE_H
+#define __AWORKSPACE_H
+
+#ifndef __ACONSTANTS_H
+#include "aconstants.hpp"
+#endif
+
+#include <deque>
+
+namespace acfd {
+
+/// Scratch matrices of one thread, kept from one call to the next so that loops over faces and elements do not allocate
+/** A matrix is borrowed by slot number and size. The first request for a slot with some size allocates the matrix;
+ * later requests for the same slot and size return that matrix, holding whatever its last user left in it.
+ * Temporaries in use at the same time must therefore be in different slots. Matrices are never freed or moved
+ * while the workspace exists, so a reference stays valid when other sizes are requested from its slot.
+ */
+class Workspace
+{
+public:
+	/// Number of slots
+	static const int nslots = 16;
+
+	/// Returns the scratch matrix of a slot with the given size, allocating it if this is the first such request
+	Matrix& matrix(const int slot, const int rows, const int cols)
+	{
+		std::deque<Matrix>& mats = slots[slot];
+		for(size_t i = 0; i < mats.size(); i++)
+			if(mats[i].rows() == rows && mats[i].cols() == cols)
+				return mats[i];
+		mats.emplace_back(rows, cols);
+		return mats.back();
+	}
+
+private:
+	std::deque<Matrix> slots[nslots];		///< Matrices of each slot, one per size requested
+};
+
+}
+#endif
@@ -0,0 +1,129 @@
+/** @file bencheuler.cpp
+ * @brief Throughput of the Euler residual, and comparison of numerical fluxes selected at compile time and virtually
+ *
+ * Usage: euler [degree [number of evaluations [max degree]]]
+ * For the NACA 0012 and bump channel meshes of the test cases, the residual is evaluated about a perturbed
+ * free-stream state. First, with the HLLC flux and an orthonormal basis, the throughput of residual evaluations
+ * (including the local time steps) is reported for degrees 0 to max degree in scatter and gather modes,
+ * in evaluations and in million DOFs per second. Then, at the given degree, the residual is evaluated with
+ * each numerical flux, once with the instantiation for that flux and once through DynamicFlux,
+ * which calls the flux virtually.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include "../aspatialeuler.hpp"
+
+using namespace acfd;
+using namespace std;
+
+/// Returns the average wall-clock time of one residual evaluation, leaving the residual in res
+double timeResidual(CompressibleEulerBase *const sd, const int nevals,
+		const DOFVector& u, DOFVector& res, std::vector<a_real>& mets)
+{
+	// one untimed evaluation to warm the caches
+	sd->update_residual(u, res, mets);
+
+	double total = 0;
+	for(int it = 0; it < nevals; it++)
+	{
+		res.setZero();
+		auto start = chrono::steady_clock::now();
+		sd->update_residual(u, res, mets);
+		auto end = chrono::steady_clock::now();
+		total += chrono::duration<double>(end-start).count();
+	}
+	return total/nevals;
+}
+
+/// Sets the free-stream state perturbed by up to 1% in each DOF
+void setPerturbedState(const CompressibleEulerBase *const sd, const a_int nelem, DOFVector& u)
+{
+	sd->setFreeStreamState(u);
+	srand(1);
+	for(a_int iel = 0; iel < nelem; iel++)
+		u[iel] += 0.01*Matrix::Random(NEULERVARS, u[iel].cols()).cwiseProduct(u[iel]);
+}
+
+/// Prints the throughput of the residual with HLLC fluxes for degrees 0 to maxdegree in both residual modes
+void throughput(const UMesh2dh& m, const Vector& uinf, const int maxdegree, const int nevals)
+{
+	const a_real g = 1.4;
+	cout << setw(10) << "degree" << setw(12) << "DOFs" << setw(18) << "scatter (res/s)" << setw(18) << "gather (res/s)"
+		<< setw(18) << "scatter (MDOF/s)" << endl;
+	for(int degree = 0; degree <= maxdegree; degree++)
+	{
+		CompressibleEulerBase* sd = createCompressibleEuler("HLLC", 's', &m, degree, 'o', g, uinf, 2, 4);
+		DOFVector u, res;
+		std::vector<a_real> mets;
+		sd->spatialSetup(u, res, mets);
+		setPerturbedState(sd, m.gnelem(), u);
+
+		sd->setResidualMode('s');
+		const double ts = timeResidual(sd, nevals, u, res, mets);
+		sd->setResidualMode('g');
+		const double tg = timeResidual(sd, nevals, u, res, mets);
+
+		cout << setw(10) << degree << setw(12) << sd->numTotalDOFs() << setw(18) << 1.0/ts << setw(18) << 1.0/tg
+			<< setw(18) << sd->numTotalDOFs()/ts*1e-6 << endl;
+		delete sd;
+	}
+}
+
+/// Times the residual with each numerical flux selected at compile time and called virtually
+void compareDispatch(const UMesh2dh& m, const Vector& uinf, const int degree, const int nevals)
+{
+	const a_real g = 1.4;
+	const char* fluxnames[] = {"LLF", "VANLEER", "ROE", "HLLC"};
+
+	cout << setw(10) << "flux" << setw(18) << "compile (res/s)" << setw(18) << "virtual (res/s)" << setw(12) << "speedup"
+		<< setw(14) << "max diff" << endl;
+	for(int iflux = 0; iflux < 4; iflux++)
+	{
+		CompressibleEulerBase* sds = createCompressibleEuler(fluxnames[iflux], 's', &m, degree, 'l', g, uinf, 2, 4);
+		CompressibleEulerBase* sdv = createCompressibleEuler(fluxnames[iflux], 'v', &m, degree, 'l', g, uinf, 2, 4);
+		DOFVector u, res, resv;
+		std::vector<a_real> mets;
+		sds->spatialSetup(u, res, mets);
+		sdv->spatialSetup(u, resv, mets);
+
+		// perturb the free stream so that the fluxes see different left and right states
+		setPerturbedState(sds, m.gnelem(), u);
+
+		const double ts = timeResidual(sds, nevals, u, res, mets);
+		const double tv = timeResidual(sdv, nevals, u, resv, mets);
+
+		a_real diff = 0;
+		for(a_int iel = 0; iel < m.gnelem(); iel++)
+			diff = std::max(diff, (res[iel]-resv[iel]).cwiseAbs().maxCoeff());
+
+		cout << setw(10) << fluxnames[iflux] << setw(18) << 1.0/ts << setw(18) << 1.0/tv << setw(12) << tv/ts
+			<< setw(14) << diff << endl;
+		delete sds;
+		delete sdv;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const int degree = argc > 1 ? atoi(argv[1]) : 1;
+	const int nevals = argc > 2 ? atoi(argv[2]) : 20;
+	const int maxdegree = argc > 3 ? atoi(argv[3]) : 3;
+	const string meshfiles[] = {"../../testcases/naca0012/naca0012-inviscid.msh", "../../testcases/bumpchannel/bumpchannel.msh"};
+	const Vector uinf = eulerFreeStreamState(1.4, 0.5, 2.0*PI/180.0, 1.0, 1.0);
+
+	for(int imesh = 0; imesh < 2; imesh++)
+	{
+		UMesh2dh m;
+		m.readGmsh2(meshfiles[imesh], 2);
+		m.compute_topological();
+		m.compute_boundary_maps();
+
+		cout << "\n" << meshfiles[imesh] << ": elements " << m.gnelem() << ", throughput" << endl;
+		throughput(m, uinf, maxdegree, nevals);
+		cout << "\n" << meshfiles[imesh] << ": elements " << m.gnelem() << ", degree " << degree 
+			<< ", numerical flux at compile time and virtually" << endl;
+		compareDispatch(m, uinf, degree, nevals);
+	}
+	return 0;
+}
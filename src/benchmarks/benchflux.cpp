@@ -0,0 +1,107 @@
+/** @file benchflux.cpp
+ * @brief Compares the throughput of the per-point and batched inviscid numerical fluxes
+ *
+ * Usage: flux [number of points [points per batch [number of evaluations]]]
+ * Random left and right states and normals are generated. The per-point path calls get_flux once per point on
+ * states stored point by point, as face loops over quadrature points do. The batched path calls get_fluxes once per
+ * batch of points (for example, the quadrature points of a face) on states stored as structure of arrays.
+ * Build with NATIVE=1 to vectorise with the widest instructions of the machine.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include "../anumericalfluxeuler.hpp"
+
+using namespace acfd;
+using namespace std;
+
+/// Returns the time taken to compute fluxes point by point; states are npoin x 4 and normals npoin x 2
+double runPointwise(InviscidNumericalFlux *const flux, const Matrix& ul, const Matrix& ur, const Matrix& n, Matrix& f)
+{
+	auto start = chrono::steady_clock::now();
+	for(a_int i = 0; i < ul.rows(); i++)
+		flux->get_flux(&ul(i,0), &ur(i,0), &n(i,0), &f(i,0));
+	auto end = chrono::steady_clock::now();
+	return chrono::duration<double>(end-start).count();
+}
+
+/// Returns the time taken to compute fluxes batch by batch; each batch is stored contiguously as structure of arrays
+double runBatched(InviscidNumericalFlux *const flux, const int batch, const Matrix& ul, const Matrix& ur, const Matrix& n,
+		Matrix& f)
+{
+	const a_int nbatches = ul.rows();
+	auto start = chrono::steady_clock::now();
+	for(a_int ib = 0; ib < nbatches; ib++)
+		flux->get_fluxes(batch, &ul(ib,0), &ur(ib,0), &n(ib,0), &f(ib,0));
+	auto end = chrono::steady_clock::now();
+	return chrono::duration<double>(end-start).count();
+}
+
+/// Random conserved states with densities and pressures in [0.5,1.5] and velocity components in [-vmax,vmax]
+Matrix randomStates(const a_int npoin, const a_real g, const a_real vmax)
+{
+	const Matrix r = Matrix::Random(npoin,4);
+	Matrix u(npoin,4);
+	for(a_int i = 0; i < npoin; i++)
+	{
+		const a_real rho = 1.0 + 0.5*r(i,0), p = 1.0 + 0.5*r(i,1);
+		const a_real vx = vmax*r(i,2), vy = vmax*r(i,3);
+		u(i,0) = rho; u(i,1) = rho*vx; u(i,2) = rho*vy;
+		u(i,3) = p/(g-1.0) + 0.5*rho*(vx*vx+vy*vy);
+	}
+	return u;
+}
+
+/// Rearranges point-by-point data (npoin x nc) into batches of structure-of-arrays data (npoin/batch x nc*batch)
+Matrix toBatches(const Matrix& a, const int batch)
+{
+	const a_int nbatches = a.rows()/batch;
+	Matrix b(nbatches, a.cols()*batch);
+	for(a_int ib = 0; ib < nbatches; ib++)
+		for(int ic = 0; ic < a.cols(); ic++)
+			for(int i = 0; i < batch; i++)
+				b(ib, ic*batch+i) = a(ib*batch+i, ic);
+	return b;
+}
+
+int main(int argc, char* argv[])
+{
+	const int batch = argc > 2 ? atoi(argv[2]) : 4;
+	const a_int npoin = (argc > 1 ? atol(argv[1]) : 1000000)/batch*batch;
+	const int nevals = argc > 3 ? atoi(argv[3]) : 5;
+	const a_real g = 1.4;
+
+	// states range from subsonic to supersonic so that all branches of the fluxes are taken
+	const Matrix ul = randomStates(npoin, g, 2.0), ur = randomStates(npoin, g, 2.0);
+	const Vector angles = 4.0*std::atan(1.0)*Vector::Random(npoin);
+	Matrix n(npoin,2);
+	for(a_int i = 0; i < npoin; i++) {
+		const a_real theta = angles(i);
+		n(i,0) = std::cos(theta); n(i,1) = std::sin(theta);
+	}
+	const Matrix bul = toBatches(ul, batch), bur = toBatches(ur, batch), bn = toBatches(n, batch);
+
+	InviscidNumericalFlux* fluxes[] = {new LocalLaxFriedrichsFlux(g), new VanLeerFlux(g), new RoeFlux(g), new HLLCFlux(g)};
+	const char* names[] = {"LLF", "Van Leer", "Roe", "HLLC"};
+
+	cout << "\nPoints: " << npoin << ", points per batch: " << batch << endl;
+	cout << setw(10) << "flux" << setw(18) << "per point (pt/s)" << setw(18) << "batched (pt/s)" << setw(12) << "speedup"
+		<< setw(14) << "max diff" << endl;
+	for(int iflux = 0; iflux < 4; iflux++)
+	{
+		Matrix f(npoin,4), bf(npoin/batch, 4*batch);
+		runPointwise(fluxes[iflux], ul, ur, n, f);
+		runBatched(fluxes[iflux], batch, bul, bur, bn, bf);
+		double tp = 0, tb = 0;
+		for(int it = 0; it < nevals; it++) {
+			tp += runPointwise(fluxes[iflux], ul, ur, n, f);
+			tb += runBatched(fluxes[iflux], batch, bul, bur, bn, bf);
+		}
+
+		const a_real diff = (toBatches(f, batch)-bf).cwiseAbs().maxCoeff();
+		cout << setw(10) << names[iflux] << setw(18) << npoin*nevals/tp << setw(18) << npoin*nevals/tb << setw(12) << tp/tb
+			<< setw(14) << diff << endl;
+		delete fluxes[iflux];
+	}
+	return 0;
+}
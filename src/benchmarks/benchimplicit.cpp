@@ -0,0 +1,155 @@
+/** @file benchimplicit.cpp
+ * @brief Time to solution of implicit BDF2 and ESDIRK3 time stepping against explicit RK for an isentropic vortex
+ *
+ * Usage: implicit [degree [explicit CFL [final time [time steps between preconditioner updates]]]]
+ * An isentropic vortex in a Mach 0.5 free stream is convected across the triangular mesh of the unit square in
+ * testcases/isentropicvortex, whose boundaries (marker 9) are far-field boundaries. The explicit TVD RK3 and
+ * low-storage RK4 schemes use the largest time step that divides the final time and does not exceed the CFL
+ * number times the smallest local time step; the implicit schemes use time steps that many times as large.
+ * For each run, the wall-clock time, the number of residual evaluations (including those of Jacobian-vector
+ * products and of the preconditioner), the L2 error in density against the exact solution and the difference
+ * in density from the RK4 solution (which is mostly the temporal error) are printed. Since the preconditioner
+ * costs one residual per DOF of an element per element colour, it is by default updated every 10 time steps.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include "../aspatialeuler.hpp"
+#include "../atimetvdrk.hpp"
+#include "../atimeimplicit.hpp"
+
+using namespace acfd;
+using namespace std;
+
+const a_real gam = 1.4;
+const a_real mach = 0.5;
+/// Free-stream temperature p/rho, for unit density and speed
+const a_real tinf = 1.0/(gam*mach*mach);
+/// Vortex strength and radius, and its centre at the initial time
+const a_real vstrength = 2.0, vradius = 0.05, xc = 0.4, yc = 0.5;
+
+/// Velocity perturbation factor and temperature of the vortex convected with unit speed in x for time t
+void vortex(const a_real x, const a_real y, const a_real t, a_real& xb, a_real& yb, a_real& f, a_real& temp)
+{
+	xb = (x - xc - t)/vradius; yb = (y - yc)/vradius;
+	const a_real e = std::exp(0.5*(1.0 - xb*xb - yb*yb));
+	f = vstrength/(2*PI) * e;
+	temp = tinf - (gam-1.0)/(2*gam) * f*f;
+}
+
+a_real density(const a_real x, const a_real y, const a_real t)
+{
+	a_real xb, yb, f, temp;
+	vortex(x, y, t, xb, yb, f, temp);
+	return std::pow(temp/tinf, 1.0/(gam-1.0));
+}
+
+a_real rho0(const a_real x, const a_real y) {
+	return density(x, y, 0);
+}
+
+a_real rhou0(const a_real x, const a_real y) {
+	a_real xb, yb, f, temp;
+	vortex(x, y, 0, xb, yb, f, temp);
+	return density(x, y, 0) * (1.0 - f*yb);
+}
+
+a_real rhov0(const a_real x, const a_real y) {
+	a_real xb, yb, f, temp;
+	vortex(x, y, 0, xb, yb, f, temp);
+	return density(x, y, 0) * f*xb;
+}
+
+a_real rhoe0(const a_real x, const a_real y) {
+	a_real xb, yb, f, temp;
+	vortex(x, y, 0, xb, yb, f, temp);
+	const a_real rho = density(x, y, 0);
+	const a_real uu = 1.0 - f*yb, vv = f*xb;
+	return rho*temp/(gam-1.0) + 0.5*rho*(uu*uu + vv*vv);
+}
+
+void setVortex(SpatialBase<NEULERVARS>* sd, DOFVector& u)
+{
+	sd->setInitialConditionProjection(0, rho0, u);
+	sd->setInitialConditionProjection(1, rhou0, u);
+	sd->setInitialConditionProjection(2, rhov0, u);
+	sd->setInitialConditionProjection(3, rhoe0, u);
+}
+
+/// Integrates from the initial vortex, leaving the solution in u; returns the wall-clock time
+template <class Stepper>
+double run(SpatialBase<NEULERVARS>* sd, Stepper& td, DOFVector& u)
+{
+	setVortex(sd, td.solution());
+	auto start = chrono::steady_clock::now();
+	td.integrate();
+	auto end = chrono::steady_clock::now();
+	u = td.solution();
+	return chrono::duration<double>(end-start).count();
+}
+
+int main(int argc, char* argv[])
+{
+	const int degree = argc > 1 ? atoi(argv[1]) : 1;
+	const double cfl = argc > 2 ? atof(argv[2]) : 0.5;
+	const double ftime = argc > 3 ? atof(argv[3]) : 0.002;
+	const int jacinterval = argc > 4 ? atoi(argv[4]) : 10;
+
+	UMesh2dh m;
+	m.readGmsh2("../../testcases/isentropicvortex/densemesh.msh", 2);
+	m.compute_topological();
+	m.compute_boundary_maps();
+
+	const Vector uinf = eulerFreeStreamState(gam, mach, 0.0, 1.0, 1.0);
+	CompressibleEulerBase* sd = createCompressibleEuler("HLLC", 's', &m, degree, 'o', gam, uinf, -1, 9);
+
+	// explicit time step
+	DOFVector u, res;
+	std::vector<a_real> mets;
+	sd->spatialSetup(u, res, mets);
+	setVortex(sd, u);
+	sd->update_residual(u, res, mets);
+	const a_int nexp = static_cast<a_int>(std::ceil(ftime/(cfl * *std::min_element(mets.begin(), mets.end()))));
+	const double dt = ftime/nexp;
+
+	cout << "\nElements " << m.gnelem() << ", degree " << degree << ", final time " << ftime
+		<< ", explicit time step " << dt << endl;
+	cout << setw(10) << "scheme" << setw(10) << "dt/dt_e" << setw(12) << "wall (s)" << setw(12) << "residuals"
+		<< setw(16) << "error" << setw(16) << "diff. from RK4" << endl;
+
+	DOFVector uref;
+	double twall = 0;
+	{
+		LowStorageRKStepping<NEULERVARS> td(&m, sd, 4, ftime, 0, 'c', dt);
+		twall = run(sd, td, uref);
+		cout << setw(10) << "LSRK4" << setw(10) << 1 << setw(12) << twall << setw(12) << 5*nexp
+			<< setw(16) << sd->computeL2Error(density, ftime, uref) << setw(16) << 0 << endl;
+	}
+	{
+		TVDRKStepping<NEULERVARS> td(&m, sd, 3, ftime, 0, 'c', dt);
+		twall = run(sd, td, u);
+		const a_real err = sd->computeL2Error(density, ftime, u);
+		u.axpy(-1.0, uref);
+		cout << setw(10) << "TVDRK3" << setw(10) << 1 << setw(12) << twall << setw(12) << 3*nexp
+			<< setw(16) << err << setw(16) << sd->computeL2Norm(u, 0) << endl;
+	}
+
+	const int nfactors = 4;
+	const int factors[] = {5, 10, 20, 40};
+	for(int order = 2; order <= 3; order++)
+		for(int ifac = 0; ifac < nfactors; ifac++)
+		{
+			const a_int nsteps = (nexp + factors[ifac] - 1)/factors[ifac];
+			ImplicitStepping<NEULERVARS> td(&m, sd, order, ftime, 0, 'c', ftime/nsteps, 1e-6, 10, 30, 1e-3, 100,
+					jacinterval);
+			twall = run(sd, td, u);
+			const a_real err = sd->computeL2Error(density, ftime, u);
+			u.axpy(-1.0, uref);
+			cout << setw(10) << (order == 2 ? "BDF2" : "ESDIRK3") << setw(10) << static_cast<double>(nexp)/nsteps
+				<< setw(12) << twall << setw(12) << td.residualCount()
+				<< setw(16) << err << setw(16) << sd->computeL2Norm(u, 0) << endl;
+		}
+
+	delete sd;
+	return 0;
+}
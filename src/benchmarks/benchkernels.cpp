@@ -0,0 +1,90 @@
+/** @file benchkernels.cpp
+ * @brief Compares the element kernels specialised at compile time with the dynamically sized ones
+ *
+ * Usage: kernels [number of elements [number of evaluations]]
+ * For Lagrange bases on triangles and quadrangles of degrees 1 to 3, and for 1 and 4 variables,
+ * random functions are evaluated at the quadrature points of each element and integrated against
+ * the test function gradients, as in the volume term of the residual.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include "../adofvector.hpp"
+#include "../aelementkernels.hpp"
+
+using namespace acfd;
+using namespace std;
+
+/// Returns the time taken by the volume-term kernels over all elements; the integrals are added to res
+double runKernels(const ElementKernels& kern, const BasisSet& bs, const DOFVector& u, DOFVector& res)
+{
+	Matrix vals, fy, term(u.nvars(), bs.basis.cols());
+
+	auto start = chrono::steady_clock::now();
+	for(a_int iel = 0; iel < u.nelem(); iel++)
+	{
+		kern.interpolate(bs, u[iel], vals);
+		fy = 0.5*vals;
+		term.setZero();
+		kern.integrateGradients(bs, vals, fy, term);
+		res[iel] += term;
+	}
+	auto end = chrono::steady_clock::now();
+	return chrono::duration<double>(end-start).count();
+}
+
+template <int nvars>
+void compareKernels(const Shape shape, const int degree, const a_int nelem, const int nevals)
+{
+	Quadrature2DTriangle tquad;
+	Quadrature2DSquare squad;
+	Quadrature2D* quad = &squad;
+	if(shape == TRIANGLE)
+		quad = &tquad;
+	quad->initialize(2*degree);
+
+	BasisRegistry reg;
+	const BasisSet* bs = reg.get(shape, degree, quad);
+	const ElementKernels fixed = getElementKernels<nvars>(shape, degree, 'l', quad);
+	const ElementKernels dynamic = makeElementKernels<DynamicElementKernels>(false);
+
+	DOFVector u(nvars, vector<int>(nelem, bs->basis.cols()));
+	for(a_int iel = 0; iel < nelem; iel++)
+		u[iel] = Matrix::Random(nvars, bs->basis.cols());
+	DOFVector resf(u), resd(u);
+	resf.setZero(); resd.setZero();
+
+	runKernels(dynamic, *bs, u, resd);
+	runKernels(fixed, *bs, u, resf);
+	double td = 0, tf = 0;
+	for(int it = 0; it < nevals; it++) {
+		td += runKernels(dynamic, *bs, u, resd);
+		tf += runKernels(fixed, *bs, u, resf);
+	}
+
+	a_real diff = 0;
+	for(a_int iel = 0; iel < nelem; iel++)
+		diff = std::max(diff, (resd[iel]-resf[iel]).cwiseAbs().maxCoeff());
+
+	cout << setw(12) << (shape == TRIANGLE ? "triangle" : "quadrangle") << setw(8) << degree << setw(8) << nvars 
+		<< setw(14) << td/nevals << setw(14) << tf/nevals << setw(12) << td/tf << setw(14) << diff << endl;
+}
+
+int main(int argc, char* argv[])
+{
+	const a_int nelem = argc > 1 ? atol(argv[1]) : 100000;
+	const int nevals = argc > 2 ? atoi(argv[2]) : 5;
+
+	cout << "\nElements: " << nelem << endl;
+	cout << setw(12) << "shape" << setw(8) << "degree" << setw(8) << "nvars" << setw(14) << "dynamic (s)" 
+		<< setw(14) << "fixed (s)" << setw(12) << "speedup" << setw(14) << "max diff" << endl;
+	for(int degree = 1; degree <= 3; degree++) {
+		compareKernels<1>(TRIANGLE, degree, nelem, nevals);
+		compareKernels<4>(TRIANGLE, degree, nelem, nevals);
+	}
+	for(int degree = 1; degree <= 3; degree++) {
+		compareKernels<1>(QUADRANGLE, degree, nelem, nevals);
+		compareKernels<4>(QUADRANGLE, degree, nelem, nevals);
+	}
+	return 0;
+}
@@ -0,0 +1,159 @@
+/** @file benchlts.cpp
+ * @brief Accuracy and speed-up of local time stepping by multirate Adams-Bashforth on graded cylinder meshes
+ *
+ * Usage: lts [degree [CFL [max levels [number of coarsest steps]]]]
+ * First, a Gaussian bump is advected past the cylinder on the medium mesh for about two time units. With global (one level) and local
+ * time steps, for Adams-Bashforth orders 2 and 3, the solution at the final time with finest time steps dt and
+ * dt/2 is compared with one computed by the fourth-order low-storage RK scheme with time step dt/8.
+ * Then the flow of the Euler equations past the cylinder at Mach 0.38 is started from the free stream on each
+ * cylinder mesh and integrated with Adams-Bashforth of order 3, with global and local time steps.
+ * The number of element residual evaluations, wall-clock times and the speed-up are printed,
+ * along with the difference between the two solutions relative to the solution.
+ * The Euler runs take the given number of steps of the coarsest level allowed; the first two of them are the
+ * start-up by SSP RK3 at the finest step, so the ratio of residual evaluations approaches its asymptotic
+ * value only with many steps. In all cases the final time is a whole number of steps of the coarsest level.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include "../aspatialadvection.hpp"
+#include "../aspatialeuler.hpp"
+#include "../atimetvdrk.hpp"
+#include "../atimelts.hpp"
+
+using namespace acfd;
+using namespace std;
+
+a_real initial(const a_real x, const a_real y)
+{
+	return std::exp(-10.0*((x+1.5)*(x+1.5) + (y-1.5)*(y-1.5)));
+}
+
+/// Reads a mesh and computes its connectivity
+void readMesh(const string& file, UMesh2dh& m)
+{
+	m.readGmsh2(file, 2);
+	m.compute_topological();
+	m.compute_boundary_maps();
+}
+
+/// Smallest of the local time steps of a state
+a_real smallestTimeStep(SpatialBase<NEULERVARS>* sd, const DOFVector& u)
+{
+	DOFVector res = u;
+	std::vector<a_real> mets;
+	res.setZero();
+	mets.resize(u.nelem());
+	sd->update_residual(u, res, mets);
+	return *std::min_element(mets.begin(), mets.end());
+}
+
+/// Integrates with LocalTimeStepping and returns the wall-clock time; the solution is left in u
+template <short nvars>
+double runLTS(const UMesh2dh& m, SpatialBase<nvars>* sd, const int order, const double ftime, const double dt,
+		const int nlevels, DOFVector& u, long& nelemres)
+{
+	LocalTimeStepping<nvars> td(&m, sd, order, ftime, 0, 'c', dt, nlevels);
+	td.solution() = u;
+	auto start = chrono::steady_clock::now();
+	td.integrate();
+	auto end = chrono::steady_clock::now();
+	u = td.solution();
+	nelemres = td.elementResidualCount();
+	return chrono::duration<double>(end-start).count();
+}
+
+void advectionAccuracy(const int degree, const double cfl, const int maxlevels)
+{
+	UMesh2dh m;
+	readMesh("../../testcases/2dcylinder/2dcylinder-medium.msh", m);
+	Vector a(2); a[0] = 1.0; a[1] = 0.0;
+	// far-field inflow values from the initial bump, which is negligible there; extrapolation at the cylinder
+	LinearAdvection sd(&m, degree, 'o', a, 4, 2, initial);
+
+	DOFVector u0, res;
+	std::vector<a_real> mets;
+	sd.spatialSetup(u0, res, mets);
+	sd.setInitialConditionProjection(0, initial, u0);
+	sd.update_residual(u0, res, mets);
+	// the local time steps of the advection operator do not account for the degree
+	const double dt = cfl/(2*degree+1) * *std::min_element(mets.begin(), mets.end());
+	// about two time units, until the bump has passed the cylinder
+	const double tcoarse = dt * (1 << (maxlevels-1));
+	const double ftime = std::ceil(2.0/tcoarse) * tcoarse;
+
+	DOFVector uref;
+	{
+		LowStorageRKStepping<1> td(&m, &sd, 4, ftime, 0, 'c', dt/8);
+		td.solution() = u0;
+		td.integrate();
+		uref = td.solution();
+	}
+	const a_real refnorm = sd.computeL2Norm(uref, 0);
+
+	cout << "\nAdvection past the cylinder, medium mesh, degree " << degree << ", final time " << ftime << endl;
+	cout << setw(8) << "order" << setw(8) << "levels" << setw(16) << "error (dt)" << setw(16) << "error (dt/2)"
+		<< setw(10) << "rate" << setw(16) << "elem. res." << endl;
+	for(int order = 2; order <= 3; order++)
+		for(int nl = 1; nl <= maxlevels; nl += maxlevels-1)
+		{
+			double err[2]; long nres[2];
+			for(int ir = 0; ir < 2; ir++) {
+				DOFVector u = u0;
+				runLTS(m, &sd, order, ftime, dt/(1 << ir), nl, u, nres[ir]);
+				u.axpy(-1.0, uref);
+				err[ir] = sd.computeL2Norm(u, 0)/refnorm;
+			}
+			cout << setw(8) << order << setw(8) << nl << setw(16) << err[0] << setw(16) << err[1]
+				<< setw(10) << std::log2(err[0]/err[1]) << setw(16) << nres[0] << endl;
+			if(maxlevels == 1) break;
+		}
+}
+
+void eulerSpeedup(const int degree, const double cfl, const int maxlevels, const int ncoarse)
+{
+	const string meshes[] = {"coarse", "medium", "fine", "vfine"};
+	const Vector uinf = eulerFreeStreamState(1.4, 0.38, 0.0, 1.0, 1.0);
+
+	cout << "\nEuler flow past the cylinder, degree " << degree << ", AB3, " << ncoarse
+		<< " steps of the coarsest allowed level" << endl;
+	cout << setw(8) << "mesh" << setw(10) << "elements" << setw(16) << "global (s)" << setw(16) << "local (s)"
+		<< setw(10) << "speedup" << setw(14) << "res. ratio" << setw(14) << "rel. diff." << endl;
+	for(int imesh = 0; imesh < 4; imesh++)
+	{
+		UMesh2dh m;
+		readMesh("../../testcases/2dcylinder/2dcylinder-" + meshes[imesh] + ".msh", m);
+		CompressibleEulerBase* sd = createCompressibleEuler("HLLC", 's', &m, degree, 'o', 1.4, uinf, 2, 4);
+
+		DOFVector u0, res;
+		std::vector<a_real> mets;
+		sd->spatialSetup(u0, res, mets);
+		sd->setFreeStreamState(u0);
+		const double dt = cfl*smallestTimeStep(sd, u0);
+		const double ftime = ncoarse * dt * (1 << (maxlevels-1));
+
+		DOFVector ug = u0, ul = u0;
+		long nresg, nresl;
+		const double tg = runLTS(m, sd, 3, ftime, dt, 1, ug, nresg);
+		const double tl = runLTS(m, sd, 3, ftime, dt, maxlevels, ul, nresl);
+
+		const a_real norm = sd->computeL2Norm(ug, 0);
+		ul.axpy(-1.0, ug);
+		cout << setw(8) << meshes[imesh] << setw(10) << m.gnelem() << setw(16) << tg << setw(16) << tl
+			<< setw(10) << tg/tl << setw(14) << static_cast<double>(nresg)/nresl
+			<< setw(14) << sd->computeL2Norm(ul, 0)/norm << endl;
+		delete sd;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const int degree = argc > 1 ? atoi(argv[1]) : 1;
+	const double cfl = argc > 2 ? atof(argv[2]) : 0.3;
+	const int maxlevels = argc > 3 ? atoi(argv[3]) : 6;
+	const int ncoarse = argc > 4 ? atoi(argv[4]) : 50;
+
+	advectionAccuracy(degree, cfl, maxlevels);
+	eulerSpeedup(degree, cfl, maxlevels, ncoarse);
+	return 0;
+}
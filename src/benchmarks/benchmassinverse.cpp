@@ -0,0 +1,75 @@
+/** @file benchmassinverse.cpp
+ * @brief Compares the setup and mass matrix inversion costs of the Lagrange, orthonormal and Gauss-Lobatto bases
+ *
+ * Usage: massinverse [n [degree [t|q [number of applications]]]]
+ * A mesh of the unit square with 2 n^2 triangles (t) or n^2 quadrangles (q) is generated. For each basis,
+ * the time for setting up the finite element data (including the mass matrices) and the average time for
+ * applying the inverse mass matrices to the DOFs once, as every explicit stage does, are printed.
+ * The L2 norms of the L2 projection of a function onto both bases should agree, as they span the same space.
+ * On quadrangles, the collocated Gauss-Lobatto basis is timed as well; its mass matrices are diagonal
+ * even on curved elements, and its norm differs slightly as its projection and norm use Gauss-Lobatto quadrature.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include "../aspatialadvection.hpp"
+
+using namespace acfd;
+using namespace std;
+
+a_real bcfunc(const a_real x, const a_real y)
+{
+	return std::sin(2*PI*y);
+}
+
+double initial(const a_real x, const a_real y)
+{
+	return std::sin(2*PI*x)*std::cos(2*PI*y);
+}
+
+void timeBasis(const UMesh2dh& m, const int degree, const char basis, const int napps)
+{
+	Vector a(2); a[0] = 1.0; a[1] = 0.5;
+	LinearAdvection sd(&m, degree, basis, a, 1, 2, bcfunc);
+	DOFVector u, res;
+	std::vector<a_real> mets;
+
+	auto start = chrono::steady_clock::now();
+	sd.spatialSetup(u, res, mets);
+	auto end = chrono::steady_clock::now();
+	const double tsetup = chrono::duration<double>(end-start).count();
+
+	sd.setInitialConditionProjection(0, initial, u);
+	const a_real norm = sd.computeL2Norm(u, 0);
+
+	res = u;
+	start = chrono::steady_clock::now();
+	for(int it = 0; it < napps; it++)
+		sd.applyMassInverse(res);
+	end = chrono::steady_clock::now();
+	const double tapply = chrono::duration<double>(end-start).count()/napps;
+
+	cout << setw(8) << basis << setw(16) << tsetup << setw(16) << tapply << setw(20) << setprecision(12) << norm
+		<< setprecision(6) << endl;
+}
+
+int main(int argc, char* argv[])
+{
+	const a_int n = argc > 1 ? atol(argv[1]) : 200;
+	const int degree = argc > 2 ? atoi(argv[2]) : 2;
+	const Shape shape = (argc > 3 && argv[3][0] == 'q') ? QUADRANGLE : TRIANGLE;
+	const int napps = argc > 4 ? atoi(argv[4]) : 50;
+
+	UMesh2dh m;
+	m.generateRectangle(0,1,0,1, n,n, shape);
+	m.compute_topological();
+	m.compute_boundary_maps();
+
+	cout << "\nElements " << m.gnelem() << ", degree " << degree << endl;
+	cout << setw(8) << "basis" << setw(16) << "setup (s)" << setw(16) << "M^-1 apply (s)" << setw(20) << "L2 norm" << endl;
+	timeBasis(m, degree, 'l', napps);
+	timeBasis(m, degree, 'o', napps);
+	if(shape == QUADRANGLE)
+		timeBasis(m, degree, 'g', napps);
+	return 0;
+}
@@ -0,0 +1,93 @@
+/** @file benchordering.cpp
+ * @brief Measures the effect of element orderings on the cost of evaluating the linear advection residual
+ *
+ * Usage: benchordering [n [degree [number of evaluations]]]
+ * A triangle mesh of the unit square with 2 n^2 elements is generated and its elements are shuffled randomly, 
+ * to emulate a mesh generator's ordering with poor locality. The residual is then timed for the shuffled ordering
+ * and for the Hilbert and reverse Cuthill-McKee orderings computed from it.
+ */
+
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include "../aspatialadvection.hpp"
+
+using namespace acfd;
+using namespace std;
+
+a_real bcfunc(const a_real x, const a_real y)
+{
+	return std::sin(2*PI*y);
+}
+
+double initial(const a_real x, const a_real y)
+{
+	return std::sin(2*PI*x)*std::cos(2*PI*y);
+}
+
+/// Returns the average wall-clock time of one residual evaluation, and the L2 norm of the residual
+double timeResidual(const UMesh2dh& m, const int degree, const int nevals, a_real& resnorm)
+{
+	Vector a(2); a[0] = 1.0; a[1] = 0.5;
+	LinearAdvection sd(&m, degree, 'l', a, 1, 2, bcfunc);
+	DOFVector u, res;
+	std::vector<a_real> mets;
+	sd.spatialSetup(u, res, mets);
+	double (*init[1])(a_real,a_real) = {initial};
+	sd.setInitialConditionNodal(0, init, u);
+
+	double total = 0;
+	for(int it = 0; it < nevals; it++)
+	{
+		res.setZero();
+		auto start = chrono::steady_clock::now();
+		sd.update_residual(u, res, mets);
+		auto end = chrono::steady_clock::now();
+		total += chrono::duration<double>(end-start).count();
+	}
+	resnorm = res.norm();
+	return total/nevals;
+}
+
+int main(int argc, char* argv[])
+{
+	const a_int n = argc > 1 ? atol(argv[1]) : 300;
+	const int degree = argc > 2 ? atoi(argv[2]) : 1;
+	const int nevals = argc > 3 ? atoi(argv[3]) : 10;
+
+	UMesh2dh m;
+	m.generateRectangle(0,1,0,1, n,n, TRIANGLE);
+	std::vector<a_int> shuffle(m.gnelem());
+	for(a_int i = 0; i < m.gnelem(); i++)
+		shuffle[i] = i;
+	std::mt19937 gen(42);
+	std::shuffle(shuffle.begin(), shuffle.end(), gen);
+	m.permute_elements(shuffle);
+	m.compute_topological();
+	m.compute_boundary_maps();
+
+	const char orderings[] = {'n', 'h', 'r'};
+	const string names[] = {"shuffled", "Hilbert", "RCM"};
+	double tref = 0;
+	std::vector<string> lines;
+	for(int i = 0; i < 3; i++)
+	{
+		// each ordering is computed from the shuffled mesh
+		UMesh2dh mo = m;
+		if(orderings[i] != 'n')
+			mo.reorder_elements(orderings[i]);
+		a_real resnorm;
+		const double t = timeResidual(mo, degree, nevals, resnorm);
+		if(i == 0) tref = t;
+		ostringstream line;
+		line << setw(12) << names[i] << setw(16) << t << setw(10) << tref/t << setw(24) << setprecision(15) << resnorm;
+		lines.push_back(line.str());
+	}
+
+	cout << "\nElements: " << m.gnelem() << ", degree " << degree << endl;
+	cout << setw(12) << "ordering" << setw(16) << "residual (s)" << setw(10) << "speedup" << setw(24) << "residual norm" << endl;
+	for(size_t i = 0; i < lines.size(); i++)
+		cout << lines[i] << endl;
+	return 0;
+}
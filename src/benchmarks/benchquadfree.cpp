@@ -0,0 +1,85 @@
+/** @file benchquadfree.cpp
+ * @brief Compares the linear advection residual computed with quadrature and without (quadrature-free)
+ *
+ * Usage: quadfree [n [degree [number of evaluations [l|o]]]]
+ * A triangle mesh of the unit square with 2 n^2 elements is generated and ordered along a Hilbert curve.
+ * The residual is timed in scatter and gather modes, with and without quadrature; the largest difference
+ * between the residuals with and without quadrature is printed as a check.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include "../aspatialadvection.hpp"
+
+using namespace acfd;
+using namespace std;
+
+a_real bcfunc(const a_real x, const a_real y)
+{
+	return std::sin(2*PI*y);
+}
+
+double initial(const a_real x, const a_real y)
+{
+	return std::sin(2*PI*x)*std::cos(2*PI*y);
+}
+
+/// Returns the average wall-clock time of one residual evaluation, leaving the residual in res
+double timeResidual(LinearAdvection& sd, const int nevals, const DOFVector& u, DOFVector& res, std::vector<a_real>& mets)
+{
+	sd.update_residual(u, res, mets);
+
+	double total = 0;
+	for(int it = 0; it < nevals; it++)
+	{
+		res.setZero();
+		auto start = chrono::steady_clock::now();
+		sd.update_residual(u, res, mets);
+		auto end = chrono::steady_clock::now();
+		total += chrono::duration<double>(end-start).count();
+	}
+	return total/nevals;
+}
+
+int main(int argc, char* argv[])
+{
+	const a_int n = argc > 1 ? atol(argv[1]) : 300;
+	const int degree = argc > 2 ? atoi(argv[2]) : 1;
+	const int nevals = argc > 3 ? atoi(argv[3]) : 10;
+	const char basis = argc > 4 ? argv[4][0] : 'l';
+
+	UMesh2dh m;
+	m.generateRectangle(0,1,0,1, n,n, TRIANGLE);
+	m.compute_topological();
+	m.compute_boundary_maps();
+	m.reorder_elements('h');
+
+	Vector a(2); a[0] = 1.0; a[1] = 0.5;
+	LinearAdvection sd(&m, degree, basis, a, 1, 2, bcfunc);
+	DOFVector u, res, resq;
+	std::vector<a_real> mets;
+	sd.spatialSetup(u, res, mets);
+	sd.setInitialConditionProjection(0, initial, u);
+	resq = res;
+
+	cout << "\nElements " << m.gnelem() << ", degree " << degree << ", basis " << basis << endl;
+	cout << setw(8) << "mode" << setw(18) << "quadrature (s)" << setw(20) << "quadrature-free (s)" << setw(12) 
+		<< "speedup" << setw(16) << "max diff" << endl;
+	const char modes[] = {'s', 'g'};
+	for(int imode = 0; imode < 2; imode++)
+	{
+		sd.setResidualMode(modes[imode]);
+		sd.setQuadratureFree(false);
+		const double tq = timeResidual(sd, nevals, u, resq, mets);
+		if(!sd.setQuadratureFree(true))
+			return -1;
+		const double tf = timeResidual(sd, nevals, u, res, mets);
+
+		a_real diff = 0;
+		for(a_int iel = 0; iel < m.gnelem(); iel++)
+			diff = std::max(diff, (res[iel]-resq[iel]).cwiseAbs().maxCoeff());
+
+		cout << setw(8) << modes[imode] << setw(18) << tq << setw(20) << tf << setw(12) << tq/tf << setw(16) << diff << endl;
+	}
+	return 0;
+}
@@ -0,0 +1,107 @@
+/** @file benchresidualmode.cpp
+ * @brief Compares scatter (coloured face loop) and gather (element-wise face walk) assembly of the residual
+ *
+ * Usage: residualmode [n [degree [number of evaluations [max threads]]]]
+ * A triangle mesh of the unit square with 2 n^2 elements is generated and ordered along a Hilbert curve.
+ * The linear advection residual is timed in both modes with 1, 2, 4, ... threads up to the maximum number
+ * of threads (capped at the number available to OpenMP). The difference between the residuals computed
+ * in the two modes is printed as a check. Compile with OMP=1 for multi-threaded runs.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "../aspatialadvection.hpp"
+
+using namespace acfd;
+using namespace std;
+
+a_real bcfunc(const a_real x, const a_real y)
+{
+	return std::sin(2*PI*y);
+}
+
+double initial(const a_real x, const a_real y)
+{
+	return std::sin(2*PI*x)*std::cos(2*PI*y);
+}
+
+/// Returns the average wall-clock time of one residual evaluation, leaving the residual in res
+template <typename Spatial>
+double timeResidual(Spatial& sd, const int nevals, 
+		const DOFVector& u, DOFVector& res, std::vector<a_real>& mets)
+{
+	// one untimed evaluation to spawn the thread team and warm the caches
+	sd.update_residual(u, res, mets);
+
+	double total = 0;
+	for(int it = 0; it < nevals; it++)
+	{
+		res.setZero();
+		auto start = chrono::steady_clock::now();
+		sd.update_residual(u, res, mets);
+		auto end = chrono::steady_clock::now();
+		total += chrono::duration<double>(end-start).count();
+	}
+	return total/nevals;
+}
+
+/// Times both modes for one operator and prints a line per thread count
+template <typename Spatial>
+void compareModes(const string& name, Spatial& sd, const a_int nelem, const int nevals, const int maxthreads,
+		const DOFVector& u, DOFVector& res, std::vector<a_real>& mets)
+{
+	DOFVector resg(res);
+	cout << "\n" << name << ": elements " << nelem << ", face colours " << sd.numFaceColours() << endl;
+	cout << setw(10) << "threads" << setw(16) << "scatter (s)" << setw(16) << "gather (s)" << setw(16) 
+		<< "gather/scatter" << setw(16) << "max diff" << endl;
+	for(int nthreads = 1; nthreads <= maxthreads; nthreads *= 2)
+	{
+#ifdef _OPENMP
+		omp_set_num_threads(nthreads);
+#endif
+		sd.setResidualMode('s');
+		const double ts = timeResidual(sd, nevals, u, res, mets);
+		sd.setResidualMode('g');
+		const double tg = timeResidual(sd, nevals, u, resg, mets);
+
+		a_real diff = 0;
+		for(a_int iel = 0; iel < nelem; iel++)
+			diff = std::max(diff, (res[iel]-resg[iel]).cwiseAbs().maxCoeff());
+
+		cout << setw(10) << nthreads << setw(16) << ts << setw(16) << tg << setw(16) << tg/ts << setw(16) << diff << endl;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const a_int n = argc > 1 ? atol(argv[1]) : 300;
+	const int degree = argc > 2 ? atoi(argv[2]) : 1;
+	const int nevals = argc > 3 ? atoi(argv[3]) : 10;
+	int maxthreads = argc > 4 ? atoi(argv[4]) : 64;
+
+#ifdef _OPENMP
+	if(maxthreads > omp_get_num_procs()) maxthreads = omp_get_num_procs();
+#else
+	maxthreads = 1;
+#endif
+
+	UMesh2dh m;
+	m.generateRectangle(0,1,0,1, n,n, TRIANGLE);
+	m.compute_topological();
+	m.compute_boundary_maps();
+	m.reorder_elements('h');
+
+	Vector a(2); a[0] = 1.0; a[1] = 0.5;
+	LinearAdvection sd(&m, degree, 'l', a, 1, 2, bcfunc);
+	DOFVector u, res;
+	std::vector<a_real> mets;
+	sd.spatialSetup(u, res, mets);
+	double (*init[1])(a_real,a_real) = {initial};
+	sd.setInitialConditionNodal(0, init, u);
+
+	compareModes("Linear advection", sd, m.gnelem(), nevals, maxthreads, u, res, mets);
+	return 0;
+}
@@ -0,0 +1,90 @@
+/** @file benchscaling.cpp
+ * @brief Measures strong scaling of the coloured, OpenMP-parallel linear advection residual
+ *
+ * Usage: scaling [n [degree [number of evaluations [max threads]]]]
+ * A triangle mesh of the unit square with 2 n^2 elements is generated and ordered along a Hilbert curve.
+ * The residual is timed with 1, 2, 4, ... threads up to the maximum number of threads (default 64, capped
+ * at the number available to OpenMP). The residual norm is printed to check that it does not depend on
+ * the number of threads. Needs to be compiled with OMP=1 to be meaningful.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "../aspatialadvection.hpp"
+
+using namespace acfd;
+using namespace std;
+
+a_real bcfunc(const a_real x, const a_real y)
+{
+	return std::sin(2*PI*y);
+}
+
+double initial(const a_real x, const a_real y)
+{
+	return std::sin(2*PI*x)*std::cos(2*PI*y);
+}
+
+int main(int argc, char* argv[])
+{
+	const a_int n = argc > 1 ? atol(argv[1]) : 300;
+	const int degree = argc > 2 ? atoi(argv[2]) : 1;
+	const int nevals = argc > 3 ? atoi(argv[3]) : 10;
+	int maxthreads = argc > 4 ? atoi(argv[4]) : 64;
+
+#ifdef _OPENMP
+	if(maxthreads > omp_get_num_procs()) maxthreads = omp_get_num_procs();
+#else
+	cout << "! Not compiled with OpenMP; only 1 thread will be used." << endl;
+	maxthreads = 1;
+#endif
+
+	UMesh2dh m;
+	m.generateRectangle(0,1,0,1, n,n, TRIANGLE);
+	m.compute_topological();
+	m.compute_boundary_maps();
+	m.reorder_elements('h');
+
+	Vector a(2); a[0] = 1.0; a[1] = 0.5;
+	LinearAdvection sd(&m, degree, 'l', a, 1, 2, bcfunc);
+	DOFVector u, res;
+	std::vector<a_real> mets;
+	sd.spatialSetup(u, res, mets);
+	double (*init[1])(a_real,a_real) = {initial};
+	sd.setInitialConditionNodal(0, init, u);
+
+	cout << "\nElements: " << m.gnelem() << ", degree " << degree << ", face colours " << sd.numFaceColours() << endl;
+	cout << setw(10) << "threads" << setw(16) << "residual (s)" << setw(10) << "speedup" << setw(12) << "efficiency" 
+		<< setw(24) << "residual norm" << endl;
+
+	double tref = 0;
+	for(int nthreads = 1; nthreads <= maxthreads; nthreads *= 2)
+	{
+#ifdef _OPENMP
+		omp_set_num_threads(nthreads);
+#endif
+		// one untimed evaluation to spawn the thread team
+		sd.update_residual(u, res, mets);
+
+		double total = 0;
+		for(int it = 0; it < nevals; it++)
+		{
+			res.setZero();
+			auto start = chrono::steady_clock::now();
+			sd.update_residual(u, res, mets);
+			auto end = chrono::steady_clock::now();
+			total += chrono::duration<double>(end-start).count();
+		}
+		const double t = total/nevals;
+		if(nthreads == 1) tref = t;
+
+		const a_real resnorm = res.norm();
+
+		cout << setw(10) << nthreads << setw(16) << t << setw(10) << tref/t << setw(12) << tref/t/nthreads 
+			<< setw(24) << setprecision(15) << resnorm << setprecision(6) << endl;
+	}
+	return 0;
+}
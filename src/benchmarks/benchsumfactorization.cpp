@@ -0,0 +1,114 @@
+/** @file benchsumfactorization.cpp
+ * @brief Compares sum-factorized and dense element kernels for Lagrange quadrangles of increasing degree
+ *
+ * Usage: sumfactorization [mesh file [max degree [number of variables [number of evaluations]]]]
+ * The mesh defaults to the finest quadrangle mesh of the advection test case. For each degree, the values and
+ * reference gradients of a random function are evaluated at the quadrature points of every element, and a flux
+ * is integrated against the test function gradients, as in the volume term of the residual. This is timed
+ * with the dense (npoints x ndofs) kernels and with sum factorization; the degree from which the latter
+ * is faster is the crossover, which SUMFACT_MIN_DEGREE in aelements.hpp should be set to.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include "../amesh2dh.hpp"
+#include "../adofvector.hpp"
+#include "../aelements.hpp"
+
+using namespace acfd;
+using namespace std;
+
+/// Evaluates values and gradients and integrates against the test function gradients for all elements
+/** Returns the time taken in seconds. The integrals are added to res.
+ */
+double runKernels(const BasisSet& bs, const bool sumfact, const DOFVector& u, DOFVector& res)
+{
+	Matrix vals, dx, dy, fx, fy, term(u.nvars(), bs.basis.cols());
+
+	auto start = chrono::steady_clock::now();
+	for(a_int iel = 0; iel < u.nelem(); iel++)
+	{
+		if(sumfact) {
+			tensorEvaluateFunctions(bs.tensor, u[iel], vals);
+			tensorEvaluateGradients(bs.tensor, u[iel], dx, dy);
+		}
+		else {
+			vals.resize(bs.basis.rows(), u.nvars());
+			evaluateFunctions(u[iel], bs.basis, vals);
+			evaluateGradients(bs, u[iel], dx, dy);
+		}
+
+		// a flux that uses both the values and the gradients
+		fx = vals + dy;
+		fy = vals - dx;
+
+		term.setZero();
+		if(sumfact)
+			tensorIntegrateGradients(bs.tensor, fx, fy, term);
+		else
+			integrateGradients(bs, fx, fy, term);
+		res[iel] += term;
+	}
+	auto end = chrono::steady_clock::now();
+	return chrono::duration<double>(end-start).count();
+}
+
+int main(int argc, char* argv[])
+{
+	const string meshfile = argc > 1 ? argv[1] : "../../testcases/advection/grids/squarequad4.msh";
+	const int maxdegree = argc > 2 ? atoi(argv[2]) : TENSOR_MAX_1D-1;
+	const int nvars = argc > 3 ? atoi(argv[3]) : 1;
+	const int nevals = argc > 4 ? atoi(argv[4]) : 5;
+
+	UMesh2dh m;
+	m.readGmsh2(meshfile, 2);
+	for(a_int iel = 0; iel < m.gnelem(); iel++)
+		if(m.gnfael(iel) != 4) {
+			cout << "! The mesh must contain only quadrangles!\n";
+			return -1;
+		}
+
+	cout << "\nQuadrangles: " << m.gnelem() << ", variables " << nvars << endl;
+	cout << setw(8) << "degree" << setw(10) << "points" << setw(14) << "dense (s)" << setw(14) << "sum-fact (s)" 
+		<< setw(14) << "speedup" << setw(14) << "max diff" << endl;
+
+	int crossover = -1;
+	for(int degree = 1; degree <= maxdegree; degree++)
+	{
+		Quadrature2DSquare quad;
+		quad.initialize(2*degree);
+		BasisRegistry reg;
+		const BasisSet* bs = reg.get(QUADRANGLE, degree, &quad);
+
+		DOFVector u(nvars, vector<int>(m.gnelem(), bs->basis.cols()));
+		for(a_int iel = 0; iel < m.gnelem(); iel++)
+			u[iel] = Matrix::Random(nvars, bs->basis.cols());
+		DOFVector resd(u), ress(u);
+		resd.setZero(); ress.setZero();
+
+		// one untimed pass of each, to warm the caches
+		runKernels(*bs, false, u, resd);
+		runKernels(*bs, true, u, ress);
+
+		double td = 0, ts = 0;
+		for(int it = 0; it < nevals; it++) {
+			td += runKernels(*bs, false, u, resd);
+			ts += runKernels(*bs, true, u, ress);
+		}
+
+		a_real diff = 0;
+		for(a_int iel = 0; iel < m.gnelem(); iel++)
+			diff = std::max(diff, (resd[iel]-ress[iel]).cwiseAbs().maxCoeff());
+
+		if(crossover < 0 && ts < td)
+			crossover = degree;
+		cout << setw(8) << degree << setw(10) << quad.numGauss() << setw(14) << td/nevals << setw(14) << ts/nevals 
+			<< setw(14) << td/ts << setw(14) << diff << endl;
+	}
+
+	if(crossover > 0)
+		cout << "Sum factorization is faster from degree " << crossover << " (SUMFACT_MIN_DEGREE is " << SUMFACT_MIN_DEGREE << ")\n";
+	else
+		cout << "Sum factorization is not faster up to degree " << maxdegree << endl;
+	return 0;
+}
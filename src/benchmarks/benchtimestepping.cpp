@@ -0,0 +1,135 @@
+/** @file benchtimestepping.cpp
+ * @brief Compares TVD RK, SSP RK and low-storage RK time stepping in cost, temporal accuracy and stable time step
+ *
+ * Usage: timestepping [n [degree [CFL]]]
+ * A Gaussian bump is advected across a mesh of [-1,1]^2 with n^2 quadrangles and an orthonormal basis.
+ * For each scheme, the solution at the final time with time steps CFL h and CFL h/2 is compared with one computed
+ * by the fourth-order low-storage scheme with time step CFL h/16. The errors and the observed order isolate
+ * the temporal error. The average time of a stage (residual, mass inverse and update) is printed as well;
+ * the low-storage schemes store one DOF vector fewer and pass over the DOFs once per stage after the residual.
+ *
+ * Then the spectral radius of the semi-discrete operator is estimated by power iteration, and each SSP scheme
+ * (including TVDRK3, whose SSP coefficient is 1) is run with the time step given by its SSP coefficient over
+ * the spectral radius, and with 1.5 times that. The number of residual evaluations per unit time and the errors
+ * show how much cheaper the many-stage schemes are for the same stable time stepping.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include "../aspatialadvection.hpp"
+#include "../atimetvdrk.hpp"
+
+using namespace acfd;
+using namespace std;
+
+a_real initial(const a_real x, const a_real y)
+{
+	return std::exp(-50.0*((x+0.2)*(x+0.2) + y*y));
+}
+
+/// Integrates from the initial bump to the final time, leaving the solution in u; returns the time per stage
+template <class Stepper>
+double run(LinearAdvection& sd, Stepper& td, const int nstages, const double ftime,
+		const double dt, DOFVector& u)
+{
+	sd.setInitialConditionProjection(0, initial, td.solution());
+	auto start = chrono::steady_clock::now();
+	td.integrate();
+	auto end = chrono::steady_clock::now();
+	u = td.solution();
+	const int nsteps = static_cast<int>(ftime/dt + 0.5);
+	return chrono::duration<double>(end-start).count()/(nsteps*nstages);
+}
+
+/// Solution at the final time with the given scheme and time step; returns the time per stage
+/** scheme is 'r' (TVD RK), 'l' (low-storage RK) or 'p' (SSP RK with nstages stages).
+ */
+double solve(const UMesh2dh& m, LinearAdvection& sd, const char scheme, const int order, const int nstages,
+		const double ftime, const double dt, DOFVector& u)
+{
+	if(scheme == 'l') {
+		LowStorageRKStepping<1> td(&m, &sd, order, ftime, 0, 'c', dt);
+		return run(sd, td, order == 3 ? 3 : 5, ftime, dt, u);
+	}
+	else if(scheme == 'p') {
+		SSPRKStepping<1> td(&m, &sd, order, nstages, ftime, 0, 'c', dt);
+		return run(sd, td, nstages, ftime, dt, u);
+	}
+	else {
+		TVDRKStepping<1> td(&m, &sd, order, ftime, 0, 'c', dt);
+		return run(sd, td, order, ftime, dt, u);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const a_int n = argc > 1 ? atol(argv[1]) : 40;
+	const int degree = argc > 2 ? atoi(argv[2]) : 2;
+	const double cfl = argc > 3 ? atof(argv[3]) : 0.1;
+	const double ftime = 0.4;
+
+	UMesh2dh m;
+	m.generateRectangle(-1,1,-1,1, n,n, QUADRANGLE);
+	m.compute_topological();
+	m.compute_boundary_maps();
+
+	Vector a(2); a[0] = 1.0; a[1] = 0.0;
+	// the bump is negligible at the boundaries, so the initial condition also serves as inflow value
+	LinearAdvection sd(&m, degree, 'o', a, 1, 2, initial);
+
+	// time steps that divide the final time
+	const double h = 2.0/n;
+	const int nsteps = static_cast<int>(ftime/(cfl*h)) + 1;
+	const double dt = ftime/nsteps;
+
+	DOFVector uref, u;
+	solve(m, sd, 'l', 4, 5, ftime, dt/16, uref);
+
+	const int nschemes = 6;
+	const char schemes[] = {'r', 'l', 'l', 'p', 'p', 'p'};
+	const int orders[] = {3, 3, 4, 3, 3, 4};
+	const int stages[] = {3, 3, 5, 4, 9, 10};
+	const char* names[] = {"TVDRK3", "LSRK3", "LSRK4", "SSPRK(4,3)", "SSPRK(9,3)", "SSPRK(10,4)"};
+	// SSP coefficients, or 0 if not an SSP scheme
+	const double sspcoeffs[] = {1, 0, 0, 2, 6, 6};
+
+	cout << "\nElements " << m.gnelem() << ", degree " << degree << ", DOFs " << sd.numTotalDOFs()
+		<< ", time step " << dt << endl;
+	cout << setw(12) << "scheme" << setw(16) << "stage (s)" << setw(16) << "error (dt)" << setw(16) << "error (dt/2)"
+		<< setw(10) << "order" << endl;
+	for(int is = 0; is < nschemes; is++)
+	{
+		double err[2], tstage = 0;
+		for(int ir = 0; ir < 2; ir++) {
+			const double ts = solve(m, sd, schemes[is], orders[is], stages[is], ftime, dt/(1 << ir), u);
+			if(ir == 0) tstage = ts;
+			u.axpy(-1.0, uref);
+			err[ir] = sd.computeL2Norm(u, 0);
+		}
+		cout << setw(12) << names[is] << setw(16) << tstage << setw(16) << err[0] << setw(16) << err[1]
+			<< setw(10) << std::log2(err[0]/err[1]) << endl;
+	}
+
+	sd.setInitialConditionProjection(0, initial, u);
+	const a_real rho = sd.estimateSpectralRadius(u, NPOWERITER);
+	cout << "\nSpectral radius " << rho << endl;
+	cout << setw(12) << "scheme" << setw(16) << "time step" << setw(16) << "residuals/time" << setw(16) << "error"
+		<< setw(16) << "error (1.5 dt)" << endl;
+	for(int is = 0; is < nschemes; is++)
+	{
+		if(sspcoeffs[is] == 0)
+			continue;
+		double err[2], tstep = 0;
+		for(int ir = 0; ir < 2; ir++) {
+			// the largest time step that divides the final time
+			const int nst = static_cast<int>(std::ceil(ftime*rho/(sspcoeffs[is]*(1.0+0.5*ir))));
+			if(ir == 0) tstep = ftime/nst;
+			solve(m, sd, schemes[is], orders[is], stages[is], ftime, ftime/nst, u);
+			u.axpy(-1.0, uref);
+			err[ir] = sd.computeL2Norm(u, 0);
+		}
+		cout << setw(12) << names[is] << setw(16) << tstep << setw(16) << stages[is]/tstep << setw(16) << err[0]
+			<< setw(16) << err[1] << endl;
+	}
+	return 0;
+}
@@ -0,0 +1,54 @@
+/** @file benchtopology.cpp
+ * @brief Compares the run time of the topology builders of UMesh2dh on generated meshes
+ *
+ * Usage: benchtopology [max number of elements]
+ * Triangle meshes of roughly 10^4, 10^5, ... elements are generated up to the given maximum (default 10^6).
+ * Build with OMP=1 and set OMP_NUM_THREADS to time the threaded builders.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include "../amesh2dh.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace acfd;
+using namespace std;
+
+/// Returns the wall-clock time in seconds taken by a call to the given member function
+double timeBuilder(UMesh2dh& m, void (UMesh2dh::*builder)())
+{
+	auto start = chrono::steady_clock::now();
+	(m.*builder)();
+	auto end = chrono::steady_clock::now();
+	return chrono::duration<double>(end-start).count();
+}
+
+int main(int argc, char* argv[])
+{
+	a_int maxelems = 1000000;
+	if(argc > 1)
+		maxelems = atol(argv[1]);
+
+#ifdef _OPENMP
+	cout << "Number of threads: " << omp_get_max_threads() << endl;
+#endif
+	cout << setw(12) << "elements" << setw(16) << "reference (s)" << setw(16) << "hashed (s)" << setw(16) << "parallel (s)"
+		<< setw(16) << "bmaps ref (s)" << setw(16) << "bmaps par (s)" << endl;
+	for(a_int nelem = 10000; nelem <= maxelems; nelem *= 10)
+	{
+		const a_int n = static_cast<a_int>(sqrt(nelem/2.0)+0.5);
+		UMesh2dh m;
+		m.generateRectangle(0,1,0,1, n,n, TRIANGLE);
+		const double tref = timeBuilder(m, &UMesh2dh::compute_topological);
+		const double tbref = timeBuilder(m, &UMesh2dh::compute_boundary_maps);
+		const double thash = timeBuilder(m, &UMesh2dh::compute_topological_hashed);
+		const double tpar = timeBuilder(m, &UMesh2dh::compute_topological_parallel);
+		const double tbpar = timeBuilder(m, &UMesh2dh::compute_boundary_maps_parallel);
+		cout << setw(12) << m.gnelem() << setw(16) << tref << setw(16) << thash << setw(16) << tpar 
+			<< setw(16) << tbref << setw(16) << tbpar << endl;
+	}
+	return 0;
+}
@@ -0,0 +1,135 @@
+/** @file euler.cpp
+ * @brief Main function for DG compressible Euler solver
+ *
+ * The flow is started from the free stream and integrated either to steady state by explicit pseudo-time
+ * stepping with local time steps, or in time up to a final time by TVD RK, SSP RK, low-storage RK,
+ * multirate Adams-Bashforth with local time steps, or implicitly by BDF2 or ESDIRK3 with Newton-Krylov solvers.
+ * In time, the time step is either the smallest local time step or is computed from an estimate of the spectral
+ * radius of the semi-discrete operator at the free stream, in both cases times the CFL number
+ * (and times the SSP coefficient for SSP RK).
+ */
+
+#include "aspatialeuler.hpp"
+#include "atimesteady.hpp"
+#include "atimetvdrk.hpp"
+#include "atimelts.hpp"
+#include "atimeimplicit.hpp"
+#include "aoutput.hpp"
+
+using namespace amat;
+using namespace std;
+using namespace acfd;
+
+int main(int argc, char* argv[])
+{
+	if(argc < 2)
+	{
+		printf("Please give a control file name.\n");
+		return -1;
+	}
+
+	// Read control file
+	ifstream control(argv[1]);
+
+	string dum, meshfile, outf, invflux;
+	double cfl, tol, ftime, M_inf, vinf, alpha, rho_inf, newtontol = 1e-6;
+	int sdegree, tdegree, maxits, slipwallflag, farfieldflag, nstages = 9, nlevels = 8, jacinterval = 1;
+	char basistype, timescheme, resmode = 's', dispatch = 's', tsoption = 'a', topocache = 'n';
+
+	control >> dum; control >> meshfile;
+	control >> dum; control >> outf;
+	control >> dum; control >> basistype;
+	control >> dum; control >> sdegree;
+	// 's' for steady state, or 'r' for TVD RK, 'p' for SSP RK, 'l' for low-storage RK
+	// or 't' for local time stepping by multirate Adams-Bashforth in time,
+	// or 'i' for implicit time stepping by BDF2 (temporal order 2) or ESDIRK3 (order 3)
+	control >> dum; control >> timescheme;
+	control >> dum; control >> tdegree;
+	control >> dum; control >> ftime;
+	control >> dum; control >> cfl;
+	control >> dum; control >> tol;
+	control >> dum; control >> maxits;
+	control >> dum; control >> M_inf;
+	control >> dum; control >> vinf;
+	control >> dum; control >> alpha;
+	control >> dum; control >> rho_inf;
+	control >> dum; control >> invflux;
+	control >> dum; control >> slipwallflag;
+	control >> dum; control >> farfieldflag;
+	// optional: scatter ('s') or gather ('g') assembly of face integrals
+	if(control >> dum) control >> resmode;
+	// optional: numerical flux selected at compile time ('s') or called virtually ('v')
+	if(control >> dum) control >> dispatch;
+	// optional: number of stages of SSP RK of order 3
+	if(control >> dum) control >> nstages;
+	// optional: time steps from local time steps ('a') or from the spectral radius ('s'), for TVD and SSP RK
+	if(control >> dum) control >> tsoption;
+	// optional: largest number of levels of local time steps
+	if(control >> dum) control >> nlevels;
+	// optional: relative tolerance of Newton's method, and number of time steps between preconditioner updates,
+	// for implicit time stepping
+	if(control >> dum) control >> newtontol;
+	if(control >> dum) control >> jacinterval;
+	// optional: 'y' to keep the topology of the mesh in a binary file beside it, computed only if absent or stale
+	if(control >> dum) control >> topocache;
+	control.close();
+
+	// a mesh file ending in .bin is read with its topology
+	UMesh2dh m; m.readMeshFile(meshfile, topocache == 'y');
+
+	const a_real g = 1.4;
+	const Vector uinf = eulerFreeStreamState(g, M_inf, alpha*PI/180.0, rho_inf, vinf);
+	CompressibleEulerBase* sd = createCompressibleEuler(invflux, dispatch, &m, sdegree, basistype, g, uinf,
+			slipwallflag, farfieldflag);
+	sd->setResidualMode(resmode);
+
+	if(timescheme == 'r') {
+		TVDRKStepping<NEULERVARS> td(&m, sd, tdegree, ftime, cfl, tsoption, 0.0);
+		sd->setFreeStreamState(td.solution());
+		const double actual_ftime = td.integrate();
+		printf("Final time = %f\n", actual_ftime);
+		sd->postprocess(td.solution());
+	}
+	else if(timescheme == 'p') {
+		SSPRKStepping<NEULERVARS> td(&m, sd, tdegree, nstages, ftime, cfl, tsoption, 0.0);
+		sd->setFreeStreamState(td.solution());
+		const double actual_ftime = td.integrate();
+		printf("Final time = %f\n", actual_ftime);
+		sd->postprocess(td.solution());
+	}
+	else if(timescheme == 't') {
+		LocalTimeStepping<NEULERVARS> td(&m, sd, tdegree, ftime, cfl, 'a', 0.0, nlevels);
+		sd->setFreeStreamState(td.solution());
+		const double actual_ftime = td.integrate();
+		printf("Final time = %f\n", actual_ftime);
+		sd->postprocess(td.solution());
+	}
+	else if(timescheme == 'i') {
+		ImplicitStepping<NEULERVARS> td(&m, sd, tdegree, ftime, cfl, 'a', 0.0, newtontol, 10, 30, 1e-3, 100,
+				jacinterval);
+		sd->setFreeStreamState(td.solution());
+		const double actual_ftime = td.integrate();
+		printf("Final time = %f\n", actual_ftime);
+		sd->postprocess(td.solution());
+	}
+	else if(timescheme == 'l') {
+		LowStorageRKStepping<NEULERVARS> td(&m, sd, tdegree, ftime, cfl, 'a', 0.0);
+		sd->setFreeStreamState(td.solution());
+		const double actual_ftime = td.integrate();
+		printf("Final time = %f\n", actual_ftime);
+		sd->postprocess(td.solution());
+	}
+	else {
+		SteadyExplicit<NEULERVARS> td(&m, sd, cfl, tol, maxits, false);
+		sd->setFreeStreamState(td.solution());
+		td.integrate();
+		sd->postprocess(td.solution());
+	}
+
+	string scalarnames[] = {"density", "mach-number", "pressure"};
+	writeScalarsVectorToVtu_PointData(outf, m, sd->getOutput(), scalarnames, sd->getVelocities(), "velocity");
+
+	delete sd;
+	printf("---\n\n");
+	return 0;
+}
@@ -39,6 +39,24 @@ double exactsol(double x, double y, double t) {
 	return init(x-a0*t, y-a1*t);
 }
 
+/// Sets the initial condition, integrates to the final time and returns the L2 error there
+template <class Stepper>
+double solve(LinearAdvection& sd, const char btype, Stepper& td)
+{
+	double (* inits[6])(double,double);
+	inits[0] = &init; inits[1] = &initgradx; inits[2] = &initgrady; inits[3] = &initgradxx; inits[4] = initgradyy; inits[5] = initgradxy;
+	if(btype == 't')
+		sd.setInitialConditionModal(0, inits, td.solution());
+	else if(btype == 'o')
+		sd.setInitialConditionProjection(0, init, td.solution());
+	else
+		sd.setInitialConditionNodal(0, inits, td.solution());
+
+	double actual_ftime = td.integrate();
+	sd.postprocess(td.solution());
+	return sd.computeL2Error(exactsol, actual_ftime, td.solution());
+}
+
 int main(int argc, char* argv[])
 {
 	if(argc < 2)
@@ -52,8 +70,8 @@ int main(int argc, char* argv[])
 
 	string dum, meshprefix, outf;
 	double cfl, tstep, ftime;
-	int sdegree, tdegree, nmesh, extrapflag, inoutflag;
-	char btype;
+	int sdegree, tdegree, nmesh, extrapflag, inoutflag, nstages = 9;
+	char btype, timescheme = 'r', topocache = 'n';
 
 	control >> dum; control >> nmesh;
 	control >> dum; control >> meshprefix;
@@ -65,6 +83,12 @@ int main(int argc, char* argv[])
 	control >> dum; control >> cfl;
 	control >> dum; control >> inoutflag;
 	control >> dum; control >> extrapflag;
+	// optional: TVD RK ('r'), SSP RK ('p') or low-storage RK ('l') of the temporal order
+	if(control >> dum) control >> timescheme;
+	// optional: number of stages of SSP RK of order 3
+	if(control >> dum) control >> nstages;
+	// optional: 'y' to keep the topology of each mesh in a binary file beside it, computed only if absent or stale
+	if(control >> dum) control >> topocache;
 	control.close();
 
 	vector<string> mfiles(nmesh), sfiles(nmesh), exfiles(nmesh);
@@ -79,7 +103,7 @@ int main(int argc, char* argv[])
 
 	for(int imesh = 0; imesh < nmesh; imesh++)
 	{
-		UMesh2dh m; m.readGmsh2(mfiles[imesh], NDIM); m.compute_topological(); m.compute_boundary_maps();
+		UMesh2dh m; m.readMeshFile(mfiles[imesh], topocache == 'y');
 		
 		// fixed time step is a constant times mesh size
 		//double hh = sqrt( 1.0/m.gnelem() );
@@ -88,20 +112,21 @@ int main(int argc, char* argv[])
 		printf("Mesh %d: h = %f, time step = %f\n", imesh, hh, tstep);
 
 		Vector a(2); a[0] = a0; a[1] = a1;
-		LinearAdvection sd(&m, sdegree, btype, a, 0.0, inoutflag, extrapflag);
-		
-		double (* inits[6])(double,double);
-		inits[0] = &init; inits[1] = &initgradx; inits[2] = &initgrady; inits[3] = &initgradxx; inits[4] = initgradyy; inits[5] = initgradxy;
-		if(btype == 't')
-			sd.setInitialConditionModal(0, inits);
-		else
-			sd.setInitialConditionNodal(0, inits);
-
-		TVDRKStepping td(&m, &sd, tdegree, ftime, cfl, 'c', tstep);
-
-		double actual_ftime = td.integrate();
-		sd.postprocess();
-		l2err[imesh] = sd.computeL2Error(exactsol, actual_ftime);
+		// the bump is negligible at the boundaries, so the initial condition also serves as inflow value
+		LinearAdvection sd(&m, sdegree, btype, a, inoutflag, extrapflag, init);
+
+		if(timescheme == 'p') {
+			SSPRKStepping<1> td(&m, &sd, tdegree, nstages, ftime, cfl, 'c', tstep);
+			l2err[imesh] = solve(sd, btype, td);
+		}
+		else if(timescheme == 'l') {
+			LowStorageRKStepping<1> td(&m, &sd, tdegree, ftime, cfl, 'c', tstep);
+			l2err[imesh] = solve(sd, btype, td);
+		}
+		else {
+			TVDRKStepping<1> td(&m, &sd, tdegree, ftime, cfl, 'c', tstep);
+			l2err[imesh] = solve(sd, btype, td);
+		}
 		
 		l2err[imesh] = log10(l2err[imesh]);
 		h[imesh] = log10(hh);
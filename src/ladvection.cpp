@@ -49,7 +49,7 @@ int main(int argc, char* argv[])
 	string dum, meshprefix, outf, outerr;
 	double cfl, tol;
 	int sdegree, maxits, nmesh, extrapflag, inoutflag;
-	char basistype;
+	char basistype, resmode = 's', quadfree = 'n', topocache = 'n';
 
 	control >> dum; control >> nmesh;
 	control >> dum; control >> meshprefix;
@@ -61,6 +61,12 @@ int main(int argc, char* argv[])
 	control >> dum; control >> maxits;
 	control >> dum; control >> inoutflag;
 	control >> dum; control >> extrapflag;
+	// optional: scatter ('s') or gather ('g') assembly of face integrals
+	if(control >> dum) control >> resmode;
+	// optional: quadrature-free residual ('y') on meshes of affine elements
+	if(control >> dum) control >> quadfree;
+	// optional: 'y' to keep the topology of each mesh in a binary file beside it, computed only if absent or stale
+	if(control >> dum) control >> topocache;
 	control.close();
 
 	vector<string> mfiles(nmesh), sfiles(nmesh), exfiles(nmesh);
@@ -76,17 +82,20 @@ int main(int argc, char* argv[])
 
 	for(int imesh = 0; imesh < nmesh; imesh++)
 	{
-		UMesh2dh m; m.readGmsh2(mfiles[imesh], NDIM); m.compute_topological(); m.compute_boundary_maps();
+		UMesh2dh m; m.readMeshFile(mfiles[imesh], topocache == 'y');
 		
 		double hh = m.meshSizeParameter();
 		printf("Mesh %d: h = %f\n", imesh, hh);
 
 		Vector a(2); a[0] = a0; a[1] = a1;
 		LinearAdvection sd(&m, sdegree, basistype, a, inoutflag, extrapflag, bcfunc);
+		sd.setResidualMode(resmode);
 		hh = 1.0/sqrt(sd.numTotalDOFs());
 		
 		SteadyExplicit<1> td(&m, &sd, cfl, tol, maxits, false);
 		//td.set_source(rhs);
+		if(quadfree == 'y')
+			sd.setQuadratureFree(true);
 		
 		td.integrate();
 
@@ -49,7 +49,7 @@ int main(int argc, char* argv[])
 	vector<string> mfiles(nmesh), sfiles(nmesh);
 	vector<double> h(nmesh,0), l2err(nmesh,0), siperr(nmesh,0);
 	string names[] = {"poisson"};
-	std::vector<Matrix> udum;
+	DOFVector udum;
 
 	for(int i = 0; i < nmesh; i++) {
 		mfiles[i] = meshprefix + to_string(i) + ".msh";
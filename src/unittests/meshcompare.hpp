@@ -0,0 +1,47 @@
+/** @file meshcompare.hpp
+ * @brief Comparison of topological data of two meshes, for the mesh unit tests
+ */
+
+#ifndef __MESHCOMPARE_H
+#define __MESHCOMPARE_H
+
+#include "../amesh2dh.hpp"
+
+using namespace amat;
+using namespace acfd;
+using namespace std;
+
+/// Returns the number of entries of topological data in which two meshes differ
+inline int compareTopology(const UMesh2dh& m, const UMesh2dh& n)
+{
+	int ndiff = 0;
+	if(m.gnaface() != n.gnaface() || m.gnbface() != n.gnbface() || m.gnbpoin() != n.gnbpoin())
+		return 1;
+	for(a_int ip = 0; ip <= m.gnpoin(); ip++)
+		ndiff += (m.gesup_p(ip) != n.gesup_p(ip)) + (m.gpsup_p(ip) != n.gpsup_p(ip));
+	for(a_int i = 0; i < m.gesup_p(m.gnpoin()); i++)
+		ndiff += m.gesup(i) != n.gesup(i);
+	for(a_int i = 0; i < m.gpsup_p(m.gnpoin()); i++)
+		ndiff += m.gpsup(i) != n.gpsup(i);
+	for(a_int iel = 0; iel < m.gnelem(); iel++)
+		for(int j = 0; j < m.gnfael(iel); j++)
+			ndiff += (m.gesuel(iel,j) != n.gesuel(iel,j)) + (m.gelemface(iel,j) != n.gelemface(iel,j));
+	for(a_int iface = 0; iface < m.gnaface(); iface++) {
+		ndiff += m.gnnofa(iface) != n.gnnofa(iface);
+		for(int j = 0; j < 2+m.gnnofa(iface); j++)
+			ndiff += m.gintfac(iface,j) != n.gintfac(iface,j);
+		for(int j = 0; j < 2; j++)
+			ndiff += m.gfacelocalnum(iface,j) != n.gfacelocalnum(iface,j);
+		ndiff += m.gedgelengthsquared(iface) != n.gedgelengthsquared(iface);
+	}
+	for(a_int iel = 0; iel < m.gnelem(); iel++)
+		ndiff += m.gelemdiam(iel) != n.gelemdiam(iel);
+	for(a_int ibface = 0; ibface < m.gnface(); ibface++) {
+		ndiff += m.gifbmap(ibface) != n.gifbmap(ibface);
+		for(int j = 0; j < m.gnbtag(); j++)
+			ndiff += m.gintfacbtags(m.gifbmap(ibface),j) != n.gintfacbtags(n.gifbmap(ibface),j);
+	}
+	return ndiff;
+}
+
+#endif
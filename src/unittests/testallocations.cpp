@@ -0,0 +1,146 @@
+/** @file testallocations.cpp
+ * @brief Checks that steady-state time steps do not allocate memory once the solver is warmed up
+ *
+ * Global operator new is replaced by one that counts its calls. Eigen allocates with malloc instead, so this
+ * must be compiled with EIGEN_RUNTIME_NO_MALLOC: heap allocations by Eigen then fail an assertion while they
+ * are disallowed.
+ */
+
+#include <cstdlib>
+#include <new>
+#include "../aspatialadvection.hpp"
+#include "../aspatialeuler.hpp"
+#include "../atimesteady.hpp"
+
+#ifndef EIGEN_RUNTIME_NO_MALLOC
+#error Compile with -DEIGEN_RUNTIME_NO_MALLOC to catch allocations by Eigen.
+#endif
+
+using namespace acfd;
+using namespace std;
+
+/// Number of calls to global operator new so far
+static long nallocs = 0;
+
+void* operator new(std::size_t size)
+{
+	nallocs++;
+	void* p = std::malloc(size > 0 ? size : 1);
+	if(!p) throw std::bad_alloc();
+	return p;
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+a_real bcfunc(const a_real x, const a_real y)
+{
+	return std::sin(2*PI*y);
+}
+
+/// Takes some steady steps to warm up the solver, then returns the number of allocations during some more
+/** If the quadrature-free residual cannot be used when asked for, returns 0.
+ */
+long countAllocations(const UMesh2dh& m, LinearAdvection* sd, const bool quadfree)
+{
+	SteadyExplicit<1> td(&m, sd, 0.5, 0.0, 3, false);
+	if(quadfree && !sd->setQuadratureFree(true))
+		return 0;
+	td.integrate();
+
+	const long nstart = nallocs;
+	Eigen::internal::set_is_malloc_allowed(false);
+	td.integrate();
+	Eigen::internal::set_is_malloc_allowed(true);
+	return nallocs - nstart;
+}
+
+/// As countAllocations, for the Euler equations started from the free stream
+long countAllocations(const UMesh2dh& m, CompressibleEulerBase* sd)
+{
+	SteadyExplicit<NEULERVARS> td(&m, sd, 0.5, 0.0, 3, false);
+	sd->setFreeStreamState(td.solution());
+	td.integrate();
+
+	const long nstart = nallocs;
+	Eigen::internal::set_is_malloc_allowed(false);
+	td.integrate();
+	Eigen::internal::set_is_malloc_allowed(true);
+	return nallocs - nstart;
+}
+
+int check(const long count, const string& name)
+{
+	if(count != 0) {
+		cout << "! " << name << ": " << count << " allocations in steady time steps!\n";
+		return 1;
+	}
+	return 0;
+}
+
+int main()
+{
+	int ierr = 0;
+
+	UMesh2dh mq, mt;
+	mq.generateRectangle(0.0, 1.0, 0.0, 1.0, 6, 5, QUADRANGLE);
+	mt.generateRectangle(0.0, 1.0, 0.0, 1.0, 6, 5, TRIANGLE);
+	UMesh2dh* meshes[] = {&mq, &mt};
+	for(int imesh = 0; imesh < 2; imesh++) {
+		meshes[imesh]->compute_topological();
+		meshes[imesh]->compute_boundary_maps();
+	}
+
+	Vector a(2); a << 1.0, 0.5;
+	const char modes[] = {'s', 'g'};
+	for(int imesh = 0; imesh < 2; imesh++)
+		for(int imode = 0; imode < 2; imode++)
+		{
+			LinearAdvection sd(meshes[imesh], 2, 'l', a, 1, 2, bcfunc);
+			sd.setResidualMode(modes[imode]);
+			ierr += check(countAllocations(*meshes[imesh], &sd, false), string("Advection, residual mode ")+modes[imode]);
+		}
+
+	{
+		LinearAdvection sd(&mq, 2, 'l', a, 1, 2, bcfunc);
+		ierr += check(countAllocations(mq, &sd, true), "Advection, quadrature-free");
+	}
+
+	const Vector uinf = eulerFreeStreamState(1.4, 0.5, 2.0*PI/180.0, 1.0, 1.0);
+	for(int imesh = 0; imesh < 2; imesh++)
+		for(int imode = 0; imode < 2; imode++)
+		{
+			CompressibleEulerBase* sd = createCompressibleEuler("HLLC", 's', meshes[imesh], 1, 'o', 1.4, uinf, 2, 1);
+			sd->setResidualMode(modes[imode]);
+			ierr += check(countAllocations(*meshes[imesh], sd), string("Euler, residual mode ")+modes[imode]);
+			delete sd;
+		}
+
+	if(ierr == 0)
+		cout << "Allocation tests passed.\n";
+	else
+		cout << "! Allocation tests failed!\n";
+	return ierr;
+}
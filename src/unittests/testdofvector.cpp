@@ -0,0 +1,57 @@
+#include "../adofvector.hpp"
+
+using namespace acfd;
+using namespace std;
+
+int main()
+{
+	int ierr = 0;
+	const short nvars = 2;
+	std::vector<int> ndofs = {3, 6, 1, 4};
+	DOFVector u(nvars, ndofs);
+
+	if(u.nelem() != 4 || u.size() != nvars*14) {
+		cout << "! DOFVector has wrong size " << u.size() << "!\n";
+		ierr++;
+	}
+
+	// blocks must be views into one contiguous array, in element order
+	for(a_int iel = 0; iel < u.nelem(); iel++)
+	{
+		MatrixMap ue = u[iel];
+		if(ue.rows() != nvars || ue.cols() != ndofs[iel] || ue.data() != u.data()+u.offset(iel)) {
+			cout << "! Block of element " << iel << " has the wrong shape or position!\n";
+			ierr++;
+		}
+		for(int i = 0; i < nvars; i++)
+			for(int j = 0; j < ndofs[iel]; j++)
+				ue(i,j) = 100*iel + 10*i + j;
+	}
+	if(u.data()[u.offset(1) + 1*ndofs[1] + 2] != 112) {
+		cout << "! Blocks are not stored row-major!\n";
+		ierr++;
+	}
+
+	// copies are deep and whole-vector operations act on all entries
+	DOFVector v(u);
+	v.axpby(2.0, -1.0, u);
+	u.axpy(-1.0, v);
+	if(u.norm() != 0 || !u.sameLayout(v)) {
+		cout << "! Whole-vector operations are wrong!\n";
+		ierr++;
+	}
+	v.setConstant(0.5);
+	if(v.dot(v) != 0.25*v.size()) {
+		cout << "! Dot product is wrong!\n";
+		ierr++;
+	}
+	v.scale(4.0);
+	if(v.dot(v) != 4.0*v.size()) {
+		cout << "! Scaling is wrong!\n";
+		ierr++;
+	}
+
+	if(ierr == 0)
+		cout << "DOF vector tests passed.\n";
+	return ierr;
+}
@@ -0,0 +1,98 @@
+#include "../aelementkernels.hpp"
+
+using namespace acfd;
+using namespace std;
+
+/// Compares the specialised kernels with the dynamic ones for the Lagrange basis of some shape and degree
+template <int nvars>
+int checkKernels(const Shape shape, const int degree)
+{
+	int ierr = 0;
+	const a_real tol = 1e-13;
+
+	Quadrature2DTriangle tquad;
+	Quadrature2DSquare squad;
+	Quadrature2D* quad = &squad;
+	if(shape == TRIANGLE)
+		quad = &tquad;
+	quad->initialize(2*degree);
+
+	BasisRegistry reg;
+	const BasisSet* bs = reg.get(shape, degree, quad);
+	const int ndofs = bs->basis.cols();
+
+	ElementKernels fixed = getElementKernels<nvars>(shape, degree, 'l', quad);
+	ElementKernels dynamic = makeElementKernels<DynamicElementKernels>(false);
+	if(!fixed.fixed) {
+		cout << "! Shape " << shape << ", degree " << degree << ": no specialised kernels!\n";
+		return 1;
+	}
+
+	Matrix dofs = Matrix::Random(nvars, ndofs);
+	Matrix fv, dv, fdx, fdy, ddx, ddy;
+	fixed.interpolate(*bs, dofs, fv);
+	dynamic.interpolate(*bs, dofs, dv);
+	fixed.gradients(*bs, dofs, fdx, fdy);
+	dynamic.gradients(*bs, dofs, ddx, ddy);
+	if((fv-dv).cwiseAbs().maxCoeff() > tol || (fdx-ddx).cwiseAbs().maxCoeff() > tol || (fdy-ddy).cwiseAbs().maxCoeff() > tol) {
+		cout << "! Shape " << shape << ", degree " << degree << ": specialised evaluation differs!\n";
+		ierr++;
+	}
+
+	Matrix fx = Matrix::Random(quad->numGauss(), nvars), fy = Matrix::Random(quad->numGauss(), nvars);
+	Matrix ft = Matrix::Zero(nvars, ndofs), dt = Matrix::Zero(nvars, ndofs);
+	fixed.integrateGradients(*bs, fx, fy, ft);
+	dynamic.integrateGradients(*bs, fx, fy, dt);
+	if((ft-dt).cwiseAbs().maxCoeff() > tol) {
+		cout << "! Shape " << shape << ", degree " << degree << ": specialised integration differs!\n";
+		ierr++;
+	}
+
+	return ierr;
+}
+
+int main()
+{
+	int ierr = 0;
+
+	// the P3 triangle must be nodal, and its gradients must be consistent with its values
+	Matrix refs(10,NDIM);
+	const a_real nodes[10][2] = {{0,0}, {1,0}, {0,1}, {1.0/3,0}, {2.0/3,0}, {2.0/3,1.0/3}, {1.0/3,2.0/3}, 
+		{0,2.0/3}, {0,1.0/3}, {1.0/3,1.0/3}};
+	for(int i = 0; i < 10; i++) {
+		refs(i,0) = nodes[i][0]; refs(i,1) = nodes[i][1];
+	}
+	Matrix nodal(10,10);
+	getLagrangeBasis(refs, TRIANGLE, 3, nodal);
+	if((nodal - Matrix::Identity(10,10)).cwiseAbs().maxCoeff() > 1e-13) {
+		cout << "! P3 triangle basis is not nodal!\n";
+		ierr++;
+	}
+
+	const a_real h = 1e-6;
+	Matrix pt(1,NDIM), ptx(1,NDIM), pty(1,NDIM), b(1,10), bx(1,10), by(1,10);
+	pt << 0.2, 0.3;
+	ptx << 0.2+h, 0.3;
+	pty << 0.2, 0.3+h;
+	std::vector<Matrix> g(1, Matrix(10,NDIM));
+	getLagrangeBasis(pt, TRIANGLE, 3, b);
+	getLagrangeBasis(ptx, TRIANGLE, 3, bx);
+	getLagrangeBasis(pty, TRIANGLE, 3, by);
+	getLagrangeBasisGrads(pt, TRIANGLE, 3, g);
+	if(((bx-b)/h - g[0].col(0).transpose()).cwiseAbs().maxCoeff() > 1e-4 
+			|| ((by-b)/h - g[0].col(1).transpose()).cwiseAbs().maxCoeff() > 1e-4) {
+		cout << "! P3 triangle basis gradients are wrong!\n";
+		ierr++;
+	}
+
+	for(int degree = 1; degree <= 3; degree++) {
+		ierr += checkKernels<1>(TRIANGLE, degree);
+		ierr += checkKernels<4>(TRIANGLE, degree);
+		ierr += checkKernels<1>(QUADRANGLE, degree);
+		ierr += checkKernels<4>(QUADRANGLE, degree);
+	}
+
+	if(ierr == 0)
+		cout << "Element kernel tests passed.\n";
+	return ierr;
+}
@@ -46,7 +46,7 @@ int main()
 	for(int ig = 0; ig < map.getQuadrature()->numGauss(); ig++) {
 		//cout << "(" << map.map()(ig,0) << ", " << map.map()(ig,1) << "), ";
 		if(fabs(map.map()(ig,0)-qc(ig,0)) > 10*SMALL_NUMBER || fabs(map.map()(ig,1)-qc(ig,1)) > 10*SMALL_NUMBER) printf("! TEST FAILED at phy coords of domain quadrature points.\n");
-		cout << map.jacDet()[ig] << ".  ";
+		cout << map.jacDet(ig) << ".  ";
 	}
 	cout << endl;
 
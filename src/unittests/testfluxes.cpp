@@ -0,0 +1,105 @@
+#include "../anumericalfluxeuler.hpp"
+
+using namespace acfd;
+using namespace std;
+
+/// Physical flux normal to n of a conserved state u
+void physicalFlux(const a_real g, const a_real *const u, const a_real *const n, a_real *const f)
+{
+	const a_real vn = (u[1]*n[0]+u[2]*n[1])/u[0];
+	const a_real p = (g-1.0)*(u[3] - 0.5*(u[1]*u[1]+u[2]*u[2])/u[0]);
+	f[0] = u[0]*vn;
+	f[1] = u[1]*vn + p*n[0];
+	f[2] = u[2]*vn + p*n[1];
+	f[3] = (u[3]+p)*vn;
+}
+
+/// Conserved state from density, velocity and pressure
+void conserved(const a_real g, const a_real rho, const a_real vx, const a_real vy, const a_real p, a_real *const u)
+{
+	u[0] = rho; u[1] = rho*vx; u[2] = rho*vy;
+	u[3] = p/(g-1.0) + 0.5*rho*(vx*vx+vy*vy);
+}
+
+/** Checks that the flux is consistent, that it upwinds supersonic flow in either direction if it is an upwind flux,
+ * and that the batched fluxes agree with the per-point ones.
+ */
+int checkFlux(InviscidNumericalFlux *const flux, const char *const name, const a_real g, const bool upwind)
+{
+	const a_real tol = 1e-12;
+	const int npoin = 7;
+	int ierr = 0;
+
+	Matrix ul(npoin,4), ur(npoin,4), n(npoin,2), f(npoin,4), fphys(1,4);
+	for(int i = 0; i < npoin; i++) {
+		const a_real theta = 0.9*i-1.3;
+		n(i,0) = std::cos(theta); n(i,1) = std::sin(theta);
+		conserved(g, 1.0+0.1*i, 0.3-0.2*i, 0.1*i, 1.0-0.05*i, &ul(i,0));
+		conserved(g, 0.9-0.05*i, 0.2*i-0.5, 0.4-0.1*i, 0.8+0.1*i, &ur(i,0));
+	}
+
+	for(int i = 0; i < npoin; i++) {
+		flux->get_flux(&ul(i,0), &ul(i,0), &n(i,0), &f(i,0));
+		physicalFlux(g, &ul(i,0), &n(i,0), &fphys(0,0));
+		if((f.row(i)-fphys).cwiseAbs().maxCoeff() > tol) {
+			cout << "! " << name << ": not consistent at point " << i << "!\n";
+			ierr++;
+		}
+	}
+
+	// flow at Mach 3 along the normal, with different tangential velocities on either side
+	if(upwind) {
+		a_real nn[2] = {0.6, 0.8}, us[4], ut[4], fs[4];
+		conserved(g, 1.2, 3.0*0.6+0.5*0.8, 3.0*0.8-0.5*0.6, 1.0/g, us);
+		conserved(g, 0.8, 3.2*0.6-0.4*0.8, 3.2*0.8+0.4*0.6, 1.1/g, ut);
+		flux->get_flux(us, ut, nn, fs);
+		physicalFlux(g, us, nn, &fphys(0,0));
+		if((Eigen::Map<Matrix>(fs,1,4)-fphys).cwiseAbs().maxCoeff() > tol) {
+			cout << "! " << name << ": not upwind for supersonic flow from the left!\n";
+			ierr++;
+		}
+		nn[0] = -0.6; nn[1] = -0.8;
+		flux->get_flux(ut, us, nn, fs);
+		physicalFlux(g, us, nn, &fphys(0,0));
+		if((Eigen::Map<Matrix>(fs,1,4)-fphys).cwiseAbs().maxCoeff() > tol) {
+			cout << "! " << name << ": not upwind for supersonic flow from the right!\n";
+			ierr++;
+		}
+	}
+
+	// batched
+	for(int i = 0; i < npoin; i++)
+		flux->get_flux(&ul(i,0), &ur(i,0), &n(i,0), &f(i,0));
+	const Matrix bul = ul.transpose(), bur = ur.transpose(), bn = n.transpose();
+	Matrix bf(4,npoin);
+	flux->get_fluxes(npoin, bul.data(), bur.data(), bn.data(), bf.data());
+	if((bf.transpose()-f).cwiseAbs().maxCoeff() > tol) {
+		cout << "! " << name << ": batched fluxes differ from per-point fluxes by "
+			<< (bf.transpose()-f).cwiseAbs().maxCoeff() << "!\n";
+		ierr++;
+	}
+
+	return ierr;
+}
+
+int main()
+{
+	const a_real g = 1.4;
+	int ierr = 0;
+
+	LocalLaxFriedrichsFlux llf(g);
+	VanLeerFlux vanleer(g);
+	RoeFlux roe(g);
+	HLLCFlux hllc(g);
+
+	ierr += checkFlux(&llf, "LLF", g, false);
+	ierr += checkFlux(&vanleer, "Van Leer", g, true);
+	ierr += checkFlux(&roe, "Roe", g, true);
+	ierr += checkFlux(&hllc, "HLLC", g, true);
+
+	if(ierr == 0)
+		cout << "Numerical flux tests passed.\n";
+	else
+		cout << "! Numerical flux tests failed!\n";
+	return ierr;
+}
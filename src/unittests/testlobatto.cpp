@@ -0,0 +1,107 @@
+#include "../aelements.hpp"
+
+using namespace acfd;
+using namespace std;
+
+/// Checks the Gauss-Lobatto-Legendre rule of n points: end points, sum of weights and exactness for degree 2n-3
+int checkRule(const int n)
+{
+	const a_real tol = 1e-13;
+	Vector pts, wts;
+	getGaussLobattoPoints(n, pts, wts);
+
+	int ierr = 0;
+	if(std::fabs(pts(0)+1.0) > tol || std::fabs(pts(n-1)-1.0) > tol) {
+		cout << "! " << n << " points: end points are not -1 and 1!\n";
+		ierr++;
+	}
+	for(int deg = 0; deg <= 2*n-3; deg++)
+	{
+		a_real integral = 0;
+		for(int i = 0; i < n; i++)
+			integral += wts(i)*std::pow(pts(i),deg);
+		const a_real exact = deg % 2 == 0 ? 2.0/(deg+1) : 0.0;
+		if(std::fabs(integral-exact) > tol) {
+			cout << "! " << n << " points: x^" << deg << " integrated to " << integral << " instead of " << exact << endl;
+			ierr++;
+		}
+	}
+	return ierr;
+}
+
+/// Checks the collocated Gauss-Lobatto basis of a degree against the dense kernels on the same basis set
+int checkBasis(const int degree)
+{
+	int ierr = 0;
+	const a_real tol = 1e-12;
+
+	Quadrature2DSquareLobatto quad;
+	quad.initialize(2*degree-1);
+	BasisRegistry reg;
+	const BasisSet* bs = reg.get(QUADRANGLE, degree, &quad, 'g');
+	const int ndofs = bs->basis.cols(), ng = quad.numGauss();
+
+	if(!bs->collocated || ng != ndofs) {
+		cout << "! Degree " << degree << ": basis set is not collocated!\n";
+		return 1;
+	}
+	if((bs->basis - Matrix::Identity(ng,ndofs)).cwiseAbs().maxCoeff() > tol) {
+		cout << "! Degree " << degree << ": basis is not the identity at the quadrature points!\n";
+		ierr++;
+	}
+
+	Matrix dofs = Matrix::Random(3, ndofs);
+	Matrix dx, dy, cdx, cdy;
+	evaluateGradients(*bs, dofs, dx, dy);
+	collocatedEvaluateGradients(bs->tensor, dofs, cdx, cdy);
+	if((dx-cdx).cwiseAbs().maxCoeff() > tol || (dy-cdy).cwiseAbs().maxCoeff() > tol) {
+		cout << "! Degree " << degree << ": collocated gradients differ from the dense ones!\n";
+		ierr++;
+	}
+
+	const Matrix fx = Matrix::Random(ng, 3), fy = Matrix::Random(ng, 3);
+	Matrix term = Matrix::Zero(3, ndofs), cterm = Matrix::Zero(3, ndofs);
+	integrateGradients(*bs, fx, fy, term);
+	collocatedIntegrateGradients(bs->tensor, fx, fy, cterm);
+	if((term-cterm).cwiseAbs().maxCoeff() > tol) {
+		cout << "! Degree " << degree << ": collocated gradient integrals differ from the dense ones!\n";
+		ierr++;
+	}
+
+	// face quadrature points on each local face, in either orientation, must coincide with element nodes
+	Quadrature1DLobatto fquad;
+	fquad.initialize(2*degree-1);
+	for(int lface = 0; lface < 8; lface++)
+	{
+		const FaceTraceSet* ts = reg.getTrace(QUADRANGLE, degree, lface%4, lface < 4 ? 1 : -1, &fquad, 'g');
+		if(ts->nodes.size() != static_cast<size_t>(fquad.numGauss())) {
+			cout << "! Degree " << degree << ", face " << lface%4 << ": face points are not element nodes!\n";
+			ierr++;
+			continue;
+		}
+		for(int ig = 0; ig < fquad.numGauss(); ig++)
+			for(int idof = 0; idof < ndofs; idof++)
+				if(std::fabs(ts->basis(ig,idof) - (idof == ts->nodes[ig] ? 1.0 : 0.0)) > tol) {
+					cout << "! Degree " << degree << ", face " << lface%4 << ": wrong node " << ts->nodes[ig] << endl;
+					ierr++;
+					idof = ndofs; ig = fquad.numGauss();
+				}
+	}
+
+	return ierr;
+}
+
+int main()
+{
+	int ierr = 0;
+	for(int n = 2; n <= 8; n++)
+		ierr += checkRule(n);
+	for(int degree = 1; degree <= 5; degree++)
+		ierr += checkBasis(degree);
+
+	if(ierr == 0)
+		cout << "Gauss-Lobatto tests passed.\n";
+	else
+		cout << "! Gauss-Lobatto tests failed!\n";
+	return ierr;
+}
@@ -0,0 +1,78 @@
+#include <iterator>
+#include "meshcompare.hpp"
+
+using namespace amat;
+using namespace acfd;
+using namespace std;
+
+int binary_roundtrip(const string meshfile)
+{
+	int ierr = 0;
+	const string binfile = "meshio-test.tmsh";
+	UMesh2dh m;
+	m.readGmsh2(meshfile,2);
+	m.compute_topological();
+	m.compute_boundary_maps();
+	m.writeBinary(binfile);
+
+	// full read
+	UMesh2dh b;
+	b.readBinary(binfile);
+	if(b.computeHash() != m.computeHash()) {
+		cout << "! Hash of mesh read from binary file does not match!\n";
+		ierr++;
+	}
+	int ndiff = compareTopology(m,b);
+	if(ndiff > 0) {
+		cout << "! Topology read from binary file differs in " << ndiff << " entries!\n";
+		ierr++;
+	}
+
+	// topology cache for the same mesh
+	UMesh2dh c;
+	c.readGmsh2(meshfile,2);
+	if(!c.readTopologyCache(binfile)) {
+		cout << "! Topology cache was not accepted for the mesh it was generated from!\n";
+		ierr++;
+	}
+	else if(compareTopology(m,c) > 0) {
+		cout << "! Topology read from cache differs!\n";
+		ierr++;
+	}
+
+	// the cache must be rejected for a different mesh
+	UMesh2dh d;
+	d.readGmsh2(meshfile,2);
+	d.scoords(0,0, d.gcoords(0,0)+1e-8);
+	if(d.readTopologyCache(binfile)) {
+		cout << "! Topology cache was accepted for a different mesh!\n";
+		ierr++;
+	}
+
+	// a truncated file must be rejected without modifying the mesh it is read into
+	const string truncfile = "meshio-test-truncated.tmsh";
+	{
+		std::ifstream fin(binfile, std::ios::binary);
+		std::string contents((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+		std::ofstream fout(truncfile, std::ios::binary);
+		fout.write(contents.data(), contents.size()/2);
+	}
+	if(b.readBinary(truncfile) || b.computeHash() != m.computeHash() || compareTopology(m,b) > 0) {
+		cout << "! Truncated binary file was accepted or modified the mesh!\n";
+		ierr++;
+	}
+	std::remove(truncfile.c_str());
+
+	std::remove(binfile.c_str());
+	if(ierr == 0)
+		cout << "Binary mesh round trip passed for " << meshfile << endl;
+	return ierr;
+}
+
+int main()
+{
+	int ierr = 0;
+	ierr += binary_roundtrip("../../testcases/unittests/circlehybrid_p2.msh");
+	ierr += binary_roundtrip("../../testcases/advection/grids/square2.msh");
+	return ierr;
+}
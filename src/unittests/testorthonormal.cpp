@@ -0,0 +1,105 @@
+#include "../aelements.hpp"
+
+using namespace acfd;
+using namespace std;
+
+/// Checks the orthonormal basis of a shape and degree: unit reference mass matrix, gradients and tensor factors
+int checkBasis(const Shape shape, const int degree)
+{
+	int ierr = 0;
+	const a_real tol = 1e-12;
+	const char* name = shape == TRIANGLE ? "Triangle" : "Quadrangle";
+
+	Quadrature2DTriangle tquad;
+	Quadrature2DSquare squad;
+	Quadrature2D* quad;
+	const int strength = degree > 0 ? 2*degree : 1;
+	if(shape == TRIANGLE) {
+		tquad.initialize(strength);
+		quad = &tquad;
+	}
+	else {
+		squad.initialize(strength);
+		quad = &squad;
+	}
+
+	BasisRegistry reg;
+	const BasisSet* bs = reg.get(shape, degree, quad, 'o');
+	const int ndofs = bs->basis.cols(), ng = quad->numGauss();
+
+	Matrix mass = Matrix::Zero(ndofs,ndofs);
+	for(int ig = 0; ig < ng; ig++)
+		mass += quad->weights()(ig) * bs->basis.row(ig).transpose()*bs->basis.row(ig);
+	if((mass - Matrix::Identity(ndofs,ndofs)).cwiseAbs().maxCoeff() > tol) {
+		cout << "! " << name << " degree " << degree << ": mass matrix is not the identity!\n" << mass << endl;
+		ierr++;
+	}
+
+	// the first basis function is a constant
+	if((bs->basis.col(0).array() - bs->basis(0,0)).abs().maxCoeff() > tol) {
+		cout << "! " << name << " degree " << degree << ": first basis function is not constant!\n";
+		ierr++;
+	}
+
+	// gradients against central differences
+	const a_real h = 1e-6;
+	const Matrix& gp = quad->points();
+	Matrix gpx = gp, gpy = gp;
+	gpx.col(0).array() += h;
+	gpy.col(1).array() += h;
+	Matrix bx(ng,ndofs), by(ng,ndofs), bxm(ng,ndofs), bym(ng,ndofs);
+	getOrthonormalBasis(gpx, shape, degree, bx);
+	getOrthonormalBasis(gpy, shape, degree, by);
+	gpx.col(0).array() -= 2*h;
+	gpy.col(1).array() -= 2*h;
+	getOrthonormalBasis(gpx, shape, degree, bxm);
+	getOrthonormalBasis(gpy, shape, degree, bym);
+	a_real graderr = 0;
+	for(int ig = 0; ig < ng; ig++)
+		for(int idof = 0; idof < ndofs; idof++) {
+			graderr = std::max(graderr, std::fabs((bx(ig,idof)-bxm(ig,idof))/(2*h) - bs->basisGrad[ig](idof,0)));
+			graderr = std::max(graderr, std::fabs((by(ig,idof)-bym(ig,idof))/(2*h) - bs->basisGrad[ig](idof,1)));
+		}
+	if(graderr > 1e-6) {
+		cout << "! " << name << " degree " << degree << ": gradients differ from finite differences by " << graderr << endl;
+		ierr++;
+	}
+
+	// on quadrangles, the sum-factorized kernels must agree with the dense products
+	if(shape == QUADRANGLE)
+	{
+		if(bs->tensor.lexindex.size() != static_cast<size_t>(ndofs)) {
+			cout << "! Quadrangle degree " << degree << ": no tensor factors!\n";
+			return ierr+1;
+		}
+		Matrix dofs = Matrix::Random(2, ndofs);
+		Matrix dense(ng,2), sumfact, dx, dy, sdx, sdy;
+		evaluateFunctions(dofs, bs->basis, dense);
+		tensorEvaluateFunctions(bs->tensor, dofs, sumfact);
+		evaluateGradients(*bs, dofs, dx, dy);
+		tensorEvaluateGradients(bs->tensor, dofs, sdx, sdy);
+		if((dense-sumfact).cwiseAbs().maxCoeff() > tol || (dx-sdx).cwiseAbs().maxCoeff() > tol
+				|| (dy-sdy).cwiseAbs().maxCoeff() > tol) {
+			cout << "! Quadrangle degree " << degree << ": sum-factorized evaluation differs!\n";
+			ierr++;
+		}
+	}
+
+	return ierr;
+}
+
+int main()
+{
+	int ierr = 0;
+	for(int degree = 0; degree <= 3; degree++)
+		ierr += checkBasis(TRIANGLE, degree);
+
+	for(int degree = 0; degree <= 5; degree++)
+		ierr += checkBasis(QUADRANGLE, degree);
+
+	if(ierr == 0)
+		cout << "Orthonormal basis tests passed.\n";
+	else
+		cout << "! Orthonormal basis tests failed!\n";
+	return ierr;
+}
@@ -0,0 +1,103 @@
+#include "../aquadrature.hpp"
+
+using namespace acfd;
+using namespace std;
+
+/// Integral of x^i over [-1,1]
+a_real lineMoment(const int i)
+{
+	return i % 2 == 0 ? 2.0/(i+1) : 0.0;
+}
+
+/// Integral of x^i y^j over the reference triangle, i! j! / (i+j+2)!
+a_real triangleMoment(const int i, const int j)
+{
+	a_real val = 1.0;
+	for(int k = 1; k <= j; k++)
+		val *= (a_real)k/(i+k);
+	for(int k = i+j+1; k <= i+j+2; k++)
+		val /= k;
+	return val;
+}
+
+/// Checks that a 2D rule integrates all monomials of degree upto its strength exactly, and has positive weights
+int check2D(const Quadrature2D& quad, const int strength, const char* name)
+{
+	int ierr = 0;
+	const Matrix& pts = quad.points();
+	const amat::Array2d<a_real>& wts = quad.weights();
+	for(int ig = 0; ig < quad.numGauss(); ig++)
+		if(wts(ig) <= 0) {
+			cout << "! " << name << " strength " << strength << ": non-positive weight!\n";
+			ierr++;
+			break;
+		}
+
+	a_real maxerr = 0;
+	for(int i = 0; i <= strength; i++)
+		for(int j = 0; i+j <= strength; j++)
+		{
+			a_real integral = 0;
+			for(int ig = 0; ig < quad.numGauss(); ig++)
+				integral += wts(ig)*std::pow(pts(ig,0),i)*std::pow(pts(ig,1),j);
+			const a_real exact = quad.getShape() == TRIANGLE ? triangleMoment(i,j) : lineMoment(i)*lineMoment(j);
+			maxerr = std::max(maxerr, std::fabs(integral-exact));
+		}
+	if(maxerr > 1e-14) {
+		cout << "! " << name << " strength " << strength << ": error in integrals of monomials " << maxerr << endl;
+		ierr++;
+	}
+	return ierr;
+}
+
+int main()
+{
+	int ierr = 0;
+
+	for(int strength = 1; strength <= 41; strength++)
+	{
+		Quadrature1D quad;
+		quad.initialize(strength);
+		if(quad.numGauss() != (strength+2)/2) {
+			cout << "! Line strength " << strength << ": " << quad.numGauss() << " points!\n";
+			ierr++;
+		}
+		a_real maxerr = 0;
+		for(int i = 0; i <= strength; i++) {
+			a_real integral = 0;
+			for(int ig = 0; ig < quad.numGauss(); ig++)
+				integral += quad.weights()(ig)*std::pow(quad.points()(ig,0),i);
+			maxerr = std::max(maxerr, std::fabs(integral-lineMoment(i)));
+		}
+		if(maxerr > 1e-14) {
+			cout << "! Line strength " << strength << ": error in integrals of monomials " << maxerr << endl;
+			ierr++;
+		}
+	}
+
+	for(int strength = 1; strength <= 15; strength++) {
+		Quadrature2DSquare quad;
+		quad.initialize(strength);
+		ierr += check2D(quad, strength, "Square");
+	}
+
+	for(int strength = 1; strength <= 20; strength++)
+	{
+		Quadrature2DTriangle quad;
+		quad.initialize(strength);
+		ierr += check2D(quad, strength, "Triangle");
+		for(int ig = 0; ig < quad.numGauss(); ig++) {
+			const a_real x = quad.points()(ig,0), y = quad.points()(ig,1);
+			if(x <= 0 || y <= 0 || x+y >= 1) {
+				cout << "! Triangle strength " << strength << ": point " << ig << " is not inside the triangle!\n";
+				ierr++;
+			}
+		}
+	}
+
+	if(ierr == 0)
+		cout << "Quadrature tests passed.\n";
+	else
+		cout << "! Quadrature tests failed!\n";
+	return ierr;
+}
@@ -0,0 +1,82 @@
+#include "../aelements.hpp"
+
+using namespace acfd;
+using namespace std;
+
+/// Compares the sum-factorized kernels with the dense products for the Lagrange basis on quadrangles of some degree
+int checkDegree(const int degree)
+{
+	int ierr = 0;
+	const int nvars = 2;
+	const a_real tol = 1e-13;
+
+	Quadrature2DSquare quad;
+	quad.initialize(2*degree);
+	BasisRegistry reg;
+	const BasisSet* bs = reg.get(QUADRANGLE, degree, &quad);
+	const int ndofs = bs->basis.cols(), ng = quad.numGauss();
+
+	if(bs->tensor.lexindex.size() != static_cast<size_t>(ndofs)) {
+		cout << "! Degree " << degree << ": no tensor factors!\n";
+		return 1;
+	}
+
+	// the basis must be nodal, and sum to 1 at any point
+	Matrix refs(ndofs,NDIM), nodal(ndofs,ndofs);
+	for(int idof = 0; idof < ndofs; idof++) {
+		refs(idof,0) = -1.0 + 2.0*(bs->tensor.lexindex[idof]/(degree+1))/degree;
+		refs(idof,1) = -1.0 + 2.0*(bs->tensor.lexindex[idof]%(degree+1))/degree;
+	}
+	getLagrangeBasis(refs, QUADRANGLE, degree, nodal);
+	if((nodal - Matrix::Identity(ndofs,ndofs)).cwiseAbs().maxCoeff() > tol) {
+		cout << "! Degree " << degree << ": basis is not nodal!\n";
+		ierr++;
+	}
+	if((bs->basis.rowwise().sum() - Vector::Ones(ng)).cwiseAbs().maxCoeff() > tol) {
+		cout << "! Degree " << degree << ": basis is not a partition of unity!\n";
+		ierr++;
+	}
+
+	Matrix dofs = Matrix::Random(nvars, ndofs);
+
+	Matrix dense(ng,nvars), sumfact;
+	evaluateFunctions(dofs, bs->basis, dense);
+	tensorEvaluateFunctions(bs->tensor, dofs, sumfact);
+	if((dense-sumfact).cwiseAbs().maxCoeff() > tol) {
+		cout << "! Degree " << degree << ": sum-factorized interpolation differs by " << (dense-sumfact).cwiseAbs().maxCoeff() << endl;
+		ierr++;
+	}
+
+	Matrix dx(ng,nvars), dy(ng,nvars), sdx, sdy;
+	for(int ig = 0; ig < ng; ig++) {
+		dx.row(ig) = (dofs*bs->basisGrad[ig].col(0)).transpose();
+		dy.row(ig) = (dofs*bs->basisGrad[ig].col(1)).transpose();
+	}
+	tensorEvaluateGradients(bs->tensor, dofs, sdx, sdy);
+	if((dx-sdx).cwiseAbs().maxCoeff() > tol || (dy-sdy).cwiseAbs().maxCoeff() > tol) {
+		cout << "! Degree " << degree << ": sum-factorized gradients differ!\n";
+		ierr++;
+	}
+
+	Matrix fx = Matrix::Random(ng,nvars), fy = Matrix::Random(ng,nvars);
+	Matrix dterm = Matrix::Zero(nvars,ndofs), sterm = Matrix::Zero(nvars,ndofs);
+	integrateGradients(*bs, fx, fy, dterm);
+	tensorIntegrateGradients(bs->tensor, fx, fy, sterm);
+	if((dterm-sterm).cwiseAbs().maxCoeff() > tol) {
+		cout << "! Degree " << degree << ": sum-factorized integration differs by " << (dterm-sterm).cwiseAbs().maxCoeff() << endl;
+		ierr++;
+	}
+
+	return ierr;
+}
+
+int main()
+{
+	int ierr = 0;
+	for(int degree = 1; degree <= 5; degree++)
+		ierr += checkDegree(degree);
+
+	if(ierr == 0)
+		cout << "Sum factorization tests passed.\n";
+	return ierr;
+}
@@ -0,0 +1,81 @@
+#include "meshcompare.hpp"
+
+/// Checks that the alternative topology builders give the same result as UMesh2dh::compute_topological
+int compare_builders(UMesh2dh& ref, UMesh2dh& m, const string name)
+{
+	int ierr = 0;
+	ref.compute_topological();
+	ref.compute_boundary_maps();
+	m.compute_topological_hashed();
+	m.compute_boundary_maps();
+	int ndiff = compareTopology(ref,m);
+	if(ndiff > 0) {
+		cout << "! Hashed topology differs from the reference in " << ndiff << " entries for " << name << "!\n";
+		ierr++;
+	}
+	
+	m.compute_topological_parallel();
+	m.compute_boundary_maps_parallel();
+	ndiff = compareTopology(ref,m);
+	if(ndiff > 0) {
+		cout << "! Parallel topology differs from the reference in " << ndiff << " entries for " << name << "!\n";
+		ierr++;
+	}
+
+	if(ierr == 0)
+		cout << "Hashed and parallel topology match the reference for " << name << endl;
+	return ierr;
+}
+
+int compare_file(const string meshfile)
+{
+	UMesh2dh ref, m;
+	ref.readGmsh2(meshfile,2);
+	m.readGmsh2(meshfile,2);
+	return compare_builders(ref, m, meshfile);
+}
+
+int compare_generated(const a_int nx, const a_int ny, const Shape shape)
+{
+	UMesh2dh ref, m;
+	ref.generateRectangle(-1.0,1.0,-1.0,1.0, nx,ny, shape);
+	m.generateRectangle(-1.0,1.0,-1.0,1.0, nx,ny, shape);
+	return compare_builders(ref, m, shape == QUADRANGLE ? "generated quadrangle mesh" : "generated triangle mesh");
+}
+
+/// Checks that the topology of a renumbered mesh is consistent
+int check_reordered(const string meshfile, const char ordering)
+{
+	UMesh2dh ref, m;
+	m.readGmsh2(meshfile,2);
+	m.compute_topological();
+	m.compute_boundary_maps();
+	m.reorder_elements(ordering);
+
+	// interior faces must be sorted by left element
+	int ierr = 0;
+	for(a_int iface = m.gnbface()+1; iface < m.gnaface(); iface++)
+		if(m.gintfac(iface,0) < m.gintfac(iface-1,0))
+			ierr++;
+	if(ierr > 0)
+		cout << "! Faces are not sorted after reordering " << meshfile << "!\n";
+
+	ref = m;
+	return ierr + compare_builders(ref, m, meshfile + " reordered by " + ordering);
+}
+
+int main()
+{
+	int ierr = 0;
+	ierr += compare_file("../../testcases/unittests/circlehybrid_p2.msh");
+	ierr += compare_file("../../testcases/unittests/testhybrid.msh");
+	ierr += compare_file("../../testcases/advection/grids/square2.msh");
+	ierr += compare_file("../../testcases/advection/grids/squarequad-p2-1.msh");
+	ierr += compare_generated(17,12,TRIANGLE);
+	ierr += compare_generated(9,23,QUADRANGLE);
+	ierr += check_reordered("../../testcases/unittests/circlehybrid_p2.msh", 'h');
+	ierr += check_reordered("../../testcases/unittests/circlehybrid_p2.msh", 'r');
+	ierr += check_reordered("../../testcases/advection/grids/square2.msh", 'h');
+	ierr += check_reordered("../../testcases/advection/grids/square2.msh", 'r');
+	return ierr;
+}
@@ -26,6 +26,10 @@ int main(int argc, char* argv[])
 		m.readDomn(inmesh);
 	else if(informat == "msh")
 		m.readGmsh2(inmesh,2);
+	else if(informat == "bin") {
+		if(!m.readBinary(inmesh))
+			return -1;
+	}
 	else {
 		cout << "Invalid format. Exiting." << endl;
 		return -1;
@@ -35,6 +39,14 @@ int main(int argc, char* argv[])
 		m.writeGmsh2(outmesh);
 	else if(outformat == "vtu")
 		writeMeshToVtu(outmesh, m);
+	else if(outformat == "bin") {
+		// the binary format carries the topological data along with the mesh
+		if(informat != "bin") {
+			m.compute_topological();
+			m.compute_boundary_maps();
+		}
+		m.writeBinary(outmesh);
+	}
 	else {
 		cout << "Invalid format. Exiting." << endl;
 		return -1;